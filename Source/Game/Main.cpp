@@ -22,8 +22,11 @@
 #include "Model/Model.h"
 #include "Renderer/Skybox.h"
 #include "Scene/Scene.h"
+#include "Scene/TerrainGenerator.h"
 #include "Scene/Voxel.h"
+#include "Shader/PackedVoxelVertexShader.h"
 #include "Shader/SkyMapVertexShader.h"
+#include "Shader/VoxelMeshVertexShader.h"
 
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
   Function: wWinMain
@@ -53,163 +56,46 @@ INT WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 
     std::unique_ptr<library::Game> game = std::make_unique<library::Game>(L"Game Graphics Programming Assignment 3: Cube Mapping");
 
-    std::ofstream sceneFile;
-    sceneFile.open("HeightMap.txt");
     constexpr const UINT MAP_WIDTH = 0;
     constexpr const UINT MAP_HEIGHT = 0;
     constexpr const UINT MAP_DEPTH = 0;
-    XMFLOAT4 aColors[] =
-    {
-        XMFLOAT4(0.0f,      0.666f, 0.0f,   1.0f),  // GRASSLAND
-        XMFLOAT4(1.0f,      1.0f,   1.0f,   1.0f),  // SNOW
-        XMFLOAT4(0.0f,      0.0f,   0.666f, 1.0f),  // OCEAN
-        XMFLOAT4(1.0f,      0.666f, 0.0f,   1.0f),  // SAND
-        XMFLOAT4(0.666f,    0.0f,   0.0f,   1.0f),  // SCORCHED
-        XMFLOAT4(0.956f,    0.643f, 0.376f, 1.0f),  // BARE
-        XMFLOAT4(0.941f,    0.0f,   1.0f,   1.0f),  // TUNDRA
-        XMFLOAT4(0.803f,    0.521f, 0.247f, 1.0f),  // TEMPERATE_DESERT
-        XMFLOAT4(0.42f,     0.556f, 0.137f, 1.0f),  // SHRUBLAND
-        XMFLOAT4(0.0f,      0.392f, 0.0f,   1.0f),  // TAIGA
-        XMFLOAT4(1.0f,      0.55f,  0.0f,   1.0f),  // TEMPERATE_DECIDUOUS_FOREST
-        XMFLOAT4(0.0f,      0.5f,   0.0f,   1.0f),  // TEMPERATE_RAIN_FOREST
-        XMFLOAT4(0.956f,    0.643f, 0.376f, 1.0f),  // SUBTROPICAL_DESERT
-        XMFLOAT4(0.133f,    0.545f, 0.133f, 1.0f),  // TROPICAL_SEASONAL_FOREST
-        XMFLOAT4(0.15f,     0.372f, 0.15f,  1.0f),  // TROPICAL_RAIN_FOREST
-    };
 
-    sceneFile << MAP_WIDTH << " " << MAP_HEIGHT << " " << MAP_DEPTH << ' ' << ARRAYSIZE(aColors) << '\n';
-
-    for (UINT colorIdx = 0; colorIdx < ARRAYSIZE(aColors); ++colorIdx)
+    library::ChunkStreamingDesc streamingDesc =
     {
-        sceneFile << aColors[colorIdx].x << ' ' <<
-            aColors[colorIdx].y << ' ' <<
-            aColors[colorIdx].z << '\n';
-    }
-
-    for (UINT z = 0u; z < MAP_DEPTH; ++z)
+        .uChunkSize = 32u,
+        .ResidencyRadius = 192.0f,
+        .uMemoryBudget = 256u * 1024u * 1024u,
+        .uNumThreads = 0u,
+        .Instancing = library::eVoxelInstancing::COLUMN,
+        .bPackedInstances = TRUE,
+        .bGreedyMeshing = TRUE,
+        .uNumLodLevels = 4u,
+        .LodDistance = 96.0f,
+        .bAmbientOcclusion = TRUE,
+        .bVoxelLighting = TRUE
+    };
+    std::shared_ptr<library::Scene> mainScene;
     {
-        for (UINT x = 0u; x < MAP_WIDTH; ++x)
+        library::TerrainGenerator terrainGenerator(MAP_WIDTH, MAP_HEIGHT, MAP_DEPTH);
+        if (terrainGenerator.IsCacheValid(L"HeightMap.bin"))
         {
-            FLOAT height = 0.0f;
-
-            FLOAT frequencySum = 0.0f;
-            for (UINT i = 0; i < 4; ++i)
-            {
-                FLOAT frequency = pow(2.0f, static_cast<FLOAT>(i));
-                frequencySum += 1.0f / frequency;
-                height += library::Scene::GetPerlin2d(frequency * static_cast<FLOAT>(x), frequency * static_cast<FLOAT>(z), 0.1f, 4u) / frequency;
-            }
-            height /= frequencySum;
-            height = pow(height * 1.2f, 1.25f);
-
-            assert(height >= 0.0f);
-
-            FLOAT moisture = 0.0f;
-
-            frequencySum = 0.0f;
-            for (UINT i = 0; i < 4; ++i)
-            {
-                FLOAT frequency = pow(2.0f, static_cast<FLOAT>(i));
-                frequencySum += 1.0f / frequency;
-                moisture += library::Scene::GetPerlin2d(frequency * static_cast<FLOAT>(x), frequency * static_cast<FLOAT>(z), 0.1f, 4u) / frequency;
-            }
-            moisture /= frequencySum;
-            moisture = pow(moisture * 1.2f, 1.25f);
-
-            library::eBlockType blockType = library::eBlockType::GRASSLAND;
-
-            if (height < 0.1f)
-            {
-                blockType = library::eBlockType::OCEAN;
-            }
-            else if (height < 0.12f)
-            {
-                blockType = library::eBlockType::SAND;
-            }
-            else if (height > 0.8f)
-            {
-                if (moisture < 0.1f)
-                {
-                    blockType = library::eBlockType::SCORCHED;
-                }
-                else if (moisture < 0.2f)
-                {
-                    blockType = library::eBlockType::BARE;
-                }
-                else if (moisture < 0.5f)
-                {
-                    blockType = library::eBlockType::TUNDRA;
-                }
-                else
-                {
-                    blockType = library::eBlockType::SNOW;
-                }
-            }
-            else if (height > 0.6f)
-            {
-                if (moisture < 0.33f)
-                {
-                    blockType = library::eBlockType::TEMPERATE_DESERT;
-                }
-                else if (moisture < 0.66f)
-                {
-                    blockType = library::eBlockType::SHRUBLAND;
-                }
-                else
-                {
-                    blockType = library::eBlockType::TAIGA;
-                }
-            }
-            else if (height > 0.3f)
-            {
-                if (moisture < 0.16f)
-                {
-                    blockType = library::eBlockType::TEMPERATE_DESERT;
-                }
-                else if (moisture < 0.5f)
-                {
-                    blockType = library::eBlockType::GRASSLAND;
-                }
-                else if (moisture < 0.83f)
-                {
-                    blockType = library::eBlockType::TEMPERATE_DECIDUOUS_FOREST;
-                }
-                else
-                {
-                    blockType = library::eBlockType::TEMPERATE_RAIN_FOREST;
-                }
-            }
-            else
+            mainScene = std::make_shared<library::Scene>(L"HeightMap.bin", streamingDesc);
+        }
+        else
+        {
+            terrainGenerator.Generate(&library::TextureCache::GetShared().GetThreadPool());
+            if (FAILED(terrainGenerator.SaveToBinary(L"HeightMap.bin")))
             {
-
-                if (moisture < 0.16f)
-                {
-                    blockType = library::eBlockType::SUBTROPICAL_DESERT;
-                }
-                else if (moisture < 0.33f)
-                {
-                    blockType = library::eBlockType::GRASSLAND;
-                }
-                else if (moisture < 0.66f)
-                {
-                    blockType = library::eBlockType::TROPICAL_SEASONAL_FOREST;
-                }
-                else
-                {
-                    blockType = library::eBlockType::TROPICAL_RAIN_FOREST;
-                }
+                return 0;
             }
-
-            sceneFile << static_cast<CHAR>(blockType);
-
-            sceneFile << height << ' ';
+            mainScene = std::make_shared<library::Scene>(terrainGenerator.GetGrid(), streamingDesc);
         }
-        sceneFile << '\n';
     }
-    sceneFile << std::endl;
-    sceneFile.close();
-
-    std::shared_ptr<library::Scene> mainScene = std::make_shared<library::Scene>(L"HeightMap.txt");
+    // Edits of the previous sessions stream in on top of the generated terrain
+    if (std::filesystem::exists(L"World.sav") && FAILED(mainScene->LoadWorld(L"World.sav")))
+    {
+        return 0;
+    }
 
     // Phong
     std::shared_ptr<library::VertexShader> phongVertexShader = std::make_shared<library::VertexShader>(L"Shaders/PhongShaders.fxh", "VSPhong", "vs_5_0");
@@ -223,6 +109,18 @@ INT WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
     {
         return 0;
     }
+    // Packed Voxel
+    std::shared_ptr<library::PackedVoxelVertexShader> packedVoxelVertexShader = std::make_shared<library::PackedVoxelVertexShader>(L"Shaders/VoxelShaders.fxh", "VSPackedVoxel", "vs_5_0");
+    if (FAILED(mainScene->AddVertexShader(L"PackedVoxelShader", packedVoxelVertexShader)))
+    {
+        return 0;
+    }
+    // Voxel Mesh
+    std::shared_ptr<library::VoxelMeshVertexShader> voxelMeshVertexShader = std::make_shared<library::VoxelMeshVertexShader>(L"Shaders/VoxelShaders.fxh", "VSVoxelMesh", "vs_5_0");
+    if (FAILED(mainScene->AddVertexShader(L"VoxelMeshShader", voxelMeshVertexShader)))
+    {
+        return 0;
+    }
     // Light Cube
     std::shared_ptr<library::VertexShader> lightVertexShader = std::make_shared<library::VertexShader>(L"Shaders/PhongShaders.fxh", "VSLightCube", "vs_5_0");
     if (FAILED(mainScene->AddVertexShader(L"LightShader", lightVertexShader)))
@@ -273,7 +171,7 @@ INT WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
         return 0;
     }
 
-    if (FAILED(mainScene->SetVertexShaderOfVoxel(L"VoxelShader")))
+    if (FAILED(mainScene->SetVertexShaderOfVoxel(streamingDesc.bPackedInstances ? L"PackedVoxelShader" : L"VoxelShader")))
     {
         return 0;
     }
@@ -283,6 +181,11 @@ INT WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
         return 0;
     }
 
+    if (FAILED(mainScene->SetVertexShaderOfVoxelMesh(L"VoxelMeshShader")))
+    {
+        return 0;
+    }
+
     std::shared_ptr<library::Skybox> skybox = std::make_shared<library::Skybox>(L"Content/Common/Maskonaive2_1024.dds", 500.0f);
     skybox->SetVertexShader(cubeMapVertexShader);
     skybox->SetPixelShader(cubeMapPixelShader);
@@ -368,5 +271,21 @@ INT WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
         return 0;
     }
 
-    return game->Run();
+    const INT iResult = game->Run();
+
+    // Deferred while a world save is still loading, FinishWorld applies
+    // the rest of it and waits for the background write
+    HRESULT hr = mainScene->SaveWorld(L"World.sav");
+    if (SUCCEEDED(hr))
+    {
+        hr = mainScene->FinishWorld();
+    }
+    if (FAILED(hr))
+    {
+        WCHAR szMessage[256];
+        swprintf_s(szMessage, L"Saving World.sav failed: 0x%08X\n", static_cast<UINT>(hr));
+        OutputDebugString(szMessage);
+    }
+
+    return iResult;
 }
\ No newline at end of file
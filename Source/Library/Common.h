@@ -104,4 +104,19 @@ namespace library
         TROPICAL_RAIN_FOREST,
         COUNT,
     };
+
+    /*E+E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E
+        Enum:     eVoxelInstancing
+
+        Summary:  Enumeration of the ways height map columns are turned
+                  into voxel instances. BLOCK emits one instance per
+                  block, COLUMN emits one instance per column whose
+                  cube is stretched over the whole column
+    E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E-E*/
+    enum class eVoxelInstancing : BYTE
+    {
+        BLOCK = 0,
+        COLUMN,
+        COUNT,
+    };
 }
\ No newline at end of file
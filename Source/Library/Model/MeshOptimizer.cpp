@@ -0,0 +1,461 @@
+#include "Model/MeshOptimizer.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MeshOptimizer::OptimizeVertexCache
+
+      Summary:  Reorders the triangles with Tipsify. The next fanning
+                vertex is the live candidate that entered the cache
+                the earliest but will still be in it after its
+                remaining triangles are emitted. When no candidate is
+                live, the algorithm jumps to a vertex of the dead-end
+                stack or the next live vertex in input order. A jump to
+                a vertex out of the cache starts a new cluster
+
+      Args:     UINT* pIndices
+                  Indices of the triangle list, reordered in place
+                UINT uNumIndices
+                  Number of indices, a multiple of 3
+                UINT uNumVertices
+                  Number of vertices referenced by the indices
+                UINT uCacheSize
+                  Number of entries of the simulated vertex cache
+                std::vector<UINT>& aOutClusters
+                  First triangle of every cluster, in ascending order
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MeshOptimizer::OptimizeVertexCache(
+        _Inout_updates_(uNumIndices) UINT* pIndices,
+        _In_ UINT uNumIndices,
+        _In_ UINT uNumVertices,
+        _In_ UINT uCacheSize,
+        _Out_ std::vector<UINT>& aOutClusters
+    )
+    {
+        aOutClusters.clear();
+
+        const UINT uNumTriangles = uNumIndices / 3u;
+        if (uNumTriangles == 0u || uNumVertices == 0u)
+        {
+            return;
+        }
+
+        // Triangles around every vertex
+        std::vector<UINT> aLiveTriangles(uNumVertices, 0u);
+        for (UINT i = 0u; i < uNumTriangles * 3u; ++i)
+        {
+            ++aLiveTriangles[pIndices[i]];
+        }
+
+        std::vector<UINT> aAdjacencyOffsets(uNumVertices + 1u, 0u);
+        std::partial_sum(aLiveTriangles.begin(), aLiveTriangles.end(), aAdjacencyOffsets.begin() + 1);
+
+        std::vector<UINT> aAdjacency(uNumTriangles * 3u);
+        std::vector<UINT> aAdjacencyCursors(aAdjacencyOffsets.begin(), aAdjacencyOffsets.end() - 1);
+        for (UINT i = 0u; i < uNumTriangles * 3u; ++i)
+        {
+            aAdjacency[aAdjacencyCursors[pIndices[i]]++] = i / 3u;
+        }
+
+        std::vector<UINT> aTimestamps(uNumVertices, 0u);
+        std::vector<BOOL> aEmitted(uNumTriangles, FALSE);
+        std::vector<UINT> aDeadEndStack;
+        std::vector<UINT> aCandidates;
+        std::vector<UINT> aOutput;
+        aDeadEndStack.reserve(uNumTriangles * 3u);
+        aOutput.reserve(uNumTriangles * 3u);
+
+        UINT uTimestamp = uCacheSize + 1u;
+        UINT uInputCursor = 1u;
+        UINT uCurrentVertex = 0u;
+
+        aOutClusters.push_back(0u);
+
+        while (uCurrentVertex != INVALID_VERTEX)
+        {
+            aCandidates.clear();
+
+            for (UINT i = aAdjacencyOffsets[uCurrentVertex]; i < aAdjacencyOffsets[uCurrentVertex + 1u]; ++i)
+            {
+                const UINT uTriangle = aAdjacency[i];
+                if (aEmitted[uTriangle])
+                {
+                    continue;
+                }
+
+                for (UINT uCorner = 0u; uCorner < 3u; ++uCorner)
+                {
+                    const UINT uVertex = pIndices[uTriangle * 3u + uCorner];
+
+                    aOutput.push_back(uVertex);
+                    aDeadEndStack.push_back(uVertex);
+                    aCandidates.push_back(uVertex);
+
+                    --aLiveTriangles[uVertex];
+
+                    if (uTimestamp - aTimestamps[uVertex] > uCacheSize)
+                    {
+                        aTimestamps[uVertex] = uTimestamp++;
+                    }
+                }
+
+                aEmitted[uTriangle] = TRUE;
+            }
+
+            UINT uNextVertex = INVALID_VERTEX;
+            INT iBestPriority = -1;
+            for (UINT uCandidate : aCandidates)
+            {
+                if (aLiveTriangles[uCandidate] == 0u)
+                {
+                    continue;
+                }
+
+                // Prefer the vertex closest to leaving the cache that
+                // survives the fan of its remaining triangles
+                INT iPriority = 0;
+                if (uTimestamp - aTimestamps[uCandidate] + 2u * aLiveTriangles[uCandidate] <= uCacheSize)
+                {
+                    iPriority = static_cast<INT>(uTimestamp - aTimestamps[uCandidate]);
+                }
+
+                if (iPriority > iBestPriority)
+                {
+                    iBestPriority = iPriority;
+                    uNextVertex = uCandidate;
+                }
+            }
+
+            if (uNextVertex == INVALID_VERTEX)
+            {
+                uNextVertex = getNextVertexDeadEnd(aDeadEndStack, uInputCursor, aLiveTriangles);
+
+                // Only split where the jump misses the cache anyway, so
+                // that reordering the clusters costs no extra misses
+                const UINT uFirstTriangle = static_cast<UINT>(aOutput.size()) / 3u;
+                if (uNextVertex != INVALID_VERTEX && uTimestamp - aTimestamps[uNextVertex] > uCacheSize && uFirstTriangle != aOutClusters.back())
+                {
+                    aOutClusters.push_back(uFirstTriangle);
+                }
+            }
+
+            uCurrentVertex = uNextVertex;
+        }
+
+        std::copy(aOutput.begin(), aOutput.end(), pIndices);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MeshOptimizer::OptimizeOverdraw
+
+      Summary:  Sorts the clusters made by OptimizeVertexCache by how
+                much they face away from the center of the mesh. From
+                most viewpoints the outward facing clusters are in
+                front, so drawing them first lets the depth test reject
+                the ones behind. The order inside every cluster is
+                kept, so the vertex cache efficiency barely changes
+
+      Args:     UINT* pIndices
+                  Indices of the triangle list, reordered in place
+                UINT uNumIndices
+                  Number of indices, a multiple of 3
+                const SimpleVertex* pVertices
+                  Vertices referenced by the indices
+                UINT uNumVertices
+                  Number of vertices
+                const std::vector<UINT>& aClusters
+                  First triangle of every cluster, in ascending order
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MeshOptimizer::OptimizeOverdraw(
+        _Inout_updates_(uNumIndices) UINT* pIndices,
+        _In_ UINT uNumIndices,
+        _In_reads_(uNumVertices) const SimpleVertex* pVertices,
+        _In_ UINT uNumVertices,
+        _In_ const std::vector<UINT>& aClusters
+    )
+    {
+        const UINT uNumTriangles = uNumIndices / 3u;
+        const UINT uNumClusters = static_cast<UINT>(aClusters.size());
+        if (uNumClusters < 2u || uNumVertices == 0u)
+        {
+            return;
+        }
+
+        // Area weighted centroids and vertex normal sums of the clusters
+        std::vector<XMFLOAT3> aCentroids(uNumClusters, XMFLOAT3(0.0f, 0.0f, 0.0f));
+        std::vector<XMFLOAT3> aNormals(uNumClusters, XMFLOAT3(0.0f, 0.0f, 0.0f));
+        XMVECTOR meshCentroid = XMVectorZero();
+        FLOAT meshArea = 0.0f;
+
+        for (UINT uCluster = 0u; uCluster < uNumClusters; ++uCluster)
+        {
+            const UINT uBeginTriangle = aClusters[uCluster];
+            const UINT uEndTriangle = uCluster + 1u < uNumClusters ? aClusters[uCluster + 1u] : uNumTriangles;
+
+            XMVECTOR centroid = XMVectorZero();
+            XMVECTOR normal = XMVectorZero();
+            FLOAT area = 0.0f;
+            for (UINT uTriangle = uBeginTriangle; uTriangle < uEndTriangle; ++uTriangle)
+            {
+                const SimpleVertex& a = pVertices[pIndices[uTriangle * 3u]];
+                const SimpleVertex& b = pVertices[pIndices[uTriangle * 3u + 1u]];
+                const SimpleVertex& c = pVertices[pIndices[uTriangle * 3u + 2u]];
+
+                const XMVECTOR positionA = XMLoadFloat3(&a.Position);
+                const XMVECTOR positionB = XMLoadFloat3(&b.Position);
+                const XMVECTOR positionC = XMLoadFloat3(&c.Position);
+
+                const FLOAT triangleArea = 0.5f * XMVectorGetX(XMVector3Length(XMVector3Cross(positionB - positionA, positionC - positionA)));
+
+                centroid += (positionA + positionB + positionC) * (triangleArea / 3.0f);
+                normal += XMLoadFloat3(&a.Normal) + XMLoadFloat3(&b.Normal) + XMLoadFloat3(&c.Normal);
+                area += triangleArea;
+            }
+
+            meshCentroid += centroid;
+            meshArea += area;
+
+            XMStoreFloat3(&aCentroids[uCluster], area > 0.0f ? centroid * (1.0f / area) : centroid);
+            XMStoreFloat3(&aNormals[uCluster], XMVector3Normalize(normal));
+        }
+
+        if (meshArea > 0.0f)
+        {
+            meshCentroid = meshCentroid * (1.0f / meshArea);
+        }
+
+        std::vector<FLOAT> aSortKeys(uNumClusters);
+        for (UINT uCluster = 0u; uCluster < uNumClusters; ++uCluster)
+        {
+            const XMVECTOR offset = XMLoadFloat3(&aCentroids[uCluster]) - meshCentroid;
+            aSortKeys[uCluster] = XMVectorGetX(XMVector3Dot(offset, XMLoadFloat3(&aNormals[uCluster])));
+        }
+
+        std::vector<UINT> aOrder(uNumClusters);
+        std::iota(aOrder.begin(), aOrder.end(), 0u);
+        std::stable_sort(aOrder.begin(), aOrder.end(), [&aSortKeys](UINT uLeft, UINT uRight)
+        {
+            return aSortKeys[uLeft] > aSortKeys[uRight];
+        });
+
+        std::vector<UINT> aOutput;
+        aOutput.reserve(uNumTriangles * 3u);
+        for (UINT uCluster : aOrder)
+        {
+            const UINT uBeginTriangle = aClusters[uCluster];
+            const UINT uEndTriangle = uCluster + 1u < uNumClusters ? aClusters[uCluster + 1u] : uNumTriangles;
+
+            aOutput.insert(aOutput.end(), pIndices + uBeginTriangle * 3u, pIndices + uEndTriangle * 3u);
+        }
+
+        std::copy(aOutput.begin(), aOutput.end(), pIndices);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MeshOptimizer::OptimizeVertexFetch
+
+      Summary:  Renumbers the vertices in order of first use in the
+                index list and rewrites the indices. Unreferenced
+                vertices are moved to the end. The vertex streams are
+                then reordered with RemapVertices
+
+      Args:     UINT* pIndices
+                  Indices of the triangle list, rewritten in place
+                UINT uNumIndices
+                  Number of indices
+                UINT uNumVertices
+                  Number of vertices
+                std::vector<UINT>& aOutRemap
+                  New index of every old vertex
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MeshOptimizer::OptimizeVertexFetch(
+        _Inout_updates_(uNumIndices) UINT* pIndices,
+        _In_ UINT uNumIndices,
+        _In_ UINT uNumVertices,
+        _Out_ std::vector<UINT>& aOutRemap
+    )
+    {
+        aOutRemap.assign(uNumVertices, INVALID_VERTEX);
+
+        UINT uNextVertex = 0u;
+        for (UINT i = 0u; i < uNumIndices; ++i)
+        {
+            UINT& uRemapped = aOutRemap[pIndices[i]];
+            if (uRemapped == INVALID_VERTEX)
+            {
+                uRemapped = uNextVertex++;
+            }
+
+            pIndices[i] = uRemapped;
+        }
+
+        for (UINT& uRemapped : aOutRemap)
+        {
+            if (uRemapped == INVALID_VERTEX)
+            {
+                uRemapped = uNextVertex++;
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MeshOptimizer::AnalyzeVertexCache
+
+      Summary:  Simulates a FIFO post-transform vertex cache over an
+                index list
+
+      Args:     const UINT* pIndices
+                  Indices of the triangle list
+                UINT uNumIndices
+                  Number of indices, a multiple of 3
+                UINT uNumVertices
+                  Number of vertices referenced by the indices
+                UINT uCacheSize
+                  Number of entries of the simulated cache
+                FLOAT& outAcmr
+                  Average cache miss ratio: transformed vertices per
+                  triangle, between 0.5 and 3
+                FLOAT& outAtvr
+                  Average transformed to vertex ratio: transformed
+                  vertices per referenced vertex, 1 at best
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MeshOptimizer::AnalyzeVertexCache(
+        _In_reads_(uNumIndices) const UINT* pIndices,
+        _In_ UINT uNumIndices,
+        _In_ UINT uNumVertices,
+        _In_ UINT uCacheSize,
+        _Out_ FLOAT& outAcmr,
+        _Out_ FLOAT& outAtvr
+    )
+    {
+        outAcmr = 0.0f;
+        outAtvr = 0.0f;
+
+        const UINT uNumTriangles = uNumIndices / 3u;
+        if (uNumTriangles == 0u)
+        {
+            return;
+        }
+
+        std::vector<UINT> aTimestamps(uNumVertices, 0u);
+        UINT uTimestamp = uCacheSize + 1u;
+        UINT uNumTransformed = 0u;
+        UINT uNumReferenced = 0u;
+
+        for (UINT i = 0u; i < uNumTriangles * 3u; ++i)
+        {
+            const UINT uVertex = pIndices[i];
+            if (aTimestamps[uVertex] == 0u)
+            {
+                ++uNumReferenced;
+            }
+
+            if (uTimestamp - aTimestamps[uVertex] > uCacheSize)
+            {
+                aTimestamps[uVertex] = uTimestamp++;
+                ++uNumTransformed;
+            }
+        }
+
+        outAcmr = static_cast<FLOAT>(uNumTransformed) / static_cast<FLOAT>(uNumTriangles);
+        outAtvr = static_cast<FLOAT>(uNumTransformed) / static_cast<FLOAT>(uNumReferenced);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MeshOptimizer::OptimizeMesh
+
+      Summary:  Reorders a mesh for the vertex cache, then its clusters
+                against overdraw, then its vertices for fetching, and
+                measures the vertex cache before and after
+
+      Args:     UINT* pIndices
+                  Indices of the triangle list, rewritten in place
+                UINT uNumIndices
+                  Number of indices, a multiple of 3
+                const SimpleVertex* pVertices
+                  Vertices of the mesh, in their original order
+                UINT uNumVertices
+                  Number of vertices
+                std::vector<UINT>& aOutRemap
+                  New index of every old vertex, to apply to every
+                  vertex stream with RemapVertices
+                MeshOptimizationStats& outStats
+                  Statistics of the mesh
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MeshOptimizer::OptimizeMesh(
+        _Inout_updates_(uNumIndices) UINT* pIndices,
+        _In_ UINT uNumIndices,
+        _In_reads_(uNumVertices) const SimpleVertex* pVertices,
+        _In_ UINT uNumVertices,
+        _Out_ std::vector<UINT>& aOutRemap,
+        _Out_ MeshOptimizationStats& outStats
+    )
+    {
+        outStats = MeshOptimizationStats
+        {
+            .uNumVertices = uNumVertices,
+            .uNumTriangles = uNumIndices / 3u,
+        };
+
+        AnalyzeVertexCache(pIndices, uNumIndices, uNumVertices, DEFAULT_CACHE_SIZE, outStats.acmrIn, outStats.atvrIn);
+
+        std::vector<UINT> aClusters;
+        OptimizeVertexCache(pIndices, uNumIndices, uNumVertices, DEFAULT_CACHE_SIZE, aClusters);
+        OptimizeOverdraw(pIndices, uNumIndices, pVertices, uNumVertices, aClusters);
+        OptimizeVertexFetch(pIndices, uNumIndices, uNumVertices, aOutRemap);
+
+        AnalyzeVertexCache(pIndices, uNumIndices, uNumVertices, DEFAULT_CACHE_SIZE, outStats.acmrOut, outStats.atvrOut);
+        outStats.uNumClusters = static_cast<UINT>(aClusters.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MeshOptimizer::getNextVertexDeadEnd
+
+      Summary:  Returns the most recent vertex of the dead-end stack
+                that still has triangles, or else the next such vertex
+                in input order
+
+      Args:     std::vector<UINT>& aDeadEndStack
+                  Vertices of the emitted triangles, most recent last
+                UINT& uInputCursor
+                  Next vertex to look at in input order
+                const std::vector<UINT>& aLiveTriangles
+                  Number of triangles left around every vertex
+
+      Returns:  UINT
+                  Next fanning vertex, INVALID_VERTEX when every
+                  triangle is emitted
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT MeshOptimizer::getNextVertexDeadEnd(
+        _Inout_ std::vector<UINT>& aDeadEndStack,
+        _Inout_ UINT& uInputCursor,
+        _In_ const std::vector<UINT>& aLiveTriangles
+    )
+    {
+        while (!aDeadEndStack.empty())
+        {
+            const UINT uVertex = aDeadEndStack.back();
+            aDeadEndStack.pop_back();
+
+            if (aLiveTriangles[uVertex] > 0u)
+            {
+                return uVertex;
+            }
+        }
+
+        while (uInputCursor < aLiveTriangles.size())
+        {
+            if (aLiveTriangles[uInputCursor] > 0u)
+            {
+                return uInputCursor;
+            }
+
+            ++uInputCursor;
+        }
+
+        return INVALID_VERTEX;
+    }
+}
@@ -0,0 +1,150 @@
+/*+===================================================================
+  File:      MESHOPTIMIZER.H
+
+  Summary:   MeshOptimizer header file contains declarations of
+             MeshOptimizer class used to reorder imported meshes for
+             the post-transform vertex cache, overdraw and vertex
+             fetch.
+
+  Classes: MeshOptimizer
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Renderer/DataTypes.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   MeshOptimizationStats
+
+      Summary:  Vertex cache statistics of a mesh before and after the
+                optimization, simulated with a FIFO post-transform
+                cache
+
+                uNumVertices
+                  Number of vertices of the mesh
+                uNumTriangles
+                  Number of triangles of the mesh
+                uNumClusters
+                  Number of clusters reordered against overdraw
+                acmrIn
+                  Average cache miss ratio, transformed vertices per
+                  triangle, of the imported order
+                atvrIn
+                  Average transformed to vertex ratio of the imported
+                  order
+                acmrOut
+                  Average cache miss ratio of the optimized order
+                atvrOut
+                  Average transformed to vertex ratio of the optimized
+                  order
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct MeshOptimizationStats
+    {
+        UINT uNumVertices;
+        UINT uNumTriangles;
+        UINT uNumClusters;
+        FLOAT acmrIn;
+        FLOAT atvrIn;
+        FLOAT acmrOut;
+        FLOAT atvrOut;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    MeshOptimizer
+
+      Summary:  Reorders the triangles and vertices of an indexed
+                triangle list. The triangles are first ordered with
+                Tipsify (Sander et al. 2007), which fans around the
+                vertices still in the post-transform cache and splits
+                the mesh into clusters wherever it has to jump to a
+                vertex out of the cache. The clusters are then sorted
+                so that the ones facing away from the center of the
+                mesh, likely occluders, are drawn first. Finally the vertices are renumbered in
+                order of first use so that the vertex streams are
+                fetched linearly. Indices are relative to the first
+                vertex of the mesh. Pure CPU, safe to call from several
+                threads at once on different meshes
+
+      Methods:  OptimizeVertexCache
+                  Reorders the triangles for the vertex cache
+                OptimizeOverdraw
+                  Reorders the clusters of triangles against overdraw
+                OptimizeVertexFetch
+                  Renumbers the vertices in order of first use
+                RemapVertices
+                  Applies a vertex renumbering to a vertex stream
+                AnalyzeVertexCache
+                  Returns the ACMR and ATVR of an index order
+                OptimizeMesh
+                  Runs every stage on a mesh and reports the gain
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class MeshOptimizer
+    {
+    public:
+        static constexpr const UINT DEFAULT_CACHE_SIZE = 16u;
+
+        static void OptimizeVertexCache(
+            _Inout_updates_(uNumIndices) UINT* pIndices,
+            _In_ UINT uNumIndices,
+            _In_ UINT uNumVertices,
+            _In_ UINT uCacheSize,
+            _Out_ std::vector<UINT>& aOutClusters
+        );
+        static void OptimizeOverdraw(
+            _Inout_updates_(uNumIndices) UINT* pIndices,
+            _In_ UINT uNumIndices,
+            _In_reads_(uNumVertices) const SimpleVertex* pVertices,
+            _In_ UINT uNumVertices,
+            _In_ const std::vector<UINT>& aClusters
+        );
+        static void OptimizeVertexFetch(
+            _Inout_updates_(uNumIndices) UINT* pIndices,
+            _In_ UINT uNumIndices,
+            _In_ UINT uNumVertices,
+            _Out_ std::vector<UINT>& aOutRemap
+        );
+        static void AnalyzeVertexCache(
+            _In_reads_(uNumIndices) const UINT* pIndices,
+            _In_ UINT uNumIndices,
+            _In_ UINT uNumVertices,
+            _In_ UINT uCacheSize,
+            _Out_ FLOAT& outAcmr,
+            _Out_ FLOAT& outAtvr
+        );
+        static void OptimizeMesh(
+            _Inout_updates_(uNumIndices) UINT* pIndices,
+            _In_ UINT uNumIndices,
+            _In_reads_(uNumVertices) const SimpleVertex* pVertices,
+            _In_ UINT uNumVertices,
+            _Out_ std::vector<UINT>& aOutRemap,
+            _Out_ MeshOptimizationStats& outStats
+        );
+
+        template <class T>
+        static void RemapVertices(_In_ const std::vector<UINT>& aRemap, _Inout_updates_(aRemap.size()) T* pVertices)
+        {
+            std::vector<T> aOldVertices(pVertices, pVertices + aRemap.size());
+            for (size_t i = 0u; i < aRemap.size(); ++i)
+            {
+                pVertices[aRemap[i]] = aOldVertices[i];
+            }
+        }
+
+    public:
+        MeshOptimizer() = delete;
+
+    private:
+        static constexpr const UINT INVALID_VERTEX = 0xFFFFFFFF;
+
+        static UINT getNextVertexDeadEnd(
+            _Inout_ std::vector<UINT>& aDeadEndStack,
+            _Inout_ UINT& uInputCursor,
+            _In_ const std::vector<UINT>& aLiveTriangles
+        );
+    };
+}
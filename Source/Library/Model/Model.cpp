@@ -1,5 +1,9 @@
 #include "Model/Model.h"
 
+#include <fstream>
+
+#include "Thread/ThreadPool.h"
+
 #include "assimp/Importer.hpp"	// C++ importer interface
 #include "assimp/scene.h"		    // output data structure
 #include "assimp/postprocess.h"	// post processing flags
@@ -46,17 +50,91 @@ namespace library
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   ConvertQuaternionToVector
-      Summary:  Convert aiQuaternion to XMVECTOR
-      Returns:  XMVECTOR
+      Method:   ConvertQuaternionToFloat4
+      Summary:  Convert aiQuaternion to XMFLOAT4
+      Returns:  XMFLOAT4
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    XMFLOAT4 ConvertQuaternionToFloat4(_In_ const aiQuaternion& quaternion)
+    {
+        return XMFLOAT4(quaternion.x, quaternion.y, quaternion.z, quaternion.w);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GetTexturePath
+
+      Summary:  Returns the path of the first texture of the given type
+                of an assimp material, relative to the model directory
+
+      Args:     const aiMaterial* pMaterial
+                  Pointer to an assimp material object
+                aiTextureType textureType
+                  Type of the texture
+
+      Returns:  std::string
+                  Path of the texture, empty if there is none
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::string GetTexturePath(_In_ const aiMaterial* pMaterial, _In_ aiTextureType textureType)
+    {
+        if (pMaterial->GetTextureCount(textureType) == 0u)
+        {
+            return std::string();
+        }
+
+        aiString aiPath;
+        if (pMaterial->GetTexture(textureType, 0u, &aiPath, nullptr, nullptr, nullptr, nullptr, nullptr) != AI_SUCCESS)
+        {
+            return std::string();
+        }
+
+        std::string szPath(aiPath.data);
+        if (szPath.substr(0ull, 2ull) == ".\\")
+        {
+            szPath = szPath.substr(2ull, szPath.size() - 2ull);
+        }
+
+        return szPath;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GetFileStamp
+
+      Summary:  Returns the size and last write time of a file
+
+      Args:     const std::filesystem::path& filePath
+                  Path to the file
+                UINT64& uOutSize
+                  Bytes of the file
+                UINT64& uOutWriteTime
+                  Last write time of the file
+
+      Returns:  BOOL
+                  Whether the file exists
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    XMVECTOR ConvertQuaternionToVector(_In_ const aiQuaternion& quaternion)
+    BOOL GetFileStamp(_In_ const std::filesystem::path& filePath, _Out_ UINT64& uOutSize, _Out_ UINT64& uOutWriteTime)
     {
-        XMFLOAT4 float4 = XMFLOAT4(quaternion.x, quaternion.y, quaternion.z, quaternion.w);
-        return XMLoadFloat4(&float4);
+        uOutSize = 0u;
+        uOutWriteTime = 0u;
+
+        std::error_code error;
+        const std::uintmax_t uSize = std::filesystem::file_size(filePath, error);
+        if (error)
+        {
+            return FALSE;
+        }
+
+        const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(filePath, error);
+        if (error)
+        {
+            return FALSE;
+        }
+
+        uOutSize = static_cast<UINT64>(uSize);
+        uOutWriteTime = static_cast<UINT64>(writeTime.time_since_epoch().count());
+
+        return TRUE;
     }
 
-    std::unique_ptr<Assimp::Importer> Model::sm_pImporter = std::make_unique<Assimp::Importer>();
+    std::unique_ptr<Assimp::Importer> Model::sm_pImporter;
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::Model
@@ -66,7 +144,12 @@ namespace library
       Args:     const std::filesystem::path& filePath
                   Path to the model to load
 
-      Modifies: [m_filePath, m_aVertices, m_aIndices].
+      Modifies: [m_filePath, m_aVertices, m_aIndices,
+                 m_aPackedIndices, m_aTexturePaths,
+                 m_aNodes, m_aNodeTransforms, m_aAnimations,
+                 m_aChannels, m_aPositionKeys, m_aRotationKeys,
+                 m_aScalingKeys, m_aMeshOptimizationStats,
+                 m_bOptimizeMeshes].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     Model::Model(_In_ const std::filesystem::path& filePath) :
         Renderable(XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f)),
@@ -76,24 +159,31 @@ namespace library
         m_aVertices(),
         m_aAnimationData(),
         m_aIndices(),     
+        m_aPackedIndices(),
         m_aBoneData(),
         m_aBoneInfo(),
         m_aTransforms(),
         m_boneNameToIndexMap(),
-        m_pScene(),
+        m_aTexturePaths(),
+        m_aNodes(),
+        m_aNodeTransforms(),
+        m_aAnimations(),
+        m_aChannels(),
+        m_aPositionKeys(),
+        m_aRotationKeys(),
+        m_aScalingKeys(),
+        m_aMeshOptimizationStats(),
         m_timeSinceLoaded(),
+        m_bOptimizeMeshes(TRUE),
         m_globalInverseTransform()
     {}
 
-    Model::~Model()
-    {
-        delete m_pScene;
-    }
-
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::Initialize
 
-      Summary:  Constructor
+      Summary:  Loads the cooked model, cooking it first when it is
+                missing or older than the model file, and creates the
+                buffers
 
       Args:     ID3D11Device* pDevice
                   The Direct3D device to create the buffers
@@ -107,33 +197,27 @@ namespace library
     {
         HRESULT hr = S_OK;
 
-        // Create the buffers for the vertices attributes
-
-        m_pScene = sm_pImporter->ReadFile(
-            m_filePath.string().c_str(),
-            ASSIMP_LOAD_FLAGS
-            );
-
-        m_pScene = sm_pImporter->GetOrphanedScene();
-
-        if (!m_pScene)
+        const std::filesystem::path cookedFilePath = getCookedFilePath();
+        hr = loadCookedModel(cookedFilePath);
+        if (FAILED(hr))
         {
-            hr = E_FAIL;
-            OutputDebugString(L"Error parsing ");
-            OutputDebugString(m_filePath.c_str());
-            OutputDebugString(L": ");
-            OutputDebugStringA(sm_pImporter->GetErrorString());
-            OutputDebugString(L"\n");
+            hr = cookModel(cookedFilePath);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
 
+        hr = initMaterials(pDevice, pImmediateContext);
+        if (FAILED(hr))
+        {
             return hr;
         }
-                
-        auto transformation = ConvertMatrix(m_pScene->mRootNode->mTransformation);
-        auto determinant = XMMatrixDeterminant(transformation);
-        m_globalInverseTransform = XMMatrixInverse(&determinant, transformation);
-        hr = initFromScene(pDevice, pImmediateContext, m_pScene, m_filePath);
 
-        if (FAILED(hr)) 
+        packIndices();
+
+        hr = initialize(pDevice, pImmediateContext);
+        if (FAILED(hr))
         {
             return hr;
         }
@@ -194,17 +278,17 @@ namespace library
     {
         m_timeSinceLoaded += deltaTime;
 
-        if (m_pScene->HasAnimations())
+        if (!m_aAnimations.empty())
         {
-            auto& anim = m_pScene->mAnimations[0];
+            const ModelAnimation& anim = m_aAnimations[0];
 
-            FLOAT ticksPerSecond = static_cast<FLOAT>((anim->mTicksPerSecond != 0.0) ? anim->mTicksPerSecond : 25.0f);
+            FLOAT ticksPerSecond = (anim.TicksPerSecond != 0.0f) ? anim.TicksPerSecond : 25.0f;
             FLOAT timeInTicks = m_timeSinceLoaded * ticksPerSecond;
-            FLOAT timeTicks = fmod(timeInTicks, static_cast<FLOAT>(anim->mDuration));
+            FLOAT timeTicks = fmod(timeInTicks, anim.Duration);
 
-            if (m_pScene->mRootNode)
+            if (!m_aNodes.empty())
             {
-                readNodeHierarchy(timeTicks, m_pScene->mRootNode, XMMatrixIdentity());
+                readNodeHierarchy(timeTicks, anim);
                 m_aTransforms.resize(m_aBoneInfo.size());
                 for (UINT i = 0u; i < m_aTransforms.size(); i++)
                 {
@@ -244,6 +328,502 @@ namespace library
     }
 
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::cookModel
+
+      Summary:  Imports the model file with Assimp, optimizes the
+                meshes if enabled and writes the cooked model. A cooked
+                model that cannot be written is not an error, the model
+                is cooked again next launch
+
+      Args:     const std::filesystem::path& cookedFilePath
+                  Path to write the cooked model to
+
+      Modifies: [m_aMeshes, m_aVertices, m_aNormalData,
+                 m_aAnimationData, m_aIndices, m_aBoneData,
+                 m_aBoneInfo, m_boneNameToIndexMap, m_aTexturePaths,
+                 m_aNodes, m_aNodeTransforms, m_aAnimations,
+                 m_aChannels, m_aPositionKeys, m_aRotationKeys,
+                 m_aScalingKeys, m_aMeshOptimizationStats,
+                 m_globalInverseTransform].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Model::cookModel(_In_ const std::filesystem::path& cookedFilePath)
+    {
+        if (!sm_pImporter)
+        {
+            sm_pImporter = std::make_unique<Assimp::Importer>();
+        }
+
+        const aiScene* pScene = sm_pImporter->ReadFile(
+            m_filePath.string().c_str(),
+            ASSIMP_LOAD_FLAGS
+            );
+
+        if (!pScene)
+        {
+            OutputDebugString(L"Error parsing ");
+            OutputDebugString(m_filePath.c_str());
+            OutputDebugString(L": ");
+            OutputDebugStringA(sm_pImporter->GetErrorString());
+            OutputDebugString(L"\n");
+
+            return E_FAIL;
+        }
+
+        auto transformation = ConvertMatrix(pScene->mRootNode->mTransformation);
+        auto determinant = XMMatrixDeterminant(transformation);
+        m_globalInverseTransform = XMMatrixInverse(&determinant, transformation);
+        initFromScene(pScene);
+
+        sm_pImporter->FreeScene();
+
+        if (m_bOptimizeMeshes)
+        {
+            optimizeMeshes();
+        }
+
+        if (FAILED(saveCookedModel(cookedFilePath)))
+        {
+            OutputDebugString(L"Error writing cooked model ");
+            OutputDebugString(cookedFilePath.c_str());
+            OutputDebugString(L"\n");
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::getCookedFilePath
+
+      Summary:  Returns the path of the cooked model, next to the model
+                file. Classes that build different meshes out of the
+                same model file return their own path
+
+      Returns:  std::filesystem::path
+                  Path of the cooked model
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::filesystem::path Model::getCookedFilePath() const
+    {
+        std::filesystem::path cookedFilePath = m_filePath;
+        cookedFilePath += L".cooked";
+
+        return cookedFilePath;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::loadCookedModel
+
+      Summary:  Memory-maps a cooked model and reads it. Fails when the
+                cooked model is missing, corrupt or older than the
+                model file
+
+      Args:     const std::filesystem::path& cookedFilePath
+                  Path to the cooked model
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Model::loadCookedModel(_In_ const std::filesystem::path& cookedFilePath)
+    {
+        HANDLE hFile = CreateFileW(cookedFilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (hFile == INVALID_HANDLE_VALUE)
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(hFile, &fileSize) || static_cast<size_t>(fileSize.QuadPart) < sizeof(CookedModelHeader))
+        {
+            CloseHandle(hFile);
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        HANDLE hFileMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0u, 0u, nullptr);
+        if (!hFileMapping)
+        {
+            HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+            CloseHandle(hFile);
+            return hr;
+        }
+
+        LPVOID pMappedView = MapViewOfFile(hFileMapping, FILE_MAP_READ, 0u, 0u, 0u);
+        if (!pMappedView)
+        {
+            HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+            CloseHandle(hFileMapping);
+            CloseHandle(hFile);
+            return hr;
+        }
+
+        HRESULT hr = readCookedModel(static_cast<const BYTE*>(pMappedView), static_cast<size_t>(fileSize.QuadPart));
+
+        UnmapViewOfFile(pMappedView);
+        CloseHandle(hFileMapping);
+        CloseHandle(hFile);
+
+        return hr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::readCookedModel
+
+      Summary:  Validates a cooked model in memory, then bulk copies
+                its arrays. Every offset, index and bone id is checked
+                against the array it reads from, and nothing is
+                modified if any is out of range, so Initialize imports
+                the model with Assimp instead. The source stamp is
+                only checked when the model file exists, so a cooked
+                model can ship without its source
+
+      Args:     const BYTE* pData
+                  Cooked model
+                size_t uSize
+                  Bytes of the cooked model
+
+      Modifies: [m_aMeshes, m_aVertices, m_aNormalData,
+                 m_aAnimationData, m_aIndices, m_aBoneInfo,
+                 m_boneNameToIndexMap, m_aTexturePaths, m_aNodes,
+                 m_aNodeTransforms, m_aAnimations, m_aChannels,
+                 m_aPositionKeys, m_aRotationKeys, m_aScalingKeys,
+                 m_globalInverseTransform].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Model::readCookedModel(_In_reads_bytes_(uSize) const BYTE* pData, _In_ size_t uSize)
+    {
+        const CookedModelHeader* pHeader = reinterpret_cast<const CookedModelHeader*>(pData);
+        if (uSize < sizeof(CookedModelHeader) || memcmp(pHeader->aMagic, COOKED_MAGIC, sizeof(COOKED_MAGIC)) != 0 || pHeader->uVersion != COOKED_VERSION)
+        {
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        UINT64 uSourceSize = 0u;
+        UINT64 uSourceWriteTime = 0u;
+        if (GetFileStamp(m_filePath, uSourceSize, uSourceWriteTime) && (uSourceSize != pHeader->uSourceSize || uSourceWriteTime != pHeader->uSourceWriteTime))
+        {
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        const UINT uFlags = m_bOptimizeMeshes ? COOKED_FLAG_OPTIMIZED_MESHES : 0u;
+        if (pHeader->uFlags != uFlags)
+        {
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        // Every array holds 4 byte aligned elements
+        const size_t uVerticesOffset = sizeof(CookedModelHeader);
+        const size_t uNormalDataOffset = uVerticesOffset + sizeof(SimpleVertex) * pHeader->uNumVertices;
+        const size_t uAnimationDataOffset = uNormalDataOffset + sizeof(NormalData) * pHeader->uNumVertices;
+        const size_t uIndicesOffset = uAnimationDataOffset + sizeof(AnimationData) * pHeader->uNumVertices;
+        const size_t uMeshesOffset = uIndicesOffset + sizeof(UINT) * pHeader->uNumIndices;
+        const size_t uMaterialsOffset = uMeshesOffset + sizeof(BasicMeshEntry) * pHeader->uNumMeshes;
+        const size_t uBonesOffset = uMaterialsOffset + sizeof(CookedMaterial) * pHeader->uNumMaterials;
+        const size_t uNodesOffset = uBonesOffset + sizeof(CookedBone) * pHeader->uNumBones;
+        const size_t uAnimationsOffset = uNodesOffset + sizeof(ModelNode) * pHeader->uNumNodes;
+        const size_t uChannelsOffset = uAnimationsOffset + sizeof(ModelAnimation) * pHeader->uNumAnimations;
+        const size_t uPositionKeysOffset = uChannelsOffset + sizeof(ModelChannel) * pHeader->uNumChannels;
+        const size_t uRotationKeysOffset = uPositionKeysOffset + sizeof(ModelVectorKey) * pHeader->uNumPositionKeys;
+        const size_t uScalingKeysOffset = uRotationKeysOffset + sizeof(ModelQuaternionKey) * pHeader->uNumRotationKeys;
+        const size_t uStringsOffset = uScalingKeysOffset + sizeof(ModelVectorKey) * pHeader->uNumScalingKeys;
+        if (uSize != uStringsOffset + pHeader->uNumStringBytes)
+        {
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        const AnimationData* pAnimationData = reinterpret_cast<const AnimationData*>(pData + uAnimationDataOffset);
+        const UINT* pIndices = reinterpret_cast<const UINT*>(pData + uIndicesOffset);
+        const BasicMeshEntry* pMeshes = reinterpret_cast<const BasicMeshEntry*>(pData + uMeshesOffset);
+        const CookedMaterial* pMaterials = reinterpret_cast<const CookedMaterial*>(pData + uMaterialsOffset);
+        const CookedBone* pBones = reinterpret_cast<const CookedBone*>(pData + uBonesOffset);
+        const ModelNode* pNodes = reinterpret_cast<const ModelNode*>(pData + uNodesOffset);
+        const ModelAnimation* pAnimations = reinterpret_cast<const ModelAnimation*>(pData + uAnimationsOffset);
+        const ModelChannel* pChannels = reinterpret_cast<const ModelChannel*>(pData + uChannelsOffset);
+        const CHAR* pszStrings = reinterpret_cast<const CHAR*>(pData + uStringsOffset);
+
+        // Offsets into the string table are valid when the table ends
+        // with a terminator
+        const UINT uNumStringBytes = pHeader->uNumStringBytes;
+        if (uNumStringBytes > 0u && pszStrings[uNumStringBytes - 1u] != '\0')
+        {
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        for (UINT i = 0u; i < pHeader->uNumMeshes; ++i)
+        {
+            const BasicMeshEntry& mesh = pMeshes[i];
+            if (static_cast<UINT64>(mesh.uBaseIndex) + mesh.uNumIndices > pHeader->uNumIndices || mesh.uBaseVertex > pHeader->uNumVertices
+                || (mesh.uMaterialIndex != INVALID_MATERIAL && mesh.uMaterialIndex >= pHeader->uNumMaterials))
+            {
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+
+            // Indices are relative to the base vertex, and the vertices
+            // of a mesh end where the next mesh begins
+            const UINT uEndVertex = i + 1u < pHeader->uNumMeshes ? pMeshes[i + 1u].uBaseVertex : pHeader->uNumVertices;
+            if (uEndVertex < mesh.uBaseVertex)
+            {
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+
+            const UINT uNumMeshVertices = uEndVertex - mesh.uBaseVertex;
+            for (UINT j = 0u; j < mesh.uNumIndices; ++j)
+            {
+                if (pIndices[mesh.uBaseIndex + j] >= uNumMeshVertices)
+                {
+                    return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                }
+            }
+        }
+
+        // Unused bone slots hold bone 0 with no weight, even in models
+        // without bones
+        for (UINT i = 0u; i < pHeader->uNumVertices; ++i)
+        {
+            const AnimationData& animationData = pAnimationData[i];
+            if ((animationData.aBoneWeights.x != 0.0f && animationData.aBoneIndices.x >= pHeader->uNumBones)
+                || (animationData.aBoneWeights.y != 0.0f && animationData.aBoneIndices.y >= pHeader->uNumBones)
+                || (animationData.aBoneWeights.z != 0.0f && animationData.aBoneIndices.z >= pHeader->uNumBones)
+                || (animationData.aBoneWeights.w != 0.0f && animationData.aBoneIndices.w >= pHeader->uNumBones))
+            {
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+        }
+
+        for (UINT i = 0u; i < pHeader->uNumMaterials; ++i)
+        {
+            const CookedMaterial& material = pMaterials[i];
+            if ((material.uDiffuseOffset != INVALID_INDEX && material.uDiffuseOffset >= uNumStringBytes)
+                || (material.uSpecularOffset != INVALID_INDEX && material.uSpecularOffset >= uNumStringBytes)
+                || (material.uNormalOffset != INVALID_INDEX && material.uNormalOffset >= uNumStringBytes))
+            {
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+        }
+
+        for (UINT i = 0u; i < pHeader->uNumBones; ++i)
+        {
+            if (pBones[i].uNameOffset >= uNumStringBytes)
+            {
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+        }
+
+        for (UINT i = 0u; i < pHeader->uNumNodes; ++i)
+        {
+            const ModelNode& node = pNodes[i];
+            if ((node.uParentIndex != INVALID_INDEX && node.uParentIndex >= i) || (node.uBoneIndex != INVALID_INDEX && node.uBoneIndex >= pHeader->uNumBones))
+            {
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+        }
+
+        for (UINT i = 0u; i < pHeader->uNumAnimations; ++i)
+        {
+            if (static_cast<UINT64>(pAnimations[i].uFirstChannel) + pAnimations[i].uNumChannels > pHeader->uNumChannels)
+            {
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+        }
+
+        for (UINT i = 0u; i < pHeader->uNumChannels; ++i)
+        {
+            const ModelChannel& channel = pChannels[i];
+            if (channel.uNodeIndex >= pHeader->uNumNodes
+                || channel.uNumPositionKeys == 0u || static_cast<UINT64>(channel.uFirstPositionKey) + channel.uNumPositionKeys > pHeader->uNumPositionKeys
+                || channel.uNumRotationKeys == 0u || static_cast<UINT64>(channel.uFirstRotationKey) + channel.uNumRotationKeys > pHeader->uNumRotationKeys
+                || channel.uNumScalingKeys == 0u || static_cast<UINT64>(channel.uFirstScalingKey) + channel.uNumScalingKeys > pHeader->uNumScalingKeys)
+            {
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+        }
+
+        const SimpleVertex* pVertices = reinterpret_cast<const SimpleVertex*>(pData + uVerticesOffset);
+        const NormalData* pNormalData = reinterpret_cast<const NormalData*>(pData + uNormalDataOffset);
+        const ModelVectorKey* pPositionKeys = reinterpret_cast<const ModelVectorKey*>(pData + uPositionKeysOffset);
+        const ModelQuaternionKey* pRotationKeys = reinterpret_cast<const ModelQuaternionKey*>(pData + uRotationKeysOffset);
+        const ModelVectorKey* pScalingKeys = reinterpret_cast<const ModelVectorKey*>(pData + uScalingKeysOffset);
+
+        m_aVertices.assign(pVertices, pVertices + pHeader->uNumVertices);
+        m_aNormalData.assign(pNormalData, pNormalData + pHeader->uNumVertices);
+        m_aAnimationData.assign(pAnimationData, pAnimationData + pHeader->uNumVertices);
+        m_aIndices.assign(pIndices, pIndices + pHeader->uNumIndices);
+        m_aMeshes.assign(pMeshes, pMeshes + pHeader->uNumMeshes);
+
+        m_aTexturePaths.resize(pHeader->uNumMaterials);
+        for (UINT i = 0u; i < pHeader->uNumMaterials; ++i)
+        {
+            const CookedMaterial& material = pMaterials[i];
+            m_aTexturePaths[i] = TexturePaths
+            {
+                .szDiffuse = (material.uDiffuseOffset != INVALID_INDEX) ? std::string(pszStrings + material.uDiffuseOffset) : std::string(),
+                .szSpecular = (material.uSpecularOffset != INVALID_INDEX) ? std::string(pszStrings + material.uSpecularOffset) : std::string(),
+                .szNormal = (material.uNormalOffset != INVALID_INDEX) ? std::string(pszStrings + material.uNormalOffset) : std::string()
+            };
+        }
+
+        m_aBoneInfo.clear();
+        m_boneNameToIndexMap.clear();
+        m_aBoneInfo.reserve(pHeader->uNumBones);
+        for (UINT i = 0u; i < pHeader->uNumBones; ++i)
+        {
+            m_aBoneInfo.push_back(BoneInfo(XMLoadFloat4x4(&pBones[i].OffsetMatrix)));
+            m_boneNameToIndexMap[pszStrings + pBones[i].uNameOffset] = i;
+        }
+
+        m_aNodes.assign(pNodes, pNodes + pHeader->uNumNodes);
+        m_aNodeTransforms.resize(m_aNodes.size());
+        m_aAnimations.assign(pAnimations, pAnimations + pHeader->uNumAnimations);
+        m_aChannels.assign(pChannels, pChannels + pHeader->uNumChannels);
+        m_aPositionKeys.assign(pPositionKeys, pPositionKeys + pHeader->uNumPositionKeys);
+        m_aRotationKeys.assign(pRotationKeys, pRotationKeys + pHeader->uNumRotationKeys);
+        m_aScalingKeys.assign(pScalingKeys, pScalingKeys + pHeader->uNumScalingKeys);
+
+        m_globalInverseTransform = XMLoadFloat4x4(&pHeader->GlobalInverseTransform);
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::saveCookedModel
+
+      Summary:  Writes the imported model as a cooked model, through a
+                temporary file so a partly written cooked model is
+                never loaded
+
+      Args:     const std::filesystem::path& cookedFilePath
+                  Path to write the cooked model to
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Model::saveCookedModel(_In_ const std::filesystem::path& cookedFilePath) const
+    {
+        std::vector<CHAR> aStrings;
+        auto addString = [&aStrings](_In_ const std::string& sz) -> UINT
+        {
+            if (sz.empty())
+            {
+                return INVALID_INDEX;
+            }
+
+            const UINT uOffset = static_cast<UINT>(aStrings.size());
+            aStrings.insert(aStrings.end(), sz.begin(), sz.end());
+            aStrings.push_back('\0');
+
+            return uOffset;
+        };
+
+        std::vector<CookedMaterial> aMaterials;
+        aMaterials.reserve(m_aTexturePaths.size());
+        for (const TexturePaths& texturePaths : m_aTexturePaths)
+        {
+            aMaterials.push_back(
+                CookedMaterial
+                {
+                    .uDiffuseOffset = addString(texturePaths.szDiffuse),
+                    .uSpecularOffset = addString(texturePaths.szSpecular),
+                    .uNormalOffset = addString(texturePaths.szNormal)
+                }
+            );
+        }
+
+        std::vector<CookedBone> aBones(m_aBoneInfo.size());
+        for (const auto& [szName, uBoneIndex] : m_boneNameToIndexMap)
+        {
+            aBones[uBoneIndex].uNameOffset = addString(szName);
+            XMStoreFloat4x4(&aBones[uBoneIndex].OffsetMatrix, m_aBoneInfo[uBoneIndex].OffsetMatrix);
+        }
+
+        UINT64 uSourceSize = 0u;
+        UINT64 uSourceWriteTime = 0u;
+        if (!GetFileStamp(m_filePath, uSourceSize, uSourceWriteTime))
+        {
+            return E_FAIL;
+        }
+
+        CookedModelHeader header =
+        {
+            .aMagic = { COOKED_MAGIC[0], COOKED_MAGIC[1], COOKED_MAGIC[2], COOKED_MAGIC[3] },
+            .uVersion = COOKED_VERSION,
+            .uSourceSize = uSourceSize,
+            .uSourceWriteTime = uSourceWriteTime,
+            .uFlags = m_bOptimizeMeshes ? COOKED_FLAG_OPTIMIZED_MESHES : 0u,
+            .uNumVertices = static_cast<UINT>(m_aVertices.size()),
+            .uNumIndices = static_cast<UINT>(m_aIndices.size()),
+            .uNumMeshes = static_cast<UINT>(m_aMeshes.size()),
+            .uNumMaterials = static_cast<UINT>(aMaterials.size()),
+            .uNumBones = static_cast<UINT>(aBones.size()),
+            .uNumNodes = static_cast<UINT>(m_aNodes.size()),
+            .uNumAnimations = static_cast<UINT>(m_aAnimations.size()),
+            .uNumChannels = static_cast<UINT>(m_aChannels.size()),
+            .uNumPositionKeys = static_cast<UINT>(m_aPositionKeys.size()),
+            .uNumRotationKeys = static_cast<UINT>(m_aRotationKeys.size()),
+            .uNumScalingKeys = static_cast<UINT>(m_aScalingKeys.size()),
+            .uNumStringBytes = static_cast<UINT>(aStrings.size())
+        };
+        XMStoreFloat4x4(&header.GlobalInverseTransform, m_globalInverseTransform);
+
+        // Every vertex gets normal and animation data, zeroed if a
+        // subclass did not build them
+        std::vector<NormalData> aNormalData(m_aNormalData);
+        aNormalData.resize(m_aVertices.size(), NormalData());
+        std::vector<AnimationData> aAnimationData(m_aAnimationData);
+        aAnimationData.resize(m_aVertices.size(), AnimationData());
+
+        std::filesystem::path tempFilePath = cookedFilePath;
+        tempFilePath += L".tmp";
+        {
+            std::ofstream outputFile(tempFilePath, std::ios::binary | std::ios::trunc);
+            if (!outputFile.is_open())
+            {
+                return E_FAIL;
+            }
+
+            auto writeArray = [&outputFile](_In_ const auto& aElements)
+            {
+                if (!aElements.empty())
+                {
+                    outputFile.write(reinterpret_cast<const CHAR*>(aElements.data()), static_cast<std::streamsize>(sizeof(aElements[0]) * aElements.size()));
+                }
+            };
+
+            outputFile.write(reinterpret_cast<const CHAR*>(&header), sizeof(header));
+            writeArray(m_aVertices);
+            writeArray(aNormalData);
+            writeArray(aAnimationData);
+            writeArray(m_aIndices);
+            writeArray(m_aMeshes);
+            writeArray(aMaterials);
+            writeArray(aBones);
+            writeArray(m_aNodes);
+            writeArray(m_aAnimations);
+            writeArray(m_aChannels);
+            writeArray(m_aPositionKeys);
+            writeArray(m_aRotationKeys);
+            writeArray(m_aScalingKeys);
+            writeArray(aStrings);
+
+            if (!outputFile.good())
+            {
+                return E_FAIL;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempFilePath, cookedFilePath, error);
+        if (error)
+        {
+            std::filesystem::remove(tempFilePath, error);
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::countVerticesAndIndices
 
@@ -288,46 +868,77 @@ namespace library
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::getIndices
 
-      Summary:  Returns the indices data
+      Summary:  Returns the 16-bit indices data
 
       Returns:  const WORD*
-                  Array of indices
+                  Array of indices, null if the model needs 32-bit
+                  indices
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     const WORD* Model::getIndices() const
     {
-        return m_aIndices.data();
+        return m_aPackedIndices.empty() ? nullptr : m_aPackedIndices.data();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::getIndexBufferData
+
+      Summary:  Returns the indices data in the index format
+
+      Returns:  const void*
+                  Array of 16-bit or 32-bit indices
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const void* Model::getIndexBufferData() const
+    {
+        if (m_indexFormat == DXGI_FORMAT_R32_UINT)
+        {
+            return m_aIndices.data();
+        }
+
+        return m_aPackedIndices.data();
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::packIndices
 
+      Summary:  Chooses the index format. The indices are relative to
+                the base vertex of their mesh, so 16-bit indices are
+                kept unless a single mesh references more than 65,536
+                vertices
 
+      Modifies: [m_aPackedIndices, m_indexFormat].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::packIndices()
+    {
+        m_aPackedIndices.clear();
+        m_indexFormat = DXGI_FORMAT_R16_UINT;
 
+        for (UINT uIndex : m_aIndices)
+        {
+            if (uIndex > 0xFFFFu)
+            {
+                m_indexFormat = DXGI_FORMAT_R32_UINT;
+                return;
+            }
+        }
+
+        m_aPackedIndices.reserve(m_aIndices.size());
+        for (UINT uIndex : m_aIndices)
+        {
+            m_aPackedIndices.push_back(static_cast<WORD>(uIndex));
+        }
+    }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::initFromScene
 
-      Summary:  Initialize all meshes in a given assimp scene
+      Summary:  Initialize all meshes, texture paths, the skeleton and
+                the animations of a given assimp scene
 
-      Args:     ID3D11Device* pDevice
-                  The Direct3D device to create the buffers
-                ID3D11DeviceContext* pImmediateContext
-                  The Direct3D context to set buffers
-                const aiScene* pScene
+      Args:     const aiScene* pScene
                   Assimp scene
-                const std::filesystem::path& filePath
-                  Path to the model
-
-      Returns:  HRESULT
-                  Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    HRESULT Model::initFromScene(
-        _In_ ID3D11Device* pDevice,
-        _In_ ID3D11DeviceContext* pImmediateContext,
-        _In_ const aiScene* pScene,
-        _In_ const std::filesystem::path& filePath
-    )
+    void Model::initFromScene(_In_ const aiScene* pScene)
     {
-        HRESULT hr = S_OK;
-
         m_aMeshes.resize(pScene->mNumMeshes);
 
         UINT uNumVertices = 0u;
@@ -339,11 +950,7 @@ namespace library
 
         initAllMeshes(pScene);
 
-        hr = initMaterials(pDevice, pImmediateContext, pScene, filePath);
-        if (FAILED(hr))
-        {
-            return hr;
-        }
+        initTexturePaths(pScene);
 
         for (size_t i = 0; i < m_aVertices.size(); ++i)
         {
@@ -356,64 +963,217 @@ namespace library
             );
         }
 
-        hr = initialize(pDevice, pImmediateContext);
-        if (FAILED(hr))
+        std::unordered_map<std::string, UINT> nodeNameToIndexMap;
+        if (pScene->mRootNode)
         {
-            return hr;
+            initNodeHierarchy(pScene->mRootNode, INVALID_INDEX, nodeNameToIndexMap);
         }
+        m_aNodeTransforms.resize(m_aNodes.size());
 
-        return hr;
+        initAnimations(pScene, nodeNameToIndexMap);
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::initMaterials
 
-      Summary:  Initialize all materials in a given assimp scene
+      Summary:  Creates a material per texture paths entry and loads
+                its textures through the shared texture cache
 
       Args:     ID3D11Device* pDevice
                   The Direct3D device to create the buffers
                 ID3D11DeviceContext* pImmediateContext
                   The Direct3D context to set buffers
-                const aiScene* pScene
-                  Assimp scene
-                const std::filesystem::path& filePath
-                  Path to the model
       
       Returns:  HRESULT
                   Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    HRESULT Model::initMaterials(
-        _In_ ID3D11Device* pDevice,
-        _In_ ID3D11DeviceContext* pImmediateContext,
-        _In_ const aiScene* pScene,
-        _In_ const std::filesystem::path& filePath
-    )
+    HRESULT Model::initMaterials(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
     {
         HRESULT hr = S_OK;
 
         // Extract the directory part from the file name
-        std::filesystem::path parentDirectory = filePath.parent_path();
+        std::filesystem::path parentDirectory = m_filePath.parent_path();
 
         // Initialize the materials
-        for (UINT i = 0u; i < pScene->mNumMaterials; ++i)
+        for (UINT i = 0u; i < m_aTexturePaths.size(); ++i)
         {
-            const aiMaterial* pMaterial = pScene->mMaterials[i];
-
-            std::string szName = filePath.string() + std::to_string(i);
+            std::string szName = m_filePath.string() + std::to_string(i);
             std::wstring pwszName(szName.length(), L' ');
             std::copy(szName.begin(), szName.end(), pwszName.begin());
             m_aMaterials.push_back(std::make_shared<Material>(pwszName));
 
-            loadTextures(pDevice, pImmediateContext, parentDirectory, pMaterial, i);
+            loadTextures(pDevice, pImmediateContext, parentDirectory, m_aTexturePaths[i], i);
         }
 
         return hr;
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::initTexturePaths
+
+      Summary:  Reads the texture paths of all materials in a given
+                assimp scene
+
+      Args:     const aiScene* pScene
+                  Assimp scene
+
+      Modifies: [m_aTexturePaths].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::initTexturePaths(_In_ const aiScene* pScene)
+    {
+        m_aTexturePaths.resize(pScene->mNumMaterials);
+
+        for (UINT i = 0u; i < pScene->mNumMaterials; ++i)
+        {
+            const aiMaterial* pMaterial = pScene->mMaterials[i];
+
+            m_aTexturePaths[i] = TexturePaths
+            {
+                .szDiffuse = GetTexturePath(pMaterial, aiTextureType_DIFFUSE),
+                .szSpecular = GetTexturePath(pMaterial, aiTextureType_SHININESS),
+                .szNormal = GetTexturePath(pMaterial, aiTextureType_HEIGHT)
+            };
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::initNodeHierarchy
+
+      Summary:  Appends a node and its children depth first to the
+                skeleton, resolving the bone each node drives
+
+      Args:     const aiNode* pNode
+                  Pointer to an assimp node object
+                UINT uParentIndex
+                  Index of the parent node, INVALID_INDEX for the root
+                std::unordered_map<std::string, UINT>& nodeNameToIndexMap
+                  Index of the first node of every name
+
+      Modifies: [m_aNodes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::initNodeHierarchy(_In_ const aiNode* pNode, _In_ UINT uParentIndex, _Inout_ std::unordered_map<std::string, UINT>& nodeNameToIndexMap)
+    {
+        const UINT uNodeIndex = static_cast<UINT>(m_aNodes.size());
+        const auto bone = m_boneNameToIndexMap.find(pNode->mName.C_Str());
+
+        ModelNode node =
+        {
+            .uParentIndex = uParentIndex,
+            .uBoneIndex = (bone != m_boneNameToIndexMap.end()) ? bone->second : INVALID_INDEX
+        };
+        XMStoreFloat4x4(&node.Transformation, ConvertMatrix(pNode->mTransformation));
+        m_aNodes.push_back(node);
+        nodeNameToIndexMap.emplace(pNode->mName.C_Str(), uNodeIndex);
+
+        for (UINT i = 0u; i < pNode->mNumChildren; ++i)
+        {
+            initNodeHierarchy(pNode->mChildren[i], uNodeIndex, nodeNameToIndexMap);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::initAnimations
+
+      Summary:  Copies the keys of all animations in a given assimp
+                scene. Channels of nodes missing from the skeleton,
+                channels without keys and every channel but the first
+                of the same node are dropped
+
+      Args:     const aiScene* pScene
+                  Assimp scene
+                const std::unordered_map<std::string, UINT>& nodeNameToIndexMap
+                  Index of the first node of every name
+
+      Modifies: [m_aAnimations, m_aChannels, m_aPositionKeys,
+                 m_aRotationKeys, m_aScalingKeys].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::initAnimations(_In_ const aiScene* pScene, _In_ const std::unordered_map<std::string, UINT>& nodeNameToIndexMap)
+    {
+        for (UINT i = 0u; i < pScene->mNumAnimations; ++i)
+        {
+            const aiAnimation* pAnimation = pScene->mAnimations[i];
+
+            ModelAnimation animation =
+            {
+                .TicksPerSecond = static_cast<FLOAT>(pAnimation->mTicksPerSecond),
+                .Duration = static_cast<FLOAT>(pAnimation->mDuration),
+                .uFirstChannel = static_cast<UINT>(m_aChannels.size()),
+                .uNumChannels = 0u
+            };
+
+            std::unordered_set<UINT> animatedNodes;
+            for (UINT j = 0u; j < pAnimation->mNumChannels; ++j)
+            {
+                const aiNodeAnim* pNodeAnim = pAnimation->mChannels[j];
+                const auto node = nodeNameToIndexMap.find(pNodeAnim->mNodeName.C_Str());
+                if (node == nodeNameToIndexMap.end() || pNodeAnim->mNumPositionKeys == 0u || pNodeAnim->mNumRotationKeys == 0u || pNodeAnim->mNumScalingKeys == 0u)
+                {
+                    continue;
+                }
+
+                if (!animatedNodes.insert(node->second).second)
+                {
+                    continue;
+                }
+
+                m_aChannels.push_back(
+                    ModelChannel
+                    {
+                        .uNodeIndex = node->second,
+                        .uFirstPositionKey = static_cast<UINT>(m_aPositionKeys.size()),
+                        .uNumPositionKeys = pNodeAnim->mNumPositionKeys,
+                        .uFirstRotationKey = static_cast<UINT>(m_aRotationKeys.size()),
+                        .uNumRotationKeys = pNodeAnim->mNumRotationKeys,
+                        .uFirstScalingKey = static_cast<UINT>(m_aScalingKeys.size()),
+                        .uNumScalingKeys = pNodeAnim->mNumScalingKeys
+                    }
+                );
+                ++animation.uNumChannels;
+
+                for (UINT k = 0u; k < pNodeAnim->mNumPositionKeys; ++k)
+                {
+                    m_aPositionKeys.push_back(
+                        ModelVectorKey
+                        {
+                            .Time = static_cast<FLOAT>(pNodeAnim->mPositionKeys[k].mTime),
+                            .Value = ConvertVector3dToFloat3(pNodeAnim->mPositionKeys[k].mValue)
+                        }
+                    );
+                }
+
+                for (UINT k = 0u; k < pNodeAnim->mNumRotationKeys; ++k)
+                {
+                    m_aRotationKeys.push_back(
+                        ModelQuaternionKey
+                        {
+                            .Time = static_cast<FLOAT>(pNodeAnim->mRotationKeys[k].mTime),
+                            .Value = ConvertQuaternionToFloat4(pNodeAnim->mRotationKeys[k].mValue)
+                        }
+                    );
+                }
+
+                for (UINT k = 0u; k < pNodeAnim->mNumScalingKeys; ++k)
+                {
+                    m_aScalingKeys.push_back(
+                        ModelVectorKey
+                        {
+                            .Time = static_cast<FLOAT>(pNodeAnim->mScalingKeys[k].mTime),
+                            .Value = ConvertVector3dToFloat3(pNodeAnim->mScalingKeys[k].mValue)
+                        }
+                    );
+                }
+            }
+
+            m_aAnimations.push_back(animation);
+        }
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::initSingleMesh
 
-      Summary:  Initialize single mesh from a given assimp mesh
+      Summary:  Initialize single mesh from a given assimp mesh,
+                writing at the base vertex and base index of the mesh.
+                Runs concurrently with the other meshes
 
       Args:     UINT uMeshIndex
                   Index of mesh
@@ -423,6 +1183,8 @@ namespace library
     void Model::initSingleMesh(_In_ UINT uMeshIndex, _In_ const aiMesh* pMesh)
     {
         const aiVector3D zero3d(0.0f, 0.0f, 0.0f);
+        const UINT uBaseVertex = m_aMeshes[uMeshIndex].uBaseVertex;
+        const UINT uBaseIndex = m_aMeshes[uMeshIndex].uBaseIndex;
 
         for (UINT i = 0u; i < pMesh->mNumVertices; i++) {
             const aiVector3D& position = pMesh->mVertices[i];
@@ -440,30 +1202,30 @@ namespace library
             };
 
 
-            m_aVertices.push_back(vertex);
+            m_aVertices[uBaseVertex + i] = vertex;
 
             NormalData normalData = {
                      .Tangent = XMFLOAT3(tangent.x, tangent.y, tangent.z),
                      .Bitangent = XMFLOAT3(bitangent.x, bitangent.y, bitangent.z)
             };
 
-            m_aNormalData.push_back(normalData);
+            m_aNormalData[uBaseVertex + i] = normalData;
 
         }
 
         for (UINT i = 0u; i < pMesh->mNumFaces; ++i) {
             const aiFace& face = pMesh->mFaces[i];
             assert(face.mNumIndices == 3);
-            WORD aIndices[3] =
+            UINT aIndices[3] =
             {
-                static_cast<WORD>(face.mIndices[0]),
-                static_cast<WORD>(face.mIndices[1]),
-                static_cast<WORD>(face.mIndices[2])
+                face.mIndices[0],
+                face.mIndices[1],
+                face.mIndices[2]
             };
 
-            m_aIndices.push_back(aIndices[0]);
-            m_aIndices.push_back(aIndices[1]);
-            m_aIndices.push_back(aIndices[2]);
+            m_aIndices[uBaseIndex + i * 3u] = aIndices[0];
+            m_aIndices[uBaseIndex + i * 3u + 1u] = aIndices[1];
+            m_aIndices[uBaseIndex + i * 3u + 2u] = aIndices[2];
         }
 
         initMeshBones(uMeshIndex, pMesh);
@@ -471,7 +1233,8 @@ namespace library
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::loadDiffuseTexture
 
-      Summary:  Load a diffuse texture from given path
+      Summary:  Load a diffuse texture from given path through the
+                texture cache
 
       Args:     ID3D11Device* pDevice
                   The Direct3D device to create the buffers
@@ -479,8 +1242,9 @@ namespace library
                   The Direct3D context to set buffers
                 const std::filesystem::path& parentDirectory
                   Parent path to the model
-                const aiMaterial* pMaterial
-                  Pointer to an assimp material object
+                const std::string& szPath
+                  Path of the texture relative to the model, empty if
+                  the material has none
                 UINT uIndex
                   Index to a material
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
@@ -488,44 +1252,30 @@ namespace library
         _In_ ID3D11Device* pDevice, 
         _In_ ID3D11DeviceContext* pImmediateContext, 
         _In_ const std::filesystem::path& parentDirectory, 
-        _In_ const aiMaterial* pMaterial, 
+        _In_ const std::string& szPath, 
         _In_ UINT uIndex
         )
     {
         HRESULT hr = S_OK;
         m_aMaterials[uIndex]->pDiffuse = nullptr;
 
-        if (pMaterial->GetTextureCount(aiTextureType_DIFFUSE) > 0)
+        if (!szPath.empty())
         {
-            aiString aiPath;
+            std::filesystem::path fullPath = parentDirectory / szPath;
 
-            if (pMaterial->GetTexture(aiTextureType_DIFFUSE, 0u, &aiPath, nullptr, nullptr, nullptr, nullptr, nullptr) == AI_SUCCESS)
+            hr = TextureCache::GetShared().Load(pDevice, fullPath, m_aMaterials[uIndex]->pDiffuse);
+            if (FAILED(hr))
             {
-                std::string szPath(aiPath.data);
-
-                if (szPath.substr(0ull, 2ull) == ".\\")
-                {
-                    szPath = szPath.substr(2ull, szPath.size() - 2ull);
-                }
-
-                std::filesystem::path fullPath = parentDirectory / szPath;
-
-                m_aMaterials[uIndex]->pDiffuse = std::make_shared<Texture>(fullPath);
-
-                hr = m_aMaterials[uIndex]->pDiffuse->Initialize(pDevice, pImmediateContext);
-                if (FAILED(hr))
-                {
-                    OutputDebugString(L"Error loading diffuse texture \"");
-                    OutputDebugString(fullPath.c_str());
-                    OutputDebugString(L"\"\n");
-
-                    return hr;
-                }
-
-                OutputDebugString(L"Loaded diffuse texture \"");
+                OutputDebugString(L"Error loading diffuse texture \"");
                 OutputDebugString(fullPath.c_str());
                 OutputDebugString(L"\"\n");
+
+                return hr;
             }
+
+            OutputDebugString(L"Queued diffuse texture \"");
+            OutputDebugString(fullPath.c_str());
+            OutputDebugString(L"\"\n");
         }
 
         return hr;
@@ -534,7 +1284,8 @@ namespace library
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::loadSpecularTexture
 
-      Summary:  Load a specular texture from given path
+      Summary:  Load a specular texture from given path through the
+                texture cache
 
       Args:     ID3D11Device* pDevice
                   The Direct3D device to create the buffers
@@ -542,8 +1293,9 @@ namespace library
                   The Direct3D context to set buffers
                 const std::filesystem::path& parentDirectory
                   Parent path to the model
-                const aiMaterial* pMaterial
-                  Pointer to an assimp material object
+                const std::string& szPath
+                  Path of the texture relative to the model, empty if
+                  the material has none
                 UINT uIndex
                   Index to a material
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
@@ -551,44 +1303,30 @@ namespace library
         _In_ ID3D11Device* pDevice, 
         _In_ ID3D11DeviceContext* pImmediateContext, 
         _In_ const std::filesystem::path& parentDirectory, 
-        _In_ const aiMaterial* pMaterial, 
+        _In_ const std::string& szPath, 
         _In_ UINT uIndex
         )
     {
         HRESULT hr = S_OK;
         m_aMaterials[uIndex]->pSpecularExponent = nullptr;
 
-        if (pMaterial->GetTextureCount(aiTextureType_SHININESS) > 0)
+        if (!szPath.empty())
         {
-            aiString aiPath;
+            std::filesystem::path fullPath = parentDirectory / szPath;
 
-            if (pMaterial->GetTexture(aiTextureType_SHININESS, 0u, &aiPath, nullptr, nullptr, nullptr, nullptr, nullptr) == AI_SUCCESS)
+            hr = TextureCache::GetShared().Load(pDevice, fullPath, m_aMaterials[uIndex]->pSpecularExponent);
+            if (FAILED(hr))
             {
-                std::string szPath(aiPath.data);
-
-                if (szPath.substr(0ull, 2ull) == ".\\")
-                {
-                    szPath = szPath.substr(2ull, szPath.size() - 2ull);
-                }
-
-                std::filesystem::path fullPath = parentDirectory / szPath;
-
-                m_aMaterials[uIndex]->pSpecularExponent = std::make_shared<Texture>(fullPath);
-
-                hr = m_aMaterials[uIndex]->pSpecularExponent->Initialize(pDevice, pImmediateContext);
-                if (FAILED(hr))
-                {
-                    OutputDebugString(L"Error loading specular texture \"");
-                    OutputDebugString(fullPath.c_str());
-                    OutputDebugString(L"\"\n");
-
-                    return hr;
-                }
-
-                OutputDebugString(L"Loaded specular texture \"");
+                OutputDebugString(L"Error loading specular texture \"");
                 OutputDebugString(fullPath.c_str());
                 OutputDebugString(L"\"\n");
+
+                return hr;
             }
+
+            OutputDebugString(L"Queued specular texture \"");
+            OutputDebugString(fullPath.c_str());
+            OutputDebugString(L"\"\n");
         }
 
         return hr;
@@ -597,7 +1335,8 @@ namespace library
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::loadNormalTexture
 
-      Summary:  Load a normal texture from given path
+      Summary:  Load a normal texture from given path through the
+                texture cache
 
       Args:     ID3D11Device* pDevice
                   The Direct3D device to create the buffers
@@ -605,57 +1344,51 @@ namespace library
                   The Direct3D context to set buffers
                 const std::filesystem::path& parentDirectory
                   Parent path to the model
-                const aiMaterial* pMaterial
-                  Pointer to an assimp material object
+                const std::string& szPath
+                  Path of the texture relative to the model, empty if
+                  the material has none
                 UINT uIndex
                   Index to a material
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    HRESULT Model::loadNormalTexture(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext, _In_ const std::filesystem::path& parentDirectory, _In_ const aiMaterial* pMaterial, _In_ UINT uIndex)
+    HRESULT Model::loadNormalTexture(
+        _In_ ID3D11Device* pDevice, 
+        _In_ ID3D11DeviceContext* pImmediateContext, 
+        _In_ const std::filesystem::path& parentDirectory, 
+        _In_ const std::string& szPath, 
+        _In_ UINT uIndex
+        )
     {
         HRESULT hr = S_OK;
         m_aMaterials[uIndex]->pNormal = nullptr;
 
-        if (pMaterial->GetTextureCount(aiTextureType_HEIGHT) > 0)
+        if (!szPath.empty())
         {
-            aiString aiPath;
-
-            if (pMaterial->GetTexture(aiTextureType_HEIGHT, 0u, &aiPath, nullptr, nullptr, nullptr, nullptr, nullptr) == AI_SUCCESS)
-            {
-                std::string szPath(aiPath.data);
-
-                if (szPath.substr(0ull, 2ull) == ".\\")
-                {
-                    szPath = szPath.substr(2ull, szPath.size() - 2ull);
-                }
+            std::filesystem::path fullPath = parentDirectory / szPath;
 
-                std::filesystem::path fullPath = parentDirectory / szPath;
+            m_bHasNormalMap = true;
 
-                m_aMaterials[uIndex]->pNormal = std::make_shared<Texture>(fullPath);
-                m_bHasNormalMap = true;
-
-                if (FAILED(hr))
-                {
-                    OutputDebugString(L"Error loading normal texture \"");
-                    OutputDebugString(fullPath.c_str());
-                    OutputDebugString(L"\"\n");
-
-                    return hr;
-                }
-
-                OutputDebugString(L"Loaded normal texture \"");
+            hr = TextureCache::GetShared().Load(pDevice, fullPath, m_aMaterials[uIndex]->pNormal);
+            if (FAILED(hr))
+            {
+                OutputDebugString(L"Error loading normal texture \"");
                 OutputDebugString(fullPath.c_str());
                 OutputDebugString(L"\"\n");
+
+                return hr;
             }
+
+            OutputDebugString(L"Queued normal texture \"");
+            OutputDebugString(fullPath.c_str());
+            OutputDebugString(L"\"\n");
         }
 
         return hr;
     }
 
-
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::loadTextures
 
-      Summary:  Load a specular texture from given path
+      Summary:  Load the textures of a material from given paths
 
       Args:     ID3D11Device* pDevice
                   The Direct3D device to create the buffers
@@ -663,26 +1396,26 @@ namespace library
                   The Direct3D context to set buffers
                 const std::filesystem::path& parentDirectory
                   Parent path to the model
-                const aiMaterial* pMaterial
-                  Pointer to an assimp material object
+                const TexturePaths& texturePaths
+                  Paths of the textures relative to the model
                 UINT uIndex
                   Index to a material
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    HRESULT Model::loadTextures(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext, _In_ const std::filesystem::path& parentDirectory, _In_ const aiMaterial* pMaterial, _In_ UINT uIndex)
+    HRESULT Model::loadTextures(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext, _In_ const std::filesystem::path& parentDirectory, _In_ const TexturePaths& texturePaths, _In_ UINT uIndex)
     {
-        HRESULT hr = loadDiffuseTexture(pDevice, pImmediateContext, parentDirectory, pMaterial, uIndex);
+        HRESULT hr = loadDiffuseTexture(pDevice, pImmediateContext, parentDirectory, texturePaths.szDiffuse, uIndex);
         if (FAILED(hr))
         {
             return hr;
         }
 
-        hr = loadSpecularTexture(pDevice, pImmediateContext, parentDirectory, pMaterial, uIndex);
+        hr = loadSpecularTexture(pDevice, pImmediateContext, parentDirectory, texturePaths.szSpecular, uIndex);
         if (FAILED(hr))
         {
             return hr;
         }
 
-        hr = loadNormalTexture(pDevice, pImmediateContext, parentDirectory, pMaterial, uIndex);
+        hr = loadNormalTexture(pDevice, pImmediateContext, parentDirectory, texturePaths.szNormal, uIndex);
         if (FAILED(hr))
         {
             return hr;
@@ -746,34 +1479,39 @@ namespace library
         return m_boneNameToIndexMap;
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::SetMeshOptimization
 
-     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-         Method:   Model::findNodeAnimOrNull
-
-         Summary:  Find the aiNodeAnim with the givne node name in the given animation
+      Summary:  Enables or disables the mesh optimization. Must be
+                called before Initialize. A cooked model made with the
+                other setting is cooked again
 
-         Args:     const aiAnimation* pAnimation
-                     Pointer to an assimp animation object
-                   PCSTR pszNodeName
-                     Node name to find
+      Args:     BOOL bOptimizeMeshes
+                  Whether cooking optimizes the meshes
 
-         Returns:  aiNodeAnim* or nullptr
-      M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    const aiNodeAnim* Model::findNodeAnimOrNull(_In_ const aiAnimation* pAnimation, _In_ PCSTR pszNodeName)
+      Modifies: [m_bOptimizeMeshes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::SetMeshOptimization(_In_ BOOL bOptimizeMeshes)
     {
-        for (UINT i = 0u; i < pAnimation->mNumChannels; ++i)
-        {
-            const aiNodeAnim* pNodeAnim = pAnimation->mChannels[i];
+        m_bOptimizeMeshes = bOptimizeMeshes;
+    }
 
-            if (strncmp(pNodeAnim->mNodeName.data, pszNodeName, pNodeAnim->mNodeName.length) == 0)
-            {
-                return pNodeAnim;
-            }
-        }
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::GetMeshOptimizationStats
 
-        return nullptr;
+      Summary:  Returns the vertex cache statistics of every mesh,
+                empty unless the model was cooked with the mesh
+                optimization during this run
+
+      Returns:  const std::vector<MeshOptimizationStats>&
+                  Statistics per mesh
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::vector<MeshOptimizationStats>& Model::GetMeshOptimizationStats() const
+    {
+        return m_aMeshOptimizationStats;
     }
 
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
         Method:   Model::findPosition
 
@@ -781,19 +1519,19 @@ namespace library
 
         Args:     FLOAT animationTimeTicks
                     Animation time
-                  const aiNodeAnim* pNodeAnim
-                     Pointer to an assimp node anim object
+                  const ModelChannel& channel
+                     Channel of the animated node
 
         Returns:  UINT
-                    Index of the key
+                    Index of the key relative to the first position key of the channel
      M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    UINT Model::findPosition(_In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim)
+    UINT Model::findPosition(_In_ FLOAT animationTimeTicks, _In_ const ModelChannel& channel) const
     {
-        assert(pNodeAnim->mNumPositionKeys > 0);
+        assert(channel.uNumPositionKeys > 0);
 
-        for (UINT i = 0; i < pNodeAnim->mNumPositionKeys - 1; ++i)
+        for (UINT i = 0u; i < channel.uNumPositionKeys - 1; ++i)
         {
-            FLOAT t = static_cast<FLOAT>(pNodeAnim->mPositionKeys[i + 1].mTime);
+            FLOAT t = m_aPositionKeys[channel.uFirstPositionKey + i + 1].Time;
 
             if (animationTimeTicks < t)
             {
@@ -811,19 +1549,19 @@ namespace library
 
         Args:     FLOAT animationTimeTicks
                     Animation time
-                  const aiNodeAnim* pNodeAnim
-                     Pointer to an assimp node anim object
+                  const ModelChannel& channel
+                     Channel of the animated node
 
         Returns:  UINT
-                    Index of the key
+                    Index of the key relative to the first rotation key of the channel
      M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    UINT Model::findRotation(_In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim)
+    UINT Model::findRotation(_In_ FLOAT animationTimeTicks, _In_ const ModelChannel& channel) const
     {
-        assert(pNodeAnim->mNumRotationKeys > 0);
+        assert(channel.uNumRotationKeys > 0);
 
-        for (UINT i = 0u; i < pNodeAnim->mNumRotationKeys - 1; ++i)
+        for (UINT i = 0u; i < channel.uNumRotationKeys - 1; ++i)
         {
-            FLOAT t = static_cast<FLOAT>(pNodeAnim->mRotationKeys[i + 1].mTime);
+            FLOAT t = m_aRotationKeys[channel.uFirstRotationKey + i + 1].Time;
 
             if (animationTimeTicks < t)
             {
@@ -841,19 +1579,19 @@ namespace library
 
         Args:     FLOAT animationTimeTicks
                     Animation time
-                  const aiNodeAnim* pNodeAnim
-                     Pointer to an assimp node anim object
+                  const ModelChannel& channel
+                     Channel of the animated node
 
         Returns:  UINT
-                    Index of the key
+                    Index of the key relative to the first scaling key of the channel
      M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    UINT Model::findScaling(_In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim)
+    UINT Model::findScaling(_In_ FLOAT animationTimeTicks, _In_ const ModelChannel& channel) const
     {
-        assert(pNodeAnim->mNumScalingKeys > 0);
+        assert(channel.uNumScalingKeys > 0);
 
-        for (UINT i = 0u; i < pNodeAnim->mNumScalingKeys - 1; ++i)
+        for (UINT i = 0u; i < channel.uNumScalingKeys - 1; ++i)
         {
-            FLOAT t = static_cast<FLOAT>(pNodeAnim->mScalingKeys[i + 1].mTime);
+            FLOAT t = m_aScalingKeys[channel.uFirstScalingKey + i + 1].Time;
 
             if (animationTimeTicks < t)
             {
@@ -898,18 +1636,38 @@ namespace library
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::initAllMeshes
 
-      Summary:  Initialize all meshes in a given assimp scene
+      Summary:  Initialize all meshes in a given assimp scene on the
+                shared loading thread pool
 
       Args:     const aiScene* pScene
                   Assimp scene
+
+      Modifies: [m_boneNameToIndexMap, m_aBoneInfo, m_aVertices,
+                 m_aNormalData, m_aIndices, m_aBoneData].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     void Model::initAllMeshes(_In_ const aiScene* pScene)
     {
+        // Bone ids follow the order the bones are first seen in, so
+        // they are assigned before the meshes are converted
+        // concurrently
         for (UINT i = 0u; i < m_aMeshes.size(); ++i)
         {
             const aiMesh* pMesh = pScene->mMeshes[i];
-            initSingleMesh(i, pMesh);
+            for (UINT j = 0u; j < pMesh->mNumBones; ++j)
+            {
+                const aiBone* pBone = pMesh->mBones[j];
+                if (getBoneId(pBone) == m_aBoneInfo.size())
+                {
+                    m_aBoneInfo.push_back(BoneInfo(ConvertMatrix(pBone->mOffsetMatrix)));
+                }
+            }
         }
+
+        // Every mesh writes its own range of the presized arrays
+        TextureCache::GetShared().GetThreadPool().ParallelFor(static_cast<UINT>(m_aMeshes.size()), [this, pScene](UINT uMeshIndex)
+        {
+            initSingleMesh(uMeshIndex, pScene->mMeshes[uMeshIndex]);
+        });
     }
   
 
@@ -932,20 +1690,19 @@ namespace library
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::initMeshSingleBone
 
-      Summary:  Initialize a single bone of the mesh
+      Summary:  Adds the weights of a single bone to the vertices of
+                the mesh. The bone id must already be assigned
 
-      Args:     const aiScene* pScene
-                  Assimp scene
+      Args:     UINT uMeshIndex
+                  Index of mesh
+                const aiBone* pBone
+                  Pointer to an assimp bone object
+
+      Modifies: [m_aBoneData].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     void Model::initMeshSingleBone(_In_ UINT uMeshIndex, _In_ const aiBone* pBone)
     {
-        UINT uBoneId = getBoneId(pBone);
-
-        if (uBoneId == m_aBoneInfo.size())
-        {
-            BoneInfo boneInfo(ConvertMatrix(pBone->mOffsetMatrix));
-            m_aBoneInfo.push_back(boneInfo);
-        }
+        UINT uBoneId = m_boneNameToIndexMap.at(pBone->mName.C_Str());
 
         for (UINT i = 0u; i < pBone->mNumWeights; ++i)
         {
@@ -966,30 +1723,31 @@ namespace library
                   Translate vector
                 FLOAT animationTimeTicks
                   Animation time
-                const aiNodeAnim* pNodeAnim
-                  Pointer to an assimp node anim object
+                const ModelChannel& channel
+                  Channel of the animated node
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    void Model::interpolatePosition(_Inout_ XMFLOAT3& outTranslate, _In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim)
+    void Model::interpolatePosition(_Inout_ XMFLOAT3& outTranslate, _In_ FLOAT animationTimeTicks, _In_ const ModelChannel& channel) const
     {
-        if (pNodeAnim->mNumPositionKeys == 1)
+        const ModelVectorKey* pKeys = m_aPositionKeys.data() + channel.uFirstPositionKey;
+
+        if (channel.uNumPositionKeys == 1)
         {
-            outTranslate = ConvertVector3dToFloat3(pNodeAnim->mPositionKeys[0].mValue);
+            outTranslate = pKeys[0].Value;
             return;
         }
 
-        UINT uPositionIndex = findPosition(animationTimeTicks, pNodeAnim);
+        UINT uPositionIndex = findPosition(animationTimeTicks, channel);
         UINT uNextPositionIndex = uPositionIndex + 1u;
-        assert(uNextPositionIndex < pNodeAnim->mNumPositionKeys);
+        assert(uNextPositionIndex < channel.uNumPositionKeys);
 
-        FLOAT t1 = static_cast<FLOAT>(pNodeAnim->mPositionKeys[uPositionIndex].mTime);
-        FLOAT t2 = static_cast<FLOAT>(pNodeAnim->mPositionKeys[uNextPositionIndex].mTime);
+        FLOAT t1 = pKeys[uPositionIndex].Time;
+        FLOAT t2 = pKeys[uNextPositionIndex].Time;
         FLOAT deltaTime = t2 - t1;
         FLOAT factor = (animationTimeTicks - t1) / deltaTime;
         assert(factor >= 0.0f && factor <= 1.0f);
-        const aiVector3D& start = pNodeAnim->mPositionKeys[uPositionIndex].mValue;
-        const aiVector3D& end = pNodeAnim->mPositionKeys[uNextPositionIndex].mValue;
-        aiVector3D delta = end - start;
-        outTranslate = ConvertVector3dToFloat3(start + factor * delta);
+        XMVECTOR start = XMLoadFloat3(&pKeys[uPositionIndex].Value);
+        XMVECTOR end = XMLoadFloat3(&pKeys[uNextPositionIndex].Value);
+        XMStoreFloat3(&outTranslate, XMVectorLerp(start, end, factor));
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
@@ -1001,122 +1759,177 @@ namespace library
                   Quaternion vector
                 FLOAT animationTimeTicks
                   Animation time
-                const aiNodeAnim* pNodeAnim
-                  Pointer to an assimp node anim object
+                const ModelChannel& channel
+                  Channel of the animated node
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    void Model::interpolateRotation(_Inout_ XMVECTOR& outQuaternion, _In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim)
+    void Model::interpolateRotation(_Inout_ XMVECTOR& outQuaternion, _In_ FLOAT animationTimeTicks, _In_ const ModelChannel& channel) const
     {
-        if (pNodeAnim->mNumRotationKeys == 1)
+        const ModelQuaternionKey* pKeys = m_aRotationKeys.data() + channel.uFirstRotationKey;
+
+        if (channel.uNumRotationKeys == 1)
         {
-            outQuaternion = ConvertQuaternionToVector(pNodeAnim->mRotationKeys[0].mValue);
+            outQuaternion = XMLoadFloat4(&pKeys[0].Value);
             return;
         }
 
-        UINT uRotationIndex = findRotation(animationTimeTicks, pNodeAnim);
+        UINT uRotationIndex = findRotation(animationTimeTicks, channel);
         UINT uNextRotationIndex = uRotationIndex + 1u;
-        assert(uNextRotationIndex < pNodeAnim->mNumRotationKeys);
+        assert(uNextRotationIndex < channel.uNumRotationKeys);
 
-        FLOAT t1 = static_cast<FLOAT>(pNodeAnim->mRotationKeys[uRotationIndex].mTime);
-        FLOAT t2 = static_cast<FLOAT>(pNodeAnim->mRotationKeys[uNextRotationIndex].mTime);
+        FLOAT t1 = pKeys[uRotationIndex].Time;
+        FLOAT t2 = pKeys[uNextRotationIndex].Time;
         FLOAT deltaTime = t2 - t1;
         FLOAT factor = (animationTimeTicks - t1) / deltaTime;
         assert(factor >= 0.0f && factor <= 1.0f);
-        const aiQuaternion& start = pNodeAnim->mRotationKeys[uRotationIndex].mValue;
-        const aiQuaternion& end = pNodeAnim->mRotationKeys[uNextRotationIndex].mValue;
-        aiQuaternion result;
-        aiQuaternion::Interpolate(result, start, end, factor);
-        outQuaternion = ConvertQuaternionToVector(result);
+        XMVECTOR start = XMLoadFloat4(&pKeys[uRotationIndex].Value);
+        XMVECTOR end = XMLoadFloat4(&pKeys[uNextRotationIndex].Value);
+        outQuaternion = XMQuaternionSlerp(start, end, factor);
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Model::interpolateRotation
+      Method:   Model::interpolateScaling
 
-      Summary:  Interpolate two keyframes to find rotation vector
+      Summary:  Interpolate two keyframes to find scaling vector
 
       Args:     XMFLOAT3& outScale
                   Scaling vector
                 FLOAT animationTimeTicks
                   Animation time
-                const aiNodeAnim* pNodeAnim
-                  Pointer to an assimp node anim object
+                const ModelChannel& channel
+                  Channel of the animated node
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    void Model::interpolateScaling(_Inout_ XMFLOAT3& outScale, _In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim)
+    void Model::interpolateScaling(_Inout_ XMFLOAT3& outScale, _In_ FLOAT animationTimeTicks, _In_ const ModelChannel& channel) const
     {
-        if (pNodeAnim->mNumScalingKeys == 1)
+        const ModelVectorKey* pKeys = m_aScalingKeys.data() + channel.uFirstScalingKey;
+
+        if (channel.uNumScalingKeys == 1)
         {
-            outScale = ConvertVector3dToFloat3(pNodeAnim->mScalingKeys[0].mValue);
+            outScale = pKeys[0].Value;
             return;
         }
 
-        UINT uScalingIndex = findScaling(animationTimeTicks, pNodeAnim);
+        UINT uScalingIndex = findScaling(animationTimeTicks, channel);
         UINT uNextScalingIndex = uScalingIndex + 1u;
-        assert(uNextScalingIndex < pNodeAnim->mNumScalingKeys);
+        assert(uNextScalingIndex < channel.uNumScalingKeys);
 
-        FLOAT t1 = static_cast<FLOAT>(pNodeAnim->mScalingKeys[uScalingIndex].mTime);
-        FLOAT t2 = static_cast<FLOAT>(pNodeAnim->mScalingKeys[uNextScalingIndex].mTime);
+        FLOAT t1 = pKeys[uScalingIndex].Time;
+        FLOAT t2 = pKeys[uNextScalingIndex].Time;
         FLOAT deltaTime = t2 - t1;
         FLOAT factor = (animationTimeTicks - t1) / deltaTime;
         assert(factor >= 0.0f && factor <= 1.0f);
-        const aiVector3D& start = pNodeAnim->mScalingKeys[uScalingIndex].mValue;
-        const aiVector3D& end = pNodeAnim->mScalingKeys[uNextScalingIndex].mValue;
-        aiVector3D delta = end - start;
-        outScale = ConvertVector3dToFloat3(start + factor * delta);
+        XMVECTOR start = XMLoadFloat3(&pKeys[uScalingIndex].Value);
+        XMVECTOR end = XMLoadFloat3(&pKeys[uNextScalingIndex].Value);
+        XMStoreFloat3(&outScale, XMVectorLerp(start, end, factor));
     }
 
     
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::optimizeMeshes
+
+      Summary:  Reorders the indices and vertices of every mesh with
+                MeshOptimizer, in parallel on the shared loading
+                thread pool, and keeps the vertex cache gain of each
+                mesh for GetMeshOptimizationStats. The meshes are laid
+                out one after the other, so the vertices of a mesh end
+                where the next mesh begins
+
+      Modifies: [m_aVertices, m_aNormalData, m_aAnimationData,
+                 m_aIndices, m_aMeshOptimizationStats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Model::optimizeMeshes()
+    {
+        const UINT uNumMeshes = static_cast<UINT>(m_aMeshes.size());
+        m_aMeshOptimizationStats.assign(uNumMeshes, MeshOptimizationStats());
+
+        TextureCache::GetShared().GetThreadPool().ParallelFor(uNumMeshes, [this, uNumMeshes](UINT uMeshIndex)
+        {
+            const BasicMeshEntry& mesh = m_aMeshes[uMeshIndex];
+            const UINT uEndVertex = uMeshIndex + 1u < uNumMeshes ? m_aMeshes[uMeshIndex + 1u].uBaseVertex : static_cast<UINT>(m_aVertices.size());
+            const UINT uNumVertices = uEndVertex - mesh.uBaseVertex;
+
+            std::vector<UINT> aRemap;
+            MeshOptimizer::OptimizeMesh(
+                m_aIndices.data() + mesh.uBaseIndex,
+                mesh.uNumIndices,
+                m_aVertices.data() + mesh.uBaseVertex,
+                uNumVertices,
+                aRemap,
+                m_aMeshOptimizationStats[uMeshIndex]
+                );
+
+            MeshOptimizer::RemapVertices(aRemap, m_aVertices.data() + mesh.uBaseVertex);
+            if (m_aNormalData.size() == m_aVertices.size())
+            {
+                MeshOptimizer::RemapVertices(aRemap, m_aNormalData.data() + mesh.uBaseVertex);
+            }
+            if (m_aAnimationData.size() == m_aVertices.size())
+            {
+                MeshOptimizer::RemapVertices(aRemap, m_aAnimationData.data() + mesh.uBaseVertex);
+            }
+        });
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::readNodeHierarchy
 
-      Summary:  Calculate bone transformation of the given assimp node
+      Summary:  Calculate the bone transformations of the skeleton. The
+                nodes are stored depth first, so a single pass over
+                them sees every parent before its children
 
       Args:     FLOAT animationTimeTicks
                   Animation time
-               const aiNode* pNode
-                  Pointer to an assimp node object
-                const XMMATRIX& parentTransform
-                  Parent transform in hierarchy
+                const ModelAnimation& animation
+                  Animation to evaluate
+
+      Modifies: [m_aNodeTransforms, m_aBoneInfo].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    void Model::readNodeHierarchy(_In_ FLOAT animationTimeTicks, _In_ const aiNode* pNode, _In_ const XMMATRIX& parentTransform)
+    void Model::readNodeHierarchy(_In_ FLOAT animationTimeTicks, _In_ const ModelAnimation& animation)
     {
-        auto anim = m_pScene->mAnimations[0];
+        for (size_t i = 0u; i < m_aNodes.size(); ++i)
+        {
+            m_aNodeTransforms[i] = XMLoadFloat4x4(&m_aNodes[i].Transformation);
+        }
 
-        XMMATRIX NodeTransform = ConvertMatrix(pNode->mTransformation);
-        auto aiNodeAnim = findNodeAnimOrNull(anim, pNode->mName.C_Str());
+        for (UINT i = 0u; i < animation.uNumChannels; ++i)
+        {
+            const ModelChannel& channel = m_aChannels[animation.uFirstChannel + i];
 
-        if (aiNodeAnim) {
             XMFLOAT3 scale = {};
             XMVECTOR rotate = {};
             XMFLOAT3 translate = {};
 
-            interpolateScaling(scale, animationTimeTicks, aiNodeAnim);
-            interpolateRotation(rotate, animationTimeTicks, aiNodeAnim);
-            interpolatePosition(translate, animationTimeTicks, aiNodeAnim);
+            interpolateScaling(scale, animationTimeTicks, channel);
+            interpolateRotation(rotate, animationTimeTicks, channel);
+            interpolatePosition(translate, animationTimeTicks, channel);
 
             XMMATRIX mScale = XMMatrixScaling(scale.x, scale.y, scale.z);
             XMMATRIX mRotate = XMMatrixRotationQuaternion(rotate);
             XMMATRIX mTranslate = XMMatrixTranslation(translate.x, translate.y, translate.z);
 
-            NodeTransform = mScale * mRotate * mTranslate;
+            m_aNodeTransforms[channel.uNodeIndex] = mScale * mRotate * mTranslate;
         }
-        XMMATRIX globalTransformation = NodeTransform * parentTransform;
 
-        if (m_boneNameToIndexMap.count(pNode->mName.C_Str()) > 0)
+        for (size_t i = 0u; i < m_aNodes.size(); ++i)
         {
-            UINT index = m_boneNameToIndexMap.find(pNode->mName.C_Str())->second;
-            m_aBoneInfo[index].FinalTransformation = m_aBoneInfo[index].OffsetMatrix * globalTransformation * m_globalInverseTransform;
-        }
+            const ModelNode& node = m_aNodes[i];
+            if (node.uParentIndex != INVALID_INDEX)
+            {
+                m_aNodeTransforms[i] = m_aNodeTransforms[i] * m_aNodeTransforms[node.uParentIndex];
+            }
 
-        for (UINT i = 0u; i < pNode->mNumChildren; ++i) 
-        { 
-            const auto& child = pNode->mChildren[i];
-            readNodeHierarchy(animationTimeTicks, child, globalTransformation);
+            if (node.uBoneIndex != INVALID_INDEX)
+            {
+                BoneInfo& boneInfo = m_aBoneInfo[node.uBoneIndex];
+                boneInfo.FinalTransformation = boneInfo.OffsetMatrix * m_aNodeTransforms[i] * m_globalInverseTransform;
+            }
         }
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::reserveSpace
 
-      Summary:  Reserve space for vertices and indices vectors
+      Summary:  Size the vertices, normal data, indices and bone data
+                vectors so the meshes can be written concurrently
 
       Args:     UINT uNumVertices
                   Number of vertices
@@ -1125,8 +1938,9 @@ namespace library
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     void Model::reserveSpace(_In_ UINT uNumVertices, _In_ UINT uNumIndices)
     {
-        m_aVertices.reserve(uNumVertices);
-        m_aIndices.reserve(uNumIndices);
+        m_aVertices.resize(uNumVertices);
+        m_aNormalData.resize(uNumVertices);
+        m_aIndices.resize(uNumIndices);
         m_aBoneData.resize(uNumVertices);
     }
 }
\ No newline at end of file
@@ -12,19 +12,18 @@
 #pragma once
 
 #include "Common.h"
+#include "Model/MeshOptimizer.h"
 #include "Renderer/DataTypes.h"
 #include "Renderer/Renderable.h"
 #include "Shader/PixelShader.h"
 #include "Shader/VertexShader.h"
 #include "Texture/Material.h"
+#include "Texture/TextureCache.h"
 
 struct aiScene;
 struct aiMesh;
-struct aiMaterial;
-struct aiAnimation;
 struct aiBone;
 struct aiNode;
-struct aiNodeAnim;
 
 namespace Assimp
 {
@@ -33,10 +32,234 @@ namespace Assimp
 
 namespace library
 {
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   CookedModelHeader
+
+      Summary:  Header of a cooked model file. It is followed by the
+                vertices, normal data, animation data, 32-bit
+                indices, meshes, materials, bones, nodes,
+                animations, channels, position keys, rotation keys,
+                scaling keys and the string table, in that order. The
+                cooked model only applies to the source file of the
+                same size and last write time
+
+                aMagic
+                  Model::COOKED_MAGIC
+                uVersion
+                  Model::COOKED_VERSION
+                uSourceSize
+                  Bytes of the source model file
+                uSourceWriteTime
+                  Last write time of the source model file
+                uFlags
+                  Model::COOKED_FLAG_* options the model was cooked
+                  with
+                uNumVertices
+                  Number of vertices
+                uNumIndices
+                  Number of indices
+                uNumMeshes
+                  Number of meshes
+                uNumMaterials
+                  Number of materials
+                uNumBones
+                  Number of bones
+                uNumNodes
+                  Number of nodes of the skeleton
+                uNumAnimations
+                  Number of animations
+                uNumChannels
+                  Number of channels of all animations
+                uNumPositionKeys
+                  Number of position keys of all channels
+                uNumRotationKeys
+                  Number of rotation keys of all channels
+                uNumScalingKeys
+                  Number of scaling keys of all channels
+                uNumStringBytes
+                  Bytes of the string table
+                GlobalInverseTransform
+                  Inverse of the transform of the root node
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct CookedModelHeader
+    {
+        CHAR aMagic[4];
+        UINT uVersion;
+        UINT64 uSourceSize;
+        UINT64 uSourceWriteTime;
+        UINT uFlags;
+        UINT uNumVertices;
+        UINT uNumIndices;
+        UINT uNumMeshes;
+        UINT uNumMaterials;
+        UINT uNumBones;
+        UINT uNumNodes;
+        UINT uNumAnimations;
+        UINT uNumChannels;
+        UINT uNumPositionKeys;
+        UINT uNumRotationKeys;
+        UINT uNumScalingKeys;
+        UINT uNumStringBytes;
+        XMFLOAT4X4 GlobalInverseTransform;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   CookedMaterial
+
+      Summary:  Texture paths of a cooked material, relative to the
+                directory of the model
+
+                uDiffuseOffset
+                  Offset of the diffuse texture path in the string
+                  table
+                uSpecularOffset
+                  Offset of the specular texture path in the string
+                  table
+                uNormalOffset
+                  Offset of the normal texture path in the string table
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct CookedMaterial
+    {
+        UINT uDiffuseOffset;
+        UINT uSpecularOffset;
+        UINT uNormalOffset;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   CookedBone
+
+      Summary:  Bone of a cooked model
+
+                uNameOffset
+                  Offset of the bone name in the string table
+                OffsetMatrix
+                  Transform from the mesh space to the bone space
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct CookedBone
+    {
+        UINT uNameOffset;
+        XMFLOAT4X4 OffsetMatrix;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ModelNode
+
+      Summary:  Node of the skeleton. Nodes are stored depth first so
+                every parent comes before its children
+
+                uParentIndex
+                  Index of the parent node, INVALID_INDEX for the root
+                uBoneIndex
+                  Index of the bone driven by the node, INVALID_INDEX
+                  if none
+                Transformation
+                  Transform relative to the parent node
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ModelNode
+    {
+        UINT uParentIndex;
+        UINT uBoneIndex;
+        XMFLOAT4X4 Transformation;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ModelAnimation
+
+      Summary:  Animation of the skeleton
+
+                TicksPerSecond
+                  Ticks per second, 0 if unspecified
+                Duration
+                  Duration in ticks
+                uFirstChannel
+                  Index of the first channel of the animation
+                uNumChannels
+                  Number of channels of the animation
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ModelAnimation
+    {
+        FLOAT TicksPerSecond;
+        FLOAT Duration;
+        UINT uFirstChannel;
+        UINT uNumChannels;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ModelChannel
+
+      Summary:  Keys animating a single node. Each kind of key holds at
+                least one key
+
+                uNodeIndex
+                  Index of the animated node
+                uFirstPositionKey
+                  Index of the first position key
+                uNumPositionKeys
+                  Number of position keys
+                uFirstRotationKey
+                  Index of the first rotation key
+                uNumRotationKeys
+                  Number of rotation keys
+                uFirstScalingKey
+                  Index of the first scaling key
+                uNumScalingKeys
+                  Number of scaling keys
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ModelChannel
+    {
+        UINT uNodeIndex;
+        UINT uFirstPositionKey;
+        UINT uNumPositionKeys;
+        UINT uFirstRotationKey;
+        UINT uNumRotationKeys;
+        UINT uFirstScalingKey;
+        UINT uNumScalingKeys;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ModelVectorKey
+
+      Summary:  Position or scaling key
+
+                Time
+                  Time of the key in ticks
+                Value
+                  Position or scaling at the time
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ModelVectorKey
+    {
+        FLOAT Time;
+        XMFLOAT3 Value;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ModelQuaternionKey
+
+      Summary:  Rotation key
+
+                Time
+                  Time of the key in ticks
+                Value
+                  Rotation quaternion at the time
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ModelQuaternionKey
+    {
+        FLOAT Time;
+        XMFLOAT4 Value;
+    };
+
     /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
       Class:    Model
 
-      Summary:  Model class is a renderable from model files
+      Summary:  Model class is a renderable from model files. The model
+                file is imported with Assimp once and cooked into a
+                binary file next to it, which later launches
+                memory-map instead. The cooked file is cooked again
+                when the model file changes. Cooking can reorder the
+                meshes for the vertex cache, overdraw and vertex fetch
+                with MeshOptimizer. Material textures come
+                from the shared texture cache, which loads them
+                asynchronously
 
       Methods:  Initialize
                   Pure virtual function that initializes the object
@@ -57,6 +280,11 @@ namespace library
                 GetNumIndices
                   Pure virtual function that returns the number of
                   indices
+                SetMeshOptimization
+                  Enables or disables the mesh optimization when
+                  cooking
+                GetMeshOptimizationStats
+                  Returns the statistics of the last mesh optimization
                 Model
                   Constructor.
                 ~Model
@@ -64,6 +292,12 @@ namespace library
     C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
     class Model : public Renderable
     {
+    public:
+        static constexpr const CHAR COOKED_MAGIC[4] = { 'C', 'M', 'D', 'L' };
+        static constexpr const UINT COOKED_VERSION = 3u;
+        static constexpr const UINT COOKED_FLAG_OPTIMIZED_MESHES = 0x1u;
+        static constexpr const UINT INVALID_INDEX = 0xFFFFFFFFu;
+
     public:
         Model() = delete;
         Model(_In_ const std::filesystem::path& filePath);
@@ -71,7 +305,7 @@ namespace library
         Model(Model&& other) = delete;
         Model& operator=(const Model& other) = delete;
         Model& operator=(Model&& other) = delete;
-        virtual ~Model();
+        virtual ~Model() = default;
 
         virtual HRESULT Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext);
         virtual void Update(_In_ FLOAT deltaTime) override;
@@ -85,6 +319,9 @@ namespace library
         std::vector<XMMATRIX>& GetBoneTransforms();
         const std::unordered_map<std::string, UINT>& GetBoneNameToIndexMap() const;
 
+        void SetMeshOptimization(_In_ BOOL bOptimizeMeshes);
+        const std::vector<MeshOptimizationStats>& GetMeshOptimizationStats() const;
+
     protected:
         struct VertexBoneData
         {
@@ -104,10 +341,6 @@ namespace library
                 aBoneIds[uNumBones] = uBoneId;
                 aWeights[uNumBones] = weight;
 
-                static CHAR szDebugMessage[256];
-                sprintf_s(szDebugMessage, "\t\t\tBone %d, weight: %f, index %u\n", uBoneId, weight, uNumBones);
-                OutputDebugStringA(szDebugMessage);
-
                 ++uNumBones;
             }
 
@@ -129,63 +362,70 @@ namespace library
             XMMATRIX FinalTransformation;
         };
 
+        struct TexturePaths
+        {
+            std::string szDiffuse;
+            std::string szSpecular;
+            std::string szNormal;
+        };
+
+        HRESULT cookModel(_In_ const std::filesystem::path& cookedFilePath);
         void countVerticesAndIndices(_Inout_ UINT& uOutNumVertices, _Inout_ UINT& uOutNumIndices, _In_ const aiScene* pScene);
-        const aiNodeAnim* findNodeAnimOrNull(_In_ const aiAnimation* pAnimation, _In_ PCSTR pszNodeName);
-        UINT findPosition(_In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim);
-        UINT findRotation(_In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim);
-        UINT findScaling(_In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim);
+        UINT findPosition(_In_ FLOAT animationTimeTicks, _In_ const ModelChannel& channel) const;
+        UINT findRotation(_In_ FLOAT animationTimeTicks, _In_ const ModelChannel& channel) const;
+        UINT findScaling(_In_ FLOAT animationTimeTicks, _In_ const ModelChannel& channel) const;
         UINT getBoneId(_In_ const aiBone* pBone);
+        virtual std::filesystem::path getCookedFilePath() const;
         const virtual SimpleVertex* getVertices() const override;
         virtual const WORD* getIndices() const override;
+        virtual const void* getIndexBufferData() const override;
         void initAllMeshes(_In_ const aiScene* pScene);
-        HRESULT initFromScene(
-            _In_ ID3D11Device* pDevice,
-            _In_ ID3D11DeviceContext* pImmediateContext,
-            _In_ const aiScene* pScene,
-            _In_ const std::filesystem::path& filePath
-        );
-        HRESULT initMaterials(
-            _In_ ID3D11Device* pDevice,
-            _In_ ID3D11DeviceContext* pImmediateContext,
-            _In_ const aiScene* pScene,
-            _In_ const std::filesystem::path& filePath
-        );
+        void initAnimations(_In_ const aiScene* pScene, _In_ const std::unordered_map<std::string, UINT>& nodeNameToIndexMap);
+        void initFromScene(_In_ const aiScene* pScene);
+        HRESULT initMaterials(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext);
         void initMeshBones(_In_ UINT uMeshIndex, _In_ const aiMesh* pMesh);
         void initMeshSingleBone(_In_ UINT uBoneIndex, _In_ const aiBone* pBone);
+        void initNodeHierarchy(_In_ const aiNode* pNode, _In_ UINT uParentIndex, _Inout_ std::unordered_map<std::string, UINT>& nodeNameToIndexMap);
         virtual void initSingleMesh(_In_ UINT uMeshIndex, _In_ const aiMesh* pMesh);
-        void interpolatePosition(_Inout_ XMFLOAT3& outTranslate, _In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim);
-        void interpolateRotation(_Inout_ XMVECTOR& outQuaternion, _In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim);
-        void interpolateScaling(_Inout_ XMFLOAT3& outScale, _In_ FLOAT animationTimeTicks, _In_ const aiNodeAnim* pNodeAnim);
+        void initTexturePaths(_In_ const aiScene* pScene);
+        void interpolatePosition(_Inout_ XMFLOAT3& outTranslate, _In_ FLOAT animationTimeTicks, _In_ const ModelChannel& channel) const;
+        void interpolateRotation(_Inout_ XMVECTOR& outQuaternion, _In_ FLOAT animationTimeTicks, _In_ const ModelChannel& channel) const;
+        void interpolateScaling(_Inout_ XMFLOAT3& outScale, _In_ FLOAT animationTimeTicks, _In_ const ModelChannel& channel) const;
+        HRESULT loadCookedModel(_In_ const std::filesystem::path& cookedFilePath);
         HRESULT loadDiffuseTexture(
             _In_ ID3D11Device* pDevice,
             _In_ ID3D11DeviceContext* pImmediateContext,
             _In_ const std::filesystem::path& parentDirectory,
-            _In_ const aiMaterial* pMaterial,
+            _In_ const std::string& szPath,
             _In_ UINT uIndex
         );
         HRESULT loadSpecularTexture(
             _In_ ID3D11Device* pDevice,
             _In_ ID3D11DeviceContext* pImmediateContext,
             _In_ const std::filesystem::path& parentDirectory,
-            _In_ const aiMaterial* pMaterial,
+            _In_ const std::string& szPath,
             _In_ UINT uIndex
         );
         HRESULT loadNormalTexture(
             _In_ ID3D11Device* pDevice,
             _In_ ID3D11DeviceContext* pImmediateContext,
             _In_ const std::filesystem::path& parentDirectory,
-            _In_ const aiMaterial* pMaterial,
+            _In_ const std::string& szPath,
             _In_ UINT uIndex
         );
         HRESULT loadTextures(
             _In_ ID3D11Device* pDevice,
             _In_ ID3D11DeviceContext* pImmediateContext,
             _In_ const std::filesystem::path& parentDirectory,
-            _In_ const aiMaterial* pMaterial,
+            _In_ const TexturePaths& texturePaths,
             _In_ UINT uIndex
         );
-        void readNodeHierarchy(_In_ FLOAT animationTimeTicks, _In_ const aiNode* pNode, _In_ const XMMATRIX& parentTransform);
+        void optimizeMeshes();
+        void packIndices();
+        HRESULT readCookedModel(_In_reads_bytes_(uSize) const BYTE* pData, _In_ size_t uSize);
+        void readNodeHierarchy(_In_ FLOAT animationTimeTicks, _In_ const ModelAnimation& animation);
         void reserveSpace(_In_ UINT uNumVertices, _In_ UINT uNumIndices);
+        HRESULT saveCookedModel(_In_ const std::filesystem::path& cookedFilePath) const;
 
     protected:
         static std::unique_ptr<Assimp::Importer> sm_pImporter;
@@ -198,15 +438,24 @@ namespace library
 
         std::vector<SimpleVertex> m_aVertices;
         std::vector<AnimationData> m_aAnimationData;
-        std::vector<WORD> m_aIndices;
+        std::vector<UINT> m_aIndices;
+        std::vector<WORD> m_aPackedIndices;
         std::vector<VertexBoneData> m_aBoneData;
         std::vector<BoneInfo> m_aBoneInfo;
         std::vector<XMMATRIX> m_aTransforms;
         std::unordered_map<std::string, UINT> m_boneNameToIndexMap;
-
-        const aiScene* m_pScene;
+        std::vector<TexturePaths> m_aTexturePaths;
+        std::vector<ModelNode> m_aNodes;
+        std::vector<XMMATRIX> m_aNodeTransforms;
+        std::vector<ModelAnimation> m_aAnimations;
+        std::vector<ModelChannel> m_aChannels;
+        std::vector<ModelVectorKey> m_aPositionKeys;
+        std::vector<ModelQuaternionKey> m_aRotationKeys;
+        std::vector<ModelVectorKey> m_aScalingKeys;
+        std::vector<MeshOptimizationStats> m_aMeshOptimizationStats;
 
         float m_timeSinceLoaded;
+        BOOL m_bOptimizeMeshes;
 
         XMMATRIX m_globalInverseTransform;
 
@@ -7,6 +7,7 @@ namespace library
     #define NUM_LIGHTS (1)
     #define MAX_NUM_BONES (256)
     #define MAX_NUM_BONES_PER_VERTEX (16)
+    #define MAX_PALETTE_SIZE (256)
     /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
       Struct:   SimpleVertex
 
@@ -33,6 +34,24 @@ namespace library
         XMMATRIX Transformation;
     };
 
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   PackedInstanceData
+
+      Summary:  Instance data of a block or column on the voxel grid in
+                8 bytes. uX and uZ are the column coordinates, uPacked
+                holds the first block of the column in bits 0-11, the
+                number of stacked blocks in bits 12-23 and the palette
+                entry in bits 24-31. The vertex shader rebuilds the
+                transformation relative to the grid origin
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct PackedInstanceData
+    {
+        WORD uX;
+        WORD uZ;
+        UINT uPacked;
+    };
+    static_assert(sizeof(PackedInstanceData) == 8u);
+
     struct AnimationData
     {
         XMUINT4 aBoneIndices;
@@ -89,6 +108,18 @@ namespace library
         XMMATRIX BoneTransforms[MAX_NUM_BONES];
     };
 
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   CBPalette
+
+      Summary:  Constant buffer containing the block colors of the
+                height map, indexed by the palette entry of the packed
+                instances
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct CBPalette
+    {
+        XMFLOAT4 Colors[MAX_PALETTE_SIZE];
+    };
+
 
     /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
       Struct:   CBLights
@@ -0,0 +1,83 @@
+#include "Renderer/DirtyRangeList.h"
+
+#include <algorithm>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DirtyRangeList::DirtyRangeList
+
+      Summary:  Constructor
+
+      Modifies: [m_aRanges].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    DirtyRangeList::DirtyRangeList()
+        : m_aRanges()
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DirtyRangeList::Add
+
+      Summary:  Marks the elements in [uBegin, uEnd) as dirty, merging
+                the range with the ranges it overlaps or touches
+
+      Args:     UINT uBegin
+                  First dirty element
+                UINT uEnd
+                  One past the last dirty element
+
+      Modifies: [m_aRanges].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void DirtyRangeList::Add(_In_ UINT uBegin, _In_ UINT uEnd)
+    {
+        if (uBegin >= uEnd)
+        {
+            return;
+        }
+
+        auto first = std::lower_bound(
+            m_aRanges.begin(),
+            m_aRanges.end(),
+            uBegin,
+            [](_In_ const DirtyRange& range, _In_ UINT uValue) { return range.uEnd < uValue; }
+        );
+
+        auto last = first;
+        while (last != m_aRanges.end() && last->uBegin <= uEnd)
+        {
+            uBegin = last->uBegin < uBegin ? last->uBegin : uBegin;
+            uEnd = last->uEnd > uEnd ? last->uEnd : uEnd;
+            ++last;
+        }
+
+        first = m_aRanges.erase(first, last);
+        m_aRanges.insert(first, DirtyRange{ .uBegin = uBegin, .uEnd = uEnd });
+    }
+
+    void DirtyRangeList::Clear()
+    {
+        m_aRanges.clear();
+    }
+
+    BOOL DirtyRangeList::IsEmpty() const
+    {
+        return m_aRanges.empty();
+    }
+
+    UINT DirtyRangeList::GetNumDirty() const
+    {
+        UINT uNumDirty = 0u;
+        for (const DirtyRange& range : m_aRanges)
+        {
+            uNumDirty += range.uEnd - range.uBegin;
+        }
+
+        return uNumDirty;
+    }
+
+    const std::vector<DirtyRange>& DirtyRangeList::GetRanges() const
+    {
+        return m_aRanges;
+    }
+}
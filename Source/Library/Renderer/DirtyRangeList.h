@@ -0,0 +1,72 @@
+/*+===================================================================
+  File:      DIRTYRANGELIST.H
+
+  Summary:   DirtyRangeList header file contains declarations of
+             DirtyRangeList class used for the lab samples of Game
+             Graphics Programming course.
+
+  Classes: DirtyRangeList
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   DirtyRange
+
+      Summary:  Half open range [uBegin, uEnd) of elements
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct DirtyRange
+    {
+        UINT uBegin;
+        UINT uEnd;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    DirtyRangeList
+
+      Summary:  Sorted list of disjoint ranges of elements that changed
+                since the last upload. Overlapping and adjacent ranges
+                are merged so each range is uploaded with one copy.
+                Pure CPU bookkeeping, independent of the GPU buffer it
+                describes
+
+      Methods:  Add
+                  Marks a range of elements as dirty
+                Clear
+                  Marks every element as clean
+                IsEmpty
+                  Returns whether no element is dirty
+                GetNumDirty
+                  Returns the number of dirty elements
+                GetRanges
+                  Returns the dirty ranges in ascending order
+                DirtyRangeList
+                  Constructor.
+                ~DirtyRangeList
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class DirtyRangeList
+    {
+    public:
+        DirtyRangeList();
+        DirtyRangeList(const DirtyRangeList& other) = delete;
+        DirtyRangeList(DirtyRangeList&& other) = delete;
+        DirtyRangeList& operator=(const DirtyRangeList& other) = delete;
+        DirtyRangeList& operator=(DirtyRangeList&& other) = delete;
+        ~DirtyRangeList() = default;
+
+        void Add(_In_ UINT uBegin, _In_ UINT uEnd);
+        void Clear();
+        BOOL IsEmpty() const;
+        UINT GetNumDirty() const;
+        const std::vector<DirtyRange>& GetRanges() const;
+
+    private:
+        std::vector<DirtyRange> m_aRanges;
+    };
+}
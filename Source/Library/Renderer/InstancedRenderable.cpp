@@ -14,6 +14,9 @@ namespace library
         Renderable(outputColor),
         m_instanceBuffer(nullptr),
         m_aInstanceData(),
+        m_aPackedInstanceData(),
+        m_uInstanceCapacity(0u),
+        m_dirtyInstances(),
         m_padding()
     {}
 
@@ -34,6 +37,31 @@ namespace library
         Renderable(outputColor),
         m_instanceBuffer(nullptr),
         m_aInstanceData(std::move(aInstanceData)),
+        m_aPackedInstanceData(),
+        m_uInstanceCapacity(0u),
+        m_dirtyInstances(),
+        m_padding()
+    {}
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::InstancedRenderable
+
+      Summary:  Constructor
+
+      Args:     std::vector<PackedInstanceData>&& aPackedInstanceData
+                  Packed instance data, decoded by the vertex shader
+                const XMFLOAT4& outputColor
+                  Default color of the renderable
+
+      Modifies: [m_instanceBuffer, m_aPackedInstanceData].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    InstancedRenderable::InstancedRenderable(_In_ std::vector<PackedInstanceData>&& aPackedInstanceData, _In_ const XMFLOAT4& outputColor) :
+        Renderable(outputColor),
+        m_instanceBuffer(nullptr),
+        m_aInstanceData(),
+        m_aPackedInstanceData(std::move(aPackedInstanceData)),
+        m_uInstanceCapacity(0u),
+        m_dirtyInstances(),
         m_padding()
     {}
     
@@ -51,10 +79,174 @@ namespace library
     void InstancedRenderable::SetInstanceData(_In_ std::vector<InstanceData>&& aInstanceData)
     {
         m_aInstanceData = std::move(aInstanceData);
+        m_aPackedInstanceData.clear();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::SetPackedInstanceData
+
+      Summary:  Sets the packed instance data, replacing the instance
+                data
+
+      Args:     std::vector<PackedInstanceData>&& aPackedInstanceData
+                  Packed instance data
+
+      Modifies: [m_aInstanceData, m_aPackedInstanceData].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void InstancedRenderable::SetPackedInstanceData(_In_ std::vector<PackedInstanceData>&& aPackedInstanceData)
+    {
+        m_aPackedInstanceData = std::move(aPackedInstanceData);
+        m_aInstanceData.clear();
     }
 
     
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::UpdateInstanceData
+
+      Summary:  Replaces the instance data of an initialized renderable.
+                Only the instances that differ from the current ones,
+                and the ones past the current count, are marked dirty
+
+      Args:     std::vector<InstanceData>&& aInstanceData
+                  New instance data
+
+      Modifies: [m_aInstanceData, m_aPackedInstanceData,
+                 m_dirtyInstances].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void InstancedRenderable::UpdateInstanceData(_In_ std::vector<InstanceData>&& aInstanceData)
+    {
+        markChangedInstances(
+            m_aInstanceData.data(),
+            static_cast<UINT>(m_aInstanceData.size()),
+            aInstanceData.data(),
+            static_cast<UINT>(aInstanceData.size()),
+            sizeof(InstanceData)
+        );
+
+        m_aInstanceData = std::move(aInstanceData);
+        m_aPackedInstanceData.clear();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::UpdatePackedInstanceData
+
+      Summary:  Replaces the packed instance data of an initialized
+                renderable. Only the instances that differ from the
+                current ones, and the ones past the current count, are
+                marked dirty
+
+      Args:     std::vector<PackedInstanceData>&& aPackedInstanceData
+                  New packed instance data
+
+      Modifies: [m_aInstanceData, m_aPackedInstanceData,
+                 m_dirtyInstances].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void InstancedRenderable::UpdatePackedInstanceData(_In_ std::vector<PackedInstanceData>&& aPackedInstanceData)
+    {
+        markChangedInstances(
+            m_aPackedInstanceData.data(),
+            static_cast<UINT>(m_aPackedInstanceData.size()),
+            aPackedInstanceData.data(),
+            static_cast<UINT>(aPackedInstanceData.size()),
+            sizeof(PackedInstanceData)
+        );
+
+        m_aPackedInstanceData = std::move(aPackedInstanceData);
+        m_aInstanceData.clear();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::UploadDirtyInstances
+
+      Summary:  Copies the dirty ranges of instances to the instance
+                buffer, one UpdateSubresource per range. When the
+                instances outgrew the buffer it is recreated with some
+                headroom so the following edits fit in place
+
+      Args:     ID3D11Device* pDevice
+                  Pointer to a Direct3D 11 device
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to update the buffer
+
+      Modifies: [m_instanceBuffer, m_uInstanceCapacity,
+                 m_dirtyInstances].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT InstancedRenderable::UploadDirtyInstances(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
+    {
+        if (m_dirtyInstances.IsEmpty())
+        {
+            return S_OK;
+        }
+
+        const UINT uStride = GetInstanceStride();
+        const UINT uNumInstances = GetNumInstances();
+        if (!m_instanceBuffer || uNumInstances > m_uInstanceCapacity)
+        {
+            const UINT uCapacity = uNumInstances + uNumInstances / 4u;
+            D3D11_BUFFER_DESC iBufferDesc =
+            {
+                .ByteWidth = uStride * uCapacity,
+                .Usage = D3D11_USAGE_DEFAULT,
+                .BindFlags = D3D11_BIND_VERTEX_BUFFER,
+                .CPUAccessFlags = 0
+            };
+
+            m_instanceBuffer.Reset();
+            HRESULT hr = pDevice->CreateBuffer(&iBufferDesc, nullptr, m_instanceBuffer.GetAddressOf());
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+
+            m_uInstanceCapacity = uCapacity;
+            m_dirtyInstances.Clear();
+            m_dirtyInstances.Add(0u, uNumInstances);
+        }
+
+        const BYTE* pData = static_cast<const BYTE*>(getInstanceData());
+        for (const DirtyRange& range : m_dirtyInstances.GetRanges())
+        {
+            const UINT uEnd = range.uEnd < uNumInstances ? range.uEnd : uNumInstances;
+            if (range.uBegin >= uEnd)
+            {
+                continue;
+            }
+
+            D3D11_BOX box =
+            {
+                .left = range.uBegin * uStride,
+                .top = 0u,
+                .front = 0u,
+                .right = uEnd * uStride,
+                .bottom = 1u,
+                .back = 1u
+            };
+            pImmediateContext->UpdateSubresource(m_instanceBuffer.Get(), 0u, &box, pData + static_cast<size_t>(range.uBegin) * uStride, 0u, 0u);
+        }
+
+        m_dirtyInstances.Clear();
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::GetDirtyInstances
+
+      Summary:  Returns the ranges of instances changed since the last
+                upload
+
+      Returns:  const DirtyRangeList&
+                  Dirty ranges of instances
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const DirtyRangeList& InstancedRenderable::GetDirtyInstances() const
+    {
+        return m_dirtyInstances;
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   InstancedRenderable::GetInstanceBuffer
 
@@ -81,7 +273,34 @@ namespace library
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     UINT InstancedRenderable::GetNumInstances() const
     {
-        return m_aInstanceData.size();
+        return static_cast<UINT>(HasPackedInstances() ? m_aPackedInstanceData.size() : m_aInstanceData.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::GetInstanceStride
+
+      Summary:  Returns the size of one instance in the instance buffer
+
+      Returns:  UINT
+                  Size of PackedInstanceData or InstanceData
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT InstancedRenderable::GetInstanceStride() const
+    {
+        return HasPackedInstances() ? sizeof(PackedInstanceData) : sizeof(InstanceData);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::HasPackedInstances
+
+      Summary:  Returns whether the instances are packed, in which case
+                they must be drawn with a packed voxel vertex shader
+
+      Returns:  BOOL
+                  TRUE if the instances are packed
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL InstancedRenderable::HasPackedInstances() const
+    {
+        return !m_aPackedInstanceData.empty();
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
@@ -100,14 +319,14 @@ namespace library
     HRESULT InstancedRenderable::initializeInstance(_In_ ID3D11Device* pDevice) {
         D3D11_BUFFER_DESC iBufferDesc =
         {
-            .ByteWidth = static_cast<UINT>(sizeof(InstanceData)) * GetNumInstances(),
+            .ByteWidth = GetInstanceStride() * GetNumInstances(),
             .Usage = D3D11_USAGE_DEFAULT,
             .BindFlags = D3D11_BIND_VERTEX_BUFFER,
             .CPUAccessFlags = 0
         };
         D3D11_SUBRESOURCE_DATA initData =
         {
-            .pSysMem = m_aInstanceData.data(),
+            .pSysMem = getInstanceData(),
             .SysMemPitch = 0,
             .SysMemSlicePitch = 0
         };
@@ -119,7 +338,79 @@ namespace library
             return hr;
         }
 
+        m_uInstanceCapacity = GetNumInstances();
+        m_dirtyInstances.Clear();
+
         return S_OK;
     }
     
-}
\ No newline at end of file
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::getInstanceData
+
+      Summary:  Returns the packed or unpacked instance data, whichever
+                is in use
+
+      Returns:  const void*
+                  Pointer to the first instance
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const void* InstancedRenderable::getInstanceData() const
+    {
+        return HasPackedInstances() ? static_cast<const void*>(m_aPackedInstanceData.data()) : static_cast<const void*>(m_aInstanceData.data());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::markChangedInstances
+
+      Summary:  Marks the runs of instances that differ between the old
+                and the new data as dirty, plus the instances past the
+                end of the old data
+
+      Args:     const void* pOldData
+                  Current instances
+                UINT uNumOldInstances
+                  Number of current instances
+                const void* pNewData
+                  New instances
+                UINT uNumNewInstances
+                  Number of new instances
+                UINT uStride
+                  Size of one instance
+
+      Modifies: [m_dirtyInstances].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void InstancedRenderable::markChangedInstances(
+        _In_ const void* pOldData,
+        _In_ UINT uNumOldInstances,
+        _In_ const void* pNewData,
+        _In_ UINT uNumNewInstances,
+        _In_ UINT uStride
+    )
+    {
+        const BYTE* pOld = static_cast<const BYTE*>(pOldData);
+        const BYTE* pNew = static_cast<const BYTE*>(pNewData);
+        const UINT uNumCommon = uNumOldInstances < uNumNewInstances ? uNumOldInstances : uNumNewInstances;
+
+        UINT uRunBegin = UINT_MAX;
+        for (UINT i = 0u; i < uNumCommon; ++i)
+        {
+            const BOOL bChanged = memcmp(pOld + static_cast<size_t>(i) * uStride, pNew + static_cast<size_t>(i) * uStride, uStride) != 0;
+            if (bChanged && uRunBegin == UINT_MAX)
+            {
+                uRunBegin = i;
+            }
+            else if (!bChanged && uRunBegin != UINT_MAX)
+            {
+                m_dirtyInstances.Add(uRunBegin, i);
+                uRunBegin = UINT_MAX;
+            }
+        }
+
+        if (uRunBegin != UINT_MAX)
+        {
+            m_dirtyInstances.Add(uRunBegin, uNumCommon);
+        }
+
+        m_dirtyInstances.Add(uNumCommon, uNumNewInstances);
+    }
+}
@@ -14,6 +14,7 @@
 #include "Common.h"
 
 #include "Renderer/DataTypes.h"
+#include "Renderer/DirtyRangeList.h"
 #include "Renderer/Renderable.h"
 
 namespace library
@@ -25,10 +26,28 @@ namespace library
 
       Methods:  SetInstanceData
                   Sets the instance data
+                SetPackedInstanceData
+                  Sets the packed instance data
+                UpdateInstanceData
+                  Replaces the instance data after initialization,
+                  marking the instances that changed as dirty
+                UpdatePackedInstanceData
+                  Replaces the packed instance data after
+                  initialization, marking the instances that changed
+                  as dirty
+                UploadDirtyInstances
+                  Copies the dirty instances to the instance buffer
+                GetDirtyInstances
+                  Returns the instances not uploaded yet
                 GetInstanceBuffer
                   Returns a instance buffer
                 GetNumInstances
                   Returns the number of instance data
+                GetInstanceStride
+                  Returns the size of one instance in the instance
+                  buffer
+                HasPackedInstances
+                  Returns whether the instances are packed
                 initializeInstance
                   Initialize the instance buffer
                 InstancedRenderable
@@ -41,6 +60,7 @@ namespace library
     public:
         InstancedRenderable(_In_ const XMFLOAT4& outputColor);
         InstancedRenderable(_In_ std::vector<InstanceData>&& aInstanceData, _In_ const XMFLOAT4& outputColor);
+        InstancedRenderable(_In_ std::vector<PackedInstanceData>&& aPackedInstanceData, _In_ const XMFLOAT4& outputColor);
         InstancedRenderable(const InstancedRenderable& other) = delete;
         InstancedRenderable(InstancedRenderable&& other) = delete;
         InstancedRenderable& operator=(const InstancedRenderable& other) = delete;
@@ -51,9 +71,16 @@ namespace library
         virtual void Update(_In_ FLOAT deltaTime) override = 0;
 
         void SetInstanceData(_In_ std::vector<InstanceData>&& aInstanceData);
+        void SetPackedInstanceData(_In_ std::vector<PackedInstanceData>&& aPackedInstanceData);
+        void UpdateInstanceData(_In_ std::vector<InstanceData>&& aInstanceData);
+        void UpdatePackedInstanceData(_In_ std::vector<PackedInstanceData>&& aPackedInstanceData);
+        HRESULT UploadDirtyInstances(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext);
+        const DirtyRangeList& GetDirtyInstances() const;
 
         virtual ComPtr<ID3D11Buffer>& GetInstanceBuffer();
         virtual UINT GetNumInstances() const;
+        UINT GetInstanceStride() const;
+        BOOL HasPackedInstances() const;
 
         UINT GetNumVertices() const override = 0;
         UINT GetNumIndices() const override = 0;
@@ -64,9 +91,16 @@ namespace library
 
         virtual HRESULT initializeInstance(_In_ ID3D11Device* pDevice);
 
+    private:
+        const void* getInstanceData() const;
+        void markChangedInstances(_In_ const void* pOldData, _In_ UINT uNumOldInstances, _In_ const void* pNewData, _In_ UINT uNumNewInstances, _In_ UINT uStride);
+
     protected:
         ComPtr<ID3D11Buffer> m_instanceBuffer;
         std::vector<InstanceData> m_aInstanceData;
+        std::vector<PackedInstanceData> m_aPackedInstanceData;
+        UINT m_uInstanceCapacity;
+        DirtyRangeList m_dirtyInstances;
 
     private:
         BYTE m_padding[8];
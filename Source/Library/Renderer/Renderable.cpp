@@ -13,7 +13,8 @@ namespace library
                   Path to the texture to use
       Modifies: [m_vertexBuffer, m_indexBuffer, m_constantBuffer,
                  m_textureRV, m_samplerLinear, m_vertexShader,
-                 m_pixelShader, m_textureFilePath, m_world].
+                 m_pixelShader, m_textureFilePath, m_world,
+                 m_indexFormat].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     Renderable::Renderable(_In_ const XMFLOAT4& outputColor):
         m_vertexBuffer(),
@@ -27,7 +28,8 @@ namespace library
         m_outputColor(outputColor),
         m_world(XMMatrixIdentity()),
         m_padding(),
-        m_bHasNormalMap()
+        m_bHasNormalMap(),
+        m_indexFormat(DXGI_FORMAT_R16_UINT)
     {}
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
@@ -99,8 +101,9 @@ namespace library
 
 
         // Create the index buffer
+        const UINT uIndexSize = (m_indexFormat == DXGI_FORMAT_R32_UINT) ? static_cast<UINT>(sizeof(UINT)) : static_cast<UINT>(sizeof(WORD));
         D3D11_BUFFER_DESC iBufferDesc = {
-            .ByteWidth = static_cast<UINT>(sizeof(WORD)) * GetNumIndices(),
+            .ByteWidth = uIndexSize * GetNumIndices(),
             .Usage = D3D11_USAGE_DEFAULT,
             .BindFlags = D3D11_BIND_INDEX_BUFFER,
             .CPUAccessFlags = 0,
@@ -108,7 +111,7 @@ namespace library
         };
 
         D3D11_SUBRESOURCE_DATA iInitData = {
-            .pSysMem = getIndices(),
+            .pSysMem = getIndexBufferData(),
             .SysMemPitch = 0,
             .SysMemSlicePitch = 0
         };
@@ -150,6 +153,20 @@ namespace library
     }
     
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderable::getIndexBufferData
+
+      Summary:  Returns the indices to upload to the index buffer, in
+                the index format. The 16-bit indices by default
+
+      Returns:  const void*
+                  Array of indices
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const void* Renderable::getIndexBufferData() const
+    {
+        return getIndices();
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Renderable::calculateNormalMapVectors
 
@@ -162,7 +179,14 @@ namespace library
     {
         UINT uNumFaces = GetNumIndices()/3;
         const SimpleVertex* vertices = getVertices();
-        const WORD* aIndices = getIndices();
+
+        // Widen the indices so both index formats are read the same way
+        const void* pIndexData = getIndexBufferData();
+        std::vector<UINT> aIndices(GetNumIndices());
+        for (UINT i = 0u; i < GetNumIndices(); ++i)
+        {
+            aIndices[i] = (m_indexFormat == DXGI_FORMAT_R32_UINT) ? static_cast<const UINT*>(pIndexData)[i] : static_cast<const WORD*>(pIndexData)[i];
+        }
 
         m_aNormalData.resize(GetNumVertices(), NormalData());
 
@@ -423,6 +447,19 @@ namespace library
         return m_indexBuffer;
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderable::GetIndexFormat
+
+      Summary:  Returns the format of the index buffer
+
+      Returns:  DXGI_FORMAT
+                  DXGI_FORMAT_R16_UINT or DXGI_FORMAT_R32_UINT
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    DXGI_FORMAT Renderable::GetIndexFormat() const
+    {
+        return m_indexFormat;
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Renderable::GetConstantBuffer
 
@@ -35,6 +35,8 @@ namespace library
                   Returns the vertex buffer
                 GetIndexBuffer
                   Returns the index buffer
+                GetIndexFormat
+                  Returns the format of the index buffer
                 GetConstantBuffer
                   Returns the constant buffer
                 GetWorldMatrix
@@ -94,6 +96,7 @@ namespace library
         ComPtr<ID3D11InputLayout>& GetVertexLayout();
         ComPtr<ID3D11Buffer>& GetVertexBuffer();
         ComPtr<ID3D11Buffer>& GetIndexBuffer();
+        DXGI_FORMAT GetIndexFormat() const;
         ComPtr<ID3D11Buffer>& GetConstantBuffer();
         ComPtr<ID3D11Buffer>& GetNormalBuffer();
 
@@ -120,6 +123,7 @@ namespace library
     protected:
         const virtual SimpleVertex* getVertices() const = 0;
         virtual const WORD* getIndices() const = 0;
+        virtual const void* getIndexBufferData() const;
         virtual HRESULT initialize(
             _In_ ID3D11Device* pDevice,
             _In_ ID3D11DeviceContext* pImmediateContext
@@ -145,5 +149,6 @@ namespace library
         BYTE m_padding[8];
         XMMATRIX m_world;
         BOOL m_bHasNormalMap;
+        DXGI_FORMAT m_indexFormat;
     };
 }
\ No newline at end of file
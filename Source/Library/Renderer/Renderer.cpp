@@ -434,7 +434,9 @@ namespace library
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Renderer::Update
 
-      Summary:  Update the renderables each frame
+      Summary:  Update the renderables each frame. A failure to stream
+                the chunks of the main scene is logged, and retried on
+                the next frame
 
       Args:     FLOAT deltaTime
                   Time difference of a frame
@@ -443,6 +445,16 @@ namespace library
     {
         m_scenes[m_pszMainSceneName]->Update(deltaTime);
 
+        HRESULT hr = m_scenes[m_pszMainSceneName]->UpdateChunks(m_camera.GetEye(), m_d3dDevice.Get(), m_immediateContext.Get());
+        if (FAILED(hr))
+        {
+            WCHAR szMessage[256];
+            swprintf_s(szMessage, L"Updating the chunks of %s failed: 0x%08X\n", m_pszMainSceneName, static_cast<UINT>(hr));
+            OutputDebugString(szMessage);
+        }
+
+        TextureCache::GetShared().Update(m_immediateContext.Get());
+
         m_camera.Update(deltaTime);
     }
 
@@ -514,7 +526,7 @@ namespace library
 
 
             m_immediateContext->IASetVertexBuffers(0, 1, skybox->GetVertexBuffer().GetAddressOf(), &sStride, &sOffset);
-            m_immediateContext->IASetIndexBuffer(skybox->GetIndexBuffer().Get(), DXGI_FORMAT_R16_UINT, 0);
+            m_immediateContext->IASetIndexBuffer(skybox->GetIndexBuffer().Get(), skybox->GetIndexFormat(), 0);
             m_immediateContext->IASetInputLayout(skybox->GetVertexLayout().Get());
 
             XMMATRIX world = skybox->GetWorldMatrix();
@@ -564,7 +576,7 @@ namespace library
             UINT roffset[2] = { 0u, 0u };
             ID3D11Buffer* rbuffer[2] = { i.second->GetVertexBuffer().Get(), i.second->GetNormalBuffer().Get() };
             m_immediateContext->IASetVertexBuffers(0, 2, rbuffer, rstride, roffset);
-            m_immediateContext->IASetIndexBuffer(i.second->GetIndexBuffer().Get(),DXGI_FORMAT_R16_UINT ,0);
+            m_immediateContext->IASetIndexBuffer(i.second->GetIndexBuffer().Get(), i.second->GetIndexFormat(), 0);
             m_immediateContext->IASetInputLayout(i.second->GetVertexLayout().Get());
                    
 
@@ -596,7 +608,7 @@ namespace library
                     if (i.second->GetMaterial(MaterialIndex)->pDiffuse)
                     {
                         ID3D11ShaderResourceView* aTextureRV[1] = {
-                            i.second->GetMaterial(MaterialIndex)->pDiffuse->GetTextureResourceView().Get()
+                            getTextureResourceView(i.second->GetMaterial(MaterialIndex)->pDiffuse)
                         };
                         eTextureSamplerType textureSamplerType = i.second->GetMaterial(MaterialIndex)->pDiffuse->GetSamplerType();
                         m_immediateContext->PSSetShaderResources(0u, 1u, aTextureRV);
@@ -606,7 +618,7 @@ namespace library
                     if (i.second->GetMaterial(MaterialIndex)->pNormal)
                     {
                         ID3D11ShaderResourceView* aTextureRV[1] = {
-                            i.second->GetMaterial(MaterialIndex)->pNormal->GetTextureResourceView().Get()
+                            getTextureResourceView(i.second->GetMaterial(MaterialIndex)->pNormal)
                         };
                         m_immediateContext->PSSetShaderResources(1u, 1u, aTextureRV);
 
@@ -631,12 +643,21 @@ namespace library
         for (auto i : m_scenes) {
             if (i.first == m_pszMainSceneName) {
 
-                for (auto j : i.second->GetVoxels()) {
-                    UINT vstride[3] = { sizeof(SimpleVertex), sizeof(NormalData), sizeof(InstanceData) };
+                i.second->CullVoxels(m_camera.GetView() * m_projection);
+
+                std::vector<std::shared_ptr<Voxel>>& aVoxels = i.second->GetVoxels();
+                for (size_t uVoxelIdx = 0u; uVoxelIdx < aVoxels.size(); ++uVoxelIdx) {
+                    const std::shared_ptr<Voxel>& j = aVoxels[uVoxelIdx];
+                    const std::vector<InstanceRange>& aRanges = i.second->GetVisibleInstanceRanges(uVoxelIdx);
+                    if (aRanges.empty()) {
+                        continue;
+                    }
+
+                    UINT vstride[3] = { sizeof(SimpleVertex), sizeof(NormalData), j->GetInstanceStride() };
                     UINT voffset[3] = { 0u, 0u, 0u };
                     ID3D11Buffer* vbuffer[3] = { j->GetVertexBuffer().Get(), j->GetNormalBuffer().Get(), j->GetInstanceBuffer().Get() };
                     m_immediateContext->IASetVertexBuffers(0u, 3u, vbuffer, vstride, voffset);
-                    m_immediateContext->IASetIndexBuffer(j->GetIndexBuffer().Get(), DXGI_FORMAT_R16_UINT, 0);
+                    m_immediateContext->IASetIndexBuffer(j->GetIndexBuffer().Get(), j->GetIndexFormat(), 0);
                     m_immediateContext->IASetInputLayout(j->GetVertexLayout().Get());
 
                     CBChangesEveryFrame cbChanges = {
@@ -655,6 +676,7 @@ namespace library
                     m_immediateContext->PSSetConstantBuffers(2, 1, j->GetConstantBuffer().GetAddressOf());
                     m_immediateContext->VSSetConstantBuffers(3, 1, m_cbLights.GetAddressOf());
                     m_immediateContext->PSSetConstantBuffers(3, 1, m_cbLights.GetAddressOf());
+                    m_immediateContext->VSSetConstantBuffers(4, 1, i.second->GetPaletteConstantBuffer().GetAddressOf());
 
                     
                     
@@ -666,7 +688,7 @@ namespace library
                             if (j->GetMaterial(0u)->pDiffuse)
                             {
                                 ID3D11ShaderResourceView* aTextureRV[1] = {
-                                    j->GetMaterial(0u)->pDiffuse->GetTextureResourceView().Get()
+                                    getTextureResourceView(j->GetMaterial(0u)->pDiffuse)
                                 };
                                 eTextureSamplerType textureSamplerType = j->GetMaterial(0u)->pDiffuse->GetSamplerType();
                                 m_immediateContext->PSSetShaderResources(0u, 1u, aTextureRV);
@@ -676,7 +698,7 @@ namespace library
                             if (j->GetMaterial(0u)->pNormal)
                             {
                                 ID3D11ShaderResourceView* aTextureRV[1] = {
-                                   j->GetMaterial(0u)->pNormal->GetTextureResourceView().Get()
+                                   getTextureResourceView(j->GetMaterial(0u)->pNormal)
                                 };
                                 m_immediateContext->PSSetShaderResources(1u, 1u, aTextureRV);
 
@@ -691,9 +713,9 @@ namespace library
                         }
                     }
                     else {
-
-
-                        m_immediateContext->DrawIndexedInstanced(j->GetNumIndices(), j->GetNumInstances(), 0, 0, 0);
+                        for (const InstanceRange& range : aRanges) {
+                            m_immediateContext->DrawIndexedInstanced(j->GetNumIndices(), range.uNumInstances, 0, 0, range.uBeginInstance);
+                        }
                     }
                     
 
@@ -705,6 +727,65 @@ namespace library
             
         }
 
+        std::vector<std::shared_ptr<VoxelMesh>>& aVoxelMeshes = mainScene->GetVoxelMeshes();
+        for (size_t uVoxelMeshIdx = 0u; uVoxelMeshIdx < aVoxelMeshes.size(); ++uVoxelMeshIdx)
+        {
+            if (!mainScene->IsVoxelMeshVisible(uVoxelMeshIdx))
+            {
+                continue;
+            }
+
+            const std::shared_ptr<VoxelMesh>& i = aVoxelMeshes[uVoxelMeshIdx];
+            UINT mstride[4] = { sizeof(SimpleVertex), sizeof(NormalData), sizeof(BYTE), sizeof(BYTE) };
+            UINT moffset[4] = { 0u, 0u, 0u, 0u };
+            ID3D11Buffer* mbuffer[4] = { i->GetVertexBuffer().Get(), i->GetNormalBuffer().Get(), i->GetOcclusionBuffer().Get(), i->GetLightBuffer().Get() };
+            m_immediateContext->IASetVertexBuffers(0u, 4u, mbuffer, mstride, moffset);
+            m_immediateContext->IASetIndexBuffer(i->GetIndexBuffer().Get(), i->GetIndexFormat(), 0);
+            m_immediateContext->IASetInputLayout(i->GetVertexLayout().Get());
+
+            CBChangesEveryFrame cbChanges = {
+                .World = XMMatrixTranspose(i->GetWorldMatrix()),
+                .OutputColor = i->GetOutputColor(),
+                .HasNormalMap = i->HasNormalMap()
+            };
+            m_immediateContext->UpdateSubresource(i->GetConstantBuffer().Get(), 0, nullptr, &cbChanges, 0, 0);
+
+            m_immediateContext->VSSetShader(i->GetVertexShader().Get(), nullptr, 0);
+            m_immediateContext->PSSetShader(i->GetPixelShader().Get(), nullptr, 0);
+            m_immediateContext->VSSetConstantBuffers(0, 1, m_camera.GetConstantBuffer().GetAddressOf());
+            m_immediateContext->PSSetConstantBuffers(0, 1, m_camera.GetConstantBuffer().GetAddressOf());
+            m_immediateContext->VSSetConstantBuffers(1, 1, m_cbChangeOnResize.GetAddressOf());
+            m_immediateContext->VSSetConstantBuffers(2, 1, i->GetConstantBuffer().GetAddressOf());
+            m_immediateContext->PSSetConstantBuffers(2, 1, i->GetConstantBuffer().GetAddressOf());
+            m_immediateContext->VSSetConstantBuffers(3, 1, m_cbLights.GetAddressOf());
+            m_immediateContext->PSSetConstantBuffers(3, 1, m_cbLights.GetAddressOf());
+
+            if (i->HasTexture())
+            {
+                if (i->GetMaterial(0u)->pDiffuse)
+                {
+                    ID3D11ShaderResourceView* aTextureRV[1] = {
+                        getTextureResourceView(i->GetMaterial(0u)->pDiffuse)
+                    };
+                    eTextureSamplerType textureSamplerType = i->GetMaterial(0u)->pDiffuse->GetSamplerType();
+                    m_immediateContext->PSSetShaderResources(0u, 1u, aTextureRV);
+                    m_immediateContext->PSSetSamplers(0u, 1u, Texture::s_samplers[static_cast<size_t>(textureSamplerType)].GetAddressOf());
+                }
+                if (i->GetMaterial(0u)->pNormal)
+                {
+                    ID3D11ShaderResourceView* aTextureRV[1] = {
+                        getTextureResourceView(i->GetMaterial(0u)->pNormal)
+                    };
+                    m_immediateContext->PSSetShaderResources(1u, 1u, aTextureRV);
+
+                    eTextureSamplerType textureSamplerType = i->GetMaterial(0u)->pDiffuse->GetSamplerType();
+                    m_immediateContext->PSSetSamplers(1u, 1u, Texture::s_samplers[static_cast<size_t>(textureSamplerType)].GetAddressOf());
+                }
+            }
+
+            m_immediateContext->DrawIndexed(i->GetNumIndices(), 0, 0);
+        }
+
         
         for (auto i : mainScene->GetModels()) 
         {
@@ -712,7 +793,7 @@ namespace library
             UINT model_offsets[3] = { 0u, 0u, 0u };
             ID3D11Buffer* model_buffers[3] = { i.second->GetVertexBuffer().Get(), i.second->GetNormalBuffer().Get() };
             m_immediateContext->IASetVertexBuffers(0, 2, model_buffers, model_strides, model_offsets);
-            m_immediateContext->IASetIndexBuffer(i.second->GetIndexBuffer().Get(), DXGI_FORMAT_R16_UINT, 0);
+            m_immediateContext->IASetIndexBuffer(i.second->GetIndexBuffer().Get(), i.second->GetIndexFormat(), 0);
             m_immediateContext->IASetInputLayout(i.second->GetVertexLayout().Get());
 
 
@@ -753,7 +834,7 @@ namespace library
                     if (i.second->GetMaterial(MaterialIndex)->pDiffuse)
                     {
                         ID3D11ShaderResourceView* aTextureRV[1] = {
-                            i.second->GetMaterial(MaterialIndex)->pDiffuse->GetTextureResourceView().Get()
+                            getTextureResourceView(i.second->GetMaterial(MaterialIndex)->pDiffuse)
                         };
                         eTextureSamplerType textureSamplerType = i.second->GetMaterial(MaterialIndex)->pDiffuse->GetSamplerType();
                         m_immediateContext->PSSetShaderResources(0u, 1u, aTextureRV);
@@ -763,7 +844,7 @@ namespace library
                     if (i.second->GetMaterial(MaterialIndex)->pNormal)
                     {
                         ID3D11ShaderResourceView* aTextureRV[1] = {
-                            i.second->GetMaterial(MaterialIndex)->pNormal->GetTextureResourceView().Get()
+                            getTextureResourceView(i.second->GetMaterial(MaterialIndex)->pNormal)
                         };
                         m_immediateContext->PSSetShaderResources(1u, 1u, aTextureRV);
 
@@ -794,6 +875,33 @@ namespace library
         return m_driverType;
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::getTextureResourceView
+
+      Summary:  Returns the view to bind for a material texture and
+                marks it as used in the texture cache. The invalid
+                texture stands in while the texture is still streaming
+                in or when it failed to load
+
+      Args:     const std::shared_ptr<Texture>& texture
+                  Material texture
+
+      Returns:  ID3D11ShaderResourceView*
+                  Shader resource view to bind
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ID3D11ShaderResourceView* Renderer::getTextureResourceView(_In_ const std::shared_ptr<Texture>& texture) const
+    {
+        TextureCache::GetShared().Touch(m_d3dDevice.Get(), texture);
+
+        const eTextureLoadState loadState = texture->GetLoadState();
+        if (loadState == eTextureLoadState::LOADING || loadState == eTextureLoadState::FAILED)
+        {
+            return m_invalidTexture->GetTextureResourceView().Get();
+        }
+
+        return texture->GetTextureResourceView().Get();
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Renderer::RenderSceneToTexture
 
@@ -822,7 +930,7 @@ namespace library
             UINT uStride = sizeof(SimpleVertex);
             UINT uOffset = 0;
             m_immediateContext->IASetVertexBuffers(0u, 1u, i.second->GetVertexBuffer().GetAddressOf(), &uStride, &uOffset);
-            m_immediateContext->IASetIndexBuffer(i.second->GetIndexBuffer().Get(), DXGI_FORMAT_R16_UINT, 0);
+            m_immediateContext->IASetIndexBuffer(i.second->GetIndexBuffer().Get(), i.second->GetIndexFormat(), 0);
             m_immediateContext->IASetInputLayout(m_shadowVertexShader->GetVertexLayout().Get());
 
             CBShadowMatrix cb = {
@@ -850,7 +958,7 @@ namespace library
                     UINT uStride = sizeof(SimpleVertex);
                     UINT uOffset = 0;
                     m_immediateContext->IASetVertexBuffers(0u, 1u, j->GetVertexBuffer().GetAddressOf(), &uStride, &uOffset);
-                    m_immediateContext->IASetIndexBuffer(j->GetIndexBuffer().Get(), DXGI_FORMAT_R16_UINT, 0);
+                    m_immediateContext->IASetIndexBuffer(j->GetIndexBuffer().Get(), j->GetIndexFormat(), 0);
                     m_immediateContext->IASetInputLayout(j->GetVertexLayout().Get());
 
                     CBShadowMatrix cb = {
@@ -873,13 +981,36 @@ namespace library
 
         }
 
+        for (auto i : mainScene->GetVoxelMeshes())
+        {
+            UINT uStride = sizeof(SimpleVertex);
+            UINT uOffset = 0;
+            m_immediateContext->IASetVertexBuffers(0u, 1u, i->GetVertexBuffer().GetAddressOf(), &uStride, &uOffset);
+            m_immediateContext->IASetIndexBuffer(i->GetIndexBuffer().Get(), i->GetIndexFormat(), 0);
+            m_immediateContext->IASetInputLayout(m_shadowVertexShader->GetVertexLayout().Get());
+
+            CBShadowMatrix cb = {
+                .World = XMMatrixTranspose(i->GetWorldMatrix()),
+                .View = XMMatrixTranspose(pointLight->GetViewMatrix()),
+                .Projection = XMMatrixTranspose(pointLight->GetProjectionMatrix()),
+                .IsVoxel = FALSE
+            };
+            m_immediateContext->UpdateSubresource(m_cbShadowMatrix.Get(), 0, nullptr, &cb, 0, 0);
+            m_immediateContext->VSSetConstantBuffers(0, 1, m_cbShadowMatrix.GetAddressOf());
+
+            m_immediateContext->VSSetShader(m_shadowVertexShader->GetVertexShader().Get(), nullptr, 0);
+            m_immediateContext->PSSetShader(m_shadowPixelShader->GetPixelShader().Get(), nullptr, 0);
+
+            m_immediateContext->DrawIndexed(i->GetNumIndices(), 0, 0);
+        }
+
 
         for (auto i : mainScene->GetModels())
         {
             UINT uStride = sizeof(SimpleVertex);         
             UINT uOffset = 0;         
             m_immediateContext->IASetVertexBuffers(0u, 1u, i.second->GetVertexBuffer().GetAddressOf(), &uStride, &uOffset);
-            m_immediateContext->IASetIndexBuffer(i.second->GetIndexBuffer().Get(), DXGI_FORMAT_R16_UINT, 0);
+            m_immediateContext->IASetIndexBuffer(i.second->GetIndexBuffer().Get(), i.second->GetIndexFormat(), 0);
             m_immediateContext->IASetInputLayout(m_shadowVertexShader->GetVertexLayout().Get());
 
             CBShadowMatrix cb = {
@@ -72,6 +72,9 @@ namespace library
 
         D3D_DRIVER_TYPE GetDriverType() const;
 
+    private:
+        ID3D11ShaderResourceView* getTextureResourceView(_In_ const std::shared_ptr<Texture>& texture) const;
+
     private:
         D3D_DRIVER_TYPE m_driverType;
         D3D_FEATURE_LEVEL m_featureLevel;
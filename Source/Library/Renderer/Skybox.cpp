@@ -73,6 +73,24 @@ namespace library
         return m_aMaterials[0]->pDiffuse;
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Skybox::getCookedFilePath
+
+      Summary:  Returns the path of the cooked sphere. The skybox winds
+                the sphere inside out, so it is cooked apart from
+                models of the same file
+
+      Returns:  std::filesystem::path
+                  Path of the cooked model
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::filesystem::path Skybox::getCookedFilePath() const
+    {
+        std::filesystem::path cookedFilePath = m_filePath;
+        cookedFilePath += L".skybox.cooked";
+
+        return cookedFilePath;
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Skybox::initSingleMesh
 
@@ -86,6 +104,8 @@ namespace library
     void Skybox::initSingleMesh(_In_ UINT uMeshIndex, _In_ const aiMesh* pMesh)
     {
         const aiVector3D zero3d(0.0f, 0.0f, 0.0f);
+        const UINT uBaseVertex = m_aMeshes[uMeshIndex].uBaseVertex;
+        const UINT uBaseIndex = m_aMeshes[uMeshIndex].uBaseIndex;
 
         for (UINT i = 0u; i < pMesh->mNumVertices; i++) {
             const aiVector3D& position = pMesh->mVertices[i];
@@ -103,30 +123,30 @@ namespace library
             };
 
 
-            m_aVertices.push_back(vertex);
+            m_aVertices[uBaseVertex + i] = vertex;
 
             NormalData normalData = {
                      .Tangent = XMFLOAT3(tangent.x, tangent.y, tangent.z),
                      .Bitangent = XMFLOAT3(bitangent.x, bitangent.y, bitangent.z)
             };
 
-            m_aNormalData.push_back(normalData);
+            m_aNormalData[uBaseVertex + i] = normalData;
 
         }
 
         for (UINT i = 0u; i < pMesh->mNumFaces; ++i) {
             const aiFace& face = pMesh->mFaces[i];
             assert(face.mNumIndices == 3);
-            WORD aIndices[3] =
+            UINT aIndices[3] =
             {
-                static_cast<WORD>(face.mIndices[2]),
-                static_cast<WORD>(face.mIndices[1]),
-                static_cast<WORD>(face.mIndices[0])
+                face.mIndices[2],
+                face.mIndices[1],
+                face.mIndices[0]
             };
 
-            m_aIndices.push_back(aIndices[0]);
-            m_aIndices.push_back(aIndices[1]);
-            m_aIndices.push_back(aIndices[2]);
+            m_aIndices[uBaseIndex + i * 3u] = aIndices[0];
+            m_aIndices[uBaseIndex + i * 3u + 1u] = aIndices[1];
+            m_aIndices[uBaseIndex + i * 3u + 2u] = aIndices[2];
         }
 
     }
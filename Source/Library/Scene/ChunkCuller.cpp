@@ -0,0 +1,491 @@
+#include "Scene/ChunkCuller.h"
+
+#include <algorithm>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkCuller::ExtractFrustumPlanes
+
+      Summary:  Returns the left, right, bottom, top, near and far
+                planes of the frustum of a view projection transform.
+                A point p is inside of a plane (a, b, c, d) when
+                a * p.x + b * p.y + c * p.z + d >= 0
+
+      Args:     const XMMATRIX& viewProjection
+                  View transform multiplied by the projection transform
+                XMFLOAT4 aOutPlanes[NUM_FRUSTUM_PLANES]
+                  Planes of the frustum, not normalized
+
+      Modifies: [aOutPlanes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkCuller::ExtractFrustumPlanes(_In_ const XMMATRIX& viewProjection, _Out_writes_(NUM_FRUSTUM_PLANES) XMFLOAT4 aOutPlanes[NUM_FRUSTUM_PLANES])
+    {
+        XMFLOAT4X4 m;
+        XMStoreFloat4x4(&m, viewProjection);
+
+        // Row vectors are multiplied on the left, so the clip
+        // coordinates are the dot products with the columns
+        aOutPlanes[0] = XMFLOAT4(m.m[0][3] + m.m[0][0], m.m[1][3] + m.m[1][0], m.m[2][3] + m.m[2][0], m.m[3][3] + m.m[3][0]);
+        aOutPlanes[1] = XMFLOAT4(m.m[0][3] - m.m[0][0], m.m[1][3] - m.m[1][0], m.m[2][3] - m.m[2][0], m.m[3][3] - m.m[3][0]);
+        aOutPlanes[2] = XMFLOAT4(m.m[0][3] + m.m[0][1], m.m[1][3] + m.m[1][1], m.m[2][3] + m.m[2][1], m.m[3][3] + m.m[3][1]);
+        aOutPlanes[3] = XMFLOAT4(m.m[0][3] - m.m[0][1], m.m[1][3] - m.m[1][1], m.m[2][3] - m.m[2][1], m.m[3][3] - m.m[3][1]);
+        aOutPlanes[4] = XMFLOAT4(m.m[0][2], m.m[1][2], m.m[2][2], m.m[3][2]);
+        aOutPlanes[5] = XMFLOAT4(m.m[0][3] - m.m[0][2], m.m[1][3] - m.m[1][2], m.m[2][3] - m.m[2][2], m.m[3][3] - m.m[3][2]);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkCuller::TestBox
+
+      Summary:  Classifies an axis aligned box against frustum planes
+                by testing, for every plane, the corner furthest along
+                the plane normal and the corner furthest against it.
+                Conservative: a box crossing two planes outside of the
+                frustum may be reported as intersecting
+
+      Args:     const XMFLOAT4 aPlanes[NUM_FRUSTUM_PLANES]
+                  Planes of the frustum
+                const XMFLOAT3& boxMin
+                  Minimum corner of the box
+                const XMFLOAT3& boxMax
+                  Maximum corner of the box
+
+      Returns:  eCullResult
+                  Whether the box is outside, crossing or inside of
+                  the frustum
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    eCullResult ChunkCuller::TestBox(_In_reads_(NUM_FRUSTUM_PLANES) const XMFLOAT4 aPlanes[NUM_FRUSTUM_PLANES], _In_ const XMFLOAT3& boxMin, _In_ const XMFLOAT3& boxMax)
+    {
+        eCullResult result = eCullResult::INSIDE;
+        for (UINT uPlaneIdx = 0u; uPlaneIdx < NUM_FRUSTUM_PLANES; ++uPlaneIdx)
+        {
+            const XMFLOAT4& plane = aPlanes[uPlaneIdx];
+
+            const FLOAT farthest = plane.x * (plane.x >= 0.0f ? boxMax.x : boxMin.x)
+                + plane.y * (plane.y >= 0.0f ? boxMax.y : boxMin.y)
+                + plane.z * (plane.z >= 0.0f ? boxMax.z : boxMin.z)
+                + plane.w;
+            if (farthest < 0.0f)
+            {
+                return eCullResult::OUTSIDE;
+            }
+
+            const FLOAT nearest = plane.x * (plane.x >= 0.0f ? boxMin.x : boxMax.x)
+                + plane.y * (plane.y >= 0.0f ? boxMin.y : boxMax.y)
+                + plane.z * (plane.z >= 0.0f ? boxMin.z : boxMax.z)
+                + plane.w;
+            if (nearest < 0.0f)
+            {
+                result = eCullResult::INTERSECTING;
+            }
+        }
+
+        return result;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkCuller::ChunkCuller
+
+      Summary:  Constructor
+
+      Args:     UINT uNumChunksX
+                  Number of chunks along the x axis
+                UINT uNumChunksZ
+                  Number of chunks along the z axis
+                UINT uRegionSize
+                  Number of chunks along each side of a region
+
+      Modifies: [m_uNumChunksX, m_uNumChunksZ, m_uRegionSize,
+                 m_uNumRegionsX, m_uNumRegionsZ, m_aChunkBounds,
+                 m_aRegionBounds, m_aDirtyRegions, m_aVisibleChunks].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ChunkCuller::ChunkCuller(_In_ UINT uNumChunksX, _In_ UINT uNumChunksZ, _In_ UINT uRegionSize)
+        : m_uNumChunksX(0u)
+        , m_uNumChunksZ(0u)
+        , m_uRegionSize(uRegionSize > 0u ? uRegionSize : DEFAULT_REGION_SIZE)
+        , m_uNumRegionsX(0u)
+        , m_uNumRegionsZ(0u)
+        , m_aChunkBounds()
+        , m_aRegionBounds()
+        , m_aDirtyRegions()
+        , m_aVisibleChunks()
+    {
+        Reset(uNumChunksX, uNumChunksZ);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkCuller::Reset
+
+      Summary:  Resizes the grid of chunks. Every chunk is forgotten
+                and culled until its bounds are set
+
+      Args:     UINT uNumChunksX
+                  Number of chunks along the x axis
+                UINT uNumChunksZ
+                  Number of chunks along the z axis
+
+      Modifies: [m_uNumChunksX, m_uNumChunksZ, m_uNumRegionsX,
+                 m_uNumRegionsZ, m_aChunkBounds, m_aRegionBounds,
+                 m_aDirtyRegions, m_aVisibleChunks].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkCuller::Reset(_In_ UINT uNumChunksX, _In_ UINT uNumChunksZ)
+    {
+        m_uNumChunksX = uNumChunksX;
+        m_uNumChunksZ = uNumChunksZ;
+        m_uNumRegionsX = (uNumChunksX + m_uRegionSize - 1u) / m_uRegionSize;
+        m_uNumRegionsZ = (uNumChunksZ + m_uRegionSize - 1u) / m_uRegionSize;
+
+        const size_t uNumChunks = static_cast<size_t>(uNumChunksX) * static_cast<size_t>(uNumChunksZ);
+        const size_t uNumRegions = static_cast<size_t>(m_uNumRegionsX) * static_cast<size_t>(m_uNumRegionsZ);
+        m_aChunkBounds.assign(uNumChunks, Bounds{ .bValid = FALSE });
+        m_aRegionBounds.assign(uNumRegions, Bounds{ .bValid = FALSE });
+        m_aDirtyRegions.assign(uNumRegions, FALSE);
+        m_aVisibleChunks.assign(uNumChunks, FALSE);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkCuller::SetChunkBounds
+
+      Summary:  Sets the bounding box of a chunk. The box of its region
+                is recomputed on the next cull
+
+      Args:     UINT uChunkX
+                  Chunk index along the x axis
+                UINT uChunkZ
+                  Chunk index along the z axis
+                const XMFLOAT3& boxMin
+                  Minimum corner of the box
+                const XMFLOAT3& boxMax
+                  Maximum corner of the box
+
+      Modifies: [m_aChunkBounds, m_aDirtyRegions].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkCuller::SetChunkBounds(_In_ UINT uChunkX, _In_ UINT uChunkZ, _In_ const XMFLOAT3& boxMin, _In_ const XMFLOAT3& boxMax)
+    {
+        assert(uChunkX < m_uNumChunksX && uChunkZ < m_uNumChunksZ);
+
+        m_aChunkBounds[GetChunkIndex(uChunkX, uChunkZ)] = Bounds{ .Min = boxMin, .Max = boxMax, .bValid = TRUE };
+        m_aDirtyRegions[static_cast<size_t>(uChunkZ / m_uRegionSize) * m_uNumRegionsX + uChunkX / m_uRegionSize] = TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkCuller::ClearChunkBounds
+
+      Summary:  Removes a chunk from the culling, it is never visible
+                until its bounds are set again
+
+      Args:     UINT uChunkX
+                  Chunk index along the x axis
+                UINT uChunkZ
+                  Chunk index along the z axis
+
+      Modifies: [m_aChunkBounds, m_aDirtyRegions].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkCuller::ClearChunkBounds(_In_ UINT uChunkX, _In_ UINT uChunkZ)
+    {
+        assert(uChunkX < m_uNumChunksX && uChunkZ < m_uNumChunksZ);
+
+        m_aChunkBounds[GetChunkIndex(uChunkX, uChunkZ)].bValid = FALSE;
+        m_aDirtyRegions[static_cast<size_t>(uChunkZ / m_uRegionSize) * m_uNumRegionsX + uChunkX / m_uRegionSize] = TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkCuller::Cull
+
+      Summary:  Computes the visibility of every chunk. Regions are
+                tested first, and the chunks of a region are only
+                tested when the region crosses the frustum
+
+      Args:     const XMMATRIX& viewProjection
+                  View transform multiplied by the projection transform
+                ChunkCullingStats* pStats
+                  Statistics to accumulate into. Can be null
+
+      Modifies: [m_aRegionBounds, m_aDirtyRegions, m_aVisibleChunks].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkCuller::Cull(_In_ const XMMATRIX& viewProjection, _Inout_opt_ ChunkCullingStats* pStats)
+    {
+        LARGE_INTEGER startingTime;
+        LARGE_INTEGER endingTime;
+        LARGE_INTEGER frequency;
+        QueryPerformanceCounter(&startingTime);
+
+        XMFLOAT4 aPlanes[NUM_FRUSTUM_PLANES];
+        ExtractFrustumPlanes(viewProjection, aPlanes);
+
+        std::fill(m_aVisibleChunks.begin(), m_aVisibleChunks.end(), static_cast<BYTE>(FALSE));
+
+        ChunkCullingStats stats = {};
+        for (UINT uRegionZ = 0u; uRegionZ < m_uNumRegionsZ; ++uRegionZ)
+        {
+            for (UINT uRegionX = 0u; uRegionX < m_uNumRegionsX; ++uRegionX)
+            {
+                const UINT uRegionIdx = uRegionZ * m_uNumRegionsX + uRegionX;
+                if (m_aDirtyRegions[uRegionIdx])
+                {
+                    updateRegionBounds(uRegionIdx);
+                }
+
+                const Bounds& region = m_aRegionBounds[uRegionIdx];
+                if (!region.bValid)
+                {
+                    continue;
+                }
+
+                ++stats.uNumRegionsTested;
+                const eCullResult regionResult = TestBox(aPlanes, region.Min, region.Max);
+                if (regionResult == eCullResult::OUTSIDE)
+                {
+                    ++stats.uNumRegionsCulled;
+                }
+                else if (regionResult == eCullResult::INSIDE)
+                {
+                    ++stats.uNumRegionsInside;
+                }
+
+                const UINT uBeginX = uRegionX * m_uRegionSize;
+                const UINT uBeginZ = uRegionZ * m_uRegionSize;
+                const UINT uEndX = uBeginX + m_uRegionSize < m_uNumChunksX ? uBeginX + m_uRegionSize : m_uNumChunksX;
+                const UINT uEndZ = uBeginZ + m_uRegionSize < m_uNumChunksZ ? uBeginZ + m_uRegionSize : m_uNumChunksZ;
+                for (UINT uChunkZ = uBeginZ; uChunkZ < uEndZ; ++uChunkZ)
+                {
+                    for (UINT uChunkX = uBeginX; uChunkX < uEndX; ++uChunkX)
+                    {
+                        const UINT uChunkIdx = GetChunkIndex(uChunkX, uChunkZ);
+                        const Bounds& chunk = m_aChunkBounds[uChunkIdx];
+                        if (!chunk.bValid)
+                        {
+                            continue;
+                        }
+
+                        ++stats.uNumChunks;
+                        BOOL bVisible = regionResult == eCullResult::INSIDE;
+                        if (regionResult == eCullResult::INTERSECTING)
+                        {
+                            ++stats.uNumChunksTested;
+                            bVisible = TestBox(aPlanes, chunk.Min, chunk.Max) != eCullResult::OUTSIDE;
+                        }
+
+                        if (bVisible)
+                        {
+                            m_aVisibleChunks[uChunkIdx] = TRUE;
+                            ++stats.uNumChunksVisible;
+                        }
+                    }
+                }
+            }
+        }
+
+        QueryPerformanceCounter(&endingTime);
+        QueryPerformanceFrequency(&frequency);
+
+        if (pStats)
+        {
+            pStats->uNumRegionsTested += stats.uNumRegionsTested;
+            pStats->uNumRegionsCulled += stats.uNumRegionsCulled;
+            pStats->uNumRegionsInside += stats.uNumRegionsInside;
+            pStats->uNumChunksTested += stats.uNumChunksTested;
+            pStats->uNumChunks += stats.uNumChunks;
+            pStats->uNumChunksVisible += stats.uNumChunksVisible;
+            pStats->uTicks += static_cast<UINT64>(endingTime.QuadPart - startingTime.QuadPart);
+            pStats->uTicksPerSecond = static_cast<UINT64>(frequency.QuadPart);
+        }
+    }
+
+    BOOL ChunkCuller::IsChunkVisible(_In_ UINT uChunkIndex) const
+    {
+        return uChunkIndex < m_aVisibleChunks.size() && m_aVisibleChunks[uChunkIndex];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkCuller::AppendVisibleRanges
+
+      Summary:  Appends the instance ranges of the chunks visible in
+                the last cull, merging ranges that follow each other in
+                the instance buffer so they are drawn by one call
+
+      Args:     const std::vector<ChunkInstanceRange>& aChunkRanges
+                  Instance ranges of a voxel, sorted by first instance
+                std::vector<InstanceRange>& aOutRanges
+                  Ranges to draw
+                ChunkCullingStats* pStats
+                  Statistics to accumulate into. Can be null
+
+      Modifies: [aOutRanges].
+
+      Returns:  UINT
+                  Number of visible instances
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT ChunkCuller::AppendVisibleRanges(
+        _In_ const std::vector<ChunkInstanceRange>& aChunkRanges,
+        _Inout_ std::vector<InstanceRange>& aOutRanges,
+        _Inout_opt_ ChunkCullingStats* pStats
+    ) const
+    {
+        const size_t uFirstRange = aOutRanges.size();
+        UINT uNumInstances = 0u;
+        UINT uNumVisibleInstances = 0u;
+        for (const ChunkInstanceRange& range : aChunkRanges)
+        {
+            uNumInstances += range.uNumInstances;
+            if (range.uNumInstances == 0u || !IsChunkVisible(range.uChunkIndex))
+            {
+                continue;
+            }
+
+            uNumVisibleInstances += range.uNumInstances;
+            if (aOutRanges.size() > uFirstRange && aOutRanges.back().uBeginInstance + aOutRanges.back().uNumInstances == range.uBeginInstance)
+            {
+                aOutRanges.back().uNumInstances += range.uNumInstances;
+            }
+            else
+            {
+                aOutRanges.push_back(InstanceRange{ .uBeginInstance = range.uBeginInstance, .uNumInstances = range.uNumInstances });
+            }
+        }
+
+        if (pStats)
+        {
+            pStats->uNumInstances += uNumInstances;
+            pStats->uNumInstancesVisible += uNumVisibleInstances;
+            pStats->uNumRanges += aOutRanges.size() - uFirstRange;
+        }
+
+        return uNumVisibleInstances;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkCuller::Benchmark
+
+      Summary:  Culls the grid a number of times with the same view and
+                reports the statistics of one cull with the average
+                time spent
+
+      Args:     const XMMATRIX& viewProjection
+                  View transform multiplied by the projection transform
+                UINT uNumIterations
+                  Number of culls
+                ChunkCullingStats& outStats
+                  Statistics of one cull
+
+      Modifies: [m_aRegionBounds, m_aDirtyRegions, m_aVisibleChunks].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkCuller::Benchmark(_In_ const XMMATRIX& viewProjection, _In_ UINT uNumIterations, _Out_ ChunkCullingStats& outStats)
+    {
+        outStats = {};
+        Cull(viewProjection, &outStats);
+
+        ChunkCullingStats timing = {};
+        for (UINT i = 0u; i < uNumIterations; ++i)
+        {
+            Cull(viewProjection, &timing);
+        }
+
+        outStats.uTicks = uNumIterations > 0u ? timing.uTicks / uNumIterations : outStats.uTicks;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkCuller::Validate
+
+      Summary:  Culls the grid, then tests the box of every chunk with
+                bounds against the frustum on its own and compares the
+                two visible sets. The regions only skip tests, so any
+                difference is a bug in the hierarchy, such as a stale
+                region box
+
+      Args:     const XMMATRIX& viewProjection
+                  View transform multiplied by the projection transform
+                ChunkCullingValidationStats& outStats
+                  Number of chunks and of disagreements
+
+      Modifies: [m_aRegionBounds, m_aDirtyRegions, m_aVisibleChunks].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkCuller::Validate(_In_ const XMMATRIX& viewProjection, _Out_ ChunkCullingValidationStats& outStats)
+    {
+        outStats = ChunkCullingValidationStats{};
+        Cull(viewProjection);
+
+        XMFLOAT4 aPlanes[NUM_FRUSTUM_PLANES];
+        ExtractFrustumPlanes(viewProjection, aPlanes);
+
+        for (UINT uChunkIdx = 0u; uChunkIdx < m_aChunkBounds.size(); ++uChunkIdx)
+        {
+            const Bounds& chunk = m_aChunkBounds[uChunkIdx];
+            const BOOL bCulledVisible = IsChunkVisible(uChunkIdx);
+            if (!chunk.bValid)
+            {
+                outStats.uNumFalsePositives += bCulledVisible ? 1u : 0u;
+                continue;
+            }
+
+            ++outStats.uNumChunks;
+            const BOOL bVisible = TestBox(aPlanes, chunk.Min, chunk.Max) != eCullResult::OUTSIDE;
+            outStats.uNumChunksVisible += bVisible ? 1u : 0u;
+            outStats.uNumFalseNegatives += bVisible && !bCulledVisible ? 1u : 0u;
+            outStats.uNumFalsePositives += !bVisible && bCulledVisible ? 1u : 0u;
+        }
+    }
+
+    UINT ChunkCuller::GetChunkIndex(_In_ UINT uChunkX, _In_ UINT uChunkZ) const
+    {
+        return uChunkZ * m_uNumChunksX + uChunkX;
+    }
+
+    UINT ChunkCuller::GetNumChunksX() const
+    {
+        return m_uNumChunksX;
+    }
+
+    UINT ChunkCuller::GetNumChunksZ() const
+    {
+        return m_uNumChunksZ;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkCuller::updateRegionBounds
+
+      Summary:  Recomputes the box of a region as the union of the
+                boxes of its chunks
+
+      Args:     UINT uRegionIdx
+                  Index of the region, row major
+
+      Modifies: [m_aRegionBounds, m_aDirtyRegions].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkCuller::updateRegionBounds(_In_ UINT uRegionIdx)
+    {
+        const UINT uBeginX = (uRegionIdx % m_uNumRegionsX) * m_uRegionSize;
+        const UINT uBeginZ = (uRegionIdx / m_uNumRegionsX) * m_uRegionSize;
+        const UINT uEndX = uBeginX + m_uRegionSize < m_uNumChunksX ? uBeginX + m_uRegionSize : m_uNumChunksX;
+        const UINT uEndZ = uBeginZ + m_uRegionSize < m_uNumChunksZ ? uBeginZ + m_uRegionSize : m_uNumChunksZ;
+
+        Bounds region = { .bValid = FALSE };
+        for (UINT uChunkZ = uBeginZ; uChunkZ < uEndZ; ++uChunkZ)
+        {
+            for (UINT uChunkX = uBeginX; uChunkX < uEndX; ++uChunkX)
+            {
+                const Bounds& chunk = m_aChunkBounds[GetChunkIndex(uChunkX, uChunkZ)];
+                if (!chunk.bValid)
+                {
+                    continue;
+                }
+
+                if (!region.bValid)
+                {
+                    region = chunk;
+                    continue;
+                }
+
+                region.Min.x = chunk.Min.x < region.Min.x ? chunk.Min.x : region.Min.x;
+                region.Min.y = chunk.Min.y < region.Min.y ? chunk.Min.y : region.Min.y;
+                region.Min.z = chunk.Min.z < region.Min.z ? chunk.Min.z : region.Min.z;
+                region.Max.x = chunk.Max.x > region.Max.x ? chunk.Max.x : region.Max.x;
+                region.Max.y = chunk.Max.y > region.Max.y ? chunk.Max.y : region.Max.y;
+                region.Max.z = chunk.Max.z > region.Max.z ? chunk.Max.z : region.Max.z;
+            }
+        }
+
+        m_aRegionBounds[uRegionIdx] = region;
+        m_aDirtyRegions[uRegionIdx] = FALSE;
+    }
+}
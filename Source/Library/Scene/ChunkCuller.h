@@ -0,0 +1,218 @@
+/*+===================================================================
+  File:      CHUNKCULLER.H
+
+  Summary:   ChunkCuller header file contains declarations of
+             ChunkCuller class used for the lab samples of Game
+             Graphics Programming course.
+
+  Classes: ChunkCuller
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+namespace library
+{
+    /*E+E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E
+      Enum:     eCullResult
+
+      Summary:  Position of a bounding box relative to the frustum
+    E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E-E*/
+    enum class eCullResult : BYTE
+    {
+        OUTSIDE = 0,
+        INTERSECTING,
+        INSIDE,
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ChunkInstanceRange
+
+      Summary:  Instances of a voxel that belong to one chunk. The
+                instances of every chunk are stored contiguously
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ChunkInstanceRange
+    {
+        UINT uChunkIndex;
+        UINT uBeginInstance;
+        UINT uNumInstances;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   InstanceRange
+
+      Summary:  Contiguous instances drawn by one instanced draw call
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct InstanceRange
+    {
+        UINT uBeginInstance;
+        UINT uNumInstances;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ChunkCullingStats
+
+      Summary:  Statistics of the frustum culling
+
+                uNumRegionsTested
+                  Regions tested against the frustum
+                uNumRegionsCulled
+                  Regions entirely outside of the frustum
+                uNumRegionsInside
+                  Regions entirely inside of the frustum, whose chunks
+                  were accepted without being tested
+                uNumChunksTested
+                  Chunks tested against the frustum
+                uNumChunks
+                  Chunks with bounds
+                uNumChunksVisible
+                  Chunks at least partially inside of the frustum
+                uNumInstances
+                  Instances before culling
+                uNumInstancesVisible
+                  Instances of the visible chunks
+                uNumRanges
+                  Draw calls after merging adjacent visible ranges
+                uTicks
+                  Time spent culling in performance counter ticks
+                uTicksPerSecond
+                  Frequency of the performance counter
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ChunkCullingStats
+    {
+        UINT64 uNumRegionsTested;
+        UINT64 uNumRegionsCulled;
+        UINT64 uNumRegionsInside;
+        UINT64 uNumChunksTested;
+        UINT64 uNumChunks;
+        UINT64 uNumChunksVisible;
+        UINT64 uNumInstances;
+        UINT64 uNumInstancesVisible;
+        UINT64 uNumRanges;
+        UINT64 uTicks;
+        UINT64 uTicksPerSecond;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ChunkCullingValidationStats
+
+      Summary:  Result of checking a cull against testing every chunk
+                on its own
+
+                uNumChunks
+                  Chunks with bounds
+                uNumChunksVisible
+                  Chunks the brute-force test keeps
+                uNumFalseNegatives
+                  Chunks the brute-force test keeps but the cull drops
+                uNumFalsePositives
+                  Chunks the cull keeps but the brute-force test drops
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ChunkCullingValidationStats
+    {
+        UINT64 uNumChunks;
+        UINT64 uNumChunksVisible;
+        UINT64 uNumFalseNegatives;
+        UINT64 uNumFalsePositives;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    ChunkCuller
+
+      Summary:  Culls a grid of chunk bounding boxes against the view
+                frustum. Chunks are grouped into square regions: a
+                region outside of the frustum rejects all of its chunks
+                and a region inside of it accepts them, so only the
+                chunks of the regions crossing a frustum plane are
+                tested. Pure CPU
+
+      Methods:  ExtractFrustumPlanes
+                  Returns the planes of the frustum of a view
+                  projection transform
+                TestBox
+                  Classifies a box against frustum planes
+                Reset
+                  Resizes the grid and forgets every chunk
+                SetChunkBounds
+                  Sets the bounding box of a chunk
+                ClearChunkBounds
+                  Removes a chunk from the culling
+                Cull
+                  Computes the visibility of every chunk
+                IsChunkVisible
+                  Returns whether a chunk was visible in the last cull
+                AppendVisibleRanges
+                  Merges the instance ranges of the visible chunks
+                Benchmark
+                  Culls repeatedly and reports the average cost
+                Validate
+                  Compares a cull with testing every chunk on its own
+                GetChunkIndex
+                  Returns the index of a chunk
+                GetNumChunksX
+                  Returns the number of chunks along the x axis
+                GetNumChunksZ
+                  Returns the number of chunks along the z axis
+                ChunkCuller
+                  Constructor.
+                ~ChunkCuller
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class ChunkCuller
+    {
+    public:
+        static constexpr const UINT DEFAULT_CHUNK_SIZE = 32u;
+        static constexpr const UINT DEFAULT_REGION_SIZE = 8u;
+        static constexpr const UINT NUM_FRUSTUM_PLANES = 6u;
+
+        static void ExtractFrustumPlanes(_In_ const XMMATRIX& viewProjection, _Out_writes_(NUM_FRUSTUM_PLANES) XMFLOAT4 aOutPlanes[NUM_FRUSTUM_PLANES]);
+        static eCullResult TestBox(_In_reads_(NUM_FRUSTUM_PLANES) const XMFLOAT4 aPlanes[NUM_FRUSTUM_PLANES], _In_ const XMFLOAT3& boxMin, _In_ const XMFLOAT3& boxMax);
+
+        ChunkCuller(_In_ UINT uNumChunksX, _In_ UINT uNumChunksZ, _In_ UINT uRegionSize = DEFAULT_REGION_SIZE);
+        ChunkCuller(const ChunkCuller& other) = delete;
+        ChunkCuller(ChunkCuller&& other) = delete;
+        ChunkCuller& operator=(const ChunkCuller& other) = delete;
+        ChunkCuller& operator=(ChunkCuller&& other) = delete;
+        ~ChunkCuller() = default;
+
+        void Reset(_In_ UINT uNumChunksX, _In_ UINT uNumChunksZ);
+        void SetChunkBounds(_In_ UINT uChunkX, _In_ UINT uChunkZ, _In_ const XMFLOAT3& boxMin, _In_ const XMFLOAT3& boxMax);
+        void ClearChunkBounds(_In_ UINT uChunkX, _In_ UINT uChunkZ);
+        void Cull(_In_ const XMMATRIX& viewProjection, _Inout_opt_ ChunkCullingStats* pStats = nullptr);
+        BOOL IsChunkVisible(_In_ UINT uChunkIndex) const;
+        UINT AppendVisibleRanges(
+            _In_ const std::vector<ChunkInstanceRange>& aChunkRanges,
+            _Inout_ std::vector<InstanceRange>& aOutRanges,
+            _Inout_opt_ ChunkCullingStats* pStats = nullptr
+        ) const;
+        void Benchmark(_In_ const XMMATRIX& viewProjection, _In_ UINT uNumIterations, _Out_ ChunkCullingStats& outStats);
+        void Validate(_In_ const XMMATRIX& viewProjection, _Out_ ChunkCullingValidationStats& outStats);
+
+        UINT GetChunkIndex(_In_ UINT uChunkX, _In_ UINT uChunkZ) const;
+        UINT GetNumChunksX() const;
+        UINT GetNumChunksZ() const;
+
+    private:
+        struct Bounds
+        {
+            XMFLOAT3 Min;
+            XMFLOAT3 Max;
+            BOOL bValid;
+        };
+
+        void updateRegionBounds(_In_ UINT uRegionIdx);
+
+    private:
+        UINT m_uNumChunksX;
+        UINT m_uNumChunksZ;
+        UINT m_uRegionSize;
+        UINT m_uNumRegionsX;
+        UINT m_uNumRegionsZ;
+        std::vector<Bounds> m_aChunkBounds;
+        std::vector<Bounds> m_aRegionBounds;
+        std::vector<BYTE> m_aDirtyRegions;
+        std::vector<BYTE> m_aVisibleChunks;
+    };
+}
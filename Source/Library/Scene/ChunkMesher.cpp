@@ -0,0 +1,743 @@
+#include "Scene/ChunkMesher.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkMesher::BuildVolume
+
+      Summary:  Fills the cell volume of the columns in
+                [uBeginX, uEndX) x [uBeginZ, uEndZ). At level of detail
+                n every 2^n x 2^n group of columns becomes one column
+                of cells. The volume is as tall as the highest column
+                of cells of the chunk, and its border holds the
+                neighboring columns of the height map. When the borders
+                are closed the faces toward the border are kept, the
+                border cells only darkening the ambient occlusion. The
+                light of a cell is read from the first column of its
+                group, no lower than the top of that column so coarse
+                cells sunk below the ground are not left dark
+
+      Args:     const HeightMap& heightMap
+                  Height map to read the columns from
+                UINT uBeginX
+                  First column along the x axis
+                UINT uBeginZ
+                  First column along the z axis
+                UINT uEndX
+                  One past the last column along the x axis
+                UINT uEndZ
+                  One past the last column along the z axis
+                UINT uLodLevel
+                  Level of detail, clamped to MAX_LOD_LEVEL
+                BOOL bClosedBorders
+                  Whether the faces on the chunk boundary are kept so
+                  the chunk is watertight whatever the level of detail
+                  of its neighbors
+                const VoxelLightMap* pLightMap
+                  Light of the blocks. Can be null to leave the chunk
+                  unlit
+                BlockVolume& outVolume
+                  Cell volume of the chunk
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkMesher::BuildVolume(
+        _In_ const HeightMap& heightMap,
+        _In_ UINT uBeginX,
+        _In_ UINT uBeginZ,
+        _In_ UINT uEndX,
+        _In_ UINT uEndZ,
+        _In_ UINT uLodLevel,
+        _In_ BOOL bClosedBorders,
+        _In_opt_ const VoxelLightMap* pLightMap,
+        _Out_ BlockVolume& outVolume
+    )
+    {
+        uEndX = uEndX < heightMap.GetWidth() ? uEndX : heightMap.GetWidth();
+        uEndZ = uEndZ < heightMap.GetDepth() ? uEndZ : heightMap.GetDepth();
+        uBeginX = uBeginX < uEndX ? uBeginX : uEndX;
+        uBeginZ = uBeginZ < uEndZ ? uBeginZ : uEndZ;
+        uLodLevel = uLodLevel < MAX_LOD_LEVEL ? uLodLevel : MAX_LOD_LEVEL;
+
+        const UINT uCellSize = 1u << uLodLevel;
+        const UINT uSizeX = (uEndX - uBeginX + uCellSize - 1u) / uCellSize;
+        const UINT uSizeZ = (uEndZ - uBeginZ + uCellSize - 1u) / uCellSize;
+        const size_t uStrideX = static_cast<size_t>(uSizeX) + 2u;
+        const size_t uStrideZ = static_cast<size_t>(uSizeZ) + 2u;
+
+        // Columns of cells including the border
+        std::vector<UINT> aNumCells(uStrideX * uStrideZ, 0u);
+        std::vector<BYTE> aTypes(uStrideX * uStrideZ, HeightMap::INVALID_TYPE);
+        UINT uMaxHeight = 0u;
+        for (INT z = -1; z <= static_cast<INT>(uSizeZ); ++z)
+        {
+            for (INT x = -1; x <= static_cast<INT>(uSizeX); ++x)
+            {
+                const BOOL bBorder = x < 0 || z < 0 || x == static_cast<INT>(uSizeX) || z == static_cast<INT>(uSizeZ);
+                const size_t uIndex = static_cast<size_t>(z + 1) * uStrideX + static_cast<size_t>(x + 1);
+                getCell(
+                    heightMap,
+                    static_cast<INT>(uBeginX) + x * static_cast<INT>(uCellSize),
+                    static_cast<INT>(uBeginZ) + z * static_cast<INT>(uCellSize),
+                    uLodLevel,
+                    aNumCells[uIndex],
+                    aTypes[uIndex]
+                );
+
+                if (!bBorder)
+                {
+                    uMaxHeight = aNumCells[uIndex] > uMaxHeight ? aNumCells[uIndex] : uMaxHeight;
+                }
+            }
+        }
+
+        const XMFLOAT3 firstBlock = heightMap.GetBlockPosition(uBeginX, 0u, uBeginZ);
+
+        outVolume.uSizeX = uSizeX;
+        outVolume.uSizeY = uMaxHeight;
+        outVolume.uSizeZ = uSizeZ;
+        outVolume.Origin = XMFLOAT3(firstBlock.x - BLOCK_SIZE / 2.0f, firstBlock.y - BLOCK_SIZE / 2.0f, firstBlock.z - BLOCK_SIZE / 2.0f);
+        outVolume.BlockSize = BLOCK_SIZE * static_cast<FLOAT>(uCellSize);
+        outVolume.bClosedBorders = bClosedBorders;
+
+        const size_t uStrideY = static_cast<size_t>(outVolume.uSizeY) + 2u;
+        outVolume.aBlocks.assign(uStrideX * uStrideY * uStrideZ, HeightMap::INVALID_TYPE);
+
+        std::vector<ColumnRun> aRuns;
+        for (size_t z = 0u; z < uStrideZ; ++z)
+        {
+            for (size_t x = 0u; x < uStrideX; ++x)
+            {
+                const BYTE type = aTypes[z * uStrideX + x];
+                if (type == HeightMap::INVALID_TYPE)
+                {
+                    continue;
+                }
+
+                UINT uNumCells = aNumCells[z * uStrideX + x];
+                uNumCells = uNumCells < outVolume.uSizeY + 1u ? uNumCells : outVolume.uSizeY + 1u;
+
+                // Full detail cells are blocks and keep the type of
+                // every run, coarser cells take the type of the group
+                aRuns.assign(1u, ColumnRun{ .uEndBlock = static_cast<WORD>(uNumCells), .type = type });
+                if (uLodLevel == 0u)
+                {
+                    heightMap.GetColumnRuns(uBeginX + static_cast<UINT>(x) - 1u, uBeginZ + static_cast<UINT>(z) - 1u, aRuns);
+                }
+
+                UINT y = 0u;
+                for (const ColumnRun& run : aRuns)
+                {
+                    for (; y < run.uEndBlock && y < uNumCells; ++y)
+                    {
+                        outVolume.aBlocks[(z * uStrideY + static_cast<size_t>(y + 1u)) * uStrideX + x] = run.type;
+                    }
+                }
+            }
+        }
+
+        outVolume.aLight.clear();
+        if (!pLightMap)
+        {
+            return;
+        }
+
+        outVolume.aLight.resize(outVolume.aBlocks.size());
+        for (size_t z = 0u; z < uStrideZ; ++z)
+        {
+            for (size_t x = 0u; x < uStrideX; ++x)
+            {
+                const INT iColumnX = static_cast<INT>(uBeginX) + (static_cast<INT>(x) - 1) * static_cast<INT>(uCellSize);
+                const INT iColumnZ = static_cast<INT>(uBeginZ) + (static_cast<INT>(z) - 1) * static_cast<INT>(uCellSize);
+                INT iGround = 0;
+                if (iColumnX >= 0 && iColumnZ >= 0 && iColumnX < static_cast<INT>(heightMap.GetWidth()) && iColumnZ < static_cast<INT>(heightMap.GetDepth())
+                    && heightMap.GetColumnType(static_cast<UINT>(iColumnX), static_cast<UINT>(iColumnZ)) < heightMap.GetNumColors())
+                {
+                    iGround = static_cast<INT>(heightMap.GetColumnHeight(static_cast<UINT>(iColumnX), static_cast<UINT>(iColumnZ)));
+                }
+
+                for (size_t y = 0u; y < uStrideY; ++y)
+                {
+                    const INT iBlockY = (static_cast<INT>(y) - 1) * static_cast<INT>(uCellSize);
+                    outVolume.aLight[(z * uStrideY + y) * uStrideX + x] = pLightMap->GetLight(iColumnX, iBlockY < 0 || iBlockY > iGround ? iBlockY : iGround, iColumnZ);
+                }
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkMesher::MeshVolume
+
+      Summary:  Greedy meshes a block volume. Every axis is swept slice
+                by slice, once per face direction. A mask holds the
+                palette entry of each visible face of the slice, and
+                rectangles of equal entries are grown first along u
+                then along v and emitted as one quad. With ambient
+                occlusion the mask also holds the occlusion levels of
+                the face, so faces only merge when their corners are
+                shaded alike. Lit faces take the light of the cell in
+                front of them, also held in the mask
+
+      Args:     const BlockVolume& volume
+                  Block volume of the chunk
+                BOOL bAmbientOcclusion
+                  Whether to bake the ambient occlusion of the vertices
+                std::vector<ChunkMeshPart>& aOutParts
+                  Mesh of the chunk, split by palette entry
+                ChunkMeshStats* pStats
+                  Statistics to accumulate into. Can be null
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkMesher::MeshVolume(
+        _In_ const BlockVolume& volume,
+        _In_ BOOL bAmbientOcclusion,
+        _Out_ std::vector<ChunkMeshPart>& aOutParts,
+        _Inout_opt_ ChunkMeshStats* pStats
+    )
+    {
+        aOutParts.clear();
+
+        const UINT aSize[3] = { volume.uSizeX, volume.uSizeY, volume.uSizeZ };
+        std::vector<UINT> aPartOfColor;
+        std::vector<UINT> aMask;
+        UINT64 uNumVisibleFaces = 0u;
+        UINT64 uNumQuads = 0u;
+        UINT64 uNumOccludedVertices = 0u;
+
+        for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+        {
+            const UINT uAxisU = (uAxis + 1u) % 3u;
+            const UINT uAxisV = (uAxis + 2u) % 3u;
+            const UINT uSizeU = aSize[uAxisU];
+            const UINT uSizeV = aSize[uAxisV];
+            aMask.assign(static_cast<size_t>(uSizeU) * static_cast<size_t>(uSizeV), 0u);
+
+            for (UINT uDirection = 0u; uDirection < 2u; ++uDirection)
+            {
+                const BOOL bPositive = uDirection == 0u;
+
+                for (UINT uSlice = 0u; uSlice < aSize[uAxis]; ++uSlice)
+                {
+                    // Mask of the faces of this slice looking along the
+                    // direction, the light and occlusion levels above the
+                    // palette entry
+                    INT aPosition[3] = { 0, 0, 0 };
+                    aPosition[uAxis] = static_cast<INT>(uSlice);
+                    for (UINT v = 0u; v < uSizeV; ++v)
+                    {
+                        aPosition[uAxisV] = static_cast<INT>(v);
+                        for (UINT u = 0u; u < uSizeU; ++u)
+                        {
+                            aPosition[uAxisU] = static_cast<INT>(u);
+
+                            UINT uFace = 0u;
+                            const BYTE type = volume.GetBlock(aPosition[0], aPosition[1], aPosition[2]);
+                            if (type != HeightMap::INVALID_TYPE)
+                            {
+                                INT aNeighbor[3] = { aPosition[0], aPosition[1], aPosition[2] };
+                                aNeighbor[uAxis] += bPositive ? 1 : -1;
+                                if (isFaceVisible(volume, aNeighbor))
+                                {
+                                    const BYTE occlusion = bAmbientOcclusion ? getFaceOcclusion(volume, uAxis, bPositive, aPosition) : 0xFFu;
+                                    const BYTE light = volume.GetLight(aNeighbor[0], aNeighbor[1], aNeighbor[2]);
+                                    uFace = (static_cast<UINT>(light) << 16u) | (static_cast<UINT>(occlusion) << 8u) | (static_cast<UINT>(type) + 1u);
+                                    ++uNumVisibleFaces;
+                                }
+                            }
+                            aMask[static_cast<size_t>(v) * uSizeU + u] = uFace;
+                        }
+                    }
+
+                    // Merge equal faces into rectangles
+                    for (UINT v = 0u; v < uSizeV; ++v)
+                    {
+                        for (UINT u = 0u; u < uSizeU;)
+                        {
+                            const UINT uFace = aMask[static_cast<size_t>(v) * uSizeU + u];
+                            if (uFace == 0u)
+                            {
+                                ++u;
+                                continue;
+                            }
+
+                            UINT uWidth = 1u;
+                            while (u + uWidth < uSizeU && aMask[static_cast<size_t>(v) * uSizeU + u + uWidth] == uFace)
+                            {
+                                ++uWidth;
+                            }
+
+                            UINT uHeight = 1u;
+                            for (; v + uHeight < uSizeV; ++uHeight)
+                            {
+                                BOOL bRowMatches = TRUE;
+                                for (UINT k = 0u; k < uWidth; ++k)
+                                {
+                                    if (aMask[static_cast<size_t>(v + uHeight) * uSizeU + u + k] != uFace)
+                                    {
+                                        bRowMatches = FALSE;
+                                        break;
+                                    }
+                                }
+
+                                if (!bRowMatches)
+                                {
+                                    break;
+                                }
+                            }
+
+                            INT aCorner[3] = { 0, 0, 0 };
+                            aCorner[uAxis] = static_cast<INT>(uSlice) + (bPositive ? 1 : 0);
+                            aCorner[uAxisU] = static_cast<INT>(u);
+                            aCorner[uAxisV] = static_cast<INT>(v);
+                            const BYTE occlusion = static_cast<BYTE>(uFace >> 8u);
+                            const BYTE light = static_cast<BYTE>(uFace >> 16u);
+                            emitQuad(volume, uAxis, bPositive, aCorner, uWidth, uHeight, (uFace & 0xFFu) - 1u, occlusion, light, aOutParts, aPartOfColor);
+                            ++uNumQuads;
+                            for (UINT uCornerIdx = 0u; uCornerIdx < 4u; ++uCornerIdx)
+                            {
+                                uNumOccludedVertices += ((occlusion >> (uCornerIdx * 2u)) & 3u) < MAX_OCCLUSION_LEVEL ? 1u : 0u;
+                            }
+
+                            for (UINT h = 0u; h < uHeight; ++h)
+                            {
+                                for (UINT k = 0u; k < uWidth; ++k)
+                                {
+                                    aMask[static_cast<size_t>(v + h) * uSizeU + u + k] = 0u;
+                                }
+                            }
+
+                            u += uWidth;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (pStats)
+        {
+            UINT64 uNumBlocks = 0u;
+            for (UINT z = 0u; z < volume.uSizeZ; ++z)
+            {
+                for (UINT y = 0u; y < volume.uSizeY; ++y)
+                {
+                    for (UINT x = 0u; x < volume.uSizeX; ++x)
+                    {
+                        if (volume.GetBlock(static_cast<INT>(x), static_cast<INT>(y), static_cast<INT>(z)) != HeightMap::INVALID_TYPE)
+                        {
+                            ++uNumBlocks;
+                        }
+                    }
+                }
+            }
+
+            pStats->uNumBlocks += uNumBlocks;
+            pStats->uNumTrianglesIn += uNumBlocks * 12u;
+            pStats->uNumVisibleFaces += uNumVisibleFaces;
+            pStats->uNumTrianglesOut += uNumQuads * 2u;
+            pStats->uNumOccludedVertices += uNumOccludedVertices;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkMesher::MeshChunk
+
+      Summary:  Builds and greedy meshes the volume of the columns in
+                [uBeginX, uEndX) x [uBeginZ, uEndZ)
+
+      Args:     const HeightMap& heightMap
+                  Height map to read the columns from
+                UINT uBeginX
+                  First column along the x axis
+                UINT uBeginZ
+                  First column along the z axis
+                UINT uEndX
+                  One past the last column along the x axis
+                UINT uEndZ
+                  One past the last column along the z axis
+                UINT uLodLevel
+                  Level of detail
+                BOOL bClosedBorders
+                  Whether the faces on the chunk boundary are kept
+                BOOL bAmbientOcclusion
+                  Whether to bake the ambient occlusion of the vertices
+                const VoxelLightMap* pLightMap
+                  Light of the blocks. Can be null to leave the chunk
+                  unlit
+                std::vector<ChunkMeshPart>& aOutParts
+                  Mesh of the chunk, split by palette entry
+                ChunkMeshStats* pStats
+                  Statistics to accumulate into, including the time
+                  spent. Can be null
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkMesher::MeshChunk(
+        _In_ const HeightMap& heightMap,
+        _In_ UINT uBeginX,
+        _In_ UINT uBeginZ,
+        _In_ UINT uEndX,
+        _In_ UINT uEndZ,
+        _In_ UINT uLodLevel,
+        _In_ BOOL bClosedBorders,
+        _In_ BOOL bAmbientOcclusion,
+        _In_opt_ const VoxelLightMap* pLightMap,
+        _Out_ std::vector<ChunkMeshPart>& aOutParts,
+        _Inout_opt_ ChunkMeshStats* pStats
+    )
+    {
+        LARGE_INTEGER startingTime;
+        QueryPerformanceCounter(&startingTime);
+
+        BlockVolume volume;
+        BuildVolume(heightMap, uBeginX, uBeginZ, uEndX, uEndZ, uLodLevel, bClosedBorders, pLightMap, volume);
+        MeshVolume(volume, bAmbientOcclusion, aOutParts, pStats);
+
+        if (pStats)
+        {
+            LARGE_INTEGER endingTime;
+            LARGE_INTEGER frequency;
+            QueryPerformanceCounter(&endingTime);
+            QueryPerformanceFrequency(&frequency);
+
+            ++pStats->uNumChunks;
+            pStats->uMeshingTicks += static_cast<UINT64>(endingTime.QuadPart - startingTime.QuadPart);
+            pStats->uTicksPerSecond = static_cast<UINT64>(frequency.QuadPart);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkMesher::Benchmark
+
+      Summary:  Meshes every chunk of a height map on the calling thread
+                and reports the triangles of the instanced cubes
+                against the triangles of the greedy meshes, and the
+                time spent, from which the throughput per chunk is
+                uMeshingTicks / uNumChunks. Running it once per level
+                of detail shows the triangles saved by each level, and
+                once with and without ambient occlusion its cost in
+                time and in faces that no longer merge
+
+      Args:     const HeightMap& heightMap
+                  Height map to mesh
+                UINT uChunkSize
+                  Number of columns along each side of a chunk
+                UINT uLodLevel
+                  Level of detail of every chunk
+                BOOL bAmbientOcclusion
+                  Whether to bake the ambient occlusion of the vertices
+                ChunkMeshStats& outStats
+                  Statistics of the whole height map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkMesher::Benchmark(
+        _In_ const HeightMap& heightMap,
+        _In_ UINT uChunkSize,
+        _In_ UINT uLodLevel,
+        _In_ BOOL bAmbientOcclusion,
+        _Out_ ChunkMeshStats& outStats
+    )
+    {
+        outStats = ChunkMeshStats{};
+        if (uChunkSize == 0u)
+        {
+            return;
+        }
+
+        std::vector<ChunkMeshPart> aParts;
+        for (UINT uBeginZ = 0u; uBeginZ < heightMap.GetDepth(); uBeginZ += uChunkSize)
+        {
+            for (UINT uBeginX = 0u; uBeginX < heightMap.GetWidth(); uBeginX += uChunkSize)
+            {
+                MeshChunk(heightMap, uBeginX, uBeginZ, uBeginX + uChunkSize, uBeginZ + uChunkSize, uLodLevel, FALSE, bAmbientOcclusion, nullptr, aParts, &outStats);
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkMesher::getCell
+
+      Summary:  Merges the 2^n x 2^n group of columns starting at
+                (iBeginX, iBeginZ) into one column of cells. Its height
+                is the mean height of the group rounded to whole cells,
+                and its type is the most common type of the group, the
+                lowest palette entry winning ties. Columns outside of
+                the height map or without a valid type are skipped
+
+      Args:     const HeightMap& heightMap
+                  Height map to read the columns from
+                INT iBeginX
+                  First column of the group along the x axis
+                INT iBeginZ
+                  First column of the group along the z axis
+                UINT uLodLevel
+                  Level of detail
+                UINT& uOutNumCells
+                  Number of cells of the merged column, 0 when the
+                  group has no valid column
+                BYTE& outType
+                  Palette entry of the merged column, or
+                  HeightMap::INVALID_TYPE
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkMesher::getCell(
+        _In_ const HeightMap& heightMap,
+        _In_ INT iBeginX,
+        _In_ INT iBeginZ,
+        _In_ UINT uLodLevel,
+        _Out_ UINT& uOutNumCells,
+        _Out_ BYTE& outType
+    )
+    {
+        uOutNumCells = 0u;
+        outType = HeightMap::INVALID_TYPE;
+
+        const INT iCellSize = 1 << uLodLevel;
+        const INT iBeginClampedX = iBeginX > 0 ? iBeginX : 0;
+        const INT iBeginClampedZ = iBeginZ > 0 ? iBeginZ : 0;
+        const INT iEndX = iBeginX + iCellSize < static_cast<INT>(heightMap.GetWidth()) ? iBeginX + iCellSize : static_cast<INT>(heightMap.GetWidth());
+        const INT iEndZ = iBeginZ + iCellSize < static_cast<INT>(heightMap.GetDepth()) ? iBeginZ + iCellSize : static_cast<INT>(heightMap.GetDepth());
+
+        UINT uNumColumns = 0u;
+        UINT uSumHeights = 0u;
+        BYTE aTypes[(1u << MAX_LOD_LEVEL) * (1u << MAX_LOD_LEVEL)];
+        for (INT z = iBeginClampedZ; z < iEndZ; ++z)
+        {
+            for (INT x = iBeginClampedX; x < iEndX; ++x)
+            {
+                const BYTE type = heightMap.GetColumnType(static_cast<UINT>(x), static_cast<UINT>(z));
+                if (type >= heightMap.GetNumColors())
+                {
+                    continue;
+                }
+
+                aTypes[uNumColumns++] = type;
+                uSumHeights += heightMap.GetColumnHeight(static_cast<UINT>(x), static_cast<UINT>(z));
+            }
+        }
+
+        if (uNumColumns == 0u)
+        {
+            return;
+        }
+
+        if (uLodLevel == 0u)
+        {
+            uOutNumCells = uSumHeights;
+            outType = aTypes[0];
+            return;
+        }
+
+        // Mean height rounded to the nearest cell, never dropping a
+        // group with ground to nothing
+        const UINT uDivisor = uNumColumns * static_cast<UINT>(iCellSize);
+        uOutNumCells = (uSumHeights + uDivisor / 2u) / uDivisor;
+        uOutNumCells = uOutNumCells > 0u ? uOutNumCells : 1u;
+
+        UINT uBestCount = 0u;
+        for (UINT i = 0u; i < uNumColumns; ++i)
+        {
+            UINT uCount = 0u;
+            for (UINT j = 0u; j < uNumColumns; ++j)
+            {
+                uCount += aTypes[j] == aTypes[i] ? 1u : 0u;
+            }
+
+            if (uCount > uBestCount || (uCount == uBestCount && aTypes[i] < outType))
+            {
+                uBestCount = uCount;
+                outType = aTypes[i];
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkMesher::isFaceVisible
+
+      Summary:  Returns whether a face looking into a cell is visible
+
+      Args:     const BlockVolume& volume
+                  Block volume of the chunk
+                const INT aNeighbor[3]
+                  Cell in front of the face
+
+      Returns:  BOOL
+                  TRUE if the cell is empty, or is on a closed border
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL ChunkMesher::isFaceVisible(_In_ const BlockVolume& volume, _In_ const INT aNeighbor[3])
+    {
+        if (volume.bClosedBorders
+            && (aNeighbor[0] < 0 || aNeighbor[2] < 0 || aNeighbor[0] == static_cast<INT>(volume.uSizeX) || aNeighbor[2] == static_cast<INT>(volume.uSizeZ)))
+        {
+            return TRUE;
+        }
+
+        return volume.GetBlock(aNeighbor[0], aNeighbor[1], aNeighbor[2]) == HeightMap::INVALID_TYPE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkMesher::getFaceOcclusion
+
+      Summary:  Computes the ambient occlusion levels of the four
+                corners of a block face from the layer of cells in
+                front of it. A corner touching two side cells is fully
+                occluded, otherwise every solid cell among the two
+                sides and the diagonal darkens it by one level
+
+      Args:     const BlockVolume& volume
+                  Block volume of the chunk
+                UINT uAxis
+                  Axis the face is perpendicular to
+                BOOL bPositive
+                  Whether the face looks toward the positive axis
+                const INT aPosition[3]
+                  Block owning the face
+
+      Returns:  BYTE
+                  Levels of the corners in the order of emitQuad, two
+                  bits each from the lowest
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BYTE ChunkMesher::getFaceOcclusion(_In_ const BlockVolume& volume, _In_ UINT uAxis, _In_ BOOL bPositive, _In_ const INT aPosition[3])
+    {
+        static constexpr const INT CORNER_U[4] = { -1, 1, 1, -1 };
+        static constexpr const INT CORNER_V[4] = { -1, -1, 1, 1 };
+
+        const UINT uAxisU = (uAxis + 1u) % 3u;
+        const UINT uAxisV = (uAxis + 2u) % 3u;
+
+        INT aFront[3] = { aPosition[0], aPosition[1], aPosition[2] };
+        aFront[uAxis] += bPositive ? 1 : -1;
+
+        BYTE occlusion = 0u;
+        for (UINT uCornerIdx = 0u; uCornerIdx < 4u; ++uCornerIdx)
+        {
+            INT aSideU[3] = { aFront[0], aFront[1], aFront[2] };
+            aSideU[uAxisU] += CORNER_U[uCornerIdx];
+            INT aSideV[3] = { aFront[0], aFront[1], aFront[2] };
+            aSideV[uAxisV] += CORNER_V[uCornerIdx];
+            INT aDiagonal[3] = { aSideU[0], aSideU[1], aSideU[2] };
+            aDiagonal[uAxisV] += CORNER_V[uCornerIdx];
+
+            const UINT uSideU = volume.GetBlock(aSideU[0], aSideU[1], aSideU[2]) != HeightMap::INVALID_TYPE ? 1u : 0u;
+            const UINT uSideV = volume.GetBlock(aSideV[0], aSideV[1], aSideV[2]) != HeightMap::INVALID_TYPE ? 1u : 0u;
+            const UINT uDiagonal = volume.GetBlock(aDiagonal[0], aDiagonal[1], aDiagonal[2]) != HeightMap::INVALID_TYPE ? 1u : 0u;
+
+            const UINT uLevel = uSideU && uSideV ? 0u : MAX_OCCLUSION_LEVEL - uSideU - uSideV - uDiagonal;
+            occlusion |= static_cast<BYTE>(uLevel << (uCornerIdx * 2u));
+        }
+
+        return occlusion;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkMesher::emitQuad
+
+      Summary:  Appends a merged face to the part of its palette entry,
+                starting a new part when the 16 bit indices would
+                overflow. Texture coordinates are in blocks, so a
+                wrapping sampler repeats the texture once per block
+                whatever the level of detail. The quad is split along
+                the diagonal whose corners are the least occluded so
+                the occlusion interpolates without creases
+
+      Args:     const BlockVolume& volume
+                  Block volume of the chunk
+                UINT uAxis
+                  Axis the face is perpendicular to
+                BOOL bPositive
+                  Whether the face looks toward the positive axis
+                const INT aCorner[3]
+                  Block coordinates of the first corner of the face
+                UINT uWidth
+                  Size of the face along the next axis
+                UINT uHeight
+                  Size of the face along the axis after
+                UINT uColorIndex
+                  Palette entry of the face
+                BYTE occlusion
+                  Ambient occlusion levels of the corners, two bits
+                  each
+                BYTE light
+                  Packed light of the face
+                std::vector<ChunkMeshPart>& aParts
+                  Parts of the chunk
+                std::vector<UINT>& aPartOfColor
+                  Index of the part being filled per palette entry
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkMesher::emitQuad(
+        _In_ const BlockVolume& volume,
+        _In_ UINT uAxis,
+        _In_ BOOL bPositive,
+        _In_ const INT aCorner[3],
+        _In_ UINT uWidth,
+        _In_ UINT uHeight,
+        _In_ UINT uColorIndex,
+        _In_ BYTE occlusion,
+        _In_ BYTE light,
+        _Inout_ std::vector<ChunkMeshPart>& aParts,
+        _Inout_ std::vector<UINT>& aPartOfColor
+    )
+    {
+        if (aPartOfColor.size() <= uColorIndex)
+        {
+            aPartOfColor.resize(static_cast<size_t>(uColorIndex) + 1u, UINT_MAX);
+        }
+
+        if (aPartOfColor[uColorIndex] == UINT_MAX || aParts[aPartOfColor[uColorIndex]].aVertices.size() + 4u > 0x10000u)
+        {
+            aPartOfColor[uColorIndex] = static_cast<UINT>(aParts.size());
+            aParts.push_back(ChunkMeshPart{ .uColorIndex = uColorIndex });
+        }
+
+        ChunkMeshPart& part = aParts[aPartOfColor[uColorIndex]];
+
+        const UINT uAxisU = (uAxis + 1u) % 3u;
+        const UINT uAxisV = (uAxis + 2u) % 3u;
+
+        FLOAT aNormal[3] = { 0.0f, 0.0f, 0.0f };
+        aNormal[uAxis] = bPositive ? 1.0f : -1.0f;
+
+        const FLOAT texScale = volume.BlockSize / BLOCK_SIZE;
+        const WORD uBaseVertex = static_cast<WORD>(part.aVertices.size());
+        for (UINT uCornerIdx = 0u; uCornerIdx < 4u; ++uCornerIdx)
+        {
+            INT aPosition[3] = { aCorner[0], aCorner[1], aCorner[2] };
+            aPosition[uAxisU] += (uCornerIdx == 1u || uCornerIdx == 2u) ? static_cast<INT>(uWidth) : 0;
+            aPosition[uAxisV] += (uCornerIdx == 2u || uCornerIdx == 3u) ? static_cast<INT>(uHeight) : 0;
+
+            XMFLOAT2 texCoord;
+            if (uAxis == 1u)
+            {
+                texCoord = XMFLOAT2(texScale * static_cast<FLOAT>(aPosition[0]), texScale * static_cast<FLOAT>(aPosition[2]));
+            }
+            else
+            {
+                texCoord = XMFLOAT2(texScale * static_cast<FLOAT>(aPosition[uAxis == 0u ? 2 : 0]), -texScale * static_cast<FLOAT>(aPosition[1]));
+            }
+
+            part.aVertices.push_back(
+                SimpleVertex
+                {
+                    .Position = XMFLOAT3(
+                        volume.Origin.x + volume.BlockSize * static_cast<FLOAT>(aPosition[0]),
+                        volume.Origin.y + volume.BlockSize * static_cast<FLOAT>(aPosition[1]),
+                        volume.Origin.z + volume.BlockSize * static_cast<FLOAT>(aPosition[2])
+                    ),
+                    .TexCoord = texCoord,
+                    .Normal = XMFLOAT3(aNormal[0], aNormal[1], aNormal[2])
+                }
+            );
+            part.aOcclusion.push_back(static_cast<BYTE>((occlusion >> (uCornerIdx * 2u)) & 3u));
+            part.aLight.push_back(light);
+        }
+
+        // Corners go along u then v, so they are clockwise seen from
+        // the positive axis
+        static constexpr const WORD POSITIVE_INDICES[] = { 0, 1, 2, 0, 2, 3 };
+        static constexpr const WORD NEGATIVE_INDICES[] = { 0, 2, 1, 0, 3, 2 };
+        static constexpr const WORD FLIPPED_POSITIVE_INDICES[] = { 1, 2, 3, 1, 3, 0 };
+        static constexpr const WORD FLIPPED_NEGATIVE_INDICES[] = { 1, 3, 2, 1, 0, 3 };
+
+        const BYTE* pOcclusion = &part.aOcclusion[uBaseVertex];
+        const BOOL bFlipped = pOcclusion[0] + pOcclusion[2] < pOcclusion[1] + pOcclusion[3];
+        const WORD* pIndices = bPositive
+            ? (bFlipped ? FLIPPED_POSITIVE_INDICES : POSITIVE_INDICES)
+            : (bFlipped ? FLIPPED_NEGATIVE_INDICES : NEGATIVE_INDICES);
+        for (UINT i = 0u; i < 6u; ++i)
+        {
+            part.aIndices.push_back(static_cast<WORD>(uBaseVertex + pIndices[i]));
+        }
+    }
+}
@@ -0,0 +1,221 @@
+/*+===================================================================
+  File:      CHUNKMESHER.H
+
+  Summary:   ChunkMesher header file contains declarations of
+             ChunkMesher class used for the lab samples of Game
+             Graphics Programming course.
+
+  Classes: ChunkMesher
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Renderer/DataTypes.h"
+#include "Scene/HeightMap.h"
+#include "Scene/VoxelLightMap.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   BlockVolume
+
+      Summary:  Dense grid of palette indices of a chunk, surrounded by
+                a one cell border holding the neighboring cells so
+                faces on the chunk boundary can be culled. Empty cells
+                are HeightMap::INVALID_TYPE. At level of detail n a
+                cell merges 2^n x 2^n x 2^n blocks and is BlockSize
+                world units wide. With closed borders the border still
+                holds the neighboring cells for the ambient occlusion,
+                but faces toward it are kept. aLight holds the packed
+                VoxelLightMap light of every cell, or is empty when the
+                chunk is unlit
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct BlockVolume
+    {
+        UINT uSizeX;
+        UINT uSizeY;
+        UINT uSizeZ;
+        XMFLOAT3 Origin;
+        FLOAT BlockSize;
+        BOOL bClosedBorders;
+        std::vector<BYTE> aBlocks;
+        std::vector<BYTE> aLight;
+
+        BYTE GetBlock(_In_ INT x, _In_ INT y, _In_ INT z) const
+        {
+            const size_t uStrideX = static_cast<size_t>(uSizeX) + 2u;
+            const size_t uStrideY = static_cast<size_t>(uSizeY) + 2u;
+            return aBlocks[(static_cast<size_t>(z + 1) * uStrideY + static_cast<size_t>(y + 1)) * uStrideX + static_cast<size_t>(x + 1)];
+        }
+
+        BYTE GetLight(_In_ INT x, _In_ INT y, _In_ INT z) const
+        {
+            if (aLight.empty())
+            {
+                return VoxelLightMap::FULL_SKY_LIGHT;
+            }
+
+            const size_t uStrideX = static_cast<size_t>(uSizeX) + 2u;
+            const size_t uStrideY = static_cast<size_t>(uSizeY) + 2u;
+            return aLight[(static_cast<size_t>(z + 1) * uStrideY + static_cast<size_t>(y + 1)) * uStrideX + static_cast<size_t>(x + 1)];
+        }
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ChunkMeshPart
+
+      Summary:  Faces of one palette entry of a chunk. A chunk may have
+                several parts per entry since the indices are 16 bits.
+                aOcclusion holds the ambient occlusion level of every
+                vertex, from 0 in a corner between three blocks to
+                ChunkMesher::MAX_OCCLUSION_LEVEL when nothing touches it,
+                and aLight the packed light of the cell in front of its
+                face
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ChunkMeshPart
+    {
+        UINT uColorIndex;
+        std::vector<SimpleVertex> aVertices;
+        std::vector<WORD> aIndices;
+        std::vector<BYTE> aOcclusion;
+        std::vector<BYTE> aLight;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ChunkMeshStats
+
+      Summary:  Statistics of the chunk mesher
+
+                uNumChunks
+                  Number of chunks meshed
+                uNumBlocks
+                  Number of solid blocks
+                uNumTrianglesIn
+                  Triangles drawn by instancing a cube per block
+                uNumVisibleFaces
+                  Block faces left after hidden-face removal
+                uNumTrianglesOut
+                  Triangles after merging the visible faces
+                uNumOccludedVertices
+                  Vertices darkened by the ambient occlusion
+                uMeshingTicks
+                  Time spent meshing in performance counter ticks
+                uTicksPerSecond
+                  Frequency of the performance counter
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ChunkMeshStats
+    {
+        UINT64 uNumChunks;
+        UINT64 uNumBlocks;
+        UINT64 uNumTrianglesIn;
+        UINT64 uNumVisibleFaces;
+        UINT64 uNumTrianglesOut;
+        UINT64 uNumOccludedVertices;
+        UINT64 uMeshingTicks;
+        UINT64 uTicksPerSecond;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    ChunkMesher
+
+      Summary:  Turns chunks of blocks into static meshes. Only faces
+                between a solid and an empty block are kept, and
+                coplanar faces of the same palette entry are merged
+                into rectangles (greedy meshing). Distant chunks can be
+                meshed at a coarser level of detail where each cell
+                merges 2x2x2, 4x4x4 or 8x8x8 blocks. Every vertex can
+                be given a baked ambient occlusion level from the three
+                cells touching it in front of its face, and only faces
+                with the same levels are merged. Faces can also be lit
+                by a VoxelLightMap, taking the light of the cell in
+                front of them, and only faces with the same light are
+                merged. Pure CPU, safe to call from several threads at
+                once
+
+      Methods:  BuildVolume
+                  Fills the block volume of a chunk of a height map
+                MeshVolume
+                  Greedy meshes a block volume
+                MeshChunk
+                  Builds and meshes the volume of a chunk
+                Benchmark
+                  Meshes every chunk of a height map and reports the
+                  statistics
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class ChunkMesher
+    {
+    public:
+        static constexpr const FLOAT BLOCK_SIZE = 2.0f;
+        static constexpr const UINT MAX_LOD_LEVEL = 3u;
+        static constexpr const BYTE MAX_OCCLUSION_LEVEL = 3u;
+
+        static void BuildVolume(
+            _In_ const HeightMap& heightMap,
+            _In_ UINT uBeginX,
+            _In_ UINT uBeginZ,
+            _In_ UINT uEndX,
+            _In_ UINT uEndZ,
+            _In_ UINT uLodLevel,
+            _In_ BOOL bClosedBorders,
+            _In_opt_ const VoxelLightMap* pLightMap,
+            _Out_ BlockVolume& outVolume
+        );
+        static void MeshVolume(
+            _In_ const BlockVolume& volume,
+            _In_ BOOL bAmbientOcclusion,
+            _Out_ std::vector<ChunkMeshPart>& aOutParts,
+            _Inout_opt_ ChunkMeshStats* pStats = nullptr
+        );
+        static void MeshChunk(
+            _In_ const HeightMap& heightMap,
+            _In_ UINT uBeginX,
+            _In_ UINT uBeginZ,
+            _In_ UINT uEndX,
+            _In_ UINT uEndZ,
+            _In_ UINT uLodLevel,
+            _In_ BOOL bClosedBorders,
+            _In_ BOOL bAmbientOcclusion,
+            _In_opt_ const VoxelLightMap* pLightMap,
+            _Out_ std::vector<ChunkMeshPart>& aOutParts,
+            _Inout_opt_ ChunkMeshStats* pStats = nullptr
+        );
+        static void Benchmark(
+            _In_ const HeightMap& heightMap,
+            _In_ UINT uChunkSize,
+            _In_ UINT uLodLevel,
+            _In_ BOOL bAmbientOcclusion,
+            _Out_ ChunkMeshStats& outStats
+        );
+
+    public:
+        ChunkMesher() = delete;
+
+    private:
+        static void getCell(
+            _In_ const HeightMap& heightMap,
+            _In_ INT iBeginX,
+            _In_ INT iBeginZ,
+            _In_ UINT uLodLevel,
+            _Out_ UINT& uOutNumCells,
+            _Out_ BYTE& outType
+        );
+        static BOOL isFaceVisible(_In_ const BlockVolume& volume, _In_ const INT aNeighbor[3]);
+        static BYTE getFaceOcclusion(_In_ const BlockVolume& volume, _In_ UINT uAxis, _In_ BOOL bPositive, _In_ const INT aPosition[3]);
+        static void emitQuad(
+            _In_ const BlockVolume& volume,
+            _In_ UINT uAxis,
+            _In_ BOOL bPositive,
+            _In_ const INT aCorner[3],
+            _In_ UINT uWidth,
+            _In_ UINT uHeight,
+            _In_ UINT uColorIndex,
+            _In_ BYTE occlusion,
+            _In_ BYTE light,
+            _Inout_ std::vector<ChunkMeshPart>& aParts,
+            _Inout_ std::vector<UINT>& aPartOfColor
+        );
+    };
+}
@@ -0,0 +1,1308 @@
+#include "Scene/ChunkStreamer.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::ChunkStreamer
+
+      Summary:  Constructor
+
+      Args:     const HeightMap& heightMap
+                  Height map to stream. Must outlive the streamer
+                const ChunkStreamingDesc& desc
+                  Streaming parameters
+                const VoxelLightMap* pLightMap
+                  Light of the blocks when desc.bVoxelLighting is set.
+                  Must outlive the streamer. Can be null
+
+      Modifies: [m_heightMap, m_pLightMap, m_desc, m_uNumChunksX, m_uNumChunksZ,
+                 m_uMaxPendingChunks, m_uResidentBytes, m_uPendingBytes,
+                 m_residentChunks, m_pendingChunks, m_dirtyChunks,
+                 m_mapsMutex, m_completedChunks, m_threadPool].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ChunkStreamer::ChunkStreamer(_In_ const HeightMap& heightMap, _In_ const ChunkStreamingDesc& desc, _In_opt_ const VoxelLightMap* pLightMap)
+        : m_heightMap(heightMap)
+        , m_pLightMap(nullptr)
+        , m_desc(desc)
+        , m_uNumChunksX(0u)
+        , m_uNumChunksZ(0u)
+        , m_uMaxPendingChunks(0u)
+        , m_uResidentBytes(0u)
+        , m_uPendingBytes(0u)
+        , m_residentChunks()
+        , m_pendingChunks()
+        , m_dirtyChunks()
+        , m_mapsMutex()
+        , m_completedMutex()
+        , m_completedChunks()
+        , m_threadPool(std::make_unique<ThreadPool>(desc.uNumThreads))
+    {
+        if (m_desc.uChunkSize == 0u)
+        {
+            m_desc.uChunkSize = 1u;
+        }
+
+        if (!m_desc.bGreedyMeshing || m_desc.uNumLodLevels == 0u)
+        {
+            m_desc.uNumLodLevels = 1u;
+        }
+        m_desc.uNumLodLevels = m_desc.uNumLodLevels < ChunkMesher::MAX_LOD_LEVEL + 1u ? m_desc.uNumLodLevels : ChunkMesher::MAX_LOD_LEVEL + 1u;
+        m_desc.bAmbientOcclusion = m_desc.bAmbientOcclusion && m_desc.bGreedyMeshing;
+        m_desc.bVoxelLighting = m_desc.bVoxelLighting && m_desc.bGreedyMeshing && pLightMap != nullptr;
+        m_pLightMap = m_desc.bVoxelLighting ? pLightMap : nullptr;
+
+        m_uNumChunksX = (m_heightMap.GetWidth() + m_desc.uChunkSize - 1u) / m_desc.uChunkSize;
+        m_uNumChunksZ = (m_heightMap.GetDepth() + m_desc.uChunkSize - 1u) / m_desc.uChunkSize;
+        m_uMaxPendingChunks = m_threadPool->GetNumThreads() * 2u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::~ChunkStreamer
+
+      Summary:  Destructor. Cancels the pending chunks so the thread
+                pool only has to skip them before joining
+
+      Modifies: [m_pendingChunks, m_threadPool].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ChunkStreamer::~ChunkStreamer()
+    {
+        for (auto it = m_pendingChunks.begin(); it != m_pendingChunks.end(); ++it)
+        {
+            it->second->bCancelled = TRUE;
+        }
+        m_threadPool.reset();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::Update
+
+      Summary:  Turns the chunks built since the last call into voxels
+                or meshes, refreshes the edited chunks, evicts the
+                chunks that are too far or over the memory budget and
+                requests the nearest missing chunks. Must be called
+                from the thread owning the immediate context. A step
+                that fails does not stop the others, so the voxels and
+                meshes created by the call are always handed back
+
+      Args:     const XMVECTOR& eye
+                  Position of the camera
+                ID3D11Device* pDevice
+                  The Direct3D device to create the buffers
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to set buffers
+                std::vector<std::shared_ptr<Voxel>>& aOutLoadedVoxels
+                  Voxels created by this call
+                std::vector<std::shared_ptr<VoxelMesh>>& aOutLoadedMeshes
+                  Meshes created by this call
+                BOOL& bOutChanged
+                  Whether the set of resident voxels or meshes changed
+
+      Modifies: [m_residentChunks, m_pendingChunks, m_dirtyChunks,
+                 m_uResidentBytes, m_uPendingBytes].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT ChunkStreamer::Update(
+        _In_ const XMVECTOR& eye,
+        _In_ ID3D11Device* pDevice,
+        _In_ ID3D11DeviceContext* pImmediateContext,
+        _Out_ std::vector<std::shared_ptr<Voxel>>& aOutLoadedVoxels,
+        _Out_ std::vector<std::shared_ptr<VoxelMesh>>& aOutLoadedMeshes,
+        _Out_ BOOL& bOutChanged
+    )
+    {
+        aOutLoadedVoxels.clear();
+        aOutLoadedMeshes.clear();
+        bOutChanged = FALSE;
+
+        const FLOAT eyeX = XMVectorGetX(eye);
+        const FLOAT eyeZ = XMVectorGetZ(eye);
+
+        BOOL bReplaced = FALSE;
+        HRESULT hr = finalizeChunks(pDevice, pImmediateContext, aOutLoadedVoxels, aOutLoadedMeshes, bReplaced);
+
+        BOOL bRefreshed = FALSE;
+        const HRESULT hrRefresh = refreshDirtyChunks(pDevice, pImmediateContext, aOutLoadedVoxels, bRefreshed);
+        if (SUCCEEDED(hr))
+        {
+            hr = hrRefresh;
+        }
+
+        BOOL bEvicted = evictChunks(eyeX, eyeZ);
+        bEvicted |= requestChunks(eyeX, eyeZ);
+
+        bOutChanged = !aOutLoadedVoxels.empty() || !aOutLoadedMeshes.empty() || bEvicted || bReplaced || bRefreshed;
+
+        return hr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::InvalidateColumn
+
+      Summary:  Marks the chunk holding an edited column as dirty so the
+                next update refreshes it. Greedy meshes with open
+                borders also read the columns next to the chunk, and
+                the ambient occlusion the cells around it, so an edit
+                near the border dirties the neighboring chunks too
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT z
+                  Column index along the z axis
+
+      Modifies: [m_dirtyChunks].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkStreamer::InvalidateColumn(_In_ UINT x, _In_ UINT z)
+    {
+        const UINT uChunkX = x / m_desc.uChunkSize;
+        const UINT uChunkZ = z / m_desc.uChunkSize;
+        if (uChunkX >= m_uNumChunksX || uChunkZ >= m_uNumChunksZ)
+        {
+            return;
+        }
+
+        m_dirtyChunks.insert(makeKey(uChunkX, uChunkZ));
+
+        if (m_desc.bGreedyMeshing && (m_desc.uNumLodLevels <= 1u || m_desc.bAmbientOcclusion))
+        {
+            // The ambient occlusion reads a cell of the coarsest level
+            // past the chunk, diagonals included
+            const UINT uMargin = m_desc.bAmbientOcclusion ? 1u << (m_desc.uNumLodLevels - 1u) : 1u;
+            const UINT uLocalX = x % m_desc.uChunkSize;
+            const UINT uLocalZ = z % m_desc.uChunkSize;
+            const INT iMinX = uLocalX < uMargin && uChunkX > 0u ? -1 : 0;
+            const INT iMaxX = uLocalX + uMargin >= m_desc.uChunkSize && uChunkX + 1u < m_uNumChunksX ? 1 : 0;
+            const INT iMinZ = uLocalZ < uMargin && uChunkZ > 0u ? -1 : 0;
+            const INT iMaxZ = uLocalZ + uMargin >= m_desc.uChunkSize && uChunkZ + 1u < m_uNumChunksZ ? 1 : 0;
+            for (INT iOffsetZ = iMinZ; iOffsetZ <= iMaxZ; ++iOffsetZ)
+            {
+                for (INT iOffsetX = iMinX; iOffsetX <= iMaxX; ++iOffsetX)
+                {
+                    if ((iOffsetX == 0 && iOffsetZ == 0) || (iOffsetX != 0 && iOffsetZ != 0 && !m_desc.bAmbientOcclusion))
+                    {
+                        continue;
+                    }
+
+                    m_dirtyChunks.insert(makeKey(static_cast<UINT>(static_cast<INT>(uChunkX) + iOffsetX), static_cast<UINT>(static_cast<INT>(uChunkZ) + iOffsetZ)));
+                }
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::InvalidateColumns
+
+      Summary:  Marks every chunk showing a rectangle of columns as
+                dirty, such as the columns whose light changed. Cells
+                of the coarsest level of detail past the rectangle read
+                it too, so it is grown by one such cell first
+
+      Args:     UINT uBeginX
+                  First column along the x axis
+                UINT uBeginZ
+                  First column along the z axis
+                UINT uEndX
+                  One past the last column along the x axis
+                UINT uEndZ
+                  One past the last column along the z axis
+
+      Modifies: [m_dirtyChunks].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkStreamer::InvalidateColumns(_In_ UINT uBeginX, _In_ UINT uBeginZ, _In_ UINT uEndX, _In_ UINT uEndZ)
+    {
+        if (uBeginX >= uEndX || uBeginZ >= uEndZ)
+        {
+            return;
+        }
+
+        const UINT uMargin = 1u << (m_desc.uNumLodLevels - 1u);
+        uBeginX = uBeginX > uMargin ? uBeginX - uMargin : 0u;
+        uBeginZ = uBeginZ > uMargin ? uBeginZ - uMargin : 0u;
+        const UINT uLastChunkX = (uEndX - 1u + uMargin) / m_desc.uChunkSize;
+        const UINT uLastChunkZ = (uEndZ - 1u + uMargin) / m_desc.uChunkSize;
+        for (UINT uChunkZ = uBeginZ / m_desc.uChunkSize; uChunkZ <= uLastChunkZ && uChunkZ < m_uNumChunksZ; ++uChunkZ)
+        {
+            for (UINT uChunkX = uBeginX / m_desc.uChunkSize; uChunkX <= uLastChunkX && uChunkX < m_uNumChunksX; ++uChunkX)
+            {
+                m_dirtyChunks.insert(makeKey(uChunkX, uChunkZ));
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::GetResidentVoxels
+
+      Summary:  Returns the voxels of every resident chunk
+
+      Args:     std::vector<std::shared_ptr<Voxel>>& aOutVoxels
+                  Voxels of the resident chunks
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkStreamer::GetResidentVoxels(_Out_ std::vector<std::shared_ptr<Voxel>>& aOutVoxels) const
+    {
+        aOutVoxels.clear();
+        for (auto it = m_residentChunks.begin(); it != m_residentChunks.end(); ++it)
+        {
+            aOutVoxels.insert(aOutVoxels.end(), it->second.aVoxels.begin(), it->second.aVoxels.end());
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::GetResidentMeshes
+
+      Summary:  Returns the meshes of every resident chunk
+
+      Args:     std::vector<std::shared_ptr<VoxelMesh>>& aOutMeshes
+                  Meshes of the resident chunks
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkStreamer::GetResidentMeshes(_Out_ std::vector<std::shared_ptr<VoxelMesh>>& aOutMeshes) const
+    {
+        aOutMeshes.clear();
+        for (auto it = m_residentChunks.begin(); it != m_residentChunks.end(); ++it)
+        {
+            aOutMeshes.insert(aOutMeshes.end(), it->second.aMeshes.begin(), it->second.aMeshes.end());
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::GetCullingData
+
+      Summary:  Resets a chunk culler to the chunk grid and sets the
+                bounds of every resident chunk. Coarse levels of detail
+                round cells up, so their boxes are raised by the height
+                of a cell
+
+      Args:     ChunkCuller& culler
+                  Culler to fill
+                std::vector<UINT>& aOutVoxelChunks
+                  Culler chunk index of every voxel, in the order of
+                  GetResidentVoxels
+                std::vector<UINT>& aOutMeshChunks
+                  Culler chunk index of every mesh, in the order of
+                  GetResidentMeshes
+
+      Modifies: [culler, aOutVoxelChunks, aOutMeshChunks].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkStreamer::GetCullingData(
+        _Inout_ ChunkCuller& culler,
+        _Out_ std::vector<UINT>& aOutVoxelChunks,
+        _Out_ std::vector<UINT>& aOutMeshChunks
+    ) const
+    {
+        culler.Reset(m_uNumChunksX, m_uNumChunksZ);
+        aOutVoxelChunks.clear();
+        aOutMeshChunks.clear();
+
+        for (auto it = m_residentChunks.begin(); it != m_residentChunks.end(); ++it)
+        {
+            const ResidentChunk& chunk = it->second;
+            const UINT uBeginX = chunk.uChunkX * m_desc.uChunkSize;
+            const UINT uBeginZ = chunk.uChunkZ * m_desc.uChunkSize;
+
+            XMFLOAT3 boxMin;
+            XMFLOAT3 boxMax;
+            m_heightMap.GetBounds(uBeginX, uBeginZ, uBeginX + m_desc.uChunkSize, uBeginZ + m_desc.uChunkSize, boxMin, boxMax);
+            boxMax.y += ChunkMesher::BLOCK_SIZE * static_cast<FLOAT>((1u << chunk.uLodLevel) - 1u);
+            culler.SetChunkBounds(chunk.uChunkX, chunk.uChunkZ, boxMin, boxMax);
+
+            const UINT uChunkIdx = culler.GetChunkIndex(chunk.uChunkX, chunk.uChunkZ);
+            aOutVoxelChunks.insert(aOutVoxelChunks.end(), chunk.aVoxels.size(), uChunkIdx);
+            aOutMeshChunks.insert(aOutMeshChunks.end(), chunk.aMeshes.size(), uChunkIdx);
+        }
+    }
+
+    size_t ChunkStreamer::GetResidentBytes() const
+    {
+        return m_uResidentBytes;
+    }
+
+    UINT ChunkStreamer::GetNumResidentChunks() const
+    {
+        return static_cast<UINT>(m_residentChunks.size());
+    }
+
+    UINT ChunkStreamer::GetNumPendingChunks() const
+    {
+        return static_cast<UINT>(m_pendingChunks.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::LockMaps
+
+      Summary:  Waits until no worker is reading the height map or the
+                light map, and keeps the workers from starting to read
+                them until the lock is released. Workers only hold
+                their side while they copy the columns of a chunk, so
+                this waits for a few copies at most. Chunks built
+                before an edit are refreshed by the update after it, as
+                long as the edited columns are invalidated
+
+      Returns:  std::unique_lock<std::shared_mutex>
+                  Lock to hold while changing either map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::unique_lock<std::shared_mutex> ChunkStreamer::LockMaps()
+    {
+        return std::unique_lock<std::shared_mutex>(m_mapsMutex);
+    }
+
+    UINT64 ChunkStreamer::makeKey(_In_ UINT uChunkX, _In_ UINT uChunkZ)
+    {
+        return (static_cast<UINT64>(uChunkZ) << 32u) | static_cast<UINT64>(uChunkX);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::concatenatePackedInstances
+
+      Summary:  Concatenates the packed instances of every palette
+                entry of a chunk in palette order, so the chunk is
+                drawn by a single voxel
+
+      Args:     std::vector<std::vector<PackedInstanceData>>& aColorInstanceData
+                  Packed instances of every palette entry. Released
+                std::vector<PackedInstanceData>& aOutInstanceData
+                  Packed instances of the chunk
+
+      Modifies: [aColorInstanceData].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkStreamer::concatenatePackedInstances(
+        _Inout_ std::vector<std::vector<PackedInstanceData>>& aColorInstanceData,
+        _Out_ std::vector<PackedInstanceData>& aOutInstanceData
+    )
+    {
+        size_t uNumInstances = 0u;
+        for (const std::vector<PackedInstanceData>& aInstanceData : aColorInstanceData)
+        {
+            uNumInstances += aInstanceData.size();
+        }
+
+        aOutInstanceData.clear();
+        aOutInstanceData.reserve(uNumInstances);
+        for (const std::vector<PackedInstanceData>& aInstanceData : aColorInstanceData)
+        {
+            aOutInstanceData.insert(aOutInstanceData.end(), aInstanceData.begin(), aInstanceData.end());
+        }
+        std::vector<std::vector<PackedInstanceData>>().swap(aColorInstanceData);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::buildChunk
+
+      Summary:  Fills the instance data of a chunk, or greedy meshes
+                it. Runs on a worker thread. The height map and the
+                light map are only read under the shared side of
+                LockMaps: greedy meshes copy the chunk into a block
+                volume under the lock and mesh the copy without it.
+                Packed instances of every palette entry are
+                concatenated after the lock is released
+
+      Args:     const std::shared_ptr<ChunkRequest>& request
+                  Chunk to build
+
+      Modifies: [request, m_completedChunks].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkStreamer::buildChunk(_In_ const std::shared_ptr<ChunkRequest>& request)
+    {
+        if (request->bCancelled)
+        {
+            return;
+        }
+
+        const UINT uBeginX = request->uChunkX * m_desc.uChunkSize;
+        const UINT uBeginZ = request->uChunkZ * m_desc.uChunkSize;
+        BlockVolume volume;
+        std::vector<std::vector<PackedInstanceData>> aColorPackedInstanceData;
+        {
+            std::shared_lock<std::shared_mutex> mapsLock(m_mapsMutex);
+            if (request->bCancelled)
+            {
+                return;
+            }
+
+            if (m_desc.bGreedyMeshing)
+            {
+                ChunkMesher::BuildVolume(
+                    m_heightMap,
+                    uBeginX,
+                    uBeginZ,
+                    uBeginX + m_desc.uChunkSize,
+                    uBeginZ + m_desc.uChunkSize,
+                    request->uLodLevel,
+                    m_desc.uNumLodLevels > 1u,
+                    m_pLightMap,
+                    volume
+                );
+            }
+            else if (m_desc.bPackedInstances)
+            {
+                m_heightMap.FillPackedInstanceData(
+                    uBeginX,
+                    uBeginZ,
+                    uBeginX + m_desc.uChunkSize,
+                    uBeginZ + m_desc.uChunkSize,
+                    m_desc.Instancing,
+                    aColorPackedInstanceData
+                );
+            }
+            else
+            {
+                m_heightMap.FillInstanceData(
+                    uBeginX,
+                    uBeginZ,
+                    uBeginX + m_desc.uChunkSize,
+                    uBeginZ + m_desc.uChunkSize,
+                    m_desc.Instancing,
+                    request->aInstanceData
+                );
+            }
+        }
+
+        if (m_desc.bGreedyMeshing)
+        {
+            ChunkMesher::MeshVolume(volume, m_desc.bAmbientOcclusion, request->aMeshParts);
+        }
+        else if (m_desc.bPackedInstances)
+        {
+            concatenatePackedInstances(aColorPackedInstanceData, request->aPackedInstanceData);
+        }
+
+        std::lock_guard<std::mutex> lock(m_completedMutex);
+        m_completedChunks.push_back(request);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::estimateChunkBytes
+
+      Summary:  Returns the bytes of instance data a chunk will need
+                once built, so the budget can be reserved before the
+                chunk is requested. For greedy meshes this is an upper
+                bound that assumes no face gets merged: the top and
+                bottom of every column plus the part of its sides
+                higher than the neighboring columns. Coarser levels of
+                detail need fewer faces, so the full detail count is
+                used for every level. When the chunk borders are closed
+                the columns outside of the chunk count as empty
+
+      Args:     UINT uChunkX
+                  Chunk index along the x axis
+                UINT uChunkZ
+                  Chunk index along the z axis
+
+      Returns:  size_t
+                  Bytes of instance or mesh data of the chunk
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    size_t ChunkStreamer::estimateChunkBytes(_In_ UINT uChunkX, _In_ UINT uChunkZ) const
+    {
+        const UINT uBeginX = uChunkX * m_desc.uChunkSize;
+        const UINT uBeginZ = uChunkZ * m_desc.uChunkSize;
+
+        if (m_desc.bGreedyMeshing)
+        {
+            const UINT uEndX = uBeginX + m_desc.uChunkSize < m_heightMap.GetWidth() ? uBeginX + m_desc.uChunkSize : m_heightMap.GetWidth();
+            const UINT uEndZ = uBeginZ + m_desc.uChunkSize < m_heightMap.GetDepth() ? uBeginZ + m_desc.uChunkSize : m_heightMap.GetDepth();
+            const INT iBeginX = m_desc.uNumLodLevels > 1u ? static_cast<INT>(uBeginX) : 0;
+            const INT iBeginZ = m_desc.uNumLodLevels > 1u ? static_cast<INT>(uBeginZ) : 0;
+            const INT iEndX = m_desc.uNumLodLevels > 1u ? static_cast<INT>(uEndX) : static_cast<INT>(m_heightMap.GetWidth());
+            const INT iEndZ = m_desc.uNumLodLevels > 1u ? static_cast<INT>(uEndZ) : static_cast<INT>(m_heightMap.GetDepth());
+            const auto getSolidHeight = [this, iBeginX, iBeginZ, iEndX, iEndZ](_In_ INT x, _In_ INT z) -> UINT
+            {
+                if (x < iBeginX || z < iBeginZ || x >= iEndX || z >= iEndZ
+                    || m_heightMap.GetColumnType(static_cast<UINT>(x), static_cast<UINT>(z)) >= m_heightMap.GetNumColors())
+                {
+                    return 0u;
+                }
+                return m_heightMap.GetColumnHeight(static_cast<UINT>(x), static_cast<UINT>(z));
+            };
+
+            size_t uNumFaces = 0u;
+            for (UINT z = uBeginZ; z < uEndZ; ++z)
+            {
+                for (UINT x = uBeginX; x < uEndX; ++x)
+                {
+                    const UINT uHeight = getSolidHeight(static_cast<INT>(x), static_cast<INT>(z));
+                    if (uHeight == 0u)
+                    {
+                        continue;
+                    }
+
+                    const UINT aNeighborHeights[4] =
+                    {
+                        getSolidHeight(static_cast<INT>(x) - 1, static_cast<INT>(z)),
+                        getSolidHeight(static_cast<INT>(x) + 1, static_cast<INT>(z)),
+                        getSolidHeight(static_cast<INT>(x), static_cast<INT>(z) - 1),
+                        getSolidHeight(static_cast<INT>(x), static_cast<INT>(z) + 1)
+                    };
+
+                    uNumFaces += 2u;
+                    for (UINT uNeighborHeight : aNeighborHeights)
+                    {
+                        uNumFaces += uHeight > uNeighborHeight ? uHeight - uNeighborHeight : 0u;
+                    }
+                }
+            }
+
+            return uNumFaces * (4u * (sizeof(SimpleVertex) + sizeof(NormalData)) + 6u * sizeof(WORD));
+        }
+
+        return m_heightMap.CountInstances(uBeginX, uBeginZ, uBeginX + m_desc.uChunkSize, uBeginZ + m_desc.uChunkSize, m_desc.Instancing)
+            * (m_desc.bPackedInstances ? sizeof(PackedInstanceData) : sizeof(InstanceData));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::getDistanceToChunk
+
+      Summary:  Returns the distance in the xz plane between the eye
+                and the closest point of a chunk
+
+      Args:     FLOAT eyeX
+                  Position of the eye along the x axis
+                FLOAT eyeZ
+                  Position of the eye along the z axis
+                UINT uChunkX
+                  Chunk index along the x axis
+                UINT uChunkZ
+                  Chunk index along the z axis
+
+      Returns:  FLOAT
+                  Distance in world units
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT ChunkStreamer::getDistanceToChunk(_In_ FLOAT eyeX, _In_ FLOAT eyeZ, _In_ UINT uChunkX, _In_ UINT uChunkZ) const
+    {
+        const UINT uBeginX = uChunkX * m_desc.uChunkSize;
+        const UINT uBeginZ = uChunkZ * m_desc.uChunkSize;
+        const XMFLOAT3 minCorner = m_heightMap.GetBlockPosition(uBeginX, 0u, uBeginZ);
+        const XMFLOAT3 maxCorner = m_heightMap.GetBlockPosition(uBeginX + m_desc.uChunkSize - 1u, 0u, uBeginZ + m_desc.uChunkSize - 1u);
+
+        const FLOAT minX = minCorner.x - 1.0f;
+        const FLOAT maxX = maxCorner.x + 1.0f;
+        const FLOAT minZ = minCorner.z - 1.0f;
+        const FLOAT maxZ = maxCorner.z + 1.0f;
+
+        const FLOAT dx = eyeX < minX ? minX - eyeX : (eyeX > maxX ? eyeX - maxX : 0.0f);
+        const FLOAT dz = eyeZ < minZ ? minZ - eyeZ : (eyeZ > maxZ ? eyeZ - maxZ : 0.0f);
+
+        return sqrtf(dx * dx + dz * dz);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::getLodLevel
+
+      Summary:  Returns the level of detail of a chunk at a distance.
+                Levels whose cells do not tile the chunk exactly are
+                skipped so neighboring chunks keep aligned cells
+
+      Args:     FLOAT distance
+                  Distance between the eye and the chunk in world units
+
+      Returns:  UINT
+                  Level of detail
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT ChunkStreamer::getLodLevel(_In_ FLOAT distance) const
+    {
+        UINT uLodLevel = 0u;
+        FLOAT threshold = m_desc.LodDistance;
+        while (uLodLevel + 1u < m_desc.uNumLodLevels && distance > threshold
+            && m_desc.uChunkSize % (1u << (uLodLevel + 1u)) == 0u)
+        {
+            ++uLodLevel;
+            threshold *= 2.0f;
+        }
+
+        return uLodLevel;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::needsLodChange
+
+      Summary:  Returns whether a resident chunk should be rebuilt at
+                another level of detail. The distance is widened or
+                narrowed by a hysteresis factor so chunks near a
+                threshold do not rebuild every frame
+
+      Args:     const ResidentChunk& chunk
+                  Resident chunk
+                FLOAT distance
+                  Distance between the eye and the chunk in world units
+
+      Returns:  BOOL
+                  Whether the level of detail of the chunk is stale
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL ChunkStreamer::needsLodChange(_In_ const ResidentChunk& chunk, _In_ FLOAT distance) const
+    {
+        return getLodLevel(distance * LOD_HYSTERESIS) < chunk.uLodLevel
+            || getLodLevel(distance / LOD_HYSTERESIS) > chunk.uLodLevel;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::requestChunks
+
+      Summary:  Queues the nearest chunks within the residency radius
+                that are neither resident nor pending, then the
+                resident chunks whose level of detail is stale. The
+                estimated size of a chunk is reserved from the memory
+                budget when it is requested. If it does not fit,
+                resident chunks farther than the requested one are
+                evicted first. A rebuilt chunk stays resident until its
+                replacement is finalized
+
+      Args:     FLOAT eyeX
+                  Position of the eye along the x axis
+                FLOAT eyeZ
+                  Position of the eye along the z axis
+
+      Modifies: [m_pendingChunks, m_residentChunks, m_uResidentBytes,
+                 m_uPendingBytes, m_threadPool].
+
+      Returns:  BOOL
+                  Whether a resident chunk was evicted
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL ChunkStreamer::requestChunks(_In_ FLOAT eyeX, _In_ FLOAT eyeZ)
+    {
+        if (m_pendingChunks.size() >= m_uMaxPendingChunks)
+        {
+            return FALSE;
+        }
+
+        INT iEyeX = 0;
+        INT iEyeZ = 0;
+        m_heightMap.GetColumnCoordinates(eyeX, eyeZ, iEyeX, iEyeZ);
+
+        const INT iChunkSize = static_cast<INT>(m_desc.uChunkSize);
+        const INT iRadiusInChunks = static_cast<INT>(m_desc.ResidencyRadius / (2.0f * static_cast<FLOAT>(m_desc.uChunkSize))) + 1;
+        const INT iCenterX = iEyeX >= 0 ? iEyeX / iChunkSize : -1;
+        const INT iCenterZ = iEyeZ >= 0 ? iEyeZ / iChunkSize : -1;
+
+        const INT iBeginX = iCenterX - iRadiusInChunks > 0 ? iCenterX - iRadiusInChunks : 0;
+        const INT iBeginZ = iCenterZ - iRadiusInChunks > 0 ? iCenterZ - iRadiusInChunks : 0;
+        const INT iEndX = iCenterX + iRadiusInChunks + 1 < static_cast<INT>(m_uNumChunksX) ? iCenterX + iRadiusInChunks + 1 : static_cast<INT>(m_uNumChunksX);
+        const INT iEndZ = iCenterZ + iRadiusInChunks + 1 < static_cast<INT>(m_uNumChunksZ) ? iCenterZ + iRadiusInChunks + 1 : static_cast<INT>(m_uNumChunksZ);
+
+        // Missing chunks come before rebuilds, nearest first
+        std::vector<std::tuple<BOOL, FLOAT, UINT64>> aCandidates;
+        for (INT iChunkZ = iBeginZ; iChunkZ < iEndZ; ++iChunkZ)
+        {
+            for (INT iChunkX = iBeginX; iChunkX < iEndX; ++iChunkX)
+            {
+                const UINT64 uKey = makeKey(static_cast<UINT>(iChunkX), static_cast<UINT>(iChunkZ));
+                if (m_pendingChunks.contains(uKey))
+                {
+                    continue;
+                }
+
+                const FLOAT distance = getDistanceToChunk(eyeX, eyeZ, static_cast<UINT>(iChunkX), static_cast<UINT>(iChunkZ));
+                auto resident = m_residentChunks.find(uKey);
+                if (resident != m_residentChunks.end())
+                {
+                    if (needsLodChange(resident->second, distance))
+                    {
+                        aCandidates.emplace_back(TRUE, distance, uKey);
+                    }
+                }
+                else if (distance <= m_desc.ResidencyRadius)
+                {
+                    aCandidates.emplace_back(FALSE, distance, uKey);
+                }
+            }
+        }
+
+        if (aCandidates.empty())
+        {
+            return FALSE;
+        }
+
+        std::sort(aCandidates.begin(), aCandidates.end());
+
+        std::vector<std::pair<FLOAT, UINT64>> aResident;
+        aResident.reserve(m_residentChunks.size());
+        for (auto it = m_residentChunks.begin(); it != m_residentChunks.end(); ++it)
+        {
+            aResident.emplace_back(getDistanceToChunk(eyeX, eyeZ, it->second.uChunkX, it->second.uChunkZ), it->first);
+        }
+        std::sort(aResident.begin(), aResident.end());
+
+        BOOL bEvicted = FALSE;
+        for (const auto& [bRebuild, candidateDistance, uCandidateKey] : aCandidates)
+        {
+            if (m_pendingChunks.size() >= m_uMaxPendingChunks)
+            {
+                break;
+            }
+
+            if (bRebuild && !m_residentChunks.contains(uCandidateKey))
+            {
+                continue;
+            }
+
+            const UINT uChunkX = static_cast<UINT>(uCandidateKey & 0xFFFFFFFFu);
+            const UINT uChunkZ = static_cast<UINT>(uCandidateKey >> 32u);
+            const size_t uEstimatedBytes = estimateChunkBytes(uChunkX, uChunkZ);
+
+            while (m_uResidentBytes + m_uPendingBytes + uEstimatedBytes > m_desc.uMemoryBudget
+                && !aResident.empty() && aResident.back().first > candidateDistance)
+            {
+                auto it = m_residentChunks.find(aResident.back().second);
+                m_uResidentBytes -= it->second.uSizeInBytes;
+                m_residentChunks.erase(it);
+                aResident.pop_back();
+                bEvicted = TRUE;
+            }
+
+            if (m_uResidentBytes + m_uPendingBytes + uEstimatedBytes > m_desc.uMemoryBudget)
+            {
+                break;
+            }
+
+            requestChunk(uChunkX, uChunkZ, getLodLevel(candidateDistance), uEstimatedBytes);
+        }
+
+        return bEvicted;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::requestChunk
+
+      Summary:  Reserves the estimated size of a chunk from the memory
+                budget and queues it on the worker threads
+
+      Args:     UINT uChunkX
+                  Chunk index along the x axis
+                UINT uChunkZ
+                  Chunk index along the z axis
+                UINT uLodLevel
+                  Level of detail to build the chunk at
+                size_t uEstimatedBytes
+                  Estimated size of the built chunk
+
+      Modifies: [m_pendingChunks, m_uPendingBytes, m_threadPool].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ChunkStreamer::requestChunk(_In_ UINT uChunkX, _In_ UINT uChunkZ, _In_ UINT uLodLevel, _In_ size_t uEstimatedBytes)
+    {
+        std::shared_ptr<ChunkRequest> request = std::make_shared<ChunkRequest>();
+        request->uKey = makeKey(uChunkX, uChunkZ);
+        request->uChunkX = uChunkX;
+        request->uChunkZ = uChunkZ;
+        request->uLodLevel = uLodLevel;
+        request->uEstimatedBytes = uEstimatedBytes;
+        request->bCancelled = FALSE;
+
+        m_uPendingBytes += uEstimatedBytes;
+        m_pendingChunks[request->uKey] = request;
+        m_threadPool->Enqueue([this, request]() { buildChunk(request); });
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::finalizeChunks
+
+      Summary:  Creates the voxels or meshes of the chunks built by the
+                workers. Chunks cancelled in the meantime are dropped,
+                and chunks rebuilt at another level of detail replace
+                the resident ones. Every built chunk is taken off the
+                pending chunks, so a chunk whose buffers fail is
+                dropped and requested again by a later update
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the buffers
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to set buffers
+                std::vector<std::shared_ptr<Voxel>>& aOutLoadedVoxels
+                  Voxels created by this call
+                std::vector<std::shared_ptr<VoxelMesh>>& aOutLoadedMeshes
+                  Meshes created by this call
+                BOOL& bOutReplaced
+                  Whether a resident chunk was replaced
+
+      Modifies: [m_completedChunks, m_pendingChunks, m_residentChunks,
+                 m_uResidentBytes, m_uPendingBytes].
+
+      Returns:  HRESULT
+                  Status code. The first failure of the chunks
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT ChunkStreamer::finalizeChunks(
+        _In_ ID3D11Device* pDevice,
+        _In_ ID3D11DeviceContext* pImmediateContext,
+        _Inout_ std::vector<std::shared_ptr<Voxel>>& aOutLoadedVoxels,
+        _Inout_ std::vector<std::shared_ptr<VoxelMesh>>& aOutLoadedMeshes,
+        _Out_ BOOL& bOutReplaced
+    )
+    {
+        bOutReplaced = FALSE;
+
+        std::vector<std::shared_ptr<ChunkRequest>> aCompletedChunks;
+        {
+            std::lock_guard<std::mutex> lock(m_completedMutex);
+            aCompletedChunks.swap(m_completedChunks);
+        }
+
+        HRESULT hr = S_OK;
+        for (const std::shared_ptr<ChunkRequest>& request : aCompletedChunks)
+        {
+            auto pending = m_pendingChunks.find(request->uKey);
+            if (request->bCancelled || pending == m_pendingChunks.end() || pending->second != request)
+            {
+                continue;
+            }
+            m_pendingChunks.erase(pending);
+            m_uPendingBytes -= request->uEstimatedBytes;
+
+            ResidentChunk chunk =
+            {
+                .uChunkX = request->uChunkX,
+                .uChunkZ = request->uChunkZ,
+                .uLodLevel = request->uLodLevel,
+                .uSizeInBytes = 0u,
+                .aVoxels = std::vector<std::shared_ptr<Voxel>>(),
+                .aVoxelColors = std::vector<UINT>(),
+                .aMeshes = std::vector<std::shared_ptr<VoxelMesh>>()
+            };
+
+            const HRESULT hrChunk = createChunk(*request, pDevice, pImmediateContext, chunk);
+            if (FAILED(hrChunk))
+            {
+                hr = SUCCEEDED(hr) ? hrChunk : hr;
+                continue;
+            }
+
+            aOutLoadedVoxels.insert(aOutLoadedVoxels.end(), chunk.aVoxels.begin(), chunk.aVoxels.end());
+            aOutLoadedMeshes.insert(aOutLoadedMeshes.end(), chunk.aMeshes.begin(), chunk.aMeshes.end());
+
+            auto resident = m_residentChunks.find(request->uKey);
+            if (resident != m_residentChunks.end())
+            {
+                m_uResidentBytes -= resident->second.uSizeInBytes;
+                m_residentChunks.erase(resident);
+                bOutReplaced = TRUE;
+            }
+
+            m_uResidentBytes += chunk.uSizeInBytes;
+            m_residentChunks.emplace(request->uKey, std::move(chunk));
+        }
+
+        return hr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::createChunk
+
+      Summary:  Creates the voxels or meshes of a chunk built by a
+                worker
+
+      Args:     ChunkRequest& request
+                  Built chunk. Its instance data and mesh parts are
+                  moved into the voxels and meshes
+                ID3D11Device* pDevice
+                  The Direct3D device to create the buffers
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to set buffers
+                ResidentChunk& chunk
+                  Chunk the voxels and meshes are added to
+
+      Modifies: [request, chunk].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT ChunkStreamer::createChunk(
+        _Inout_ ChunkRequest& request,
+        _In_ ID3D11Device* pDevice,
+        _In_ ID3D11DeviceContext* pImmediateContext,
+        _Inout_ ResidentChunk& chunk
+    )
+    {
+        std::vector<std::shared_ptr<VoxelMesh>> aLoadedMeshes;
+        HRESULT hr = createMeshes(request.aMeshParts, pDevice, pImmediateContext, chunk, aLoadedMeshes);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        if (!request.aPackedInstanceData.empty())
+        {
+            chunk.uSizeInBytes += request.aPackedInstanceData.size() * sizeof(PackedInstanceData);
+
+            // The packed instances carry their palette entry
+            std::shared_ptr<Voxel> voxel = std::make_shared<Voxel>(
+                std::move(request.aPackedInstanceData),
+                m_heightMap.GetGridOrigin(),
+                XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f)
+            );
+            hr = voxel->Initialize(pDevice, pImmediateContext);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+
+            chunk.aVoxels.push_back(voxel);
+        }
+
+        for (UINT uColorIdx = 0u; uColorIdx < request.aInstanceData.size(); ++uColorIdx)
+        {
+            if (request.aInstanceData[uColorIdx].empty())
+            {
+                continue;
+            }
+
+            chunk.uSizeInBytes += request.aInstanceData[uColorIdx].size() * sizeof(InstanceData);
+
+            std::shared_ptr<Voxel> voxel = std::make_shared<Voxel>(std::move(request.aInstanceData[uColorIdx]), m_heightMap.GetColor(uColorIdx));
+            hr = voxel->Initialize(pDevice, pImmediateContext);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+
+            chunk.aVoxels.push_back(voxel);
+            chunk.aVoxelColors.push_back(uColorIdx);
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::evictChunks
+
+      Summary:  Cancels the pending chunks and evicts the resident
+                chunks that moved past the residency radius. The
+                radius is widened by a hysteresis factor so chunks on
+                the border do not reload every frame. Then evicts the
+                farthest chunks until the memory budget is met
+
+      Args:     FLOAT eyeX
+                  Position of the eye along the x axis
+                FLOAT eyeZ
+                  Position of the eye along the z axis
+
+      Modifies: [m_pendingChunks, m_residentChunks, m_uResidentBytes,
+                 m_uPendingBytes].
+
+      Returns:  BOOL
+                  Whether a resident chunk was evicted
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL ChunkStreamer::evictChunks(_In_ FLOAT eyeX, _In_ FLOAT eyeZ)
+    {
+        const FLOAT evictionRadius = m_desc.ResidencyRadius * EVICTION_HYSTERESIS;
+        BOOL bEvicted = FALSE;
+
+        for (auto it = m_pendingChunks.begin(); it != m_pendingChunks.end();)
+        {
+            if (getDistanceToChunk(eyeX, eyeZ, it->second->uChunkX, it->second->uChunkZ) > evictionRadius)
+            {
+                it->second->bCancelled = TRUE;
+                m_uPendingBytes -= it->second->uEstimatedBytes;
+                it = m_pendingChunks.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        std::vector<std::pair<FLOAT, UINT64>> aResident;
+        aResident.reserve(m_residentChunks.size());
+        for (auto it = m_residentChunks.begin(); it != m_residentChunks.end();)
+        {
+            const FLOAT distance = getDistanceToChunk(eyeX, eyeZ, it->second.uChunkX, it->second.uChunkZ);
+            if (distance > evictionRadius)
+            {
+                m_uResidentBytes -= it->second.uSizeInBytes;
+                it = m_residentChunks.erase(it);
+                bEvicted = TRUE;
+            }
+            else
+            {
+                aResident.emplace_back(distance, it->first);
+                ++it;
+            }
+        }
+
+        if (m_uResidentBytes > m_desc.uMemoryBudget)
+        {
+            std::sort(aResident.begin(), aResident.end());
+            while (m_uResidentBytes > m_desc.uMemoryBudget && !aResident.empty())
+            {
+                auto it = m_residentChunks.find(aResident.back().second);
+                m_uResidentBytes -= it->second.uSizeInBytes;
+                m_residentChunks.erase(it);
+                aResident.pop_back();
+                bEvicted = TRUE;
+            }
+        }
+
+        return bEvicted;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::refreshDirtyChunks
+
+      Summary:  Rebuilds the chunks marked dirty since the last update.
+                Pending chunks may have read the columns before the
+                edit, so they are cancelled and requested again.
+                Resident voxels are refilled on the calling thread,
+                which only touches the columns of the chunk. Resident
+                greedy meshes are requested again from the workers and
+                stay drawn until their rebuild is finalized. Rebuilds
+                past the pending chunk limit stay dirty until a later
+                update, so relighting the whole map spreads over
+                several frames
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the buffers
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to update buffers
+                std::vector<std::shared_ptr<Voxel>>& aOutLoadedVoxels
+                  Voxels created by this call
+                BOOL& bOutChanged
+                  Whether the set of resident voxels or meshes changed
+
+      Modifies: [m_dirtyChunks, m_pendingChunks, m_residentChunks,
+                 m_uResidentBytes, m_uPendingBytes, m_threadPool].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT ChunkStreamer::refreshDirtyChunks(
+        _In_ ID3D11Device* pDevice,
+        _In_ ID3D11DeviceContext* pImmediateContext,
+        _Inout_ std::vector<std::shared_ptr<Voxel>>& aOutLoadedVoxels,
+        _Out_ BOOL& bOutChanged
+    )
+    {
+        bOutChanged = FALSE;
+
+        for (auto it = m_dirtyChunks.begin(); it != m_dirtyChunks.end();)
+        {
+            const UINT64 uKey = *it;
+            auto resident = m_residentChunks.find(uKey);
+            if (m_desc.bGreedyMeshing && resident != m_residentChunks.end()
+                && !m_pendingChunks.contains(uKey) && m_pendingChunks.size() >= m_uMaxPendingChunks)
+            {
+                ++it;
+                continue;
+            }
+            it = m_dirtyChunks.erase(it);
+
+            auto pending = m_pendingChunks.find(uKey);
+            if (pending != m_pendingChunks.end())
+            {
+                pending->second->bCancelled = TRUE;
+                m_uPendingBytes -= pending->second->uEstimatedBytes;
+                m_pendingChunks.erase(pending);
+            }
+
+            if (resident == m_residentChunks.end())
+            {
+                continue;
+            }
+
+            ResidentChunk& chunk = resident->second;
+            if (m_desc.bGreedyMeshing)
+            {
+                requestChunk(chunk.uChunkX, chunk.uChunkZ, chunk.uLodLevel, estimateChunkBytes(chunk.uChunkX, chunk.uChunkZ));
+                continue;
+            }
+
+            m_uResidentBytes -= chunk.uSizeInBytes;
+            BOOL bVoxelsChanged = FALSE;
+            HRESULT hr = refreshVoxels(chunk, pDevice, pImmediateContext, aOutLoadedVoxels, bVoxelsChanged);
+            bOutChanged |= bVoxelsChanged;
+            m_uResidentBytes += chunk.uSizeInBytes;
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::refreshVoxels
+
+      Summary:  Refills the instance data of a resident chunk and hands
+                it to the existing voxels, which upload only the runs
+                of instances that changed. Packed instances are handed
+                to the single voxel of the chunk. Otherwise voxels of
+                palette entries that disappeared from the chunk are
+                dropped and voxels of new entries are created
+
+      Args:     ResidentChunk& chunk
+                  Chunk to refresh
+                ID3D11Device* pDevice
+                  The Direct3D device to create the buffers
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to update buffers
+                std::vector<std::shared_ptr<Voxel>>& aOutLoadedVoxels
+                  Voxels created by this call
+                BOOL& bOutChanged
+                  Whether voxels were created or dropped
+
+      Modifies: [chunk].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT ChunkStreamer::refreshVoxels(
+        _Inout_ ResidentChunk& chunk,
+        _In_ ID3D11Device* pDevice,
+        _In_ ID3D11DeviceContext* pImmediateContext,
+        _Inout_ std::vector<std::shared_ptr<Voxel>>& aOutLoadedVoxels,
+        _Out_ BOOL& bOutChanged
+    )
+    {
+        bOutChanged = FALSE;
+
+        const UINT uBeginX = chunk.uChunkX * m_desc.uChunkSize;
+        const UINT uBeginZ = chunk.uChunkZ * m_desc.uChunkSize;
+        chunk.uSizeInBytes = 0u;
+        if (m_desc.bPackedInstances)
+        {
+            std::vector<std::vector<PackedInstanceData>> aColorInstanceData;
+            std::vector<PackedInstanceData> aInstanceData;
+            m_heightMap.FillPackedInstanceData(uBeginX, uBeginZ, uBeginX + m_desc.uChunkSize, uBeginZ + m_desc.uChunkSize, m_desc.Instancing, aColorInstanceData);
+            concatenatePackedInstances(aColorInstanceData, aInstanceData);
+
+            std::shared_ptr<Voxel> voxel = chunk.aVoxels.empty() ? nullptr : chunk.aVoxels.front();
+            if (aInstanceData.empty())
+            {
+                bOutChanged = voxel != nullptr;
+                chunk.aVoxels.clear();
+                return S_OK;
+            }
+
+            if (voxel)
+            {
+                voxel->UpdatePackedInstanceData(std::move(aInstanceData));
+                HRESULT hr = voxel->UploadDirtyInstances(pDevice, pImmediateContext);
+                if (FAILED(hr))
+                {
+                    return hr;
+                }
+            }
+            else
+            {
+                voxel = std::make_shared<Voxel>(std::move(aInstanceData), m_heightMap.GetGridOrigin(), XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
+                HRESULT hr = voxel->Initialize(pDevice, pImmediateContext);
+                if (FAILED(hr))
+                {
+                    return hr;
+                }
+
+                chunk.aVoxels.push_back(voxel);
+                aOutLoadedVoxels.push_back(voxel);
+                bOutChanged = TRUE;
+            }
+
+            chunk.uSizeInBytes = static_cast<size_t>(voxel->GetNumInstances()) * voxel->GetInstanceStride();
+
+            return S_OK;
+        }
+
+        std::vector<std::vector<InstanceData>> aInstanceData;
+        m_heightMap.FillInstanceData(uBeginX, uBeginZ, uBeginX + m_desc.uChunkSize, uBeginZ + m_desc.uChunkSize, m_desc.Instancing, aInstanceData);
+
+        std::vector<std::shared_ptr<Voxel>> aVoxels;
+        std::vector<UINT> aVoxelColors;
+        for (UINT uColorIdx = 0u; uColorIdx < m_heightMap.GetNumColors(); ++uColorIdx)
+        {
+            const BOOL bEmpty = aInstanceData[uColorIdx].empty();
+
+            std::shared_ptr<Voxel> voxel;
+            for (size_t i = 0u; i < chunk.aVoxelColors.size(); ++i)
+            {
+                if (chunk.aVoxelColors[i] == uColorIdx)
+                {
+                    voxel = chunk.aVoxels[i];
+                    break;
+                }
+            }
+
+            if (bEmpty)
+            {
+                bOutChanged |= voxel != nullptr;
+                continue;
+            }
+
+            if (voxel)
+            {
+                voxel->UpdateInstanceData(std::move(aInstanceData[uColorIdx]));
+
+                HRESULT hr = voxel->UploadDirtyInstances(pDevice, pImmediateContext);
+                if (FAILED(hr))
+                {
+                    return hr;
+                }
+            }
+            else
+            {
+                voxel = std::make_shared<Voxel>(std::move(aInstanceData[uColorIdx]), m_heightMap.GetColor(uColorIdx));
+                HRESULT hr = voxel->Initialize(pDevice, pImmediateContext);
+                if (FAILED(hr))
+                {
+                    return hr;
+                }
+
+                aOutLoadedVoxels.push_back(voxel);
+                bOutChanged = TRUE;
+            }
+
+            chunk.uSizeInBytes += static_cast<size_t>(voxel->GetNumInstances()) * voxel->GetInstanceStride();
+            aVoxels.push_back(voxel);
+            aVoxelColors.push_back(uColorIdx);
+        }
+
+        chunk.aVoxels.swap(aVoxels);
+        chunk.aVoxelColors.swap(aVoxelColors);
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ChunkStreamer::createMeshes
+
+      Summary:  Creates the meshes of the greedy meshed parts of a chunk
+                and adds their size to the chunk
+
+      Args:     std::vector<ChunkMeshPart>& aMeshParts
+                  Parts of the chunk. Moved into the meshes
+                ID3D11Device* pDevice
+                  The Direct3D device to create the buffers
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to set buffers
+                ResidentChunk& chunk
+                  Chunk receiving the meshes
+                std::vector<std::shared_ptr<VoxelMesh>>& aOutLoadedMeshes
+                  Meshes created by this call
+
+      Modifies: [chunk].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT ChunkStreamer::createMeshes(
+        _Inout_ std::vector<ChunkMeshPart>& aMeshParts,
+        _In_ ID3D11Device* pDevice,
+        _In_ ID3D11DeviceContext* pImmediateContext,
+        _Inout_ ResidentChunk& chunk,
+        _Inout_ std::vector<std::shared_ptr<VoxelMesh>>& aOutLoadedMeshes
+    )
+    {
+        for (ChunkMeshPart& part : aMeshParts)
+        {
+            chunk.uSizeInBytes += part.aVertices.size() * (sizeof(SimpleVertex) + sizeof(NormalData) + 2u * sizeof(BYTE)) + part.aIndices.size() * sizeof(WORD);
+
+            const XMFLOAT4 color = m_heightMap.GetColor(part.uColorIndex);
+            std::shared_ptr<VoxelMesh> mesh = std::make_shared<VoxelMesh>(std::move(part), color);
+            HRESULT hr = mesh->Initialize(pDevice, pImmediateContext);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+
+            chunk.aMeshes.push_back(mesh);
+            aOutLoadedMeshes.push_back(mesh);
+        }
+
+        return S_OK;
+    }
+}
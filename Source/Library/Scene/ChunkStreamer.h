@@ -0,0 +1,272 @@
+/*+===================================================================
+  File:      CHUNKSTREAMER.H
+
+  Summary:   ChunkStreamer header file contains declarations of
+             ChunkStreamer class used for the lab samples of Game
+             Graphics Programming course.
+
+  Classes: ChunkStreamer
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <atomic>
+#include <shared_mutex>
+
+#include "Scene/ChunkCuller.h"
+#include "Scene/ChunkMesher.h"
+#include "Scene/HeightMap.h"
+#include "Scene/Voxel.h"
+#include "Scene/VoxelLightMap.h"
+#include "Scene/VoxelMesh.h"
+#include "Thread/ThreadPool.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ChunkStreamingDesc
+
+      Summary:  Parameters of the chunk streaming
+
+                uChunkSize
+                  Number of columns along each side of a chunk
+                ResidencyRadius
+                  Distance from the camera in world units within which
+                  chunks are loaded
+                uMemoryBudget
+                  Maximum number of bytes of instance data or mesh
+                  data kept resident
+                uNumThreads
+                  Number of background threads building chunks. 0 uses
+                  one thread per hardware thread
+                Instancing
+                  Whether chunks hold one instance per block or per
+                  column
+                bPackedInstances
+                  Whether voxels use 8 byte PackedInstanceData instead
+                  of a matrix per instance. They must be drawn with a
+                  PackedVoxelVertexShader
+                bGreedyMeshing
+                  Whether chunks are built into greedy meshes instead
+                  of instanced voxels
+                uNumLodLevels
+                  Number of levels of detail of the greedy meshes. 0 or
+                  1 meshes every chunk at full detail. Level n merges
+                  2^n x 2^n x 2^n blocks into one cell, up to
+                  ChunkMesher::MAX_LOD_LEVEL
+                LodDistance
+                  Distance from the camera in world units past which
+                  chunks drop to level 1. Each further level starts at
+                  twice the distance of the previous one
+                bAmbientOcclusion
+                  Whether greedy meshes bake the ambient occlusion of
+                  their vertices. They must be drawn with a
+                  VoxelMeshVertexShader
+                bVoxelLighting
+                  Whether greedy meshes are lit by the sky and block
+                  light of a VoxelLightMap
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ChunkStreamingDesc
+    {
+        UINT uChunkSize;
+        FLOAT ResidencyRadius;
+        size_t uMemoryBudget;
+        UINT uNumThreads;
+        eVoxelInstancing Instancing;
+        BOOL bPackedInstances;
+        BOOL bGreedyMeshing;
+        UINT uNumLodLevels;
+        FLOAT LodDistance;
+        BOOL bAmbientOcclusion;
+        BOOL bVoxelLighting;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    ChunkStreamer
+
+      Summary:  Splits the height map into square chunks of columns.
+                Chunks within the residency radius of the camera are
+                built on background threads, nearest first, and turned
+                into voxels or greedy meshes on the main thread. Chunks that leave the
+                radius or exceed the memory budget are evicted. Greedy
+                meshed chunks are rebuilt at a coarser or finer level
+                of detail as the camera moves away from or toward them.
+                Chunks whose columns were edited are refreshed on the
+                next update, uploading only the instances that changed.
+                Workers read the height map and light map under a
+                shared lock, so whoever changes them holds LockMaps
+
+      Methods:  Update
+                  Requests, finalizes and evicts chunks around the eye
+                InvalidateColumn
+                  Marks the chunks showing a column as dirty
+                InvalidateColumns
+                  Marks the chunks showing a rectangle of columns as
+                  dirty
+                GetResidentVoxels
+                  Returns the voxels of every resident chunk
+                GetResidentMeshes
+                  Returns the meshes of every resident chunk
+                GetCullingData
+                  Fills a chunk culler with the bounds of the resident
+                  chunks
+                GetResidentBytes
+                  Returns the bytes of resident instance and mesh data
+                GetNumResidentChunks
+                  Returns the number of resident chunks
+                GetNumPendingChunks
+                  Returns the number of chunks being built
+                LockMaps
+                  Waits for the workers reading the height map and the
+                  light map and keeps them out until released
+                ChunkStreamer
+                  Constructor.
+                ~ChunkStreamer
+                  Destructor. Cancels the pending chunks
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class ChunkStreamer
+    {
+    public:
+        ChunkStreamer(_In_ const HeightMap& heightMap, _In_ const ChunkStreamingDesc& desc, _In_opt_ const VoxelLightMap* pLightMap = nullptr);
+        ChunkStreamer(const ChunkStreamer& other) = delete;
+        ChunkStreamer(ChunkStreamer&& other) = delete;
+        ChunkStreamer& operator=(const ChunkStreamer& other) = delete;
+        ChunkStreamer& operator=(ChunkStreamer&& other) = delete;
+        ~ChunkStreamer();
+
+        HRESULT Update(
+            _In_ const XMVECTOR& eye,
+            _In_ ID3D11Device* pDevice,
+            _In_ ID3D11DeviceContext* pImmediateContext,
+            _Out_ std::vector<std::shared_ptr<Voxel>>& aOutLoadedVoxels,
+            _Out_ std::vector<std::shared_ptr<VoxelMesh>>& aOutLoadedMeshes,
+            _Out_ BOOL& bOutChanged
+        );
+
+        void InvalidateColumn(_In_ UINT x, _In_ UINT z);
+        void InvalidateColumns(_In_ UINT uBeginX, _In_ UINT uBeginZ, _In_ UINT uEndX, _In_ UINT uEndZ);
+        void GetResidentVoxels(_Out_ std::vector<std::shared_ptr<Voxel>>& aOutVoxels) const;
+        void GetResidentMeshes(_Out_ std::vector<std::shared_ptr<VoxelMesh>>& aOutMeshes) const;
+        void GetCullingData(
+            _Inout_ ChunkCuller& culler,
+            _Out_ std::vector<UINT>& aOutVoxelChunks,
+            _Out_ std::vector<UINT>& aOutMeshChunks
+        ) const;
+        size_t GetResidentBytes() const;
+        UINT GetNumResidentChunks() const;
+        UINT GetNumPendingChunks() const;
+        std::unique_lock<std::shared_mutex> LockMaps();
+
+    private:
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   ChunkRequest
+
+          Summary:  Chunk handed to a worker thread. The worker skips
+                    the request if it was cancelled before it started.
+                    Packed instances of every palette entry are
+                    concatenated, since they carry their own color
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct ChunkRequest
+        {
+            UINT64 uKey;
+            UINT uChunkX;
+            UINT uChunkZ;
+            UINT uLodLevel;
+            size_t uEstimatedBytes;
+            std::atomic<BOOL> bCancelled;
+            std::vector<std::vector<InstanceData>> aInstanceData;
+            std::vector<PackedInstanceData> aPackedInstanceData;
+            std::vector<ChunkMeshPart> aMeshParts;
+        };
+
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   ResidentChunk
+
+          Summary:  Chunk whose voxels or meshes are uploaded to the GPU.
+                    Full instances are split into one voxel per palette
+                    entry, listed in aVoxelColors. Packed instances are
+                    drawn by a single voxel and leave aVoxelColors empty
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct ResidentChunk
+        {
+            UINT uChunkX;
+            UINT uChunkZ;
+            UINT uLodLevel;
+            size_t uSizeInBytes;
+            std::vector<std::shared_ptr<Voxel>> aVoxels;
+            std::vector<UINT> aVoxelColors;
+            std::vector<std::shared_ptr<VoxelMesh>> aMeshes;
+        };
+
+        static UINT64 makeKey(_In_ UINT uChunkX, _In_ UINT uChunkZ);
+        static void concatenatePackedInstances(
+            _Inout_ std::vector<std::vector<PackedInstanceData>>& aColorInstanceData,
+            _Out_ std::vector<PackedInstanceData>& aOutInstanceData
+        );
+
+        void buildChunk(_In_ const std::shared_ptr<ChunkRequest>& request);
+        size_t estimateChunkBytes(_In_ UINT uChunkX, _In_ UINT uChunkZ) const;
+        FLOAT getDistanceToChunk(_In_ FLOAT eyeX, _In_ FLOAT eyeZ, _In_ UINT uChunkX, _In_ UINT uChunkZ) const;
+        UINT getLodLevel(_In_ FLOAT distance) const;
+        BOOL needsLodChange(_In_ const ResidentChunk& chunk, _In_ FLOAT distance) const;
+        BOOL requestChunks(_In_ FLOAT eyeX, _In_ FLOAT eyeZ);
+        void requestChunk(_In_ UINT uChunkX, _In_ UINT uChunkZ, _In_ UINT uLodLevel, _In_ size_t uEstimatedBytes);
+        HRESULT finalizeChunks(
+            _In_ ID3D11Device* pDevice,
+            _In_ ID3D11DeviceContext* pImmediateContext,
+            _Inout_ std::vector<std::shared_ptr<Voxel>>& aOutLoadedVoxels,
+            _Inout_ std::vector<std::shared_ptr<VoxelMesh>>& aOutLoadedMeshes,
+            _Out_ BOOL& bOutReplaced
+        );
+        HRESULT createChunk(
+            _Inout_ ChunkRequest& request,
+            _In_ ID3D11Device* pDevice,
+            _In_ ID3D11DeviceContext* pImmediateContext,
+            _Inout_ ResidentChunk& chunk
+        );
+        BOOL evictChunks(_In_ FLOAT eyeX, _In_ FLOAT eyeZ);
+        HRESULT refreshDirtyChunks(
+            _In_ ID3D11Device* pDevice,
+            _In_ ID3D11DeviceContext* pImmediateContext,
+            _Inout_ std::vector<std::shared_ptr<Voxel>>& aOutLoadedVoxels,
+            _Out_ BOOL& bOutChanged
+        );
+        HRESULT refreshVoxels(
+            _Inout_ ResidentChunk& chunk,
+            _In_ ID3D11Device* pDevice,
+            _In_ ID3D11DeviceContext* pImmediateContext,
+            _Inout_ std::vector<std::shared_ptr<Voxel>>& aOutLoadedVoxels,
+            _Out_ BOOL& bOutChanged
+        );
+        HRESULT createMeshes(
+            _Inout_ std::vector<ChunkMeshPart>& aMeshParts,
+            _In_ ID3D11Device* pDevice,
+            _In_ ID3D11DeviceContext* pImmediateContext,
+            _Inout_ ResidentChunk& chunk,
+            _Inout_ std::vector<std::shared_ptr<VoxelMesh>>& aOutLoadedMeshes
+        );
+
+    private:
+        static constexpr const FLOAT EVICTION_HYSTERESIS = 1.25f;
+        static constexpr const FLOAT LOD_HYSTERESIS = 1.1f;
+
+        const HeightMap& m_heightMap;
+        const VoxelLightMap* m_pLightMap;
+        ChunkStreamingDesc m_desc;
+        UINT m_uNumChunksX;
+        UINT m_uNumChunksZ;
+        UINT m_uMaxPendingChunks;
+        size_t m_uResidentBytes;
+        size_t m_uPendingBytes;
+        std::unordered_map<UINT64, ResidentChunk> m_residentChunks;
+        std::unordered_map<UINT64, std::shared_ptr<ChunkRequest>> m_pendingChunks;
+        std::unordered_set<UINT64> m_dirtyChunks;
+        std::shared_mutex m_mapsMutex;
+        std::mutex m_completedMutex;
+        std::vector<std::shared_ptr<ChunkRequest>> m_completedChunks;
+        std::unique_ptr<ThreadPool> m_threadPool;
+    };
+}
@@ -0,0 +1,1774 @@
+#include "Scene/HeightMap.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::ConvertTextToBinary
+
+      Summary:  Converts a text height map into the binary format
+
+      Args:     const std::filesystem::path& textFilePath
+                  Path to the text height map
+                const std::filesystem::path& binaryFilePath
+                  Path to the binary height map to write
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HeightMap::ConvertTextToBinary(_In_ const std::filesystem::path& textFilePath, _In_ const std::filesystem::path& binaryFilePath)
+    {
+        HeightMap heightMap;
+
+        HRESULT hr = heightMap.LoadFromText(textFilePath);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        return heightMap.SaveToBinary(binaryFilePath);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::IsBinaryFile
+
+      Summary:  Returns whether the file starts with the binary magic
+
+      Args:     const std::filesystem::path& filePath
+                  Path to the height map
+
+      Returns:  BOOL
+                  TRUE if the file is a binary height map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL HeightMap::IsBinaryFile(_In_ const std::filesystem::path& filePath)
+    {
+        std::ifstream inputFile(filePath, std::ios::binary);
+
+        CHAR aMagic[ARRAYSIZE(MAGIC)] = { '\0', };
+        inputFile.read(aMagic, sizeof(aMagic));
+
+        return inputFile.good() && memcmp(aMagic, MAGIC, sizeof(MAGIC)) == 0;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::ExpandColumnInstances
+
+      Summary:  Converts column instances into the equivalent block
+                instances. This is the CPU path for renderers that
+                cannot stretch the cube and stack its texture, and
+                produces the same instances as eVoxelInstancing::BLOCK
+
+      Args:     const std::vector<InstanceData>& aColumnInstanceData
+                  Column instances made by GetColumnTransform
+                std::vector<InstanceData>& aOutBlockInstanceData
+                  Block instances appended in column order
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HeightMap::ExpandColumnInstances(_In_ const std::vector<InstanceData>& aColumnInstanceData, _Inout_ std::vector<InstanceData>& aOutBlockInstanceData)
+    {
+        for (const InstanceData& column : aColumnInstanceData)
+        {
+            XMFLOAT4X4 transform;
+            XMStoreFloat4x4(&transform, column.Transformation);
+
+            const UINT uNumBlocks = static_cast<UINT>(transform.m[1][1] + 0.5f);
+            const FLOAT baseY = transform.m[3][1] - static_cast<FLOAT>(uNumBlocks) + 1.0f;
+            for (UINT y = 0u; y < uNumBlocks; ++y)
+            {
+                aOutBlockInstanceData.push_back(
+                    InstanceData
+                    {
+                        .Transformation = XMMatrixTranslation(transform.m[3][0], baseY + 2.0f * static_cast<FLOAT>(y), transform.m[3][2])
+                    }
+                );
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::PackInstance
+
+      Summary:  Packs a stack of blocks into 8 bytes. Coordinates must
+                fit in 16 bits, and the first block and the number of
+                blocks in 12 bits
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT y
+                  First block of the stack inside the column
+                UINT z
+                  Column index along the z axis
+                UINT uNumBlocks
+                  Number of stacked blocks, 1 for a block instance
+                BYTE type
+                  Palette entry of the blocks
+
+      Returns:  PackedInstanceData
+                  Packed instance
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    PackedInstanceData HeightMap::PackInstance(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ UINT uNumBlocks, _In_ BYTE type)
+    {
+        assert(x <= 0xFFFFu && z <= 0xFFFFu && y <= MAX_PACKED_BLOCK && uNumBlocks <= MAX_PACKED_BLOCK);
+
+        return PackedInstanceData
+        {
+            .uX = static_cast<WORD>(x),
+            .uZ = static_cast<WORD>(z),
+            .uPacked = (y & MAX_PACKED_BLOCK) | ((uNumBlocks & MAX_PACKED_BLOCK) << 12u) | (static_cast<UINT>(type) << 24u)
+        };
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::UnpackInstance
+
+      Summary:  Rebuilds the transformation of a packed instance the
+                same way VSPackedVoxel does. The unit cube is scaled
+                along the y axis by the number of blocks and moved to
+                the center of the stack, so a single block decodes to
+                the translation of GetBlockPosition and a whole column
+                to GetColumnTransform
+
+      Args:     const PackedInstanceData& packedInstance
+                  Packed instance
+                const XMFLOAT3& gridOrigin
+                  World position of the first block of the map, see
+                  GetGridOrigin
+
+      Returns:  XMMATRIX
+                  Transformation of the instance
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    XMMATRIX HeightMap::UnpackInstance(_In_ const PackedInstanceData& packedInstance, _In_ const XMFLOAT3& gridOrigin)
+    {
+        const FLOAT y = static_cast<FLOAT>(packedInstance.uPacked & MAX_PACKED_BLOCK);
+        const FLOAT numBlocks = static_cast<FLOAT>((packedInstance.uPacked >> 12u) & MAX_PACKED_BLOCK);
+
+        return XMMatrixScaling(1.0f, numBlocks, 1.0f)
+            * XMMatrixTranslation(
+                gridOrigin.x + 2.0f * static_cast<FLOAT>(packedInstance.uX),
+                gridOrigin.y + 2.0f * y + numBlocks - 1.0f,
+                gridOrigin.z + 2.0f * static_cast<FLOAT>(packedInstance.uZ)
+            );
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::HeightMap
+
+      Summary:  Constructor
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_uSourceHash,
+                 m_aPalette, m_aColumnHeights, m_aColumnTypes,
+                 m_pColumnHeights, m_pColumnTypes, m_layeredColumns,
+                 m_uNumLayeredColumns, m_hFile, m_hFileMapping,
+                 m_pMappedView].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HeightMap::HeightMap()
+        : m_uWidth(0u)
+        , m_uHeight(0u)
+        , m_uDepth(0u)
+        , m_uSourceHash(0u)
+        , m_aPalette()
+        , m_aColumnHeights()
+        , m_aColumnTypes()
+        , m_pColumnHeights(nullptr)
+        , m_pColumnTypes(nullptr)
+        , m_layeredColumns()
+        , m_uNumLayeredColumns(0u)
+        , m_layeredColumnsMutex()
+        , m_hFile(INVALID_HANDLE_VALUE)
+        , m_hFileMapping(nullptr)
+        , m_pMappedView(nullptr)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::~HeightMap
+
+      Summary:  Destructor. Unmaps the binary file if it was mapped
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HeightMap::~HeightMap()
+    {
+        reset();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::LoadFromFile
+
+      Summary:  Loads a height map, memory-mapping it when it is in the
+                binary format and parsing it otherwise
+
+      Args:     const std::filesystem::path& filePath
+                  Path to the height map
+                ThreadPool* pThreadPool
+                  Thread pool to parse a text height map on
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HeightMap::LoadFromFile(_In_ const std::filesystem::path& filePath, _In_opt_ ThreadPool* pThreadPool)
+    {
+        if (IsBinaryFile(filePath))
+        {
+            return LoadFromBinary(filePath);
+        }
+
+        return LoadFromText(filePath, pThreadPool);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::LoadFromText
+
+      Summary:  Parses a text height map. The first line holds the
+                width, height, depth and number of colors, followed by
+                the palette and one line of columns per depth index.
+                Every column is a block type character directly
+                followed by its height and a single space.
+
+                The column lines are split into ranges that are parsed
+                with std::from_chars on the thread pool. Every range
+                first counts its lines so each one knows the depth
+                index it starts at, so the result does not depend on
+                the number of threads
+
+      Args:     const std::filesystem::path& filePath
+                  Path to the text height map
+                ThreadPool* pThreadPool
+                  Thread pool to parse the columns on. The columns are
+                  parsed on the calling thread if it is null
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_aPalette,
+                 m_aColumnHeights, m_aColumnTypes, m_pColumnHeights,
+                 m_pColumnTypes].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HeightMap::LoadFromText(_In_ const std::filesystem::path& filePath, _In_opt_ ThreadPool* pThreadPool)
+    {
+        reset();
+
+        std::ifstream inputFile(filePath, std::ios::binary);
+        if (!inputFile.is_open())
+        {
+            return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+        }
+
+        std::string text;
+        inputFile.seekg(0, std::ios::end);
+        text.resize(static_cast<size_t>(inputFile.tellg()));
+        inputFile.seekg(0, std::ios::beg);
+        inputFile.read(text.data(), static_cast<std::streamsize>(text.size()));
+        inputFile.close();
+
+        const CHAR* pCursor = text.data();
+        const CHAR* const pEnd = text.data() + text.size();
+
+        // Reads the next number, skipping any token that is not one
+        auto parseNext = [&pCursor, pEnd](auto& outValue) -> BOOL
+        {
+            while (pCursor < pEnd)
+            {
+                while (pCursor < pEnd && isspace(static_cast<unsigned char>(*pCursor)))
+                {
+                    ++pCursor;
+                }
+
+                const std::from_chars_result result = std::from_chars(pCursor, pEnd, outValue);
+                if (result.ec == std::errc())
+                {
+                    pCursor = result.ptr;
+                    return TRUE;
+                }
+
+                while (pCursor < pEnd && !isspace(static_cast<unsigned char>(*pCursor)))
+                {
+                    ++pCursor;
+                }
+            }
+
+            return FALSE;
+        };
+
+        UINT aDimension[4] = { 0u, };
+        for (UINT uDimensionIdx = 0u; uDimensionIdx < ARRAYSIZE(aDimension); ++uDimensionIdx)
+        {
+            if (!parseNext(aDimension[uDimensionIdx]))
+            {
+                break;
+            }
+        }
+
+        m_uWidth = aDimension[0];
+        m_uHeight = aDimension[1];
+        m_uDepth = aDimension[2];
+
+        XMFLOAT4 color(0.0f, 0.0f, 0.0f, 1.0f);
+        while (m_aPalette.size() < aDimension[3] && parseNext(color.x) && parseNext(color.y) && parseNext(color.z))
+        {
+            m_aPalette.push_back(color);
+        }
+
+        pCursor = std::find(pCursor, pEnd, '\n');
+        if (pCursor < pEnd)
+        {
+            ++pCursor;
+        }
+
+        const size_t uNumColumns = static_cast<size_t>(m_uWidth) * static_cast<size_t>(m_uDepth);
+        m_aColumnHeights.assign(uNumColumns, 0u);
+        m_aColumnTypes.assign(uNumColumns, INVALID_TYPE);
+
+        if (uNumColumns > 0u && pCursor < pEnd)
+        {
+            const size_t uDataSize = static_cast<size_t>(pEnd - pCursor);
+            const size_t uMaxNumRanges = uDataSize / MIN_PARSE_RANGE_SIZE > 1u ? uDataSize / MIN_PARSE_RANGE_SIZE : 1u;
+            UINT uNumRanges = pThreadPool ? pThreadPool->GetNumThreads() * 4u : 1u;
+            if (uNumRanges > uMaxNumRanges)
+            {
+                uNumRanges = static_cast<UINT>(uMaxNumRanges);
+            }
+
+            std::vector<const CHAR*> aRangeBegins(uNumRanges + 1u, pEnd);
+            aRangeBegins[0] = pCursor;
+            for (UINT uRangeIdx = 1u; uRangeIdx < uNumRanges; ++uRangeIdx)
+            {
+                const CHAR* pSplit = pCursor + uDataSize * uRangeIdx / uNumRanges;
+                if (pSplit < aRangeBegins[uRangeIdx - 1u])
+                {
+                    pSplit = aRangeBegins[uRangeIdx - 1u];
+                }
+
+                pSplit = std::find(pSplit, pEnd, '\n');
+                aRangeBegins[uRangeIdx] = pSplit < pEnd ? pSplit + 1 : pEnd;
+            }
+
+            auto runRanges = [pThreadPool, uNumRanges](const std::function<void(UINT)>& task)
+            {
+                if (pThreadPool)
+                {
+                    pThreadPool->ParallelFor(uNumRanges, task);
+                }
+                else
+                {
+                    for (UINT uRangeIdx = 0u; uRangeIdx < uNumRanges; ++uRangeIdx)
+                    {
+                        task(uRangeIdx);
+                    }
+                }
+            };
+
+            std::vector<UINT> aFirstDepthIndices(uNumRanges + 1u, 0u);
+            runRanges([&aRangeBegins, &aFirstDepthIndices](UINT uRangeIdx)
+            {
+                aFirstDepthIndices[uRangeIdx + 1u] = countColumnLines(aRangeBegins[uRangeIdx], aRangeBegins[uRangeIdx + 1u]);
+            });
+
+            for (UINT uRangeIdx = 0u; uRangeIdx < uNumRanges; ++uRangeIdx)
+            {
+                aFirstDepthIndices[uRangeIdx + 1u] += aFirstDepthIndices[uRangeIdx];
+            }
+
+            runRanges([this, &aRangeBegins, &aFirstDepthIndices](UINT uRangeIdx)
+            {
+                parseColumnLines(aRangeBegins[uRangeIdx], aRangeBegins[uRangeIdx + 1u], aFirstDepthIndices[uRangeIdx]);
+            });
+        }
+
+        m_pColumnHeights = m_aColumnHeights.data();
+        m_pColumnTypes = m_aColumnTypes.data();
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::LoadFromBinary
+
+      Summary:  Memory-maps a binary height map. The column arrays are
+                read straight from the mapped view, so the load time is
+                bounded by paging the file in. Only the runs of the
+                layered columns are copied out. Files of version 2 have
+                no layered columns
+
+      Args:     const std::filesystem::path& filePath
+                  Path to the binary height map
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_uSourceHash,
+                 m_aPalette, m_pColumnHeights, m_pColumnTypes,
+                 m_layeredColumns, m_uNumLayeredColumns, m_hFile,
+                 m_hFileMapping, m_pMappedView].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HeightMap::LoadFromBinary(_In_ const std::filesystem::path& filePath)
+    {
+        reset();
+
+        m_hFile = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_hFile == INVALID_HANDLE_VALUE)
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(m_hFile, &fileSize) || static_cast<size_t>(fileSize.QuadPart) < sizeof(HeightMapHeader))
+        {
+            reset();
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        m_hFileMapping = CreateFileMappingW(m_hFile, nullptr, PAGE_READONLY, 0u, 0u, nullptr);
+        if (!m_hFileMapping)
+        {
+            HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+            reset();
+            return hr;
+        }
+
+        m_pMappedView = MapViewOfFile(m_hFileMapping, FILE_MAP_READ, 0u, 0u, 0u);
+        if (!m_pMappedView)
+        {
+            HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+            reset();
+            return hr;
+        }
+
+        const BYTE* pData = static_cast<const BYTE*>(m_pMappedView);
+        const HeightMapHeader* pHeader = reinterpret_cast<const HeightMapHeader*>(pData);
+        if (memcmp(pHeader->aMagic, MAGIC, sizeof(MAGIC)) != 0 || pHeader->uVersion < MIN_VERSION || pHeader->uVersion > VERSION)
+        {
+            reset();
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        const size_t uNumColumns = static_cast<size_t>(pHeader->uWidth) * static_cast<size_t>(pHeader->uDepth);
+        const size_t uPaletteOffset = sizeof(HeightMapHeader);
+        const size_t uHeightsOffset = uPaletteOffset + sizeof(XMFLOAT3) * pHeader->uNumColors;
+        const size_t uTypesOffset = uHeightsOffset + sizeof(WORD) * uNumColumns;
+        const size_t uLayersOffset = uTypesOffset + sizeof(BYTE) * uNumColumns;
+        const size_t uFileSize = static_cast<size_t>(fileSize.QuadPart);
+        if (uFileSize < uLayersOffset)
+        {
+            reset();
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        // The runs are not aligned, so they are copied out field by
+        // field
+        if (pHeader->uVersion >= 3u)
+        {
+            size_t uOffset = uLayersOffset;
+            UINT uNumLayeredColumns = 0u;
+            if (uFileSize < uOffset + sizeof(UINT))
+            {
+                reset();
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+            memcpy(&uNumLayeredColumns, pData + uOffset, sizeof(UINT));
+            uOffset += sizeof(UINT);
+
+            for (UINT uLayerIdx = 0u; uLayerIdx < uNumLayeredColumns; ++uLayerIdx)
+            {
+                UINT aColumn[2] = { 0u, 0u };
+                if (uFileSize < uOffset + sizeof(aColumn))
+                {
+                    reset();
+                    return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                }
+                memcpy(aColumn, pData + uOffset, sizeof(aColumn));
+                uOffset += sizeof(aColumn);
+
+                const size_t uRunSize = sizeof(WORD) + sizeof(BYTE);
+                if (aColumn[0] >= uNumColumns || uFileSize < uOffset + uRunSize * aColumn[1])
+                {
+                    reset();
+                    return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                }
+
+                std::vector<ColumnRun> aRuns(aColumn[1]);
+                for (ColumnRun& run : aRuns)
+                {
+                    memcpy(&run.uEndBlock, pData + uOffset, sizeof(WORD));
+                    run.type = pData[uOffset + sizeof(WORD)];
+                    uOffset += uRunSize;
+                }
+                m_layeredColumns[aColumn[0]] = std::move(aRuns);
+            }
+            m_uNumLayeredColumns = m_layeredColumns.size();
+        }
+
+        m_uWidth = pHeader->uWidth;
+        m_uHeight = pHeader->uHeight;
+        m_uDepth = pHeader->uDepth;
+        m_uSourceHash = pHeader->uSourceHash;
+
+        const XMFLOAT3* pPalette = reinterpret_cast<const XMFLOAT3*>(pData + uPaletteOffset);
+        m_aPalette.reserve(pHeader->uNumColors);
+        for (UINT uColorIdx = 0u; uColorIdx < pHeader->uNumColors; ++uColorIdx)
+        {
+            m_aPalette.push_back(XMFLOAT4(pPalette[uColorIdx].x, pPalette[uColorIdx].y, pPalette[uColorIdx].z, 1.0f));
+        }
+
+        m_pColumnHeights = reinterpret_cast<const WORD*>(pData + uHeightsOffset);
+        m_pColumnTypes = pData + uTypesOffset;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::LoadFromGrid
+
+      Summary:  Converts a height map held in memory into columns the
+                same way LoadFromText converts the parsed text, without
+                writing or parsing any file. Columns with an unknown
+                type are left empty
+
+      Args:     const HeightMapGrid& grid
+                  Heights, block types and palette of the map
+                ThreadPool* pThreadPool
+                  Thread pool to convert the rows on. Can be null
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_uSourceHash,
+                 m_aPalette, m_aColumnHeights, m_aColumnTypes,
+                 m_pColumnHeights, m_pColumnTypes].
+
+      Returns:  HRESULT
+                  Status code. E_INVALIDARG if an array is missing
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HeightMap::LoadFromGrid(_In_ const HeightMapGrid& grid, _In_opt_ ThreadPool* pThreadPool)
+    {
+        reset();
+
+        const size_t uNumColumns = static_cast<size_t>(grid.uWidth) * static_cast<size_t>(grid.uDepth);
+        if ((uNumColumns > 0u && (!grid.pHeights || !grid.pBlockTypes)) || (grid.uNumColors > 0u && !grid.pPalette))
+        {
+            return E_INVALIDARG;
+        }
+
+        m_uWidth = grid.uWidth;
+        m_uHeight = grid.uHeight;
+        m_uDepth = grid.uDepth;
+        m_uSourceHash = grid.uSourceHash;
+        m_aPalette.assign(grid.pPalette, grid.pPalette + grid.uNumColors);
+        m_aColumnHeights.assign(uNumColumns, 0u);
+        m_aColumnTypes.assign(uNumColumns, INVALID_TYPE);
+
+        const auto convertRow = [this, &grid](UINT z)
+        {
+            const size_t uRowOffset = static_cast<size_t>(z) * static_cast<size_t>(m_uWidth);
+            for (size_t uIndex = uRowOffset; uIndex < uRowOffset + m_uWidth; ++uIndex)
+            {
+                const eBlockType type = grid.pBlockTypes[uIndex];
+                if (eBlockType::GRASSLAND <= type && type < eBlockType::COUNT)
+                {
+                    m_aColumnHeights[uIndex] = getNumBlocks(m_uHeight, grid.pHeights[uIndex]);
+                    m_aColumnTypes[uIndex] = static_cast<BYTE>(static_cast<CHAR>(type) - static_cast<CHAR>(eBlockType::GRASSLAND));
+                }
+            }
+        };
+
+        if (pThreadPool)
+        {
+            pThreadPool->ParallelFor(m_uDepth, convertRow);
+        }
+        else
+        {
+            for (UINT z = 0u; z < m_uDepth; ++z)
+            {
+                convertRow(z);
+            }
+        }
+
+        m_pColumnHeights = m_aColumnHeights.data();
+        m_pColumnTypes = m_aColumnTypes.data();
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::SaveToBinary
+
+      Summary:  Writes the height map in the binary format
+
+      Args:     const std::filesystem::path& filePath
+                  Path to the binary height map to write
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HeightMap::SaveToBinary(_In_ const std::filesystem::path& filePath) const
+    {
+        std::ofstream outputFile(filePath, std::ios::binary | std::ios::trunc);
+        if (!outputFile.is_open())
+        {
+            return E_FAIL;
+        }
+
+        HeightMapHeader header =
+        {
+            .aMagic = { MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3] },
+            .uVersion = VERSION,
+            .uWidth = m_uWidth,
+            .uHeight = m_uHeight,
+            .uDepth = m_uDepth,
+            .uNumColors = static_cast<UINT>(m_aPalette.size()),
+            .uSourceHash = m_uSourceHash
+        };
+        outputFile.write(reinterpret_cast<const CHAR*>(&header), sizeof(header));
+
+        for (const XMFLOAT4& color : m_aPalette)
+        {
+            XMFLOAT3 rgb(color.x, color.y, color.z);
+            outputFile.write(reinterpret_cast<const CHAR*>(&rgb), sizeof(rgb));
+        }
+
+        const size_t uNumColumns = static_cast<size_t>(m_uWidth) * static_cast<size_t>(m_uDepth);
+        if (uNumColumns > 0u)
+        {
+            outputFile.write(reinterpret_cast<const CHAR*>(m_pColumnHeights), static_cast<std::streamsize>(sizeof(WORD) * uNumColumns));
+            outputFile.write(reinterpret_cast<const CHAR*>(m_pColumnTypes), static_cast<std::streamsize>(sizeof(BYTE) * uNumColumns));
+        }
+
+        {
+            std::shared_lock<std::shared_mutex> lock(m_layeredColumnsMutex);
+
+            const UINT uNumLayeredColumns = static_cast<UINT>(m_layeredColumns.size());
+            outputFile.write(reinterpret_cast<const CHAR*>(&uNumLayeredColumns), sizeof(uNumLayeredColumns));
+            for (auto it = m_layeredColumns.begin(); it != m_layeredColumns.end(); ++it)
+            {
+                const UINT aColumn[2] = { static_cast<UINT>(it->first), static_cast<UINT>(it->second.size()) };
+                outputFile.write(reinterpret_cast<const CHAR*>(aColumn), sizeof(aColumn));
+                for (const ColumnRun& run : it->second)
+                {
+                    outputFile.write(reinterpret_cast<const CHAR*>(&run.uEndBlock), sizeof(run.uEndBlock));
+                    outputFile.write(reinterpret_cast<const CHAR*>(&run.type), sizeof(run.type));
+                }
+            }
+        }
+
+        if (!outputFile.good())
+        {
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
+
+    UINT HeightMap::GetWidth() const
+    {
+        return m_uWidth;
+    }
+
+    UINT HeightMap::GetHeight() const
+    {
+        return m_uHeight;
+    }
+
+    UINT HeightMap::GetDepth() const
+    {
+        return m_uDepth;
+    }
+
+    UINT HeightMap::GetNumColors() const
+    {
+        return static_cast<UINT>(m_aPalette.size());
+    }
+
+    const XMFLOAT4& HeightMap::GetColor(_In_ UINT uIndex) const
+    {
+        assert(uIndex < m_aPalette.size());
+
+        return m_aPalette[uIndex];
+    }
+
+    UINT64 HeightMap::GetSourceHash() const
+    {
+        return m_uSourceHash;
+    }
+
+    const WORD* HeightMap::GetColumnHeights() const
+    {
+        return m_pColumnHeights;
+    }
+
+    const BYTE* HeightMap::GetColumnTypes() const
+    {
+        return m_pColumnTypes;
+    }
+
+    UINT HeightMap::GetColumnHeight(_In_ UINT x, _In_ UINT z) const
+    {
+        assert(x < m_uWidth && z < m_uDepth);
+
+        return m_pColumnHeights[static_cast<size_t>(z) * static_cast<size_t>(m_uWidth) + static_cast<size_t>(x)];
+    }
+
+    BYTE HeightMap::GetColumnType(_In_ UINT x, _In_ UINT z) const
+    {
+        assert(x < m_uWidth && z < m_uDepth);
+
+        return m_pColumnTypes[static_cast<size_t>(z) * static_cast<size_t>(m_uWidth) + static_cast<size_t>(x)];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetColumnRuns
+
+      Summary:  Returns the runs of blocks of a column from the bottom
+                up. A column of a single palette entry is one run, an
+                empty column has none
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT z
+                  Column index along the z axis
+                std::vector<ColumnRun>& aOutRuns
+                  Runs of the column. Cleared first
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HeightMap::GetColumnRuns(_In_ UINT x, _In_ UINT z, _Out_ std::vector<ColumnRun>& aOutRuns) const
+    {
+        assert(x < m_uWidth && z < m_uDepth);
+
+        aOutRuns.clear();
+
+        const size_t uIndex = static_cast<size_t>(z) * static_cast<size_t>(m_uWidth) + static_cast<size_t>(x);
+        const BYTE type = m_pColumnTypes[uIndex];
+        const WORD uNumBlocks = m_pColumnHeights[uIndex];
+        if (type >= GetNumColors() || uNumBlocks == 0u)
+        {
+            return;
+        }
+
+        if (m_uNumLayeredColumns > 0u)
+        {
+            std::shared_lock<std::shared_mutex> lock(m_layeredColumnsMutex);
+            auto it = m_layeredColumns.find(uIndex);
+            if (it != m_layeredColumns.end())
+            {
+                aOutRuns.assign(it->second.begin(), it->second.end());
+                return;
+            }
+        }
+
+        aOutRuns.push_back(ColumnRun{ .uEndBlock = uNumBlocks, .type = type });
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetBlockType
+
+      Summary:  Returns the palette index of a block
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT y
+                  Block index along the y axis
+                UINT z
+                  Column index along the z axis
+
+      Returns:  BYTE
+                  Palette index of the block, INVALID_TYPE if the block
+                  is empty
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BYTE HeightMap::GetBlockType(_In_ UINT x, _In_ UINT y, _In_ UINT z) const
+    {
+        assert(x < m_uWidth && z < m_uDepth);
+
+        const size_t uIndex = static_cast<size_t>(z) * static_cast<size_t>(m_uWidth) + static_cast<size_t>(x);
+        const BYTE type = m_pColumnTypes[uIndex];
+        if (type >= GetNumColors() || y >= m_pColumnHeights[uIndex])
+        {
+            return INVALID_TYPE;
+        }
+
+        if (m_uNumLayeredColumns > 0u)
+        {
+            std::shared_lock<std::shared_mutex> lock(m_layeredColumnsMutex);
+            auto it = m_layeredColumns.find(uIndex);
+            if (it != m_layeredColumns.end())
+            {
+                for (const ColumnRun& run : it->second)
+                {
+                    if (y < run.uEndBlock)
+                    {
+                        return run.type;
+                    }
+                }
+
+                return INVALID_TYPE;
+            }
+        }
+
+        return type;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetBlockPosition
+
+      Summary:  Returns the world position of the center of a block.
+                Blocks are 2 units wide and the map is centered on the
+                origin in the xz plane
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT y
+                  Block index inside the column
+                UINT z
+                  Column index along the z axis
+
+      Returns:  XMFLOAT3
+                  World position of the block
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    XMFLOAT3 HeightMap::GetBlockPosition(_In_ UINT x, _In_ UINT y, _In_ UINT z) const
+    {
+        return XMFLOAT3(
+            2.0f * (static_cast<FLOAT>(x) - static_cast<FLOAT>(m_uWidth) / 2.0f),
+            2.0f * (static_cast<FLOAT>(y) - static_cast<FLOAT>(m_uHeight)) + (static_cast<FLOAT>(m_uHeight) * 0.75f),
+            2.0f * (static_cast<FLOAT>(z) - static_cast<FLOAT>(m_uDepth) / 2.0f)
+        );
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetColumnCoordinates
+
+      Summary:  Returns the column containing a world position. The
+                result may lie outside of the map
+
+      Args:     FLOAT worldX
+                  World position along the x axis
+                FLOAT worldZ
+                  World position along the z axis
+                INT& x
+                  Column index along the x axis
+                INT& z
+                  Column index along the z axis
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HeightMap::GetColumnCoordinates(_In_ FLOAT worldX, _In_ FLOAT worldZ, _Out_ INT& x, _Out_ INT& z) const
+    {
+        x = static_cast<INT>(floorf(worldX / 2.0f + static_cast<FLOAT>(m_uWidth) / 2.0f + 0.5f));
+        z = static_cast<INT>(floorf(worldZ / 2.0f + static_cast<FLOAT>(m_uDepth) / 2.0f + 0.5f));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetColumnTransform
+
+      Summary:  Returns the transform of a column instance. The unit
+                cube is scaled along the y axis by the number of blocks
+                and centered on the column, so it covers exactly the
+                cubes of the block instances of the column
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT z
+                  Column index along the z axis
+
+      Returns:  XMMATRIX
+                  Transform of the column instance
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    XMMATRIX HeightMap::GetColumnTransform(_In_ UINT x, _In_ UINT z) const
+    {
+        return getRunTransform(x, z, 0u, GetColumnHeight(x, z));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetBounds
+
+      Summary:  Returns the world bounding box of the blocks of a
+                rectangle of columns. The box spans every column of the
+                rectangle from the bottom of the map to the top of the
+                highest column
+
+      Args:     UINT uBeginX
+                  First column along the x axis
+                UINT uBeginZ
+                  First column along the z axis
+                UINT uEndX
+                  One past the last column along the x axis
+                UINT uEndZ
+                  One past the last column along the z axis
+                XMFLOAT3& outMin
+                  Minimum corner of the box
+                XMFLOAT3& outMax
+                  Maximum corner of the box
+
+      Modifies: [outMin, outMax].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HeightMap::GetBounds(
+        _In_ UINT uBeginX,
+        _In_ UINT uBeginZ,
+        _In_ UINT uEndX,
+        _In_ UINT uEndZ,
+        _Out_ XMFLOAT3& outMin,
+        _Out_ XMFLOAT3& outMax
+    ) const
+    {
+        uEndX = uEndX < m_uWidth ? uEndX : m_uWidth;
+        uEndZ = uEndZ < m_uDepth ? uEndZ : m_uDepth;
+
+        UINT uMaxHeight = 1u;
+        for (UINT z = uBeginZ; z < uEndZ; ++z)
+        {
+            for (UINT x = uBeginX; x < uEndX; ++x)
+            {
+                const UINT uNumBlocks = GetColumnHeight(x, z);
+                uMaxHeight = uNumBlocks > uMaxHeight ? uNumBlocks : uMaxHeight;
+            }
+        }
+
+        const XMFLOAT3 minCorner = GetBlockPosition(uBeginX, 0u, uBeginZ);
+        const XMFLOAT3 maxCorner = GetBlockPosition(uEndX > uBeginX ? uEndX - 1u : uBeginX, uMaxHeight - 1u, uEndZ > uBeginZ ? uEndZ - 1u : uBeginZ);
+
+        outMin = XMFLOAT3(minCorner.x - 1.0f, minCorner.y - 1.0f, minCorner.z - 1.0f);
+        outMax = XMFLOAT3(maxCorner.x + 1.0f, maxCorner.y + 1.0f, maxCorner.z + 1.0f);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::CountInstances
+
+      Summary:  Returns the number of instances FillInstanceData emits
+                for the columns in [uBeginX, uEndX) x [uBeginZ, uEndZ)
+
+      Args:     UINT uBeginX
+                  First column along the x axis
+                UINT uBeginZ
+                  First column along the z axis
+                UINT uEndX
+                  One past the last column along the x axis
+                UINT uEndZ
+                  One past the last column along the z axis
+                eVoxelInstancing instancing
+                  One instance per block or per column
+
+      Returns:  size_t
+                  Number of instances
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    size_t HeightMap::CountInstances(
+        _In_ UINT uBeginX,
+        _In_ UINT uBeginZ,
+        _In_ UINT uEndX,
+        _In_ UINT uEndZ,
+        _In_ eVoxelInstancing instancing
+    ) const
+    {
+        uEndX = uEndX < m_uWidth ? uEndX : m_uWidth;
+        uEndZ = uEndZ < m_uDepth ? uEndZ : m_uDepth;
+
+        size_t uNumInstances = 0u;
+        std::vector<ColumnRun> aRuns;
+        for (UINT z = uBeginZ; z < uEndZ; ++z)
+        {
+            for (UINT x = uBeginX; x < uEndX; ++x)
+            {
+                GetColumnRuns(x, z, aRuns);
+                uNumInstances += instancing == eVoxelInstancing::COLUMN ? aRuns.size() : (aRuns.empty() ? 0u : aRuns.back().uEndBlock);
+            }
+        }
+
+        return uNumInstances;
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::FillInstanceData
+
+      Summary:  Appends the instances of the columns in
+                [uBeginX, uEndX) x [uBeginZ, uEndZ) to the instance
+                data of their palette entry, either one per block or
+                one per run of a column, so a layered column gets one
+                column instance per palette entry. Columns are visited
+                in row order so the output is deterministic
+
+      Args:     UINT uBeginX
+                  First column along the x axis
+                UINT uBeginZ
+                  First column along the z axis
+                UINT uEndX
+                  One past the last column along the x axis
+                UINT uEndZ
+                  One past the last column along the z axis
+                eVoxelInstancing instancing
+                  One instance per block or per column
+                std::vector<std::vector<InstanceData>>& aOutInstanceData
+                  Instance data per palette entry. Resized to the
+                  number of colors if needed
+
+      Returns:  size_t
+                  Number of instances appended
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    size_t HeightMap::FillInstanceData(
+        _In_ UINT uBeginX,
+        _In_ UINT uBeginZ,
+        _In_ UINT uEndX,
+        _In_ UINT uEndZ,
+        _In_ eVoxelInstancing instancing,
+        _Inout_ std::vector<std::vector<InstanceData>>& aOutInstanceData
+    ) const
+    {
+        const UINT uNumColors = GetNumColors();
+        if (aOutInstanceData.size() < uNumColors)
+        {
+            aOutInstanceData.resize(uNumColors);
+        }
+
+        uEndX = uEndX < m_uWidth ? uEndX : m_uWidth;
+        uEndZ = uEndZ < m_uDepth ? uEndZ : m_uDepth;
+
+        std::vector<size_t> aNumInstances(uNumColors, 0u);
+        std::vector<ColumnRun> aRuns;
+        for (UINT z = uBeginZ; z < uEndZ; ++z)
+        {
+            for (UINT x = uBeginX; x < uEndX; ++x)
+            {
+                GetColumnRuns(x, z, aRuns);
+                UINT uFirstBlock = 0u;
+                for (const ColumnRun& run : aRuns)
+                {
+                    aNumInstances[run.type] += instancing == eVoxelInstancing::COLUMN ? 1u : run.uEndBlock - uFirstBlock;
+                    uFirstBlock = run.uEndBlock;
+                }
+            }
+        }
+
+        size_t uTotalInstances = 0u;
+        for (UINT uColorIdx = 0u; uColorIdx < uNumColors; ++uColorIdx)
+        {
+            aOutInstanceData[uColorIdx].reserve(aOutInstanceData[uColorIdx].size() + aNumInstances[uColorIdx]);
+            uTotalInstances += aNumInstances[uColorIdx];
+        }
+
+        for (UINT z = uBeginZ; z < uEndZ; ++z)
+        {
+            for (UINT x = uBeginX; x < uEndX; ++x)
+            {
+                GetColumnRuns(x, z, aRuns);
+                UINT uFirstBlock = 0u;
+                for (const ColumnRun& run : aRuns)
+                {
+                    if (instancing == eVoxelInstancing::COLUMN)
+                    {
+                        aOutInstanceData[run.type].push_back(InstanceData{ .Transformation = getRunTransform(x, z, uFirstBlock, run.uEndBlock - uFirstBlock) });
+                        uFirstBlock = run.uEndBlock;
+                        continue;
+                    }
+
+                    for (UINT y = uFirstBlock; y < run.uEndBlock; ++y)
+                    {
+                        const XMFLOAT3 position = GetBlockPosition(x, y, z);
+                        aOutInstanceData[run.type].push_back(
+                            InstanceData
+                            {
+                                .Transformation = XMMatrixTranslation(position.x, position.y, position.z)
+                            }
+                        );
+                    }
+                    uFirstBlock = run.uEndBlock;
+                }
+            }
+        }
+
+        return uTotalInstances;
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::FillPackedInstanceData
+
+      Summary:  Same as FillInstanceData with 8 byte instances. Columns
+                are clamped to MAX_PACKED_BLOCK blocks
+
+      Args:     UINT uBeginX
+                  First column along the x axis
+                UINT uBeginZ
+                  First column along the z axis
+                UINT uEndX
+                  One past the last column along the x axis
+                UINT uEndZ
+                  One past the last column along the z axis
+                eVoxelInstancing instancing
+                  One instance per block or per column
+                std::vector<std::vector<PackedInstanceData>>& aOutInstanceData
+                  Instance data per palette entry. Resized to the
+                  number of colors if needed
+
+      Returns:  size_t
+                  Number of instances appended
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    size_t HeightMap::FillPackedInstanceData(
+        _In_ UINT uBeginX,
+        _In_ UINT uBeginZ,
+        _In_ UINT uEndX,
+        _In_ UINT uEndZ,
+        _In_ eVoxelInstancing instancing,
+        _Inout_ std::vector<std::vector<PackedInstanceData>>& aOutInstanceData
+    ) const
+    {
+        const UINT uNumColors = GetNumColors();
+        if (aOutInstanceData.size() < uNumColors)
+        {
+            aOutInstanceData.resize(uNumColors);
+        }
+
+        uEndX = uEndX < m_uWidth ? uEndX : m_uWidth;
+        uEndZ = uEndZ < m_uDepth ? uEndZ : m_uDepth;
+
+        size_t uTotalInstances = 0u;
+        std::vector<ColumnRun> aRuns;
+        for (UINT z = uBeginZ; z < uEndZ; ++z)
+        {
+            for (UINT x = uBeginX; x < uEndX; ++x)
+            {
+                GetColumnRuns(x, z, aRuns);
+                UINT uFirstBlock = 0u;
+                for (const ColumnRun& run : aRuns)
+                {
+                    const UINT uEndBlock = run.uEndBlock < MAX_PACKED_BLOCK ? run.uEndBlock : MAX_PACKED_BLOCK;
+                    if (uFirstBlock >= uEndBlock)
+                    {
+                        break;
+                    }
+
+                    if (instancing == eVoxelInstancing::COLUMN)
+                    {
+                        aOutInstanceData[run.type].push_back(PackInstance(x, uFirstBlock, z, uEndBlock - uFirstBlock, run.type));
+                        ++uTotalInstances;
+                    }
+                    else
+                    {
+                        for (UINT y = uFirstBlock; y < uEndBlock; ++y)
+                        {
+                            aOutInstanceData[run.type].push_back(PackInstance(x, y, z, 1u, run.type));
+                        }
+                        uTotalInstances += uEndBlock - uFirstBlock;
+                    }
+                    uFirstBlock = uEndBlock;
+                }
+            }
+        }
+
+        return uTotalInstances;
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::GetGridOrigin
+
+      Summary:  Returns the world position of the center of the first
+                block of the map. Packed instances are relative to it
+
+      Returns:  XMFLOAT3
+                  World position of block (0, 0, 0)
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    XMFLOAT3 HeightMap::GetGridOrigin() const
+    {
+        return GetBlockPosition(0u, 0u, 0u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::FillPalette
+
+      Summary:  Copies the palette into the constant buffer the vertex
+                shader resolves the palette entry of packed instances
+                against. Entries past the palette are black
+
+      Args:     CBPalette& outPalette
+                  Palette constant buffer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HeightMap::FillPalette(_Out_ CBPalette& outPalette) const
+    {
+        const size_t uNumColors = m_aPalette.size() < MAX_PALETTE_SIZE ? m_aPalette.size() : MAX_PALETTE_SIZE;
+        for (size_t i = 0u; i < MAX_PALETTE_SIZE; ++i)
+        {
+            outPalette.Colors[i] = i < uNumColors ? m_aPalette[i] : XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::UnpackInstanceColor
+
+      Summary:  Returns the color of a packed instance the same way
+                VSPackedVoxel reads it from the palette constant buffer
+
+      Args:     const PackedInstanceData& packedInstance
+                  Packed instance
+
+      Returns:  XMFLOAT4
+                  Palette color of the instance, black if the palette
+                  entry is out of the palette
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    XMFLOAT4 HeightMap::UnpackInstanceColor(_In_ const PackedInstanceData& packedInstance) const
+    {
+        const UINT uIndex = packedInstance.uPacked >> 24u;
+
+        return uIndex < m_aPalette.size() ? m_aPalette[uIndex] : XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::ValidatePackedInstances
+
+      Summary:  Fills the full and the packed instances of the whole
+                map, decodes every packed instance with UnpackInstance
+                and UnpackInstanceColor and compares it to the full
+                instance at the same position. Both fills visit the
+                runs in the same order, so the instances of a palette
+                entry line up. Columns taller than MAX_PACKED_BLOCK
+                blocks are clamped and show up as mismatches
+
+      Args:     eVoxelInstancing instancing
+                  One instance per block or per column
+                PackedInstanceValidationStats& outStats
+                  Number of instances compared and of mismatches
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HeightMap::ValidatePackedInstances(_In_ eVoxelInstancing instancing, _Out_ PackedInstanceValidationStats& outStats) const
+    {
+        outStats = PackedInstanceValidationStats{};
+
+        std::vector<std::vector<InstanceData>> aInstanceData;
+        std::vector<std::vector<PackedInstanceData>> aPackedInstanceData;
+        FillInstanceData(0u, 0u, m_uWidth, m_uDepth, instancing, aInstanceData);
+        FillPackedInstanceData(0u, 0u, m_uWidth, m_uDepth, instancing, aPackedInstanceData);
+
+        const XMFLOAT3 gridOrigin = GetGridOrigin();
+        for (size_t uColorIdx = 0u; uColorIdx < aInstanceData.size(); ++uColorIdx)
+        {
+            const std::vector<InstanceData>& aInstances = aInstanceData[uColorIdx];
+            const std::vector<PackedInstanceData>& aPackedInstances = aPackedInstanceData[uColorIdx];
+            const size_t uNumInstances = aInstances.size() > aPackedInstances.size() ? aInstances.size() : aPackedInstances.size();
+            for (size_t i = 0u; i < uNumInstances; ++i)
+            {
+                ++outStats.uNumInstances;
+                if (i >= aInstances.size() || i >= aPackedInstances.size())
+                {
+                    ++outStats.uNumMismatches;
+                    continue;
+                }
+
+                XMFLOAT4X4 expected;
+                XMFLOAT4X4 unpacked;
+                XMStoreFloat4x4(&expected, aInstances[i].Transformation);
+                XMStoreFloat4x4(&unpacked, UnpackInstance(aPackedInstances[i], gridOrigin));
+
+                FLOAT error = 0.0f;
+                for (UINT uRow = 0u; uRow < 4u; ++uRow)
+                {
+                    for (UINT uColumn = 0u; uColumn < 4u; ++uColumn)
+                    {
+                        const FLOAT difference = fabsf(expected.m[uRow][uColumn] - unpacked.m[uRow][uColumn]);
+                        error = difference > error ? difference : error;
+                    }
+                }
+                outStats.maxError = error > outStats.maxError ? error : outStats.maxError;
+
+                const XMFLOAT4 color = UnpackInstanceColor(aPackedInstances[i]);
+                const XMFLOAT4& expectedColor = m_aPalette[uColorIdx];
+                if (error != 0.0f
+                    || color.x != expectedColor.x || color.y != expectedColor.y
+                    || color.z != expectedColor.z || color.w != expectedColor.w)
+                {
+                    ++outStats.uNumMismatches;
+                }
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::SetColumn
+
+      Summary:  Changes the height and type of a column, which becomes
+                a single run. A memory mapped map is copied into owned
+                arrays on the first edit. The map no longer matches the inputs it was
+                generated from, so its source hash is cleared. Must not
+                be called while other threads read the columns being
+                changed
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT z
+                  Column index along the z axis
+                UINT uNumBlocks
+                  New number of blocks of the column
+                BYTE type
+                  New palette entry of the column
+
+      Modifies: [m_uSourceHash, m_aColumnHeights, m_aColumnTypes,
+                 m_pColumnHeights, m_pColumnTypes, m_layeredColumns,
+                 m_uNumLayeredColumns].
+
+      Returns:  HRESULT
+                  Status code. E_INVALIDARG if the column is outside of
+                  the map or the type is not in the palette
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HeightMap::SetColumn(_In_ UINT x, _In_ UINT z, _In_ UINT uNumBlocks, _In_ BYTE type)
+    {
+        if (x >= m_uWidth || z >= m_uDepth || type >= GetNumColors() || uNumBlocks > 0xFFFFu)
+        {
+            return E_INVALIDARG;
+        }
+
+        makeWritable();
+
+        const size_t uIndex = static_cast<size_t>(z) * static_cast<size_t>(m_uWidth) + static_cast<size_t>(x);
+        m_aColumnTypes[uIndex] = type;
+        std::vector<ColumnRun> aRuns;
+        if (uNumBlocks > 0u)
+        {
+            aRuns.push_back(ColumnRun{ .uEndBlock = static_cast<WORD>(uNumBlocks), .type = type });
+        }
+        setColumnRuns(uIndex, std::move(aRuns));
+        m_uSourceHash = 0u;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::SetBlock
+
+      Summary:  Changes the type of a block. The run holding it is
+                split, and a block above the column grows the column to
+                reach it with blocks of the new type since columns have
+                no holes. Same threading rules as SetColumn
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT y
+                  Block index along the y axis
+                UINT z
+                  Column index along the z axis
+                BYTE type
+                  New palette entry of the block
+
+      Modifies: [m_uSourceHash, m_aColumnHeights, m_aColumnTypes,
+                 m_pColumnHeights, m_pColumnTypes, m_layeredColumns,
+                 m_uNumLayeredColumns].
+
+      Returns:  HRESULT
+                  Status code. E_INVALIDARG if the block is outside of
+                  the map or the type is not in the palette
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HeightMap::SetBlock(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ BYTE type)
+    {
+        if (x >= m_uWidth || z >= m_uDepth || type >= GetNumColors() || y >= 0xFFFFu)
+        {
+            return E_INVALIDARG;
+        }
+
+        std::vector<ColumnRun> aRuns;
+        GetColumnRuns(x, z, aRuns);
+
+        if (aRuns.empty() || y >= aRuns.back().uEndBlock)
+        {
+            aRuns.push_back(ColumnRun{ .uEndBlock = static_cast<WORD>(y + 1u), .type = type });
+        }
+        else
+        {
+            size_t uRunIdx = 0u;
+            while (aRuns[uRunIdx].uEndBlock <= y)
+            {
+                ++uRunIdx;
+            }
+
+            const UINT uFirstBlock = uRunIdx > 0u ? aRuns[uRunIdx - 1u].uEndBlock : 0u;
+            const ColumnRun run = aRuns[uRunIdx];
+            std::vector<ColumnRun> aSplit;
+            if (y > uFirstBlock)
+            {
+                aSplit.push_back(ColumnRun{ .uEndBlock = static_cast<WORD>(y), .type = run.type });
+            }
+            aSplit.push_back(ColumnRun{ .uEndBlock = static_cast<WORD>(y + 1u), .type = type });
+            if (y + 1u < run.uEndBlock)
+            {
+                aSplit.push_back(run);
+            }
+
+            aRuns.erase(aRuns.begin() + static_cast<ptrdiff_t>(uRunIdx));
+            aRuns.insert(aRuns.begin() + static_cast<ptrdiff_t>(uRunIdx), aSplit.begin(), aSplit.end());
+        }
+
+        makeWritable();
+        setColumnRuns(static_cast<size_t>(z) * static_cast<size_t>(m_uWidth) + static_cast<size_t>(x), std::move(aRuns));
+        m_uSourceHash = 0u;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::TruncateColumn
+
+      Summary:  Removes the blocks of a column from a height up, keeping
+                the runs below it. Same threading rules as SetColumn
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT z
+                  Column index along the z axis
+                UINT uNumBlocks
+                  Number of blocks left in the column
+
+      Modifies: [m_uSourceHash, m_aColumnHeights, m_aColumnTypes,
+                 m_pColumnHeights, m_pColumnTypes, m_layeredColumns,
+                 m_uNumLayeredColumns].
+
+      Returns:  HRESULT
+                  Status code. E_INVALIDARG if the column is outside of
+                  the map, S_FALSE if the column is not higher than
+                  uNumBlocks
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HeightMap::TruncateColumn(_In_ UINT x, _In_ UINT z, _In_ UINT uNumBlocks)
+    {
+        if (x >= m_uWidth || z >= m_uDepth)
+        {
+            return E_INVALIDARG;
+        }
+
+        std::vector<ColumnRun> aRuns;
+        GetColumnRuns(x, z, aRuns);
+        if (aRuns.empty() || aRuns.back().uEndBlock <= uNumBlocks)
+        {
+            return S_FALSE;
+        }
+
+        while (!aRuns.empty() && (aRuns.size() == 1u ? 0u : aRuns[aRuns.size() - 2u].uEndBlock) >= uNumBlocks)
+        {
+            aRuns.pop_back();
+        }
+        if (!aRuns.empty())
+        {
+            aRuns.back().uEndBlock = static_cast<WORD>(uNumBlocks);
+        }
+
+        makeWritable();
+        setColumnRuns(static_cast<size_t>(z) * static_cast<size_t>(m_uWidth) + static_cast<size_t>(x), std::move(aRuns));
+        m_uSourceHash = 0u;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::SetColumnRuns
+
+      Summary:  Replaces the runs of a column, as read back from a
+                world save. Same threading rules as SetColumn
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT z
+                  Column index along the z axis
+                std::vector<ColumnRun>&& aRuns
+                  New runs of the column, from the bottom up. Empty to
+                  clear the column
+
+      Modifies: [m_uSourceHash, m_aColumnHeights, m_aColumnTypes,
+                 m_pColumnHeights, m_pColumnTypes, m_layeredColumns,
+                 m_uNumLayeredColumns].
+
+      Returns:  HRESULT
+                  Status code. E_INVALIDARG if the column is outside of
+                  the map, the runs do not grow or a type is not in the
+                  palette
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT HeightMap::SetColumnRuns(_In_ UINT x, _In_ UINT z, _In_ std::vector<ColumnRun>&& aRuns)
+    {
+        if (x >= m_uWidth || z >= m_uDepth)
+        {
+            return E_INVALIDARG;
+        }
+
+        UINT uFirstBlock = 0u;
+        for (const ColumnRun& run : aRuns)
+        {
+            if (run.uEndBlock <= uFirstBlock || run.type >= GetNumColors())
+            {
+                return E_INVALIDARG;
+            }
+            uFirstBlock = run.uEndBlock;
+        }
+
+        makeWritable();
+        setColumnRuns(static_cast<size_t>(z) * static_cast<size_t>(m_uWidth) + static_cast<size_t>(x), std::move(aRuns));
+        m_uSourceHash = 0u;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::isBlankLine
+
+      Summary:  Returns whether a line only contains white spaces
+
+      Args:     const CHAR* pBegin
+                  First character of the line
+                const CHAR* pEnd
+                  One past the last character of the line
+
+      Returns:  BOOL
+                  TRUE if the line is blank
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL HeightMap::isBlankLine(_In_ const CHAR* pBegin, _In_ const CHAR* pEnd)
+    {
+        return std::all_of(pBegin, pEnd, [](CHAR c) { return isspace(static_cast<unsigned char>(c)) != 0; });
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::countColumnLines
+
+      Summary:  Returns the number of non-blank lines in a range of
+                column lines
+
+      Args:     const CHAR* pBegin
+                  First character of the range, at a line start
+                const CHAR* pEnd
+                  One past the last character of the range
+
+      Returns:  UINT
+                  Number of column lines
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT HeightMap::countColumnLines(_In_ const CHAR* pBegin, _In_ const CHAR* pEnd)
+    {
+        UINT uNumLines = 0u;
+        while (pBegin < pEnd)
+        {
+            const CHAR* pLineEnd = std::find(pBegin, pEnd, '\n');
+            if (!isBlankLine(pBegin, pLineEnd))
+            {
+                ++uNumLines;
+            }
+            pBegin = pLineEnd < pEnd ? pLineEnd + 1 : pEnd;
+        }
+
+        return uNumLines;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::getNumBlocks
+
+      Summary:  Returns the number of blocks of a column from its
+                normalized height
+
+      Args:     UINT uHeight
+                  Number of blocks of a column of height 1
+                FLOAT height
+                  Normalized height of the column
+
+      Returns:  WORD
+                  Number of blocks, clamped to the column height range
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    WORD HeightMap::getNumBlocks(_In_ UINT uHeight, _In_ FLOAT height)
+    {
+        const UINT uNumBlocks = static_cast<UINT>(static_cast<FLOAT>(uHeight) * height);
+
+        return static_cast<WORD>(uNumBlocks > 0xFFFFu ? 0xFFFFu : uNumBlocks);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::parseColumnLines
+
+      Summary:  Parses a range of column lines. The block type is read
+                by position rather than as a token, so the type whose
+                character is a space is not mistaken for a separator.
+                Columns with an unknown type are skipped
+
+      Args:     const CHAR* pBegin
+                  First character of the range, at a line start
+                const CHAR* pEnd
+                  One past the last character of the range
+                UINT uFirstDepthIdx
+                  Depth index of the first non-blank line of the range
+
+      Modifies: [m_aColumnHeights, m_aColumnTypes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HeightMap::parseColumnLines(_In_ const CHAR* pBegin, _In_ const CHAR* pEnd, _In_ UINT uFirstDepthIdx)
+    {
+        UINT uDepthIdx = uFirstDepthIdx;
+        while (pBegin < pEnd && uDepthIdx < m_uDepth)
+        {
+            const CHAR* pLineEnd = std::find(pBegin, pEnd, '\n');
+            const CHAR* pNextLine = pLineEnd < pEnd ? pLineEnd + 1 : pEnd;
+            if (pLineEnd > pBegin && *(pLineEnd - 1) == '\r')
+            {
+                --pLineEnd;
+            }
+
+            if (isBlankLine(pBegin, pLineEnd))
+            {
+                pBegin = pNextLine;
+                continue;
+            }
+
+            const size_t uRowOffset = static_cast<size_t>(uDepthIdx) * static_cast<size_t>(m_uWidth);
+            const CHAR* pCursor = pBegin;
+            UINT uWidthIdx = 0u;
+            while (pCursor < pLineEnd && uWidthIdx < m_uWidth)
+            {
+                const CHAR voxelType = *pCursor++;
+
+                FLOAT height = 0.0f;
+                const std::from_chars_result result = std::from_chars(pCursor, pLineEnd, height);
+                if (result.ec != std::errc())
+                {
+                    break;
+                }
+
+                pCursor = result.ptr;
+                if (pCursor < pLineEnd && *pCursor == ' ')
+                {
+                    ++pCursor;
+                }
+
+                if (static_cast<CHAR>(eBlockType::GRASSLAND) <= voxelType && voxelType < static_cast<CHAR>(eBlockType::COUNT))
+                {
+                    m_aColumnHeights[uRowOffset + uWidthIdx] = getNumBlocks(m_uHeight, height);
+                    m_aColumnTypes[uRowOffset + uWidthIdx] = static_cast<BYTE>(voxelType - static_cast<CHAR>(eBlockType::GRASSLAND));
+                    ++uWidthIdx;
+                }
+            }
+
+            ++uDepthIdx;
+            pBegin = pNextLine;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::getRunTransform
+
+      Summary:  Returns the transform of an instance covering a run of
+                blocks of a column. The unit cube is scaled along the y
+                axis by the number of blocks and centered on the run
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT z
+                  Column index along the z axis
+                UINT uFirstBlock
+                  First block of the run
+                UINT uNumBlocks
+                  Number of blocks of the run
+
+      Returns:  XMMATRIX
+                  Transform of the instance
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    XMMATRIX HeightMap::getRunTransform(_In_ UINT x, _In_ UINT z, _In_ UINT uFirstBlock, _In_ UINT uNumBlocks) const
+    {
+        const XMFLOAT3 base = GetBlockPosition(x, uFirstBlock, z);
+
+        return XMMatrixScaling(1.0f, static_cast<FLOAT>(uNumBlocks), 1.0f)
+            * XMMatrixTranslation(base.x, base.y + static_cast<FLOAT>(uNumBlocks) - 1.0f, base.z);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::setColumnRuns
+
+      Summary:  Stores the runs of a column of the owned arrays. Runs
+                of the same palette entry are merged, the height and
+                type arrays take the top of the column, and only
+                columns left with several runs stay in the side table.
+                An empty column keeps its type
+
+      Args:     size_t uIndex
+                  Index of the column
+                std::vector<ColumnRun>&& aRuns
+                  Runs of the column from the bottom up
+
+      Modifies: [m_aColumnHeights, m_aColumnTypes, m_layeredColumns,
+                 m_uNumLayeredColumns].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HeightMap::setColumnRuns(_In_ size_t uIndex, _In_ std::vector<ColumnRun>&& aRuns)
+    {
+        size_t uNumRuns = 0u;
+        for (size_t i = 0u; i < aRuns.size(); ++i)
+        {
+            if (uNumRuns > 0u && aRuns[uNumRuns - 1u].type == aRuns[i].type)
+            {
+                aRuns[uNumRuns - 1u].uEndBlock = aRuns[i].uEndBlock;
+                continue;
+            }
+            aRuns[uNumRuns++] = aRuns[i];
+        }
+        aRuns.resize(uNumRuns);
+
+        m_aColumnHeights[uIndex] = aRuns.empty() ? 0u : aRuns.back().uEndBlock;
+        if (!aRuns.empty())
+        {
+            m_aColumnTypes[uIndex] = aRuns.back().type;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(m_layeredColumnsMutex);
+        if (aRuns.size() > 1u)
+        {
+            m_layeredColumns[uIndex] = std::move(aRuns);
+        }
+        else
+        {
+            m_layeredColumns.erase(uIndex);
+        }
+        m_uNumLayeredColumns = m_layeredColumns.size();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::makeWritable
+
+      Summary:  Copies the columns of a memory mapped map into the
+                owned arrays. The view stays mapped until the map is
+                reset so readers holding the old pointers stay valid
+
+      Modifies: [m_aColumnHeights, m_aColumnTypes, m_pColumnHeights,
+                 m_pColumnTypes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HeightMap::makeWritable()
+    {
+        if (m_pColumnHeights == m_aColumnHeights.data() && m_pColumnTypes == m_aColumnTypes.data())
+        {
+            return;
+        }
+
+        const size_t uNumColumns = static_cast<size_t>(m_uWidth) * static_cast<size_t>(m_uDepth);
+        m_aColumnHeights.assign(m_pColumnHeights, m_pColumnHeights + uNumColumns);
+        m_aColumnTypes.assign(m_pColumnTypes, m_pColumnTypes + uNumColumns);
+        m_pColumnHeights = m_aColumnHeights.data();
+        m_pColumnTypes = m_aColumnTypes.data();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   HeightMap::reset
+
+      Summary:  Releases the mapped view, the owned column arrays and
+                the runs of the layered columns
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_uSourceHash,
+                 m_aPalette, m_aColumnHeights, m_aColumnTypes,
+                 m_pColumnHeights, m_pColumnTypes, m_layeredColumns,
+                 m_uNumLayeredColumns, m_hFile, m_hFileMapping,
+                 m_pMappedView].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void HeightMap::reset()
+    {
+        if (m_pMappedView)
+        {
+            UnmapViewOfFile(m_pMappedView);
+            m_pMappedView = nullptr;
+        }
+
+        if (m_hFileMapping)
+        {
+            CloseHandle(m_hFileMapping);
+            m_hFileMapping = nullptr;
+        }
+
+        if (m_hFile != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_hFile);
+            m_hFile = INVALID_HANDLE_VALUE;
+        }
+
+        m_uWidth = 0u;
+        m_uHeight = 0u;
+        m_uDepth = 0u;
+        m_uSourceHash = 0u;
+        m_aPalette.clear();
+        m_aColumnHeights.clear();
+        m_aColumnTypes.clear();
+        m_pColumnHeights = nullptr;
+        m_pColumnTypes = nullptr;
+
+        std::unique_lock<std::shared_mutex> lock(m_layeredColumnsMutex);
+        m_layeredColumns.clear();
+        m_uNumLayeredColumns = 0u;
+    }
+}
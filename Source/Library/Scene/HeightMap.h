@@ -0,0 +1,342 @@
+/*+===================================================================
+  File:      HEIGHTMAP.H
+
+  Summary:   HeightMap header file contains declarations of HeightMap
+             class used for the lab samples of Game Graphics
+             Programming course.
+
+  Classes: HeightMap
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <atomic>
+#include <shared_mutex>
+
+#include "Renderer/DataTypes.h"
+#include "Thread/ThreadPool.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   HeightMapHeader
+
+      Summary:  Header of the binary height map file. It is followed by
+                uNumColors XMFLOAT3 palette entries, uWidth * uDepth
+                WORD column heights and uWidth * uDepth BYTE column
+                types, so every array is naturally aligned. Since
+                version 3 they are followed by the layered columns: a
+                UINT count, then for every column its UINT index, its
+                UINT number of runs and the runs as a WORD end block
+                and a BYTE type each. uSourceHash identifies the inputs
+                the map was generated from, 0 when it was converted
+                from a text height map
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct HeightMapHeader
+    {
+        CHAR aMagic[4];
+        UINT uVersion;
+        UINT uWidth;
+        UINT uHeight;
+        UINT uDepth;
+        UINT uNumColors;
+        UINT64 uSourceHash;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ColumnRun
+
+      Summary:  Run of blocks of the same palette entry in a column.
+                Runs are stacked from the bottom of the column, each
+                one starting where the one below ends
+
+                uEndBlock
+                  One past the last block of the run
+                type
+                  Palette entry of the blocks of the run
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ColumnRun
+    {
+        WORD uEndBlock;
+        BYTE type;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   HeightMapGrid
+
+      Summary:  View of a height map held in memory, with the same
+                content as the text format: a normalized height and a
+                block type per column, row major, and the palette. The
+                arrays are only read while the map is loaded
+
+                uWidth
+                  Number of columns along the x axis
+                uHeight
+                  Number of blocks of a column of height 1
+                uDepth
+                  Number of columns along the z axis
+                pHeights
+                  uWidth * uDepth normalized column heights
+                pBlockTypes
+                  uWidth * uDepth column types
+                pPalette
+                  uNumColors palette entries
+                uNumColors
+                  Number of palette entries
+                uSourceHash
+                  Hash of the inputs the grid was generated from, 0 if
+                  unknown
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct HeightMapGrid
+    {
+        UINT uWidth;
+        UINT uHeight;
+        UINT uDepth;
+        const FLOAT* pHeights;
+        const eBlockType* pBlockTypes;
+        const XMFLOAT4* pPalette;
+        UINT uNumColors;
+        UINT64 uSourceHash;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   PackedInstanceValidationStats
+
+      Summary:  Result of checking the packed instances of a map
+                against the full instance matrices
+
+                uNumInstances
+                  Number of instances compared
+                uNumMismatches
+                  Number of packed instances that do not decode to the
+                  matrix and palette entry of their full instance
+                maxError
+                  Largest difference of a matrix element
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct PackedInstanceValidationStats
+    {
+        UINT64 uNumInstances;
+        UINT64 uNumMismatches;
+        FLOAT maxError;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    HeightMap
+
+      Summary:  Column based voxel map. Every (x, z) column stores the
+                number of stacked blocks and the palette index of its
+                top block in 3 bytes. Columns made of several palette
+                entries, after block edits, also keep their run-length
+                encoded runs in a side table, a few bytes per run.
+                Columns have no holes. Can be parsed from the text
+                format or memory-mapped from the binary format without
+                any parsing
+
+      Methods:  ConvertTextToBinary
+                  Converts a text height map into the binary format
+                IsBinaryFile
+                  Returns whether the file starts with the binary magic
+                LoadFromFile
+                  Loads a text or binary height map
+                LoadFromText
+                  Parses a text height map, in parallel if a thread
+                  pool is given
+                LoadFromBinary
+                  Memory-maps a binary height map
+                LoadFromGrid
+                  Converts a height map held in memory without any
+                  file or text round trip
+                SaveToBinary
+                  Writes the height map in the binary format
+                GetWidth
+                  Returns the number of columns along the x axis
+                GetHeight
+                  Returns the vertical scale of the map
+                GetDepth
+                  Returns the number of columns along the z axis
+                GetNumColors
+                  Returns the number of palette entries
+                GetColor
+                  Returns a palette entry
+                GetSourceHash
+                  Returns the hash of the inputs the map was generated
+                  from
+                GetColumnHeights
+                  Returns the column height array
+                GetColumnTypes
+                  Returns the column palette index array
+                GetColumnHeight
+                  Returns the number of blocks in a column
+                GetColumnType
+                  Returns the palette index of the top block of a
+                  column
+                GetColumnRuns
+                  Returns the runs of blocks of a column
+                GetBlockType
+                  Returns the palette index of a block
+                GetBlockPosition
+                  Returns the world position of a block
+                GetColumnCoordinates
+                  Returns the column containing a world position
+                GetColumnTransform
+                  Returns the transform of a column instance
+                GetBounds
+                  Returns the world bounding box of the blocks of a
+                  rectangle of columns
+                CountInstances
+                  Returns the number of instances of a rectangle of
+                  columns
+                FillInstanceData
+                  Appends the instance data of a rectangle of columns
+                FillPackedInstanceData
+                  Appends the packed instance data of a rectangle of
+                  columns
+                GetGridOrigin
+                  Returns the world position packed instances are
+                  relative to
+                FillPalette
+                  Copies the palette into the constant buffer read by
+                  the vertex shader
+                UnpackInstanceColor
+                  CPU reference of the palette lookup done by the
+                  vertex shader
+                SetColumn
+                  Changes the height and type of a column
+                SetBlock
+                  Changes the type of a block, growing the column to
+                  reach it if needed
+                TruncateColumn
+                  Removes the blocks of a column above a height
+                SetColumnRuns
+                  Replaces the runs of a column
+                ExpandColumnInstances
+                  Converts column instances into block instances
+                PackInstance
+                  Packs a block or column into 8 bytes
+                UnpackInstance
+                  CPU reference of the packed instance decoding done by
+                  the vertex shader
+                ValidatePackedInstances
+                  Checks that every packed instance of the map decodes
+                  to the matrix of its full instance
+                HeightMap
+                  Constructor.
+                ~HeightMap
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class HeightMap
+    {
+    public:
+        static constexpr const CHAR MAGIC[4] = { 'V', 'X', 'H', 'M' };
+        static constexpr const UINT VERSION = 3u;
+        static constexpr const UINT MIN_VERSION = 2u;
+        static constexpr const BYTE INVALID_TYPE = 0xFF;
+        static constexpr const size_t MIN_PARSE_RANGE_SIZE = 64u * 1024u;
+        static constexpr const UINT MAX_PACKED_BLOCK = 0xFFFu;
+
+        static HRESULT ConvertTextToBinary(_In_ const std::filesystem::path& textFilePath, _In_ const std::filesystem::path& binaryFilePath);
+        static BOOL IsBinaryFile(_In_ const std::filesystem::path& filePath);
+        static void ExpandColumnInstances(_In_ const std::vector<InstanceData>& aColumnInstanceData, _Inout_ std::vector<InstanceData>& aOutBlockInstanceData);
+        static PackedInstanceData PackInstance(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ UINT uNumBlocks, _In_ BYTE type);
+        static XMMATRIX UnpackInstance(_In_ const PackedInstanceData& packedInstance, _In_ const XMFLOAT3& gridOrigin);
+
+        HeightMap();
+        HeightMap(const HeightMap& other) = delete;
+        HeightMap(HeightMap&& other) = delete;
+        HeightMap& operator=(const HeightMap& other) = delete;
+        HeightMap& operator=(HeightMap&& other) = delete;
+        ~HeightMap();
+
+        HRESULT LoadFromFile(_In_ const std::filesystem::path& filePath, _In_opt_ ThreadPool* pThreadPool = nullptr);
+        HRESULT LoadFromText(_In_ const std::filesystem::path& filePath, _In_opt_ ThreadPool* pThreadPool = nullptr);
+        HRESULT LoadFromBinary(_In_ const std::filesystem::path& filePath);
+        HRESULT LoadFromGrid(_In_ const HeightMapGrid& grid, _In_opt_ ThreadPool* pThreadPool = nullptr);
+        HRESULT SaveToBinary(_In_ const std::filesystem::path& filePath) const;
+
+        UINT GetWidth() const;
+        UINT GetHeight() const;
+        UINT GetDepth() const;
+        UINT GetNumColors() const;
+        const XMFLOAT4& GetColor(_In_ UINT uIndex) const;
+        UINT64 GetSourceHash() const;
+        const WORD* GetColumnHeights() const;
+        const BYTE* GetColumnTypes() const;
+        UINT GetColumnHeight(_In_ UINT x, _In_ UINT z) const;
+        BYTE GetColumnType(_In_ UINT x, _In_ UINT z) const;
+        void GetColumnRuns(_In_ UINT x, _In_ UINT z, _Out_ std::vector<ColumnRun>& aOutRuns) const;
+        BYTE GetBlockType(_In_ UINT x, _In_ UINT y, _In_ UINT z) const;
+        XMFLOAT3 GetBlockPosition(_In_ UINT x, _In_ UINT y, _In_ UINT z) const;
+        void GetColumnCoordinates(_In_ FLOAT worldX, _In_ FLOAT worldZ, _Out_ INT& x, _Out_ INT& z) const;
+        XMMATRIX GetColumnTransform(_In_ UINT x, _In_ UINT z) const;
+        void GetBounds(
+            _In_ UINT uBeginX,
+            _In_ UINT uBeginZ,
+            _In_ UINT uEndX,
+            _In_ UINT uEndZ,
+            _Out_ XMFLOAT3& outMin,
+            _Out_ XMFLOAT3& outMax
+        ) const;
+        size_t CountInstances(
+            _In_ UINT uBeginX,
+            _In_ UINT uBeginZ,
+            _In_ UINT uEndX,
+            _In_ UINT uEndZ,
+            _In_ eVoxelInstancing instancing
+        ) const;
+        size_t FillInstanceData(
+            _In_ UINT uBeginX,
+            _In_ UINT uBeginZ,
+            _In_ UINT uEndX,
+            _In_ UINT uEndZ,
+            _In_ eVoxelInstancing instancing,
+            _Inout_ std::vector<std::vector<InstanceData>>& aOutInstanceData
+        ) const;
+        size_t FillPackedInstanceData(
+            _In_ UINT uBeginX,
+            _In_ UINT uBeginZ,
+            _In_ UINT uEndX,
+            _In_ UINT uEndZ,
+            _In_ eVoxelInstancing instancing,
+            _Inout_ std::vector<std::vector<PackedInstanceData>>& aOutInstanceData
+        ) const;
+        XMFLOAT3 GetGridOrigin() const;
+        void FillPalette(_Out_ CBPalette& outPalette) const;
+        XMFLOAT4 UnpackInstanceColor(_In_ const PackedInstanceData& packedInstance) const;
+        void ValidatePackedInstances(_In_ eVoxelInstancing instancing, _Out_ PackedInstanceValidationStats& outStats) const;
+        HRESULT SetColumn(_In_ UINT x, _In_ UINT z, _In_ UINT uNumBlocks, _In_ BYTE type);
+        HRESULT SetBlock(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ BYTE type);
+        HRESULT TruncateColumn(_In_ UINT x, _In_ UINT z, _In_ UINT uNumBlocks);
+        HRESULT SetColumnRuns(_In_ UINT x, _In_ UINT z, _In_ std::vector<ColumnRun>&& aRuns);
+
+    private:
+        static BOOL isBlankLine(_In_ const CHAR* pBegin, _In_ const CHAR* pEnd);
+        static UINT countColumnLines(_In_ const CHAR* pBegin, _In_ const CHAR* pEnd);
+        static WORD getNumBlocks(_In_ UINT uHeight, _In_ FLOAT height);
+
+        void parseColumnLines(_In_ const CHAR* pBegin, _In_ const CHAR* pEnd, _In_ UINT uFirstDepthIdx);
+        XMMATRIX getRunTransform(_In_ UINT x, _In_ UINT z, _In_ UINT uFirstBlock, _In_ UINT uNumBlocks) const;
+        void setColumnRuns(_In_ size_t uIndex, _In_ std::vector<ColumnRun>&& aRuns);
+        void makeWritable();
+        void reset();
+
+    private:
+        UINT m_uWidth;
+        UINT m_uHeight;
+        UINT m_uDepth;
+        UINT64 m_uSourceHash;
+        std::vector<XMFLOAT4> m_aPalette;
+        std::vector<WORD> m_aColumnHeights;
+        std::vector<BYTE> m_aColumnTypes;
+        const WORD* m_pColumnHeights;
+        const BYTE* m_pColumnTypes;
+        std::unordered_map<size_t, std::vector<ColumnRun>> m_layeredColumns;
+        std::atomic<size_t> m_uNumLayeredColumns;
+        mutable std::shared_mutex m_layeredColumnsMutex;
+        HANDLE m_hFile;
+        HANDLE m_hFileMapping;
+        LPVOID m_pMappedView;
+    };
+}
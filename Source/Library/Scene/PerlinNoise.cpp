@@ -0,0 +1,478 @@
+#include "Scene/PerlinNoise.h"
+
+#include <cstring>
+#include <intrin.h>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PerlinNoise::Sample2d
+
+      Summary:  Sums octaves of noise at a point, each octave at twice
+                the frequency and half the amplitude of the previous one
+
+      Args:     FLOAT x
+                  Sample position along the x axis, at least 0
+                FLOAT y
+                  Sample position along the y axis, at least 0
+                FLOAT frequency
+                  Frequency of the first octave
+                UINT uDepth
+                  Number of octaves
+
+      Returns:  FLOAT
+                  Noise between 0 and 1
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT PerlinNoise::Sample2d(_In_ FLOAT x, _In_ FLOAT y, _In_ FLOAT frequency, _In_ UINT uDepth)
+    {
+        FLOAT xa = x * frequency;
+        FLOAT ya = y * frequency;
+        FLOAT amp = 1.0f;
+        FLOAT fin = 0.0f;
+        FLOAT div = 0.0f;
+
+        for (UINT i = 0; i < uDepth; ++i)
+        {
+            div += 256.0f * amp;
+            fin += getNoise2d(xa, ya) * amp;
+            amp /= 2.0f;
+            xa *= 2.0f;
+            ya *= 2.0f;
+        }
+
+        return fin / div;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PerlinNoise::SampleBatch2d
+
+      Summary:  Evaluates Sample2d at many points. Full vectors go
+                through the AVX2 or the SSE2 kernel depending on the
+                processor, the remainder through the scalar path
+
+      Args:     const FLOAT* pX
+                  Sample positions along the x axis
+                const FLOAT* pY
+                  Sample positions along the y axis
+                UINT uNumSamples
+                  Number of samples
+                FLOAT frequency
+                  Frequency of the first octave
+                UINT uDepth
+                  Number of octaves
+                FLOAT* pOutSamples
+                  Receives the noise of every sample
+
+      Modifies: [pOutSamples].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void PerlinNoise::SampleBatch2d(
+        _In_reads_(uNumSamples) const FLOAT* pX,
+        _In_reads_(uNumSamples) const FLOAT* pY,
+        _In_ UINT uNumSamples,
+        _In_ FLOAT frequency,
+        _In_ UINT uDepth,
+        _Out_writes_(uNumSamples) FLOAT* pOutSamples
+    )
+    {
+        UINT uNumDone = isAvx2Supported()
+            ? sampleBatch2dAvx2(pX, pY, uNumSamples, frequency, uDepth, pOutSamples)
+            : sampleBatch2dSse2(pX, pY, uNumSamples, frequency, uDepth, pOutSamples);
+
+        SampleBatch2dScalar(pX + uNumDone, pY + uNumDone, uNumSamples - uNumDone, frequency, uDepth, pOutSamples + uNumDone);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PerlinNoise::SampleBatch2dScalar
+
+      Summary:  Evaluates Sample2d at many points one at a time. Used
+                for the tail of a batch and as the reference of the
+                benchmark
+
+      Args:     const FLOAT* pX
+                  Sample positions along the x axis
+                const FLOAT* pY
+                  Sample positions along the y axis
+                UINT uNumSamples
+                  Number of samples
+                FLOAT frequency
+                  Frequency of the first octave
+                UINT uDepth
+                  Number of octaves
+                FLOAT* pOutSamples
+                  Receives the noise of every sample
+
+      Modifies: [pOutSamples].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void PerlinNoise::SampleBatch2dScalar(
+        _In_reads_(uNumSamples) const FLOAT* pX,
+        _In_reads_(uNumSamples) const FLOAT* pY,
+        _In_ UINT uNumSamples,
+        _In_ FLOAT frequency,
+        _In_ UINT uDepth,
+        _Out_writes_(uNumSamples) FLOAT* pOutSamples
+    )
+    {
+        for (UINT i = 0; i < uNumSamples; ++i)
+        {
+            pOutSamples[i] = Sample2d(pX[i], pY[i], frequency, uDepth);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PerlinNoise::GetNumLanes
+
+      Summary:  Returns the number of samples per vector of the batch
+                path
+
+      Returns:  UINT
+                  8 with AVX2, 4 otherwise
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT PerlinNoise::GetNumLanes()
+    {
+        return isAvx2Supported() ? 8u : 4u;
+    }
+
+    UINT PerlinNoise::GetNumHashes()
+    {
+        return static_cast<UINT>(ARRAYSIZE(ms_aHashes));
+    }
+
+    const UINT* PerlinNoise::GetHashes()
+    {
+        return ms_aHashes;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PerlinNoise::Benchmark
+
+      Summary:  Evaluates the noise of a square grid of samples laid
+                out like the rows of a height map with the scalar and
+                the batch path, then compares the results bit by bit
+
+      Args:     UINT uNumSamples
+                  Number of samples
+                PerlinNoiseStats& outStats
+                  Receives the statistics
+
+      Modifies: [outStats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void PerlinNoise::Benchmark(_In_ UINT uNumSamples, _Out_ PerlinNoiseStats& outStats)
+    {
+        outStats = {};
+        outStats.uNumSamples = uNumSamples;
+        outStats.uNumLanes = GetNumLanes();
+
+        UINT uRowSize = 1u;
+        while (uRowSize * uRowSize < uNumSamples)
+        {
+            ++uRowSize;
+        }
+
+        std::vector<FLOAT> aX(uNumSamples);
+        std::vector<FLOAT> aY(uNumSamples);
+        for (UINT i = 0; i < uNumSamples; ++i)
+        {
+            aX[i] = static_cast<FLOAT>(i % uRowSize);
+            aY[i] = static_cast<FLOAT>(i / uRowSize);
+        }
+
+        std::vector<FLOAT> aScalarSamples(uNumSamples);
+        std::vector<FLOAT> aBatchSamples(uNumSamples);
+
+        LARGE_INTEGER frequency;
+        LARGE_INTEGER startingTime;
+        LARGE_INTEGER endingTime;
+        QueryPerformanceFrequency(&frequency);
+
+        QueryPerformanceCounter(&startingTime);
+        SampleBatch2dScalar(aX.data(), aY.data(), uNumSamples, 0.1f, 4u, aScalarSamples.data());
+        QueryPerformanceCounter(&endingTime);
+        outStats.uScalarTicks = static_cast<UINT64>(endingTime.QuadPart - startingTime.QuadPart);
+
+        QueryPerformanceCounter(&startingTime);
+        SampleBatch2d(aX.data(), aY.data(), uNumSamples, 0.1f, 4u, aBatchSamples.data());
+        QueryPerformanceCounter(&endingTime);
+        outStats.uBatchTicks = static_cast<UINT64>(endingTime.QuadPart - startingTime.QuadPart);
+        outStats.uTicksPerSecond = static_cast<UINT64>(frequency.QuadPart);
+
+        for (UINT i = 0; i < uNumSamples; ++i)
+        {
+            if (memcmp(&aScalarSamples[i], &aBatchSamples[i], sizeof(FLOAT)) != 0)
+            {
+                ++outStats.uNumMismatches;
+            }
+        }
+    }
+
+    FLOAT PerlinNoise::getNoise2(_In_ UINT x, _In_ UINT y)
+    {
+        UINT temp = ms_aHashes[y % 256u];
+
+        return static_cast<FLOAT>(ms_aHashes[(temp + x) % 256u]);
+    }
+
+    FLOAT PerlinNoise::getNoise2d(_In_ FLOAT x, _In_ FLOAT y)
+    {
+        UINT uX = static_cast<UINT>(x);
+        UINT uY = static_cast<UINT>(y);
+        FLOAT xFrac = x - static_cast<FLOAT>(uX);
+        FLOAT yFrac = y - static_cast<FLOAT>(uY);
+
+        UINT s = static_cast<UINT>(getNoise2(uX, uY));
+        UINT t = static_cast<UINT>(getNoise2(uX + 1u, uY));
+        UINT u = static_cast<UINT>(getNoise2(uX, uY + 1u));
+        UINT v = static_cast<UINT>(getNoise2(uX + 1u, uY + 1u));
+
+        FLOAT low = smoothLerp(static_cast<FLOAT>(s), static_cast<FLOAT>(t), xFrac);
+        FLOAT high = smoothLerp(static_cast<FLOAT>(u), static_cast<FLOAT>(v), xFrac);
+
+        return smoothLerp(low, high, yFrac);
+    }
+
+    FLOAT PerlinNoise::lerp(_In_ FLOAT x, _In_ FLOAT y, _In_ FLOAT s)
+    {
+        return x + s * (y - x);
+    }
+
+    FLOAT PerlinNoise::smoothLerp(_In_ FLOAT x, _In_ FLOAT y, _In_ FLOAT s)
+    {
+        return lerp(x, y, s * s * (3.0f - 2.0f * s));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PerlinNoise::getDivisor
+
+      Summary:  Returns the sum of the largest value of every octave,
+                accumulated in the same order as Sample2d
+
+      Args:     UINT uDepth
+                  Number of octaves
+
+      Returns:  FLOAT
+                  Divisor normalizing the sum of the octaves
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT PerlinNoise::getDivisor(_In_ UINT uDepth)
+    {
+        FLOAT amp = 1.0f;
+        FLOAT div = 0.0f;
+        for (UINT i = 0; i < uDepth; ++i)
+        {
+            div += 256.0f * amp;
+            amp /= 2.0f;
+        }
+
+        return div;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PerlinNoise::isAvx2Supported
+
+      Summary:  Checks once whether both the processor and the
+                operating system support AVX2
+
+      Returns:  BOOL
+                  TRUE if the AVX2 kernel can run
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL PerlinNoise::isAvx2Supported()
+    {
+        static const BOOL s_bSupported = []()
+        {
+            INT aInfo[4];
+            __cpuid(aInfo, 0);
+            if (aInfo[0] < 7)
+            {
+                return FALSE;
+            }
+
+            __cpuid(aInfo, 1);
+            const BOOL bOsxsave = (aInfo[2] & (1 << 27)) != 0;
+            const BOOL bAvx = (aInfo[2] & (1 << 28)) != 0;
+            if (!bOsxsave || !bAvx || (_xgetbv(0) & 6u) != 6u)
+            {
+                return FALSE;
+            }
+
+            __cpuidex(aInfo, 7, 0);
+            return static_cast<BOOL>((aInfo[1] & (1 << 5)) != 0);
+        }();
+
+        return s_bSupported;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PerlinNoise::sampleBatch2dSse2
+
+      Summary:  Evaluates 4 samples per iteration. SSE2 has no gather,
+                so the hashes are looked up one lane at a time and only
+                the interpolation runs in vector lanes
+
+      Args:     const FLOAT* pX
+                  Sample positions along the x axis
+                const FLOAT* pY
+                  Sample positions along the y axis
+                UINT uNumSamples
+                  Number of samples
+                FLOAT frequency
+                  Frequency of the first octave
+                UINT uDepth
+                  Number of octaves
+                FLOAT* pOutSamples
+                  Receives the noise of every sample
+
+      Modifies: [pOutSamples].
+
+      Returns:  UINT
+                  Number of samples evaluated, a multiple of 4
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT PerlinNoise::sampleBatch2dSse2(
+        _In_ const FLOAT* pX,
+        _In_ const FLOAT* pY,
+        _In_ UINT uNumSamples,
+        _In_ FLOAT frequency,
+        _In_ UINT uDepth,
+        _Out_ FLOAT* pOutSamples
+    )
+    {
+        const __m128 vFrequency = _mm_set1_ps(frequency);
+        const __m128 vDivisor = _mm_set1_ps(getDivisor(uDepth));
+        const __m128 vTwo = _mm_set1_ps(2.0f);
+        const __m128 vThree = _mm_set1_ps(3.0f);
+        const UINT uNumDone = uNumSamples & ~3u;
+
+        alignas(16) UINT aX[4];
+        alignas(16) UINT aY[4];
+        alignas(16) INT aHashes[4][4];
+
+        for (UINT i = 0; i < uNumDone; i += 4u)
+        {
+            __m128 xa = _mm_mul_ps(_mm_loadu_ps(pX + i), vFrequency);
+            __m128 ya = _mm_mul_ps(_mm_loadu_ps(pY + i), vFrequency);
+            __m128 fin = _mm_setzero_ps();
+            FLOAT amp = 1.0f;
+
+            for (UINT uOctave = 0; uOctave < uDepth; ++uOctave)
+            {
+                __m128i ix = _mm_cvttps_epi32(xa);
+                __m128i iy = _mm_cvttps_epi32(ya);
+                __m128 xFrac = _mm_sub_ps(xa, _mm_cvtepi32_ps(ix));
+                __m128 yFrac = _mm_sub_ps(ya, _mm_cvtepi32_ps(iy));
+
+                _mm_store_si128(reinterpret_cast<__m128i*>(aX), ix);
+                _mm_store_si128(reinterpret_cast<__m128i*>(aY), iy);
+                for (UINT uLane = 0; uLane < 4u; ++uLane)
+                {
+                    UINT tempLow = ms_aHashes[aY[uLane] % 256u];
+                    UINT tempHigh = ms_aHashes[(aY[uLane] + 1u) % 256u];
+                    aHashes[0][uLane] = static_cast<INT>(ms_aHashes[(tempLow + aX[uLane]) % 256u]);
+                    aHashes[1][uLane] = static_cast<INT>(ms_aHashes[(tempLow + aX[uLane] + 1u) % 256u]);
+                    aHashes[2][uLane] = static_cast<INT>(ms_aHashes[(tempHigh + aX[uLane]) % 256u]);
+                    aHashes[3][uLane] = static_cast<INT>(ms_aHashes[(tempHigh + aX[uLane] + 1u) % 256u]);
+                }
+                __m128 s = _mm_cvtepi32_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(aHashes[0])));
+                __m128 t = _mm_cvtepi32_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(aHashes[1])));
+                __m128 u = _mm_cvtepi32_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(aHashes[2])));
+                __m128 v = _mm_cvtepi32_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(aHashes[3])));
+
+                // smoothLerp(x, y, s) = x + s * s * (3 - 2 * s) * (y - x)
+                __m128 xWeight = _mm_mul_ps(_mm_mul_ps(xFrac, xFrac), _mm_sub_ps(vThree, _mm_mul_ps(vTwo, xFrac)));
+                __m128 yWeight = _mm_mul_ps(_mm_mul_ps(yFrac, yFrac), _mm_sub_ps(vThree, _mm_mul_ps(vTwo, yFrac)));
+                __m128 low = _mm_add_ps(s, _mm_mul_ps(xWeight, _mm_sub_ps(t, s)));
+                __m128 high = _mm_add_ps(u, _mm_mul_ps(xWeight, _mm_sub_ps(v, u)));
+                __m128 noise = _mm_add_ps(low, _mm_mul_ps(yWeight, _mm_sub_ps(high, low)));
+
+                fin = _mm_add_ps(fin, _mm_mul_ps(noise, _mm_set1_ps(amp)));
+                amp /= 2.0f;
+                xa = _mm_mul_ps(xa, vTwo);
+                ya = _mm_mul_ps(ya, vTwo);
+            }
+
+            _mm_storeu_ps(pOutSamples + i, _mm_div_ps(fin, vDivisor));
+        }
+
+        return uNumDone;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PerlinNoise::sampleBatch2dAvx2
+
+      Summary:  Evaluates 8 samples per iteration, gathering the hashes
+                of all lanes at once. Only called after
+                isAvx2Supported returned TRUE
+
+      Args:     const FLOAT* pX
+                  Sample positions along the x axis
+                const FLOAT* pY
+                  Sample positions along the y axis
+                UINT uNumSamples
+                  Number of samples
+                FLOAT frequency
+                  Frequency of the first octave
+                UINT uDepth
+                  Number of octaves
+                FLOAT* pOutSamples
+                  Receives the noise of every sample
+
+      Modifies: [pOutSamples].
+
+      Returns:  UINT
+                  Number of samples evaluated, a multiple of 8
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT PerlinNoise::sampleBatch2dAvx2(
+        _In_ const FLOAT* pX,
+        _In_ const FLOAT* pY,
+        _In_ UINT uNumSamples,
+        _In_ FLOAT frequency,
+        _In_ UINT uDepth,
+        _Out_ FLOAT* pOutSamples
+    )
+    {
+        const INT* pHashes = reinterpret_cast<const INT*>(ms_aHashes);
+        const __m256 vFrequency = _mm256_set1_ps(frequency);
+        const __m256 vDivisor = _mm256_set1_ps(getDivisor(uDepth));
+        const __m256 vTwo = _mm256_set1_ps(2.0f);
+        const __m256 vThree = _mm256_set1_ps(3.0f);
+        const __m256i vOne = _mm256_set1_epi32(1);
+        const __m256i vMask = _mm256_set1_epi32(255);
+        const UINT uNumDone = uNumSamples & ~7u;
+
+        for (UINT i = 0; i < uNumDone; i += 8u)
+        {
+            __m256 xa = _mm256_mul_ps(_mm256_loadu_ps(pX + i), vFrequency);
+            __m256 ya = _mm256_mul_ps(_mm256_loadu_ps(pY + i), vFrequency);
+            __m256 fin = _mm256_setzero_ps();
+            FLOAT amp = 1.0f;
+
+            for (UINT uOctave = 0; uOctave < uDepth; ++uOctave)
+            {
+                __m256i ix = _mm256_cvttps_epi32(xa);
+                __m256i iy = _mm256_cvttps_epi32(ya);
+                __m256 xFrac = _mm256_sub_ps(xa, _mm256_cvtepi32_ps(ix));
+                __m256 yFrac = _mm256_sub_ps(ya, _mm256_cvtepi32_ps(iy));
+
+                __m256i tempLow = _mm256_i32gather_epi32(pHashes, _mm256_and_si256(iy, vMask), 4);
+                __m256i tempHigh = _mm256_i32gather_epi32(pHashes, _mm256_and_si256(_mm256_add_epi32(iy, vOne), vMask), 4);
+                __m256i ixNext = _mm256_add_epi32(ix, vOne);
+                __m256 s = _mm256_cvtepi32_ps(_mm256_i32gather_epi32(pHashes, _mm256_and_si256(_mm256_add_epi32(tempLow, ix), vMask), 4));
+                __m256 t = _mm256_cvtepi32_ps(_mm256_i32gather_epi32(pHashes, _mm256_and_si256(_mm256_add_epi32(tempLow, ixNext), vMask), 4));
+                __m256 u = _mm256_cvtepi32_ps(_mm256_i32gather_epi32(pHashes, _mm256_and_si256(_mm256_add_epi32(tempHigh, ix), vMask), 4));
+                __m256 v = _mm256_cvtepi32_ps(_mm256_i32gather_epi32(pHashes, _mm256_and_si256(_mm256_add_epi32(tempHigh, ixNext), vMask), 4));
+
+                // smoothLerp(x, y, s) = x + s * s * (3 - 2 * s) * (y - x)
+                __m256 xWeight = _mm256_mul_ps(_mm256_mul_ps(xFrac, xFrac), _mm256_sub_ps(vThree, _mm256_mul_ps(vTwo, xFrac)));
+                __m256 yWeight = _mm256_mul_ps(_mm256_mul_ps(yFrac, yFrac), _mm256_sub_ps(vThree, _mm256_mul_ps(vTwo, yFrac)));
+                __m256 low = _mm256_add_ps(s, _mm256_mul_ps(xWeight, _mm256_sub_ps(t, s)));
+                __m256 high = _mm256_add_ps(u, _mm256_mul_ps(xWeight, _mm256_sub_ps(v, u)));
+                __m256 noise = _mm256_add_ps(low, _mm256_mul_ps(yWeight, _mm256_sub_ps(high, low)));
+
+                fin = _mm256_add_ps(fin, _mm256_mul_ps(noise, _mm256_set1_ps(amp)));
+                amp /= 2.0f;
+                xa = _mm256_mul_ps(xa, vTwo);
+                ya = _mm256_mul_ps(ya, vTwo);
+            }
+
+            _mm256_storeu_ps(pOutSamples + i, _mm256_div_ps(fin, vDivisor));
+        }
+
+        return uNumDone;
+    }
+}
@@ -0,0 +1,147 @@
+/*+===================================================================
+  File:      PERLINNOISE.H
+
+  Summary:   PerlinNoise header file contains declarations of
+             PerlinNoise class used for the lab samples of Game
+             Graphics Programming course.
+
+  Classes: PerlinNoise
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   PerlinNoiseStats
+
+      Summary:  Statistics of a noise benchmark
+
+                uNumSamples
+                  Number of samples evaluated by each path
+                uScalarTicks
+                  Time spent by the scalar path in performance counter
+                  ticks
+                uBatchTicks
+                  Time spent by the batch path in performance counter
+                  ticks
+                uTicksPerSecond
+                  Frequency of the performance counter
+                uNumLanes
+                  Number of samples per vector of the batch path, 1
+                  when it fell back to scalar code
+                uNumMismatches
+                  Number of samples whose bits differ between the
+                  paths. Always 0 unless the batch path is broken
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct PerlinNoiseStats
+    {
+        UINT64 uNumSamples;
+        UINT64 uScalarTicks;
+        UINT64 uBatchTicks;
+        UINT64 uTicksPerSecond;
+        UINT uNumLanes;
+        UINT64 uNumMismatches;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    PerlinNoise
+
+      Summary:  Hashed value noise summed over octaves. The batch path
+                evaluates 8 samples per AVX2 vector, or 4 per SSE2
+                vector on processors without AVX2, using the same
+                operations in the same order as the scalar path so the
+                results are bit-identical
+
+      Methods:  Sample2d
+                  Evaluates one sample
+                SampleBatch2d
+                  Evaluates many samples with the widest vectors the
+                  processor supports
+                SampleBatch2dScalar
+                  Evaluates many samples one at a time
+                GetNumLanes
+                  Returns the number of samples per vector of the
+                  batch path
+                GetNumHashes
+                  Returns the size of the permutation table
+                GetHashes
+                  Returns the permutation table the noise is seeded
+                  with
+                Benchmark
+                  Compares the throughput of the scalar and batch
+                  paths
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class PerlinNoise
+    {
+    public:
+        static FLOAT Sample2d(_In_ FLOAT x, _In_ FLOAT y, _In_ FLOAT frequency, _In_ UINT uDepth);
+        static void SampleBatch2d(
+            _In_reads_(uNumSamples) const FLOAT* pX,
+            _In_reads_(uNumSamples) const FLOAT* pY,
+            _In_ UINT uNumSamples,
+            _In_ FLOAT frequency,
+            _In_ UINT uDepth,
+            _Out_writes_(uNumSamples) FLOAT* pOutSamples
+        );
+        static void SampleBatch2dScalar(
+            _In_reads_(uNumSamples) const FLOAT* pX,
+            _In_reads_(uNumSamples) const FLOAT* pY,
+            _In_ UINT uNumSamples,
+            _In_ FLOAT frequency,
+            _In_ UINT uDepth,
+            _Out_writes_(uNumSamples) FLOAT* pOutSamples
+        );
+        static UINT GetNumLanes();
+        static UINT GetNumHashes();
+        static const UINT* GetHashes();
+        static void Benchmark(_In_ UINT uNumSamples, _Out_ PerlinNoiseStats& outStats);
+
+    public:
+        PerlinNoise() = delete;
+
+    private:
+        static FLOAT getNoise2(_In_ UINT x, _In_ UINT y);
+        static FLOAT getNoise2d(_In_ FLOAT x, _In_ FLOAT y);
+        static FLOAT lerp(_In_ FLOAT x, _In_ FLOAT y, _In_ FLOAT s);
+        static FLOAT smoothLerp(_In_ FLOAT x, _In_ FLOAT y, _In_ FLOAT s);
+        static FLOAT getDivisor(_In_ UINT uDepth);
+        static BOOL isAvx2Supported();
+        static UINT sampleBatch2dSse2(
+            _In_ const FLOAT* pX,
+            _In_ const FLOAT* pY,
+            _In_ UINT uNumSamples,
+            _In_ FLOAT frequency,
+            _In_ UINT uDepth,
+            _Out_ FLOAT* pOutSamples
+        );
+        static UINT sampleBatch2dAvx2(
+            _In_ const FLOAT* pX,
+            _In_ const FLOAT* pY,
+            _In_ UINT uNumSamples,
+            _In_ FLOAT frequency,
+            _In_ UINT uDepth,
+            _Out_ FLOAT* pOutSamples
+        );
+
+    private:
+        static constexpr const UINT ms_aHashes[] =
+        {
+            208,34,231,213,32,248,233,56,161,78,24,140,71,48,140,254,245,255,247,247,40,
+            185,248,251,245,28,124,204,204,76,36,1,107,28,234,163,202,224,245,128,167,204,
+            9,92,217,54,239,174,173,102,193,189,190,121,100,108,167,44,43,77,180,204,8,81,
+            70,223,11,38,24,254,210,210,177,32,81,195,243,125,8,169,112,32,97,53,195,13,
+            203,9,47,104,125,117,114,124,165,203,181,235,193,206,70,180,174,0,167,181,41,
+            164,30,116,127,198,245,146,87,224,149,206,57,4,192,210,65,210,129,240,178,105,
+            228,108,245,148,140,40,35,195,38,58,65,207,215,253,65,85,208,76,62,3,237,55,89,
+            232,50,217,64,244,157,199,121,252,90,17,212,203,149,152,140,187,234,177,73,174,
+            193,100,192,143,97,53,145,135,19,103,13,90,135,151,199,91,239,247,33,39,145,
+            101,120,99,3,186,86,99,41,237,203,111,79,220,135,158,42,30,154,120,67,87,167,
+            135,176,183,191,253,115,184,21,233,58,129,233,142,39,128,211,118,137,139,255,
+            114,20,218,113,154,27,127,246,250,1,8,198,250,209,92,222,173,21,88,102,219
+        };
+    };
+}
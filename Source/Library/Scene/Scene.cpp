@@ -4,155 +4,104 @@ namespace library
 {
     FLOAT Scene::GetPerlin2d(FLOAT x, FLOAT y, FLOAT frequency, UINT uDepth)
     {
-        FLOAT xa = x * frequency;
-        FLOAT ya = y * frequency;
-        FLOAT amp = 1.0f;
-        FLOAT fin = 0.0f;
-        FLOAT div = 0.0f;
-
-        for (UINT i = 0; i < uDepth; ++i)
-        {
-            div += 256.0f * amp;
-            fin += getNoise2d(xa, ya) * amp;
-            amp /= 2.0f;
-            xa *= 2.0f;
-            ya *= 2.0f;
-        }
-
-        return fin / div;
+        return PerlinNoise::Sample2d(x, y, frequency, uDepth);
     }
 
-    Scene::Scene(const std::filesystem::path& filePath)
-        : m_filePath(filePath)
-        , m_voxels()
-        , m_renderables()
-        , m_models()
-        , m_aPointLights{ nullptr }
-        , m_vertexShaders()
-        , m_pixelShaders()
-        , m_materials()
-        , m_skyBox()
+    Scene::Scene(const std::filesystem::path& filePath, _In_opt_ eVoxelInstancing instancing, _In_opt_ BOOL bPackedInstances)
+        : Scene()
     {
-        std::ifstream inputFile;
-        inputFile.open(m_filePath.string());
+        m_filePath = filePath;
 
-        std::string trash;
-        UINT aDimension[4] = { 0u, };
-        UINT uDimensionIdx = 0u;
-        while (!inputFile.eof() && uDimensionIdx < ARRAYSIZE(aDimension))
+        ThreadPool& threadPool = TextureCache::GetShared().GetThreadPool();
+        if (SUCCEEDED(m_heightMap->LoadFromFile(m_filePath, &threadPool)))
         {
-            inputFile >> aDimension[uDimensionIdx];
-
-            if (inputFile.fail())
-            {
-                if (inputFile.eof())
-                {
-                    break;
-                }
-                inputFile.clear();
-                inputFile >> trash;
-            }
-            else
-            {
-                ++uDimensionIdx;
-            }
+            initializeVoxels(*m_heightMap, instancing, bPackedInstances, threadPool);
         }
+    }
 
-        UINT uColorIdx = 0u;
-        XMFLOAT4 color;
-        while (!inputFile.eof() && uColorIdx < aDimension[3])
-        {
-            inputFile >> color.x >> color.y >> color.z;
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::Scene
 
-            if (inputFile.fail())
-            {
-                if (inputFile.eof())
-                {
-                    break;
-                }
-                inputFile.clear();
-                inputFile >> trash;
-            }
-            else
-            {
-                color.w = 1.0f;
-                m_voxels.push_back(std::make_shared<Voxel>(color));
-                ++uColorIdx;
-            }
-        }
+      Summary:  Constructor. Keeps the height map loaded and streams its
+                voxels in chunks around the camera instead of building
+                the whole world up front. Lit greedy meshes get a light
+                map of the height map, flooded before streaming starts
+
+      Args:     const std::filesystem::path& filePath
+                  Path of the height map file
+                const ChunkStreamingDesc& streamingDesc
+                  Chunk size, residency radius, memory budget and
+                  number of threads of the streaming
 
-        std::vector<std::vector<InstanceData>> aInstanceData;
-        aInstanceData.reserve(m_voxels.size());
-        for (UINT renderableIdx = 0u; renderableIdx < m_voxels.size(); ++renderableIdx)
+      Modifies: [m_filePath, m_heightMap, m_lightMap, m_chunkStreamer,
+                 m_raycaster, m_worldSave].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    Scene::Scene(_In_ const std::filesystem::path& filePath, _In_ const ChunkStreamingDesc& streamingDesc)
+        : Scene()
+    {
+        m_filePath = filePath;
+
+        ThreadPool& threadPool = TextureCache::GetShared().GetThreadPool();
+        if (SUCCEEDED(m_heightMap->LoadFromFile(m_filePath, &threadPool)))
         {
-            aInstanceData.push_back(std::vector<InstanceData>());
-            aInstanceData.back().reserve(
-                static_cast<size_t>(aDimension[0]) * static_cast<size_t>(aDimension[1]) * static_cast<size_t>(aDimension[2])
-            );
+            initializeStreaming(streamingDesc);
         }
+    }
 
-        UINT uDepthIdx = 0u;
-        UINT uWidthIdx = 0u;
-        CHAR voxelType;
-        FLOAT height;
-        while (!inputFile.eof())
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::Scene
+
+      Summary:  Constructor. Builds the voxels straight from a height
+                map held in memory, skipping the file and the text
+                parsing
+
+      Args:     const HeightMapGrid& grid
+                  Heights, block types and palette of the map. Only
+                  read during the construction
+                eVoxelInstancing instancing
+                  Whether to instance every block or every column
+                BOOL bPackedInstances
+                  Whether the terrain is a single voxel of packed
+                  instances, to be drawn with VSPackedVoxel, instead
+                  of one voxel per palette color
+
+      Modifies: [m_heightMap, m_voxels, m_raycaster].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    Scene::Scene(_In_ const HeightMapGrid& grid, _In_opt_ eVoxelInstancing instancing, _In_opt_ BOOL bPackedInstances)
+        : Scene()
+    {
+        ThreadPool& threadPool = TextureCache::GetShared().GetThreadPool();
+        if (SUCCEEDED(m_heightMap->LoadFromGrid(grid, &threadPool)))
         {
-            inputFile >> voxelType >> height;
-
-            if (inputFile.fail())
-            {
-                if (inputFile.eof())
-                {
-                    break;
-                }
-                inputFile.clear();
-                inputFile >> trash;
-            }
-            else if (static_cast<CHAR>(eBlockType::GRASSLAND) <= voxelType && voxelType < static_cast<CHAR>(eBlockType::COUNT))
-            {
-                for (UINT heightIdx = 0; heightIdx < static_cast<UINT>(static_cast<float>(aDimension[1]) * height); ++heightIdx)
-                {
-                    aInstanceData[static_cast<size_t>(voxelType) - static_cast<size_t>(eBlockType::GRASSLAND)].push_back(
-                        InstanceData
-                        {
-                            .Transformation = XMMatrixTranslation(
-                                2.0f * (static_cast<FLOAT>(uWidthIdx) - static_cast<FLOAT>(aDimension[0]) / 2.0f),
-                                2.0f * (static_cast<FLOAT>(heightIdx) - static_cast<FLOAT>(aDimension[1])) + (static_cast<FLOAT>(aDimension[1]) * 0.75f),
-                                2.0f * (static_cast<FLOAT>(uDepthIdx) - static_cast<FLOAT>(aDimension[2]) / 2.0f)
-                                )
-                        }
-                    );
-                }
-                ++uWidthIdx;
-                if (uWidthIdx >= aDimension[0])
-                {
-                    uWidthIdx -= aDimension[0];
-                    ++uDepthIdx;
-
-                    if (uDepthIdx >= aDimension[2])
-                    {
-                        uDepthIdx -= aDimension[2];
-                    }
-                }
-            }
+            initializeVoxels(*m_heightMap, instancing, bPackedInstances, threadPool);
         }
+    }
 
-        inputFile.close();
-
-        UINT uVoxelIdx = 0u;
-        auto it = m_voxels.begin();
-        while (it != m_voxels.end())
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::Scene
+
+      Summary:  Constructor. Copies a height map held in memory and
+                streams its voxels in chunks around the camera, without
+                any file or text round trip. Lit greedy meshes get a
+                light map of the height map
+
+      Args:     const HeightMapGrid& grid
+                  Heights, block types and palette of the map. Only
+                  read during the construction
+                const ChunkStreamingDesc& streamingDesc
+                  Chunk size, residency radius, memory budget and
+                  number of threads of the streaming
+
+      Modifies: [m_heightMap, m_lightMap, m_chunkStreamer, m_raycaster,
+                 m_worldSave].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    Scene::Scene(_In_ const HeightMapGrid& grid, _In_ const ChunkStreamingDesc& streamingDesc)
+        : Scene()
+    {
+        ThreadPool& threadPool = TextureCache::GetShared().GetThreadPool();
+        if (SUCCEEDED(m_heightMap->LoadFromGrid(grid, &threadPool)))
         {
-            if (aInstanceData[uVoxelIdx].size() <= 0)
-            {
-                it = m_voxels.erase(it);
-            }
-            else
-            {
-                (*it)->SetInstanceData(std::move(aInstanceData[uVoxelIdx]));
-                ++it;
-            }
-            ++uVoxelIdx;
+            initializeStreaming(streamingDesc);
         }
     }
 
@@ -231,6 +180,30 @@ namespace library
             }
         }
 
+        CBPalette cbPalette;
+        m_heightMap->FillPalette(cbPalette);
+
+        D3D11_BUFFER_DESC paletteBufferDesc = {
+            .ByteWidth = sizeof(CBPalette),
+            .Usage = D3D11_USAGE_DEFAULT,
+            .BindFlags = D3D11_BIND_CONSTANT_BUFFER,
+            .CPUAccessFlags = 0,
+            .MiscFlags = 0,
+            .StructureByteStride = 0
+        };
+
+        D3D11_SUBRESOURCE_DATA paletteInitData = {
+            .pSysMem = &cbPalette,
+            .SysMemPitch = 0,
+            .SysMemSlicePitch = 0
+        };
+
+        HRESULT hr = pDevice->CreateBuffer(&paletteBufferDesc, &paletteInitData, m_cbPalette.ReleaseAndGetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
         return S_OK;
     }
 
@@ -436,11 +409,575 @@ namespace library
         
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::UpdateChunks
+
+      Summary:  Streams the voxel chunks around the camera. Newly loaded
+                voxels get the voxel shaders and material of the scene,
+                and newly loaded meshes the voxel mesh vertex shader
+                with the voxel pixel shader and material. The light
+                changed by edits is flooded first, up to
+                MAX_LIGHT_STEPS_PER_UPDATE blocks per call while the
+                chunk workers are kept out of the light map, and the
+                chunks showing it are refreshed once it settles. The
+                chunks of a world save being loaded are applied first,
+                nearest to the camera first, up to
+                MAX_WORLD_CHUNKS_PER_UPDATE per call, and a save
+                deferred by SaveWorld starts once they all are
+
+      Args:     const XMVECTOR& eye
+                  Position of the camera
+                ID3D11Device* pDevice
+                  The Direct3D device to create the buffers
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to set buffers
+
+      Modifies: [m_voxels, m_voxelMeshes, m_heightMap, m_lightMap,
+                 m_chunkStreamer, m_raycaster, m_worldSave,
+                 m_pendingSavePath, m_culler, m_aVoxelChunkRanges,
+                 m_aVoxelMeshChunks, m_bCullingDataDirty].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::UpdateChunks(_In_ const XMVECTOR& eye, _In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
+    {
+        if (!m_chunkStreamer)
+        {
+            return S_OK;
+        }
+
+        if (m_worldSave->IsLoading())
+        {
+            INT eyeX = 0;
+            INT eyeZ = 0;
+            m_heightMap->GetColumnCoordinates(XMVectorGetX(eye), XMVectorGetZ(eye), eyeX, eyeZ);
+
+            std::vector<WorldSaveChunk> aChunks;
+            m_worldSave->Update(eyeX, eyeZ, MAX_WORLD_CHUNKS_PER_UPDATE, aChunks);
+            if (!aChunks.empty())
+            {
+                std::unique_lock<std::shared_mutex> mapsLock = m_chunkStreamer->LockMaps();
+                for (WorldSaveChunk& chunk : aChunks)
+                {
+                    applyWorldChunk(chunk);
+                }
+            }
+        }
+
+        if (!m_pendingSavePath.empty() && !m_worldSave->IsLoading())
+        {
+            HRESULT hr = m_worldSave->Save(m_pendingSavePath);
+            m_pendingSavePath.clear();
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+
+        if (m_lightMap)
+        {
+            // Wait for the flood to settle so a chunk is not remeshed on
+            // every step of a large one
+            if (m_lightMap->IsPropagating())
+            {
+                std::unique_lock<std::shared_mutex> mapsLock = m_chunkStreamer->LockMaps();
+                m_lightMap->Propagate(MAX_LIGHT_STEPS_PER_UPDATE);
+            }
+
+            UINT uBeginX = 0u;
+            UINT uBeginZ = 0u;
+            UINT uEndX = 0u;
+            UINT uEndZ = 0u;
+            if (!m_lightMap->IsPropagating() && m_lightMap->TakeChangedRegion(uBeginX, uBeginZ, uEndX, uEndZ))
+            {
+                m_chunkStreamer->InvalidateColumns(uBeginX, uBeginZ, uEndX, uEndZ);
+            }
+        }
+
+        std::vector<std::shared_ptr<Voxel>> aLoadedVoxels;
+        std::vector<std::shared_ptr<VoxelMesh>> aLoadedMeshes;
+        BOOL bChanged = FALSE;
+        // The voxels and meshes created before a failure are resident,
+        // so they get their shaders whatever the result
+        const HRESULT hr = m_chunkStreamer->Update(eye, pDevice, pImmediateContext, aLoadedVoxels, aLoadedMeshes, bChanged);
+
+        for (std::shared_ptr<Voxel>& voxel : aLoadedVoxels)
+        {
+            if (m_voxelVertexShader)
+            {
+                voxel->SetVertexShader(m_voxelVertexShader);
+            }
+            if (m_voxelPixelShader)
+            {
+                voxel->SetPixelShader(m_voxelPixelShader);
+            }
+            if (m_voxelMaterial)
+            {
+                voxel->AddMaterial(m_voxelMaterial);
+            }
+        }
+
+        for (std::shared_ptr<VoxelMesh>& mesh : aLoadedMeshes)
+        {
+            if (m_voxelMeshVertexShader)
+            {
+                mesh->SetVertexShader(m_voxelMeshVertexShader);
+            }
+            if (m_voxelPixelShader)
+            {
+                mesh->SetPixelShader(m_voxelPixelShader);
+            }
+            if (m_voxelMaterial)
+            {
+                mesh->AddMaterial(m_voxelMaterial);
+            }
+        }
+
+        if (bChanged)
+        {
+            m_chunkStreamer->GetResidentVoxels(m_voxels);
+            m_chunkStreamer->GetResidentMeshes(m_voxelMeshes);
+        }
+
+        if (bChanged || m_bCullingDataDirty)
+        {
+            updateCullingData();
+        }
+
+        return hr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::Raycast
+
+      Summary:  Returns the first block of the height map hit by a ray,
+                for picking and camera collision. Works whether the
+                blocks are resident or not
+
+      Args:     const VoxelRay& ray
+                  Ray in world space
+                VoxelRaycastHit& outHit
+                  Hit block, face, distance and position
+
+      Returns:  BOOL
+                  TRUE if a block was hit
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL Scene::Raycast(_In_ const VoxelRay& ray, _Out_ VoxelRaycastHit& outHit) const
+    {
+        if (!m_raycaster)
+        {
+            outHit = VoxelRaycastHit{ .bHit = FALSE };
+            return FALSE;
+        }
+
+        return m_raycaster->Raycast(ray, outHit);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::RaycastBatch
+
+      Summary:  Casts many rays against the blocks of the height map
+
+      Args:     const std::vector<VoxelRay>& aRays
+                  Rays in world space
+                std::vector<VoxelRaycastHit>& aOutHits
+                  Hit of each ray, in the order of the rays
+                ThreadPool* pThreadPool
+                  Thread pool to cast the rays on. Can be null
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::RaycastBatch(
+        _In_ const std::vector<VoxelRay>& aRays,
+        _Out_ std::vector<VoxelRaycastHit>& aOutHits,
+        _In_opt_ ThreadPool* pThreadPool
+    ) const
+    {
+        if (!m_raycaster)
+        {
+            aOutHits.assign(aRays.size(), VoxelRaycastHit{ .bHit = FALSE });
+            return;
+        }
+
+        m_raycaster->RaycastBatch(aRays, aOutHits, pThreadPool);
+    }
+
+    const VoxelRaycaster* Scene::GetRaycaster() const
+    {
+        return m_raycaster.get();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::CullVoxels
+
+      Summary:  Culls the chunks of the height map against the view
+                frustum and gathers the instance ranges of every voxel
+                to draw this frame. Voxels and meshes that do not come
+                from the height map are always visible
+
+      Args:     const XMMATRIX& viewProjection
+                  View projection transform of the camera
+
+      Modifies: [m_culler, m_aVisibleInstanceRanges,
+                 m_aVisibleVoxelMeshes, m_cullingStats].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::CullVoxels(_In_ const XMMATRIX& viewProjection)
+    {
+        m_cullingStats = {};
+        if (m_culler)
+        {
+            m_culler->Cull(viewProjection, &m_cullingStats);
+        }
+
+        m_aVisibleInstanceRanges.resize(m_voxels.size());
+        for (size_t i = 0u; i < m_voxels.size(); ++i)
+        {
+            std::vector<InstanceRange>& aRanges = m_aVisibleInstanceRanges[i];
+            aRanges.clear();
+
+            if (m_culler && i < m_aVoxelChunkRanges.size())
+            {
+                m_culler->AppendVisibleRanges(m_aVoxelChunkRanges[i], aRanges, &m_cullingStats);
+                continue;
+            }
+
+            const UINT uNumInstances = m_voxels[i]->GetNumInstances();
+            m_cullingStats.uNumInstances += uNumInstances;
+            m_cullingStats.uNumInstancesVisible += uNumInstances;
+            if (uNumInstances > 0u)
+            {
+                aRanges.push_back({ .uBeginInstance = 0u, .uNumInstances = uNumInstances });
+                ++m_cullingStats.uNumRanges;
+            }
+        }
+
+        m_aVisibleVoxelMeshes.resize(m_voxelMeshes.size());
+        for (size_t i = 0u; i < m_voxelMeshes.size(); ++i)
+        {
+            m_aVisibleVoxelMeshes[i] = m_culler && i < m_aVoxelMeshChunks.size() ? static_cast<BYTE>(m_culler->IsChunkVisible(m_aVoxelMeshChunks[i])) : TRUE;
+        }
+    }
+
+    const std::vector<InstanceRange>& Scene::GetVisibleInstanceRanges(_In_ size_t uVoxelIdx) const
+    {
+        return m_aVisibleInstanceRanges[uVoxelIdx];
+    }
+
+    BOOL Scene::IsVoxelMeshVisible(_In_ size_t uVoxelMeshIdx) const
+    {
+        return uVoxelMeshIdx < m_aVisibleVoxelMeshes.size() ? m_aVisibleVoxelMeshes[uVoxelMeshIdx] : TRUE;
+    }
+
+    const ChunkCullingStats& Scene::GetCullingStats() const
+    {
+        return m_cullingStats;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::SetBlock
+
+      Summary:  Places a block. Columns of the height map have no
+                holes, so a block above the column grows it to reach the
+                block with the new type, and a block inside of it only
+                changes that block. Waits for the chunk workers reading
+                the height map first. Only the chunks showing the
+                column are refreshed, on the next UpdateChunks
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT y
+                  Block index along the y axis
+                UINT z
+                  Column index along the z axis
+                BYTE type
+                  Palette entry of the block
+
+      Modifies: [m_heightMap, m_lightMap, m_chunkStreamer, m_raycaster].
+
+      Returns:  HRESULT
+                  Status code. E_FAIL if the scene does not stream its
+                  chunks, E_INVALIDARG if the block is outside of the
+                  map or the type is not in the palette
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::SetBlock(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ BYTE type)
+    {
+        if (!m_chunkStreamer || x >= m_heightMap->GetWidth() || z >= m_heightMap->GetDepth())
+        {
+            return m_chunkStreamer ? E_INVALIDARG : E_FAIL;
+        }
+
+        const UINT uOldNumBlocks = m_heightMap->GetColumnType(x, z) < m_heightMap->GetNumColors() ? m_heightMap->GetColumnHeight(x, z) : 0u;
+        std::unique_lock<std::shared_mutex> mapsLock = m_chunkStreamer->LockMaps();
+        HRESULT hr = m_heightMap->SetBlock(x, y, z, type);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        onColumnChanged(x, z, y < uOldNumBlocks ? y : uOldNumBlocks, y + 1u);
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::RemoveBlock
+
+      Summary:  Removes a block. Columns of a height map have no holes,
+                so the blocks above it are removed as well. Waits for
+                the chunk workers reading the height map first
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT y
+                  Block index along the y axis
+                UINT z
+                  Column index along the z axis
+
+      Modifies: [m_heightMap, m_lightMap, m_chunkStreamer].
+
+      Returns:  HRESULT
+                  Status code. E_FAIL if the scene does not stream its
+                  chunks, E_INVALIDARG if the column is outside of the
+                  map. S_FALSE if there was no block to remove
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::RemoveBlock(_In_ UINT x, _In_ UINT y, _In_ UINT z)
+    {
+        if (!m_chunkStreamer || x >= m_heightMap->GetWidth() || z >= m_heightMap->GetDepth())
+        {
+            return m_chunkStreamer ? E_INVALIDARG : E_FAIL;
+        }
+
+        const BYTE type = m_heightMap->GetColumnType(x, z);
+        if (type >= m_heightMap->GetNumColors() || y >= m_heightMap->GetColumnHeight(x, z))
+        {
+            return S_FALSE;
+        }
+
+        const UINT uOldNumBlocks = m_heightMap->GetColumnHeight(x, z);
+        std::unique_lock<std::shared_mutex> mapsLock = m_chunkStreamer->LockMaps();
+        HRESULT hr = m_heightMap->TruncateColumn(x, z, y);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        onColumnChanged(x, z, y, uOldNumBlocks);
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::SetBlockLight
+
+      Summary:  Adds, changes or removes a light in an empty block, like
+                a torch. The light spreads over the next UpdateChunks
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT y
+                  Block index along the y axis
+                UINT z
+                  Column index along the z axis
+                BYTE level
+                  Light emitted, up to VoxelLightMap::MAX_LIGHT_LEVEL.
+                  0 removes the light
+
+      Modifies: [m_lightMap].
+
+      Returns:  HRESULT
+                  Status code. E_FAIL if the scene has no light map,
+                  E_INVALIDARG if the block is outside of the map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::SetBlockLight(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ BYTE level)
+    {
+        if (!m_lightMap)
+        {
+            return E_FAIL;
+        }
+
+        std::unique_lock<std::shared_mutex> mapsLock = m_chunkStreamer->LockMaps();
+
+        return m_lightMap->SetEmitter(x, y, z, level);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::SetEmissiveType
+
+      Summary:  Makes the exposed blocks of a palette entry emit light
+                and relights the whole map, which refreshes every
+                resident chunk on the next UpdateChunks
+
+      Args:     BYTE type
+                  Palette entry
+                BYTE level
+                  Light emitted, up to VoxelLightMap::MAX_LIGHT_LEVEL.
+                  0 stops the entry from emitting
+
+      Modifies: [m_lightMap].
+
+      Returns:  HRESULT
+                  Status code. E_FAIL if the scene has no light map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::SetEmissiveType(_In_ BYTE type, _In_ BYTE level)
+    {
+        if (!m_lightMap)
+        {
+            return E_FAIL;
+        }
+
+        std::unique_lock<std::shared_mutex> mapsLock = m_chunkStreamer->LockMaps();
+        m_lightMap->SetEmissiveType(type, level);
+        m_lightMap->Initialize();
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetLightMap
+
+      Summary:  Returns the light map of the lit greedy meshes. It is
+                read by the chunk workers, so it is changed through
+                SetBlockLight and SetEmissiveType only
+
+      Returns:  const VoxelLightMap*
+                  Light map, or null if the meshes are not lit
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const VoxelLightMap* Scene::GetLightMap() const
+    {
+        return m_lightMap.get();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::SaveWorld
+
+      Summary:  Starts saving the chunks edited since the height map was
+                generated. The file is written on a background thread,
+                GetWorldSave()->GetSaveResult tells when it is done.
+                While a world save is still being loaded, the save is
+                deferred until UpdateChunks has applied all of it, so
+                its chunks are not dropped from the new save
+
+      Args:     const std::filesystem::path& filePath
+                  Path of the world save
+
+      Modifies: [m_worldSave, m_pendingSavePath].
+
+      Returns:  HRESULT
+                  Status code. E_FAIL if the scene does not stream its
+                  chunks, HRESULT_FROM_WIN32(ERROR_BUSY) if a world
+                  save is being written
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::SaveWorld(_In_ const std::filesystem::path& filePath)
+    {
+        if (!m_worldSave)
+        {
+            return E_FAIL;
+        }
+
+        if (m_worldSave->IsLoading())
+        {
+            m_pendingSavePath = filePath;
+            return S_OK;
+        }
+
+        return m_worldSave->Save(filePath);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::LoadWorld
+
+      Summary:  Starts loading a world save made from the same height
+                map. Its chunks are read on a background thread and
+                applied by UpdateChunks, nearest to the camera first,
+                so the game keeps running while they stream in
+
+      Args:     const std::filesystem::path& filePath
+                  Path of the world save
+
+      Modifies: [m_worldSave].
+
+      Returns:  HRESULT
+                  Status code. E_FAIL if the scene does not stream its
+                  chunks, HRESULT_FROM_WIN32(ERROR_BUSY) if a world
+                  save is being written or loaded
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::LoadWorld(_In_ const std::filesystem::path& filePath)
+    {
+        if (!m_worldSave)
+        {
+            return E_FAIL;
+        }
+
+        return m_worldSave->Load(filePath);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::FinishWorld
+
+      Summary:  Applies the rest of the world save being loaded, starts
+                the save deferred by SaveWorld and waits for the save
+                being written. Blocks, so it is meant for shutdown once
+                UpdateChunks is no longer called
+
+      Modifies: [m_worldSave, m_pendingSavePath, m_heightMap,
+                 m_lightMap, m_chunkStreamer, m_raycaster,
+                 m_bCullingDataDirty].
+
+      Returns:  HRESULT
+                  Status code of the last save. E_FAIL if the scene
+                  does not stream its chunks
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::FinishWorld()
+    {
+        if (!m_worldSave)
+        {
+            return E_FAIL;
+        }
+
+        finishWorldLoad();
+
+        if (!m_pendingSavePath.empty())
+        {
+            m_worldSave->WaitForSave();
+            HRESULT hr = m_worldSave->Save(m_pendingSavePath);
+            m_pendingSavePath.clear();
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+
+        return m_worldSave->WaitForSave();
+    }
+
+    WorldSave* Scene::GetWorldSave()
+    {
+        return m_worldSave.get();
+    }
+
     std::vector<std::shared_ptr<Voxel>>& Scene::GetVoxels()
     {
         return m_voxels;
     }
 
+    std::vector<std::shared_ptr<VoxelMesh>>& Scene::GetVoxelMeshes()
+    {
+        return m_voxelMeshes;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetPaletteConstantBuffer
+
+      Summary:  Returns the constant buffer holding the block colors
+                of the height map, created by Initialize
+
+      Returns:  ComPtr<ID3D11Buffer>&
+                  Palette constant buffer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ComPtr<ID3D11Buffer>& Scene::GetPaletteConstantBuffer()
+    {
+        return m_cbPalette;
+    }
+
     std::unordered_map<std::wstring, std::shared_ptr<Renderable>>& Scene::GetRenderables()
     {
         return m_renderables;
@@ -597,9 +1134,10 @@ namespace library
             return E_FAIL;
         }
 
+        m_voxelVertexShader = m_vertexShaders[pszVertexShaderName];
         for (std::shared_ptr<Voxel>& voxel : m_voxels)
         {
-            voxel->SetVertexShader(m_vertexShaders[pszVertexShaderName]);
+            voxel->SetVertexShader(m_voxelVertexShader);
         }
 
         return S_OK;
@@ -627,9 +1165,14 @@ namespace library
             return E_FAIL;
         }
 
+        m_voxelPixelShader = m_pixelShaders[pszPixelShaderName];
         for (std::shared_ptr<Voxel>& voxel : m_voxels)
         {
-            voxel->SetPixelShader(m_pixelShaders[pszPixelShaderName]);
+            voxel->SetPixelShader(m_voxelPixelShader);
+        }
+        for (std::shared_ptr<VoxelMesh>& mesh : m_voxelMeshes)
+        {
+            mesh->SetPixelShader(m_voxelPixelShader);
         }
 
         return S_OK;
@@ -642,47 +1185,460 @@ namespace library
             return E_FAIL;
         }
 
+        m_voxelMaterial = m_materials[pszMaterialName];
         for (std::shared_ptr<Voxel>& voxel : m_voxels)
         {
-            voxel->AddMaterial(m_materials[pszMaterialName]);
+            voxel->AddMaterial(m_voxelMaterial);
+        }
+        for (std::shared_ptr<VoxelMesh>& mesh : m_voxelMeshes)
+        {
+            mesh->AddMaterial(m_voxelMaterial);
         }
 
         return S_OK;
     }
 
-    FLOAT Scene::getNoise2(UINT x, UINT y)
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::SetVertexShaderOfVoxelMesh
+
+      Summary:  Sets the vertex shader for the greedy meshed chunks in
+                a scene. They share the pixel shader and the material
+                of the voxels
+
+      Args:     PCWSTR pszVertexShaderName
+                  Key of the vertex shader
+
+      Modifies: [m_voxelMeshVertexShader, m_voxelMeshes].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::SetVertexShaderOfVoxelMesh(_In_ PCWSTR pszVertexShaderName)
+    {
+        if (!m_vertexShaders.contains(pszVertexShaderName))
+        {
+            return E_FAIL;
+        }
+
+        m_voxelMeshVertexShader = m_vertexShaders[pszVertexShaderName];
+        for (std::shared_ptr<VoxelMesh>& mesh : m_voxelMeshes)
+        {
+            mesh->SetVertexShader(m_voxelMeshVertexShader);
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::Scene
+
+      Summary:  Constructor every public constructor delegates to. The
+                height map is created empty, to be loaded by the caller
+
+      Modifies: [m_filePath, m_voxels, m_voxelMeshes, m_renderables,
+                 m_models, m_aPointLights, m_vertexShaders,
+                 m_pixelShaders, m_materials, m_skyBox,
+                 m_voxelVertexShader, m_voxelPixelShader,
+                 m_voxelMaterial, m_voxelMeshVertexShader, m_heightMap,
+                 m_lightMap, m_chunkStreamer, m_raycaster, m_worldSave,
+                 m_pendingSavePath, m_culler, m_aVoxelChunkRanges,
+                 m_aVoxelMeshChunks, m_aVisibleInstanceRanges,
+                 m_aVisibleVoxelMeshes, m_cullingStats,
+                 m_bCullingDataDirty, m_cbPalette].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    Scene::Scene()
+        : m_filePath()
+        , m_voxels()
+        , m_voxelMeshes()
+        , m_renderables()
+        , m_models()
+        , m_aPointLights{ nullptr }
+        , m_vertexShaders()
+        , m_pixelShaders()
+        , m_materials()
+        , m_skyBox()
+        , m_voxelVertexShader()
+        , m_voxelPixelShader()
+        , m_voxelMaterial()
+        , m_voxelMeshVertexShader()
+        , m_heightMap(std::make_unique<HeightMap>())
+        , m_lightMap()
+        , m_chunkStreamer()
+        , m_raycaster()
+        , m_worldSave()
+        , m_pendingSavePath()
+        , m_culler()
+        , m_aVoxelChunkRanges()
+        , m_aVoxelMeshChunks()
+        , m_aVisibleInstanceRanges()
+        , m_aVisibleVoxelMeshes()
+        , m_cullingStats()
+        , m_bCullingDataDirty(FALSE)
+        , m_cbPalette()
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::initializeVoxels
+
+      Summary:  Creates the voxels of the height map. The map is split
+                into square chunks filled in parallel, and the
+                instances of every chunk are concatenated in chunk
+                order so each chunk owns a contiguous instance range
+                that the frustum culling can draw or skip. Full
+                instances make one voxel per palette color. Packed
+                instances make a single voxel holding every palette
+                entry, so the whole terrain is one draw, and the
+                vertex shader reads the color of each instance from
+                the palette constant buffer. Also creates the
+                raycaster of the height map
+
+      Args:     const HeightMap& heightMap
+                  Height map to build the voxels from
+                eVoxelInstancing instancing
+                  One instance per block or per column
+                BOOL bPackedInstances
+                  Whether to build PackedInstanceData, to be drawn
+                  with VSPackedVoxel, instead of InstanceData
+                ThreadPool& threadPool
+                  Thread pool to build the instance data on
+
+      Modifies: [m_voxels, m_culler, m_aVoxelChunkRanges, m_raycaster].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::initializeVoxels(
+        _In_ const HeightMap& heightMap,
+        _In_ eVoxelInstancing instancing,
+        _In_ BOOL bPackedInstances,
+        _In_ ThreadPool& threadPool
+    )
     {
-        UINT temp = ms_aHashes[y % 256u];
+        const UINT uChunkSize = ChunkCuller::DEFAULT_CHUNK_SIZE;
+        const UINT uNumChunksX = (heightMap.GetWidth() + uChunkSize - 1u) / uChunkSize;
+        const UINT uNumChunksZ = (heightMap.GetDepth() + uChunkSize - 1u) / uChunkSize;
+        const UINT uNumChunks = uNumChunksX * uNumChunksZ;
+
+        m_raycaster = std::make_unique<VoxelRaycaster>(heightMap);
+        m_culler = std::make_unique<ChunkCuller>(uNumChunksX, uNumChunksZ);
+
+        for (UINT uChunkIdx = 0u; uChunkIdx < uNumChunks; ++uChunkIdx)
+        {
+            const UINT uBeginX = (uChunkIdx % uNumChunksX) * uChunkSize;
+            const UINT uBeginZ = (uChunkIdx / uNumChunksX) * uChunkSize;
+
+            XMFLOAT3 boxMin;
+            XMFLOAT3 boxMax;
+            heightMap.GetBounds(uBeginX, uBeginZ, uBeginX + uChunkSize, uBeginZ + uChunkSize, boxMin, boxMax);
+            m_culler->SetChunkBounds(uChunkIdx % uNumChunksX, uChunkIdx / uNumChunksX, boxMin, boxMax);
+        }
+
+        if (bPackedInstances)
+        {
+            initializePackedVoxels(heightMap, instancing, threadPool);
+            return;
+        }
+
+        std::vector<std::vector<std::vector<InstanceData>>> aChunkInstanceData(uNumChunks);
+        threadPool.ParallelFor(uNumChunks, [&heightMap, &aChunkInstanceData, instancing, uChunkSize, uNumChunksX](UINT uChunkIdx)
+        {
+            const UINT uBeginX = (uChunkIdx % uNumChunksX) * uChunkSize;
+            const UINT uBeginZ = (uChunkIdx / uNumChunksX) * uChunkSize;
+            heightMap.FillInstanceData(uBeginX, uBeginZ, uBeginX + uChunkSize, uBeginZ + uChunkSize, instancing, aChunkInstanceData[uChunkIdx]);
+        });
+
+        for (UINT uColorIdx = 0u; uColorIdx < heightMap.GetNumColors(); ++uColorIdx)
+        {
+            size_t uNumInstances = 0u;
+            for (const std::vector<std::vector<InstanceData>>& aInstanceData : aChunkInstanceData)
+            {
+                uNumInstances += aInstanceData[uColorIdx].size();
+            }
+
+            if (uNumInstances == 0u)
+            {
+                continue;
+            }
+
+            std::vector<InstanceData> aInstanceData;
+            std::vector<ChunkInstanceRange> aChunkRanges;
+            aInstanceData.reserve(uNumInstances);
+            for (UINT uChunkIdx = 0u; uChunkIdx < uNumChunks; ++uChunkIdx)
+            {
+                std::vector<InstanceData>& aChunk = aChunkInstanceData[uChunkIdx][uColorIdx];
+                if (aChunk.empty())
+                {
+                    continue;
+                }
+
+                aChunkRanges.push_back(
+                    {
+                        .uChunkIndex = uChunkIdx,
+                        .uBeginInstance = static_cast<UINT>(aInstanceData.size()),
+                        .uNumInstances = static_cast<UINT>(aChunk.size()),
+                    }
+                );
+                aInstanceData.insert(aInstanceData.end(), aChunk.begin(), aChunk.end());
+                std::vector<InstanceData>().swap(aChunk);
+            }
+
+            m_aVoxelChunkRanges.push_back(std::move(aChunkRanges));
+            m_voxels.push_back(std::make_shared<Voxel>(std::move(aInstanceData), heightMap.GetColor(uColorIdx)));
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::initializePackedVoxels
+
+      Summary:  Creates the single voxel of packed instances of the
+                height map for initializeVoxels, whose chunks it uses
+
+      Args:     const HeightMap& heightMap
+                  Height map to build the voxel from
+                eVoxelInstancing instancing
+                  One instance per block or per column
+                ThreadPool& threadPool
+                  Thread pool to build the instance data on
+
+      Modifies: [m_voxels, m_aVoxelChunkRanges].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::initializePackedVoxels(_In_ const HeightMap& heightMap, _In_ eVoxelInstancing instancing, _In_ ThreadPool& threadPool)
+    {
+        const UINT uChunkSize = ChunkCuller::DEFAULT_CHUNK_SIZE;
+        const UINT uNumChunksX = (heightMap.GetWidth() + uChunkSize - 1u) / uChunkSize;
+        const UINT uNumChunksZ = (heightMap.GetDepth() + uChunkSize - 1u) / uChunkSize;
+        const UINT uNumChunks = uNumChunksX * uNumChunksZ;
+
+        std::vector<std::vector<std::vector<PackedInstanceData>>> aChunkInstanceData(uNumChunks);
+        threadPool.ParallelFor(uNumChunks, [&heightMap, &aChunkInstanceData, instancing, uChunkSize, uNumChunksX](UINT uChunkIdx)
+        {
+            const UINT uBeginX = (uChunkIdx % uNumChunksX) * uChunkSize;
+            const UINT uBeginZ = (uChunkIdx / uNumChunksX) * uChunkSize;
+            heightMap.FillPackedInstanceData(uBeginX, uBeginZ, uBeginX + uChunkSize, uBeginZ + uChunkSize, instancing, aChunkInstanceData[uChunkIdx]);
+        });
+
+        size_t uNumInstances = 0u;
+        for (const std::vector<std::vector<PackedInstanceData>>& aChunk : aChunkInstanceData)
+        {
+            for (const std::vector<PackedInstanceData>& aColorInstanceData : aChunk)
+            {
+                uNumInstances += aColorInstanceData.size();
+            }
+        }
+
+        if (uNumInstances == 0u)
+        {
+            return;
+        }
+
+        std::vector<PackedInstanceData> aInstanceData;
+        std::vector<ChunkInstanceRange> aChunkRanges;
+        aInstanceData.reserve(uNumInstances);
+        for (UINT uChunkIdx = 0u; uChunkIdx < uNumChunks; ++uChunkIdx)
+        {
+            const size_t uBeginInstance = aInstanceData.size();
+            for (std::vector<PackedInstanceData>& aColorInstanceData : aChunkInstanceData[uChunkIdx])
+            {
+                aInstanceData.insert(aInstanceData.end(), aColorInstanceData.begin(), aColorInstanceData.end());
+            }
+            std::vector<std::vector<PackedInstanceData>>().swap(aChunkInstanceData[uChunkIdx]);
+
+            if (aInstanceData.size() == uBeginInstance)
+            {
+                continue;
+            }
+
+            aChunkRanges.push_back(
+                {
+                    .uChunkIndex = uChunkIdx,
+                    .uBeginInstance = static_cast<UINT>(uBeginInstance),
+                    .uNumInstances = static_cast<UINT>(aInstanceData.size() - uBeginInstance),
+                }
+            );
+        }
 
-        return static_cast<FLOAT>(ms_aHashes[(temp + x) % 256u]);
+        m_aVoxelChunkRanges.push_back(std::move(aChunkRanges));
+        m_voxels.push_back(std::make_shared<Voxel>(std::move(aInstanceData), heightMap.GetGridOrigin(), XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f)));
     }
 
-    FLOAT Scene::getNoise2d(FLOAT x, FLOAT y)
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::initializeStreaming
+
+      Summary:  Creates the chunk streaming of the loaded height map,
+                with its light map when greedy meshes are lit, and the
+                raycaster and world save working on the same map
+
+      Args:     const ChunkStreamingDesc& streamingDesc
+                  Chunk size, residency radius, memory budget and
+                  number of threads of the streaming
+
+      Modifies: [m_lightMap, m_chunkStreamer, m_raycaster, m_worldSave].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::initializeStreaming(_In_ const ChunkStreamingDesc& streamingDesc)
     {
-        UINT uX = static_cast<UINT>(x);
-        UINT uY = static_cast<UINT>(y);
-        FLOAT xFrac = x - static_cast<FLOAT>(uX);
-        FLOAT yFrac = y - static_cast<FLOAT>(uY);
+        if (streamingDesc.bGreedyMeshing && streamingDesc.bVoxelLighting)
+        {
+            m_lightMap = std::make_unique<VoxelLightMap>(*m_heightMap);
+            m_lightMap->Initialize();
+        }
+        m_chunkStreamer = std::make_unique<ChunkStreamer>(*m_heightMap, streamingDesc, m_lightMap.get());
+        m_raycaster = std::make_unique<VoxelRaycaster>(*m_heightMap);
+        m_worldSave = std::make_unique<WorldSave>(*m_heightMap, streamingDesc.uChunkSize);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::onColumnChanged
+
+      Summary:  Queues the light around blocks of a column that were
+                edited and marks the chunks showing it as dirty
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT z
+                  Column index along the z axis
+                UINT uBeginY
+                  First block that changed
+                UINT uEndY
+                  One past the last block that changed
+
+      Modifies: [m_lightMap, m_chunkStreamer, m_raycaster,
+                 m_worldSave, m_bCullingDataDirty].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::onColumnChanged(_In_ UINT x, _In_ UINT z, _In_ UINT uBeginY, _In_ UINT uEndY)
+    {
+        if (m_lightMap)
+        {
+            m_lightMap->OnColumnChanged(x, z, uBeginY, uEndY);
+        }
+
+        m_chunkStreamer->InvalidateColumn(x, z);
+        m_worldSave->OnColumnChanged(x, z);
+        m_bCullingDataDirty = TRUE;
+        if (m_raycaster)
+        {
+            m_raycaster->OnColumnChanged(m_heightMap->GetColumnHeight(x, z));
+        }
+    }
 
-        UINT s = static_cast<UINT>(getNoise2(uX, uY));
-        UINT t = static_cast<UINT>(getNoise2(uX + 1u, uY));
-        UINT u = static_cast<UINT>(getNoise2(uX, uY + 1u));
-        UINT v = static_cast<UINT>(getNoise2(uX + 1u, uY + 1u));
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::finishWorldLoad
 
-        FLOAT low = smoothLerp(static_cast<FLOAT>(s), static_cast<FLOAT>(t), xFrac);
-        FLOAT high = smoothLerp(static_cast<FLOAT>(u), static_cast<FLOAT>(v), xFrac);
+      Summary:  Waits for the world save being loaded and applies every
+                chunk left, regardless of the camera. Sleeps on the
+                world save between batches instead of spinning. Does
+                nothing if no load is in progress
 
-        return smoothLerp(low, high, yFrac);
+      Modifies: [m_worldSave, m_heightMap, m_lightMap, m_chunkStreamer,
+                 m_raycaster, m_bCullingDataDirty].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::finishWorldLoad()
+    {
+        std::vector<WorldSaveChunk> aChunks;
+        while (m_worldSave->IsLoading())
+        {
+            m_worldSave->Update(0, 0, WorldSave::MAX_PENDING_CHUNKS, aChunks);
+            if (aChunks.empty())
+            {
+                m_worldSave->WaitForChunks();
+                continue;
+            }
+
+            std::unique_lock<std::shared_mutex> mapsLock = m_chunkStreamer->LockMaps();
+            for (WorldSaveChunk& chunk : aChunks)
+            {
+                applyWorldChunk(chunk);
+            }
+        }
     }
 
-    FLOAT Scene::lerp(FLOAT x, FLOAT y, FLOAT s)
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::applyWorldChunk
+
+      Summary:  Replaces the columns of a chunk read from a world save.
+                Only the blocks from the first one that differs are
+                relit, so chunks that were already up to date cost
+                little. Must be called while holding
+                ChunkStreamer::LockMaps
+
+      Args:     WorldSaveChunk& chunk
+                  Chunk read from the world save. Its runs are moved
+                  into the height map
+
+      Modifies: [m_heightMap, m_lightMap, m_chunkStreamer, m_raycaster,
+                 m_worldSave, m_bCullingDataDirty].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::applyWorldChunk(_Inout_ WorldSaveChunk& chunk)
     {
-        return x + s * (y - x);
+        const UINT uBeginX = chunk.uChunkX * m_worldSave->GetChunkSize();
+        const UINT uBeginZ = chunk.uChunkZ * m_worldSave->GetChunkSize();
+        const UINT uEndX = uBeginX + m_worldSave->GetChunkSize() < m_heightMap->GetWidth() ? uBeginX + m_worldSave->GetChunkSize() : m_heightMap->GetWidth();
+        const UINT uNumColumnsX = uEndX - uBeginX;
+
+        std::vector<ColumnRun> aOldRuns;
+        for (size_t i = 0u; i < chunk.aColumns.size(); ++i)
+        {
+            const UINT x = uBeginX + static_cast<UINT>(i % uNumColumnsX);
+            const UINT z = uBeginZ + static_cast<UINT>(i / uNumColumnsX);
+            std::vector<ColumnRun>& aNewRuns = chunk.aColumns[i];
+            m_heightMap->GetColumnRuns(x, z, aOldRuns);
+
+            // Skip the runs both columns share from the bottom
+            UINT uBeginY = 0u;
+            size_t uOldIdx = 0u;
+            size_t uNewIdx = 0u;
+            while (uOldIdx < aOldRuns.size() && uNewIdx < aNewRuns.size() && aOldRuns[uOldIdx].type == aNewRuns[uNewIdx].type)
+            {
+                const WORD uEndBlock = aOldRuns[uOldIdx].uEndBlock < aNewRuns[uNewIdx].uEndBlock ? aOldRuns[uOldIdx].uEndBlock : aNewRuns[uNewIdx].uEndBlock;
+                uOldIdx += aOldRuns[uOldIdx].uEndBlock == uEndBlock ? 1u : 0u;
+                uNewIdx += aNewRuns[uNewIdx].uEndBlock == uEndBlock ? 1u : 0u;
+                uBeginY = uEndBlock;
+            }
+
+            const UINT uOldNumBlocks = aOldRuns.empty() ? 0u : aOldRuns.back().uEndBlock;
+            const UINT uNewNumBlocks = aNewRuns.empty() ? 0u : aNewRuns.back().uEndBlock;
+            if (uOldIdx == aOldRuns.size() && uNewIdx == aNewRuns.size())
+            {
+                continue;
+            }
+
+            if (SUCCEEDED(m_heightMap->SetColumnRuns(x, z, std::move(aNewRuns))))
+            {
+                onColumnChanged(x, z, uBeginY, uOldNumBlocks > uNewNumBlocks ? uOldNumBlocks : uNewNumBlocks);
+            }
+        }
     }
 
-    FLOAT Scene::smoothLerp(FLOAT x, FLOAT y, FLOAT s)
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::updateCullingData
+
+      Summary:  Rebuilds the chunk bounds of the culling from the
+                resident chunks. A streamed voxel holds the instances
+                of a single chunk, so it is drawn or skipped as a whole
+
+      Modifies: [m_culler, m_aVoxelChunkRanges, m_aVoxelMeshChunks,
+                 m_bCullingDataDirty].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Scene::updateCullingData()
     {
-        return lerp(x, y, s * s * (3.0f - 2.0f * s));
+        if (!m_culler)
+        {
+            m_culler = std::make_unique<ChunkCuller>(0u, 0u);
+        }
+
+        std::vector<UINT> aVoxelChunks;
+        m_chunkStreamer->GetCullingData(*m_culler, aVoxelChunks, m_aVoxelMeshChunks);
+        m_bCullingDataDirty = FALSE;
+
+        m_aVoxelChunkRanges.resize(aVoxelChunks.size());
+        for (size_t i = 0u; i < aVoxelChunks.size(); ++i)
+        {
+            m_aVoxelChunkRanges[i].assign(
+                1u,
+                {
+                    .uChunkIndex = aVoxelChunks[i],
+                    .uBeginInstance = 0u,
+                    .uNumInstances = m_voxels[i]->GetNumInstances(),
+                }
+            );
+        }
     }
 
 }
\ No newline at end of file
@@ -19,16 +19,30 @@
 #include "Light/PointLight.h"
 #include "Renderer/Skybox.h"
 #include "Renderer/Renderable.h"
+#include "Scene/ChunkCuller.h"
+#include "Scene/ChunkStreamer.h"
+#include "Scene/HeightMap.h"
+#include "Scene/PerlinNoise.h"
 #include "Scene/Voxel.h"
+#include "Scene/VoxelLightMap.h"
+#include "Scene/VoxelMesh.h"
+#include "Scene/VoxelRaycaster.h"
+#include "Scene/WorldSave.h"
 
 namespace library
 {
     class Scene
     {
     public:
+        static constexpr const UINT MAX_LIGHT_STEPS_PER_UPDATE = 32768u;
+        static constexpr const UINT MAX_WORLD_CHUNKS_PER_UPDATE = 2u;
+
         static FLOAT GetPerlin2d(FLOAT x, FLOAT y, FLOAT frequency, UINT uDepth);
 
-        Scene(const std::filesystem::path& filePath);
+        Scene(const std::filesystem::path& filePath, _In_opt_ eVoxelInstancing instancing = eVoxelInstancing::BLOCK, _In_opt_ BOOL bPackedInstances = FALSE);
+        Scene(_In_ const std::filesystem::path& filePath, _In_ const ChunkStreamingDesc& streamingDesc);
+        Scene(_In_ const HeightMapGrid& grid, _In_opt_ eVoxelInstancing instancing = eVoxelInstancing::BLOCK, _In_opt_ BOOL bPackedInstances = FALSE);
+        Scene(_In_ const HeightMapGrid& grid, _In_ const ChunkStreamingDesc& streamingDesc);
         Scene(const Scene& other) = delete;
         Scene(Scene&& other) = delete;
         Scene& operator=(const Scene& other) = delete;
@@ -47,8 +61,35 @@ namespace library
         HRESULT AddMaterial(_In_ const std::shared_ptr<Material>& material);
 
         void Update(_In_ FLOAT deltaTime);
+        HRESULT UpdateChunks(_In_ const XMVECTOR& eye, _In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext);
+
+        BOOL Raycast(_In_ const VoxelRay& ray, _Out_ VoxelRaycastHit& outHit) const;
+        void RaycastBatch(
+            _In_ const std::vector<VoxelRay>& aRays,
+            _Out_ std::vector<VoxelRaycastHit>& aOutHits,
+            _In_opt_ ThreadPool* pThreadPool = nullptr
+        ) const;
+        const VoxelRaycaster* GetRaycaster() const;
+
+        void CullVoxels(_In_ const XMMATRIX& viewProjection);
+        const std::vector<InstanceRange>& GetVisibleInstanceRanges(_In_ size_t uVoxelIdx) const;
+        BOOL IsVoxelMeshVisible(_In_ size_t uVoxelMeshIdx) const;
+        const ChunkCullingStats& GetCullingStats() const;
+
+        HRESULT SetBlock(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ BYTE type);
+        HRESULT RemoveBlock(_In_ UINT x, _In_ UINT y, _In_ UINT z);
+        HRESULT SetBlockLight(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ BYTE level);
+        HRESULT SetEmissiveType(_In_ BYTE type, _In_ BYTE level);
+        const VoxelLightMap* GetLightMap() const;
+
+        HRESULT SaveWorld(_In_ const std::filesystem::path& filePath);
+        HRESULT LoadWorld(_In_ const std::filesystem::path& filePath);
+        HRESULT FinishWorld();
+        WorldSave* GetWorldSave();
 
         std::vector<std::shared_ptr<Voxel>>& GetVoxels();
+        std::vector<std::shared_ptr<VoxelMesh>>& GetVoxelMeshes();
+        ComPtr<ID3D11Buffer>& GetPaletteConstantBuffer();
         std::unordered_map<std::wstring, std::shared_ptr<Renderable>>& GetRenderables();
         std::unordered_map<std::wstring, std::shared_ptr<Model>>& GetModels();
         std::shared_ptr<PointLight>& GetPointLight(_In_ size_t index);
@@ -67,33 +108,28 @@ namespace library
         HRESULT SetVertexShaderOfVoxel(_In_ PCWSTR pszVertexShaderName);
         HRESULT SetPixelShaderOfVoxel(_In_ PCWSTR pszPixelShaderName);
         HRESULT SetMaterialOfVoxel(_In_ PCWSTR pszMaterialName);
+        HRESULT SetVertexShaderOfVoxelMesh(_In_ PCWSTR pszVertexShaderName);
 
     private:
-        static FLOAT getNoise2(UINT x, UINT y);
-        static FLOAT getNoise2d(FLOAT x, FLOAT y);
-        static FLOAT lerp(FLOAT x, FLOAT y, FLOAT s);
-        static FLOAT smoothLerp(FLOAT x, FLOAT y, FLOAT s);
-
-    private:
-        static constexpr const UINT ms_aHashes[] =
-        {
-            208,34,231,213,32,248,233,56,161,78,24,140,71,48,140,254,245,255,247,247,40,
-            185,248,251,245,28,124,204,204,76,36,1,107,28,234,163,202,224,245,128,167,204,
-            9,92,217,54,239,174,173,102,193,189,190,121,100,108,167,44,43,77,180,204,8,81,
-            70,223,11,38,24,254,210,210,177,32,81,195,243,125,8,169,112,32,97,53,195,13,
-            203,9,47,104,125,117,114,124,165,203,181,235,193,206,70,180,174,0,167,181,41,
-            164,30,116,127,198,245,146,87,224,149,206,57,4,192,210,65,210,129,240,178,105,
-            228,108,245,148,140,40,35,195,38,58,65,207,215,253,65,85,208,76,62,3,237,55,89,
-            232,50,217,64,244,157,199,121,252,90,17,212,203,149,152,140,187,234,177,73,174,
-            193,100,192,143,97,53,145,135,19,103,13,90,135,151,199,91,239,247,33,39,145,
-            101,120,99,3,186,86,99,41,237,203,111,79,220,135,158,42,30,154,120,67,87,167,
-            135,176,183,191,253,115,184,21,233,58,129,233,142,39,128,211,118,137,139,255,
-            114,20,218,113,154,27,127,246,250,1,8,198,250,209,92,222,173,21,88,102,219
-        };
+        Scene();
+
+        void initializeVoxels(
+            _In_ const HeightMap& heightMap,
+            _In_ eVoxelInstancing instancing,
+            _In_ BOOL bPackedInstances,
+            _In_ ThreadPool& threadPool
+        );
+        void initializePackedVoxels(_In_ const HeightMap& heightMap, _In_ eVoxelInstancing instancing, _In_ ThreadPool& threadPool);
+        void initializeStreaming(_In_ const ChunkStreamingDesc& streamingDesc);
+        void onColumnChanged(_In_ UINT x, _In_ UINT z, _In_ UINT uBeginY, _In_ UINT uEndY);
+        void finishWorldLoad();
+        void applyWorldChunk(_Inout_ WorldSaveChunk& chunk);
+        void updateCullingData();
 
     private:
         std::filesystem::path m_filePath;
         std::vector<std::shared_ptr<Voxel>> m_voxels;
+        std::vector<std::shared_ptr<VoxelMesh>> m_voxelMeshes;
         std::unordered_map<std::wstring, std::shared_ptr<Renderable>> m_renderables;
         std::unordered_map<std::wstring, std::shared_ptr<Model>> m_models;
         std::shared_ptr<PointLight> m_aPointLights[NUM_LIGHTS];
@@ -101,5 +137,23 @@ namespace library
         std::unordered_map<std::wstring, std::shared_ptr<PixelShader>> m_pixelShaders;
         std::shared_ptr<Skybox> m_skyBox;
         std::unordered_map<std::wstring, std::shared_ptr<Material>> m_materials;
+        std::shared_ptr<VertexShader> m_voxelVertexShader;
+        std::shared_ptr<PixelShader> m_voxelPixelShader;
+        std::shared_ptr<Material> m_voxelMaterial;
+        std::shared_ptr<VertexShader> m_voxelMeshVertexShader;
+        std::unique_ptr<HeightMap> m_heightMap;
+        std::unique_ptr<VoxelLightMap> m_lightMap;
+        std::unique_ptr<ChunkStreamer> m_chunkStreamer;
+        std::unique_ptr<VoxelRaycaster> m_raycaster;
+        std::unique_ptr<WorldSave> m_worldSave;
+        std::filesystem::path m_pendingSavePath;
+        std::unique_ptr<ChunkCuller> m_culler;
+        std::vector<std::vector<ChunkInstanceRange>> m_aVoxelChunkRanges;
+        std::vector<UINT> m_aVoxelMeshChunks;
+        std::vector<std::vector<InstanceRange>> m_aVisibleInstanceRanges;
+        std::vector<BYTE> m_aVisibleVoxelMeshes;
+        ChunkCullingStats m_cullingStats;
+        BOOL m_bCullingDataDirty;
+        ComPtr<ID3D11Buffer> m_cbPalette;
     };
 }
\ No newline at end of file
@@ -0,0 +1,623 @@
+#include "Scene/TerrainGenerator.h"
+
+#include <charconv>
+#include <cmath>
+#include <fstream>
+
+#include "Scene/PerlinNoise.h"
+
+namespace library
+{
+    const XMFLOAT4 TerrainGenerator::ms_aPalette[] =
+    {
+        XMFLOAT4(0.0f,      0.666f, 0.0f,   1.0f),  // GRASSLAND
+        XMFLOAT4(1.0f,      1.0f,   1.0f,   1.0f),  // SNOW
+        XMFLOAT4(0.0f,      0.0f,   0.666f, 1.0f),  // OCEAN
+        XMFLOAT4(1.0f,      0.666f, 0.0f,   1.0f),  // SAND
+        XMFLOAT4(0.666f,    0.0f,   0.0f,   1.0f),  // SCORCHED
+        XMFLOAT4(0.956f,    0.643f, 0.376f, 1.0f),  // BARE
+        XMFLOAT4(0.941f,    0.0f,   1.0f,   1.0f),  // TUNDRA
+        XMFLOAT4(0.803f,    0.521f, 0.247f, 1.0f),  // TEMPERATE_DESERT
+        XMFLOAT4(0.42f,     0.556f, 0.137f, 1.0f),  // SHRUBLAND
+        XMFLOAT4(0.0f,      0.392f, 0.0f,   1.0f),  // TAIGA
+        XMFLOAT4(1.0f,      0.55f,  0.0f,   1.0f),  // TEMPERATE_DECIDUOUS_FOREST
+        XMFLOAT4(0.0f,      0.5f,   0.0f,   1.0f),  // TEMPERATE_RAIN_FOREST
+        XMFLOAT4(0.956f,    0.643f, 0.376f, 1.0f),  // SUBTROPICAL_DESERT
+        XMFLOAT4(0.133f,    0.545f, 0.133f, 1.0f),  // TROPICAL_SEASONAL_FOREST
+        XMFLOAT4(0.15f,     0.372f, 0.15f,  1.0f),  // TROPICAL_RAIN_FOREST
+    };
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::ComputeHeight
+
+      Summary:  Returns the normalized height of a column as
+                NUM_OCTAVES octaves of Perlin noise, weighted by the inverse of
+                their frequency and reshaped to flatten the lowlands
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT z
+                  Column index along the z axis
+
+      Returns:  FLOAT
+                  Height of the column, 0 at the sea floor
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT TerrainGenerator::ComputeHeight(_In_ UINT x, _In_ UINT z)
+    {
+        FLOAT height = 0.0f;
+        FLOAT frequencySum = 0.0f;
+        for (UINT i = 0; i < NUM_OCTAVES; ++i)
+        {
+            FLOAT frequency = pow(2.0f, static_cast<FLOAT>(i));
+            frequencySum += 1.0f / frequency;
+            height += PerlinNoise::Sample2d(frequency * static_cast<FLOAT>(x), frequency * static_cast<FLOAT>(z), NOISE_FREQUENCY, NOISE_DEPTH) / frequency;
+        }
+        height /= frequencySum;
+
+        return pow(height * 1.2f, 1.25f);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::ComputeHeights
+
+      Summary:  Returns the same heights as ComputeHeight for a run of
+                columns of a row, sampling each octave of the whole run
+                with PerlinNoise::SampleBatch2d
+
+      Args:     UINT uBeginX
+                  Column index of the first column along the x axis
+                UINT z
+                  Column index along the z axis
+                UINT uNumColumns
+                  Number of columns
+                FLOAT* pOutHeights
+                  Receives the height of every column
+
+      Modifies: [pOutHeights].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TerrainGenerator::ComputeHeights(_In_ UINT uBeginX, _In_ UINT z, _In_ UINT uNumColumns, _Out_writes_(uNumColumns) FLOAT* pOutHeights)
+    {
+        constexpr const UINT BATCH_SIZE = 64u;
+
+        FLOAT aX[BATCH_SIZE];
+        FLOAT aZ[BATCH_SIZE];
+        FLOAT aSamples[BATCH_SIZE];
+        for (UINT uBegin = 0u; uBegin < uNumColumns; uBegin += BATCH_SIZE)
+        {
+            const UINT uCount = uNumColumns - uBegin < BATCH_SIZE ? uNumColumns - uBegin : BATCH_SIZE;
+            FLOAT* pHeights = pOutHeights + uBegin;
+            for (UINT i = 0u; i < uCount; ++i)
+            {
+                pHeights[i] = 0.0f;
+            }
+
+            FLOAT frequencySum = 0.0f;
+            for (UINT uOctave = 0; uOctave < NUM_OCTAVES; ++uOctave)
+            {
+                FLOAT frequency = pow(2.0f, static_cast<FLOAT>(uOctave));
+                frequencySum += 1.0f / frequency;
+                for (UINT i = 0u; i < uCount; ++i)
+                {
+                    aX[i] = frequency * static_cast<FLOAT>(uBeginX + uBegin + i);
+                    aZ[i] = frequency * static_cast<FLOAT>(z);
+                }
+
+                PerlinNoise::SampleBatch2d(aX, aZ, uCount, NOISE_FREQUENCY, NOISE_DEPTH, aSamples);
+                for (UINT i = 0u; i < uCount; ++i)
+                {
+                    pHeights[i] += aSamples[i] / frequency;
+                }
+            }
+
+            for (UINT i = 0u; i < uCount; ++i)
+            {
+                pHeights[i] = pow((pHeights[i] / frequencySum) * 1.2f, 1.25f);
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::ComputeBlockType
+
+      Summary:  Returns the biome of a column from its height and its
+                moisture
+
+      Args:     FLOAT height
+                  Normalized height of the column
+                FLOAT moisture
+                  Normalized moisture of the column
+
+      Returns:  eBlockType
+                  Biome of the column
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    eBlockType TerrainGenerator::ComputeBlockType(_In_ FLOAT height, _In_ FLOAT moisture)
+    {
+        if (height < 0.1f)
+        {
+            return eBlockType::OCEAN;
+        }
+        if (height < 0.12f)
+        {
+            return eBlockType::SAND;
+        }
+
+        if (height > 0.8f)
+        {
+            if (moisture < 0.1f)
+            {
+                return eBlockType::SCORCHED;
+            }
+            if (moisture < 0.2f)
+            {
+                return eBlockType::BARE;
+            }
+            if (moisture < 0.5f)
+            {
+                return eBlockType::TUNDRA;
+            }
+            return eBlockType::SNOW;
+        }
+
+        if (height > 0.6f)
+        {
+            if (moisture < 0.33f)
+            {
+                return eBlockType::TEMPERATE_DESERT;
+            }
+            if (moisture < 0.66f)
+            {
+                return eBlockType::SHRUBLAND;
+            }
+            return eBlockType::TAIGA;
+        }
+
+        if (height > 0.3f)
+        {
+            if (moisture < 0.16f)
+            {
+                return eBlockType::TEMPERATE_DESERT;
+            }
+            if (moisture < 0.5f)
+            {
+                return eBlockType::GRASSLAND;
+            }
+            if (moisture < 0.83f)
+            {
+                return eBlockType::TEMPERATE_DECIDUOUS_FOREST;
+            }
+            return eBlockType::TEMPERATE_RAIN_FOREST;
+        }
+
+        if (moisture < 0.16f)
+        {
+            return eBlockType::SUBTROPICAL_DESERT;
+        }
+        if (moisture < 0.33f)
+        {
+            return eBlockType::GRASSLAND;
+        }
+        if (moisture < 0.66f)
+        {
+            return eBlockType::TROPICAL_SEASONAL_FOREST;
+        }
+        return eBlockType::TROPICAL_RAIN_FOREST;
+    }
+
+    UINT TerrainGenerator::GetNumColors()
+    {
+        return static_cast<UINT>(ARRAYSIZE(ms_aPalette));
+    }
+
+    const XMFLOAT4& TerrainGenerator::GetColor(_In_ UINT uIndex)
+    {
+        assert(uIndex < GetNumColors());
+
+        return ms_aPalette[uIndex];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::TerrainGenerator
+
+      Summary:  Constructor
+
+      Args:     UINT uWidth
+                  Number of columns along the x axis
+                UINT uHeight
+                  Number of blocks of a column of height 1
+                UINT uDepth
+                  Number of columns along the z axis
+                UINT uTileSize
+                  Number of columns along each side of a tile
+
+      Modifies: [m_uWidth, m_uHeight, m_uDepth, m_uTileSize,
+                 m_uNumTilesX, m_uNumTilesZ, m_aHeights,
+                 m_aBlockTypes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    TerrainGenerator::TerrainGenerator(_In_ UINT uWidth, _In_ UINT uHeight, _In_ UINT uDepth, _In_ UINT uTileSize)
+        : m_uWidth(uWidth)
+        , m_uHeight(uHeight)
+        , m_uDepth(uDepth)
+        , m_uTileSize(uTileSize > 0u ? uTileSize : DEFAULT_TILE_SIZE)
+        , m_uNumTilesX(0u)
+        , m_uNumTilesZ(0u)
+        , m_aHeights()
+        , m_aBlockTypes()
+    {
+        m_uNumTilesX = (m_uWidth + m_uTileSize - 1u) / m_uTileSize;
+        m_uNumTilesZ = (m_uDepth + m_uTileSize - 1u) / m_uTileSize;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::Generate
+
+      Summary:  Generates every column of the map, one task per tile.
+                Tiles write disjoint columns, so no locking is needed
+
+      Args:     ThreadPool* pThreadPool
+                  Thread pool to generate the tiles on. Can be null to
+                  generate on the calling thread
+
+      Modifies: [m_aHeights, m_aBlockTypes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TerrainGenerator::Generate(_In_opt_ ThreadPool* pThreadPool)
+    {
+        const size_t uNumColumns = static_cast<size_t>(m_uWidth) * static_cast<size_t>(m_uDepth);
+        m_aHeights.assign(uNumColumns, 0.0f);
+        m_aBlockTypes.assign(uNumColumns, eBlockType::GRASSLAND);
+
+        const UINT uNumTiles = m_uNumTilesX * m_uNumTilesZ;
+        if (pThreadPool)
+        {
+            pThreadPool->ParallelFor(uNumTiles, [this](UINT uTileIdx) { generateTile(uTileIdx); });
+        }
+        else
+        {
+            for (UINT uTileIdx = 0u; uTileIdx < uNumTiles; ++uTileIdx)
+            {
+                generateTile(uTileIdx);
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::SaveToText
+
+      Summary:  Writes the generated map in the text height map format
+                read by HeightMap::LoadFromText. Rows are formatted in
+                parallel and written in order
+
+      Args:     const std::filesystem::path& filePath
+                  Path of the text file
+                ThreadPool* pThreadPool
+                  Thread pool to format the rows on. Can be null
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TerrainGenerator::SaveToText(_In_ const std::filesystem::path& filePath, _In_opt_ ThreadPool* pThreadPool) const
+    {
+        std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            return E_FAIL;
+        }
+
+        file << m_uWidth << " " << m_uHeight << " " << m_uDepth << ' ' << GetNumColors() << '\n';
+        for (UINT uColorIdx = 0u; uColorIdx < GetNumColors(); ++uColorIdx)
+        {
+            file << ms_aPalette[uColorIdx].x << ' ' << ms_aPalette[uColorIdx].y << ' ' << ms_aPalette[uColorIdx].z << '\n';
+        }
+
+        if (m_aHeights.size() == static_cast<size_t>(m_uWidth) * static_cast<size_t>(m_uDepth))
+        {
+            std::vector<std::string> aRows(m_uDepth);
+            const auto formatRow = [this, &aRows](UINT z)
+            {
+                std::string& row = aRows[z];
+                row.reserve(static_cast<size_t>(m_uWidth) * 12u + 1u);
+
+                CHAR szHeight[32];
+                for (UINT x = 0u; x < m_uWidth; ++x)
+                {
+                    const size_t uIndex = static_cast<size_t>(z) * static_cast<size_t>(m_uWidth) + static_cast<size_t>(x);
+                    const std::to_chars_result result = std::to_chars(szHeight, szHeight + ARRAYSIZE(szHeight), m_aHeights[uIndex], std::chars_format::general, 6);
+
+                    row.push_back(static_cast<CHAR>(m_aBlockTypes[uIndex]));
+                    row.append(szHeight, result.ptr);
+                    row.push_back(' ');
+                }
+                row.push_back('\n');
+            };
+
+            if (pThreadPool)
+            {
+                pThreadPool->ParallelFor(m_uDepth, formatRow);
+            }
+            else
+            {
+                for (UINT z = 0u; z < m_uDepth; ++z)
+                {
+                    formatRow(z);
+                }
+            }
+
+            for (const std::string& row : aRows)
+            {
+                file.write(row.data(), static_cast<std::streamsize>(row.size()));
+            }
+        }
+
+        file << std::endl;
+        if (!file.good())
+        {
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::SaveToBinary
+
+      Summary:  Writes the generated map in the binary height map
+                format read by HeightMap::LoadFromBinary. The header
+                carries the parameter hash so a later run can reuse the
+                file with IsCacheValid
+
+      Args:     const std::filesystem::path& filePath
+                  Path of the binary file
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TerrainGenerator::SaveToBinary(_In_ const std::filesystem::path& filePath) const
+    {
+        if (m_aHeights.size() != static_cast<size_t>(m_uWidth) * static_cast<size_t>(m_uDepth))
+        {
+            return E_FAIL;
+        }
+
+        HeightMap heightMap;
+        HRESULT hr = heightMap.LoadFromGrid(GetGrid());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        return heightMap.SaveToBinary(filePath);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::IsCacheValid
+
+      Summary:  Reads the header of a binary height map and checks that
+                it was written by SaveToBinary with the same parameters
+                and is complete, so generation can be skipped
+
+      Args:     const std::filesystem::path& filePath
+                  Path of the binary file
+
+      Returns:  BOOL
+                  TRUE if the file can be loaded instead of generating
+                  the map
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL TerrainGenerator::IsCacheValid(_In_ const std::filesystem::path& filePath) const
+    {
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            return FALSE;
+        }
+
+        const std::streamoff fileSize = file.tellg();
+        HeightMapHeader header = {};
+        file.seekg(0);
+        file.read(reinterpret_cast<CHAR*>(&header), sizeof(header));
+        if (!file.good())
+        {
+            return FALSE;
+        }
+
+        if (memcmp(header.aMagic, HeightMap::MAGIC, sizeof(HeightMap::MAGIC)) != 0
+            || header.uVersion != HeightMap::VERSION
+            || header.uWidth != m_uWidth
+            || header.uHeight != m_uHeight
+            || header.uDepth != m_uDepth
+            || header.uNumColors != GetNumColors()
+            || header.uSourceHash != GetParameterHash())
+        {
+            return FALSE;
+        }
+
+        const UINT64 uNumColumns = static_cast<UINT64>(m_uWidth) * static_cast<UINT64>(m_uDepth);
+        const UINT64 uExpectedSize = sizeof(HeightMapHeader) + sizeof(XMFLOAT3) * GetNumColors() + (sizeof(WORD) + sizeof(BYTE)) * uNumColumns;
+
+        return static_cast<UINT64>(fileSize) >= uExpectedSize;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::GetParameterHash
+
+      Summary:  Hashes every input that changes the generated map: the
+                generator version, the dimensions, the octave
+                frequencies, the noise frequency and depth, the palette
+                and the permutation table seeding the noise. The tile
+                size is left out since it does not change the result.
+                Never returns 0, which marks maps that were not
+                generated
+
+      Returns:  UINT64
+                  64-bit FNV-1a hash of the parameters
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 TerrainGenerator::GetParameterHash() const
+    {
+        UINT64 uHash = 14695981039346656037ull;
+
+        const UINT aParameters[] = { GENERATOR_VERSION, m_uWidth, m_uHeight, m_uDepth, NUM_OCTAVES, NOISE_DEPTH };
+        uHash = hashBytes(aParameters, sizeof(aParameters), uHash);
+
+        for (UINT i = 0; i < NUM_OCTAVES; ++i)
+        {
+            const FLOAT frequency = pow(2.0f, static_cast<FLOAT>(i));
+            uHash = hashBytes(&frequency, sizeof(frequency), uHash);
+        }
+        const FLOAT noiseFrequency = NOISE_FREQUENCY;
+        uHash = hashBytes(&noiseFrequency, sizeof(noiseFrequency), uHash);
+
+        uHash = hashBytes(ms_aPalette, sizeof(XMFLOAT4) * GetNumColors(), uHash);
+        uHash = hashBytes(PerlinNoise::GetHashes(), sizeof(UINT) * PerlinNoise::GetNumHashes(), uHash);
+
+        return uHash != 0u ? uHash : 1u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::Benchmark
+
+      Summary:  Generates the map and reports the time spent, without
+                touching the GPU or the disk
+
+      Args:     ThreadPool* pThreadPool
+                  Thread pool to generate the tiles on. Can be null
+                TerrainGenerationStats& outStats
+                  Statistics of the generation
+
+      Modifies: [m_aHeights, m_aBlockTypes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TerrainGenerator::Benchmark(_In_opt_ ThreadPool* pThreadPool, _Out_ TerrainGenerationStats& outStats)
+    {
+        LARGE_INTEGER startingTime;
+        LARGE_INTEGER endingTime;
+        LARGE_INTEGER frequency;
+        QueryPerformanceCounter(&startingTime);
+
+        Generate(pThreadPool);
+
+        QueryPerformanceCounter(&endingTime);
+        QueryPerformanceFrequency(&frequency);
+
+        outStats = TerrainGenerationStats
+        {
+            .uNumColumns = static_cast<UINT64>(m_uWidth) * static_cast<UINT64>(m_uDepth),
+            .uNumTiles = static_cast<UINT64>(m_uNumTilesX) * static_cast<UINT64>(m_uNumTilesZ),
+            .uNumThreads = pThreadPool ? pThreadPool->GetNumThreads() : 1u,
+            .uTicks = static_cast<UINT64>(endingTime.QuadPart - startingTime.QuadPart),
+            .uTicksPerSecond = static_cast<UINT64>(frequency.QuadPart)
+        };
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::GetGrid
+
+      Summary:  Returns a view of the generated map that a HeightMap or
+                a Scene can be built from directly. Valid until the map
+                is generated again or the generator is destroyed
+
+      Returns:  HeightMapGrid
+                  Heights, block types, palette and parameter hash
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HeightMapGrid TerrainGenerator::GetGrid() const
+    {
+        return HeightMapGrid
+        {
+            .uWidth = m_uWidth,
+            .uHeight = m_uHeight,
+            .uDepth = m_uDepth,
+            .pHeights = m_aHeights.data(),
+            .pBlockTypes = m_aBlockTypes.data(),
+            .pPalette = ms_aPalette,
+            .uNumColors = GetNumColors(),
+            .uSourceHash = GetParameterHash()
+        };
+    }
+
+    FLOAT TerrainGenerator::GetColumnHeight(_In_ UINT x, _In_ UINT z) const
+    {
+        assert(x < m_uWidth && z < m_uDepth);
+
+        return m_aHeights[static_cast<size_t>(z) * static_cast<size_t>(m_uWidth) + static_cast<size_t>(x)];
+    }
+
+    eBlockType TerrainGenerator::GetBlockType(_In_ UINT x, _In_ UINT z) const
+    {
+        assert(x < m_uWidth && z < m_uDepth);
+
+        return m_aBlockTypes[static_cast<size_t>(z) * static_cast<size_t>(m_uWidth) + static_cast<size_t>(x)];
+    }
+
+    UINT TerrainGenerator::GetWidth() const
+    {
+        return m_uWidth;
+    }
+
+    UINT TerrainGenerator::GetHeight() const
+    {
+        return m_uHeight;
+    }
+
+    UINT TerrainGenerator::GetDepth() const
+    {
+        return m_uDepth;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::hashBytes
+
+      Summary:  Folds bytes into a 64-bit FNV-1a hash
+
+      Args:     const void* pData
+                  Bytes to hash
+                size_t uSize
+                  Number of bytes
+                UINT64 uHash
+                  Hash of the previous bytes
+
+      Returns:  UINT64
+                  Updated hash
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 TerrainGenerator::hashBytes(_In_ const void* pData, _In_ size_t uSize, _In_ UINT64 uHash)
+    {
+        const BYTE* pBytes = static_cast<const BYTE*>(pData);
+        for (size_t i = 0u; i < uSize; ++i)
+        {
+            uHash ^= pBytes[i];
+            uHash *= 1099511628211ull;
+        }
+
+        return uHash;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TerrainGenerator::generateTile
+
+      Summary:  Generates the columns of a tile row by row. The moisture
+                noise is sampled with the same octaves and frequency as
+                the height, so it equals the height and is not computed
+                twice
+
+      Args:     UINT uTileIdx
+                  Index of the tile, row major
+
+      Modifies: [m_aHeights, m_aBlockTypes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TerrainGenerator::generateTile(_In_ UINT uTileIdx)
+    {
+        const UINT uBeginX = (uTileIdx % m_uNumTilesX) * m_uTileSize;
+        const UINT uBeginZ = (uTileIdx / m_uNumTilesX) * m_uTileSize;
+        const UINT uEndX = uBeginX + m_uTileSize < m_uWidth ? uBeginX + m_uTileSize : m_uWidth;
+        const UINT uEndZ = uBeginZ + m_uTileSize < m_uDepth ? uBeginZ + m_uTileSize : m_uDepth;
+
+        for (UINT z = uBeginZ; z < uEndZ; ++z)
+        {
+            const size_t uRowIndex = static_cast<size_t>(z) * static_cast<size_t>(m_uWidth);
+            ComputeHeights(uBeginX, z, uEndX - uBeginX, &m_aHeights[uRowIndex + uBeginX]);
+
+            for (UINT x = uBeginX; x < uEndX; ++x)
+            {
+                const FLOAT height = m_aHeights[uRowIndex + x];
+                assert(height >= 0.0f);
+
+                m_aBlockTypes[uRowIndex + x] = ComputeBlockType(height, height);
+            }
+        }
+    }
+}
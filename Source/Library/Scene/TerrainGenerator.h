@@ -0,0 +1,150 @@
+/*+===================================================================
+  File:      TERRAINGENERATOR.H
+
+  Summary:   TerrainGenerator header file contains declarations of
+             TerrainGenerator class used for the lab samples of Game
+             Graphics Programming course.
+
+  Classes: TerrainGenerator
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Scene/HeightMap.h"
+#include "Thread/ThreadPool.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   TerrainGenerationStats
+
+      Summary:  Statistics of a terrain generation benchmark
+
+                uNumColumns
+                  Number of columns generated
+                uNumTiles
+                  Number of tiles the map was split into
+                uNumThreads
+                  Number of threads the tiles ran on
+                uTicks
+                  Time spent in performance counter ticks
+                uTicksPerSecond
+                  Frequency of the performance counter
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct TerrainGenerationStats
+    {
+        UINT64 uNumColumns;
+        UINT64 uNumTiles;
+        UINT64 uNumThreads;
+        UINT64 uTicks;
+        UINT64 uTicksPerSecond;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    TerrainGenerator
+
+      Summary:  Generates the height and biome of every column of a map
+                from Perlin noise. The map is split into square tiles
+                processed by a thread pool. Every column only depends
+                on its own coordinates, so the result is the same
+                whatever the number of threads
+
+      Methods:  ComputeHeight
+                  Returns the normalized height of a column from noise
+                ComputeHeights
+                  Returns the normalized heights of a run of columns,
+                  sampling the noise in vector lanes
+                ComputeBlockType
+                  Returns the biome of a height and a moisture
+                GetNumColors
+                  Returns the number of palette entries
+                GetColor
+                  Returns a palette entry
+                Generate
+                  Generates every column of the map
+                SaveToText
+                  Writes the map in the text height map format
+                SaveToBinary
+                  Writes the map in the binary height map format,
+                  tagged with the parameter hash
+                IsCacheValid
+                  Returns whether a binary height map was generated
+                  from the same parameters
+                GetParameterHash
+                  Returns the hash of every input of the generation
+                Benchmark
+                  Generates the map and reports the time spent
+                GetGrid
+                  Returns a view of the generated map
+                GetColumnHeight
+                  Returns the normalized height of a column
+                GetBlockType
+                  Returns the biome of a column
+                GetWidth
+                  Returns the number of columns along the x axis
+                GetHeight
+                  Returns the number of blocks of a column of height 1
+                GetDepth
+                  Returns the number of columns along the z axis
+                TerrainGenerator
+                  Constructor.
+                ~TerrainGenerator
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class TerrainGenerator
+    {
+    public:
+        static constexpr const UINT DEFAULT_TILE_SIZE = 64u;
+        static constexpr const UINT GENERATOR_VERSION = 1u;
+        static constexpr const UINT NUM_OCTAVES = 4u;
+        static constexpr const FLOAT NOISE_FREQUENCY = 0.1f;
+        static constexpr const UINT NOISE_DEPTH = 4u;
+
+        static FLOAT ComputeHeight(_In_ UINT x, _In_ UINT z);
+        static void ComputeHeights(_In_ UINT uBeginX, _In_ UINT z, _In_ UINT uNumColumns, _Out_writes_(uNumColumns) FLOAT* pOutHeights);
+        static eBlockType ComputeBlockType(_In_ FLOAT height, _In_ FLOAT moisture);
+        static UINT GetNumColors();
+        static const XMFLOAT4& GetColor(_In_ UINT uIndex);
+
+        TerrainGenerator(_In_ UINT uWidth, _In_ UINT uHeight, _In_ UINT uDepth, _In_ UINT uTileSize = DEFAULT_TILE_SIZE);
+        TerrainGenerator(const TerrainGenerator& other) = delete;
+        TerrainGenerator(TerrainGenerator&& other) = delete;
+        TerrainGenerator& operator=(const TerrainGenerator& other) = delete;
+        TerrainGenerator& operator=(TerrainGenerator&& other) = delete;
+        ~TerrainGenerator() = default;
+
+        void Generate(_In_opt_ ThreadPool* pThreadPool = nullptr);
+        HRESULT SaveToText(_In_ const std::filesystem::path& filePath, _In_opt_ ThreadPool* pThreadPool = nullptr) const;
+        HRESULT SaveToBinary(_In_ const std::filesystem::path& filePath) const;
+        BOOL IsCacheValid(_In_ const std::filesystem::path& filePath) const;
+        UINT64 GetParameterHash() const;
+        void Benchmark(_In_opt_ ThreadPool* pThreadPool, _Out_ TerrainGenerationStats& outStats);
+
+        HeightMapGrid GetGrid() const;
+        FLOAT GetColumnHeight(_In_ UINT x, _In_ UINT z) const;
+        eBlockType GetBlockType(_In_ UINT x, _In_ UINT z) const;
+        UINT GetWidth() const;
+        UINT GetHeight() const;
+        UINT GetDepth() const;
+
+    private:
+        static UINT64 hashBytes(_In_ const void* pData, _In_ size_t uSize, _In_ UINT64 uHash);
+
+        void generateTile(_In_ UINT uTileIdx);
+
+    private:
+        static const XMFLOAT4 ms_aPalette[];
+
+        UINT m_uWidth;
+        UINT m_uHeight;
+        UINT m_uDepth;
+        UINT m_uTileSize;
+        UINT m_uNumTilesX;
+        UINT m_uNumTilesZ;
+        std::vector<FLOAT> m_aHeights;
+        std::vector<eBlockType> m_aBlockTypes;
+    };
+}
@@ -30,6 +30,25 @@ namespace library
         InstancedRenderable(std::move(aInstanceData), outputColor)
     {}
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Voxel::Voxel
+
+      Summary:  Constructor. Packed instances are grid coordinates, so
+                the world matrix is moved to the grid origin
+
+      Args:     std::vector<PackedInstanceData>&& aPackedInstanceData
+                  Packed instance data
+                const XMFLOAT3& gridOrigin
+                  World position of the first block of the grid
+                const XMFLOAT4& outputColor
+                  Color of the voxel
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    Voxel::Voxel(_In_ std::vector<PackedInstanceData>&& aPackedInstanceData, _In_ const XMFLOAT3& gridOrigin, _In_ const XMFLOAT4& outputColor) :
+        InstancedRenderable(std::move(aPackedInstanceData), outputColor)
+    {
+        Translate(XMLoadFloat3(&gridOrigin));
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Voxel::Initialize
 
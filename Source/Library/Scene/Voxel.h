@@ -33,6 +33,7 @@ namespace library
     public:
         Voxel(_In_ const XMFLOAT4& outputColor);
         Voxel(_In_ std::vector<InstanceData>&& aInstanceData, _In_ const XMFLOAT4& outputColor);
+        Voxel(_In_ std::vector<PackedInstanceData>&& aPackedInstanceData, _In_ const XMFLOAT3& gridOrigin, _In_ const XMFLOAT4& outputColor);
         Voxel(const Voxel& other) = delete;
         Voxel(Voxel&& other) = delete;
         Voxel& operator=(const Voxel& other) = delete;
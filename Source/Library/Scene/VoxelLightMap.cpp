@@ -0,0 +1,817 @@
+#include "Scene/VoxelLightMap.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::VoxelLightMap
+
+      Summary:  Constructor. The map stays empty until Initialize
+
+      Args:     const HeightMap& heightMap
+                  Height map to light. Must outlive the light map
+
+      Modifies: [m_heightMap, m_uSizeY, m_aLight, m_aEmissiveLevels,
+                 m_emitters, m_skyRemovalQueue, m_blockRemovalQueue,
+                 m_skyAdditionQueue, m_blockAdditionQueue,
+                 m_uNumCellsChanged, m_bChanged, m_uChangedBeginX,
+                 m_uChangedBeginZ, m_uChangedEndX, m_uChangedEndZ].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    VoxelLightMap::VoxelLightMap(_In_ const HeightMap& heightMap)
+        : m_heightMap(heightMap)
+        , m_uSizeY(0u)
+        , m_aLight()
+        , m_aEmissiveLevels(256u, 0u)
+        , m_emitters()
+        , m_skyRemovalQueue()
+        , m_blockRemovalQueue()
+        , m_skyAdditionQueue()
+        , m_blockAdditionQueue()
+        , m_uNumCellsChanged(0u)
+        , m_bChanged(FALSE)
+        , m_uChangedBeginX(0u)
+        , m_uChangedBeginZ(0u)
+        , m_uChangedEndX(0u)
+        , m_uChangedEndZ(0u)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::Initialize
+
+      Summary:  Lights the whole map. The columns are stored up to
+                MAX_LIGHT_LEVEL blocks above the tallest one, so light
+                spreading up from the highest blocks fades out before
+                the top. Without overhangs the sky flood fill reaches
+                every empty block straight down at full strength, so
+                the empty blocks are filled with it directly. Emissive
+                blocks and emitters are then flooded to completion
+
+      Args:     VoxelLightStats* pStats
+                  Statistics to accumulate into. Can be null
+
+      Modifies: [m_uSizeY, m_aLight, m_emitters, m_skyRemovalQueue,
+                 m_blockRemovalQueue, m_skyAdditionQueue,
+                 m_blockAdditionQueue, m_bChanged, m_uChangedBeginX,
+                 m_uChangedBeginZ, m_uChangedEndX, m_uChangedEndZ].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelLightMap::Initialize(_Inout_opt_ VoxelLightStats* pStats)
+    {
+        const UINT uWidth = m_heightMap.GetWidth();
+        const UINT uDepth = m_heightMap.GetDepth();
+        const size_t uNumColumns = static_cast<size_t>(uWidth) * static_cast<size_t>(uDepth);
+        const WORD* pColumnHeights = m_heightMap.GetColumnHeights();
+
+        UINT uMaxHeight = 0u;
+        for (size_t i = 0u; i < uNumColumns; ++i)
+        {
+            uMaxHeight = pColumnHeights[i] > uMaxHeight ? pColumnHeights[i] : uMaxHeight;
+        }
+
+        // Emitters are keyed by cell index, which depends on the height
+        std::vector<std::pair<UINT64, BYTE>> aEmitters;
+        for (auto it = m_emitters.begin(); it != m_emitters.end(); ++it)
+        {
+            const UINT64 y = it->first % m_uSizeY;
+            if (y < uMaxHeight + MAX_LIGHT_LEVEL)
+            {
+                aEmitters.push_back({ it->first / m_uSizeY * (uMaxHeight + MAX_LIGHT_LEVEL) + y, it->second });
+            }
+        }
+        m_emitters.clear();
+        m_emitters.insert(aEmitters.begin(), aEmitters.end());
+
+        m_uSizeY = uMaxHeight + MAX_LIGHT_LEVEL;
+        m_aLight.assign(uNumColumns * static_cast<size_t>(m_uSizeY), 0u);
+        m_skyRemovalQueue.clear();
+        m_blockRemovalQueue.clear();
+        m_skyAdditionQueue.clear();
+        m_blockAdditionQueue.clear();
+
+        std::vector<ColumnRun> aRuns;
+        for (UINT z = 0u; z < uDepth; ++z)
+        {
+            for (UINT x = 0u; x < uWidth; ++x)
+            {
+                m_heightMap.GetColumnRuns(x, z, aRuns);
+                const UINT uNumBlocks = aRuns.empty() ? 0u : aRuns.back().uEndBlock;
+                for (UINT y = uNumBlocks; y < m_uSizeY; ++y)
+                {
+                    m_aLight[getIndex(x, y, z)] = FULL_SKY_LIGHT;
+                }
+
+                UINT uFirstBlock = 0u;
+                for (const ColumnRun& run : aRuns)
+                {
+                    if (m_aEmissiveLevels[run.type] > 0u)
+                    {
+                        for (UINT y = uFirstBlock; y < run.uEndBlock; ++y)
+                        {
+                            const BYTE emission = getEmission(x, y, z);
+                            if (emission > 0u)
+                            {
+                                m_aLight[getIndex(x, y, z)] = emission;
+                                m_blockAdditionQueue.push_back(LightNode{ .x = x, .y = y, .z = z, .level = emission });
+                            }
+                        }
+                    }
+                    uFirstBlock = run.uEndBlock;
+                }
+            }
+        }
+
+        for (auto it = m_emitters.begin(); it != m_emitters.end(); ++it)
+        {
+            const UINT y = static_cast<UINT>(it->first % m_uSizeY);
+            const UINT uColumn = static_cast<UINT>(it->first / m_uSizeY);
+            const UINT x = uColumn % uWidth;
+            const UINT z = uColumn / uWidth;
+            if (!isSolid(x, y, z))
+            {
+                m_aLight[it->first] = FULL_SKY_LIGHT | it->second;
+                m_blockAdditionQueue.push_back(LightNode{ .x = x, .y = y, .z = z, .level = it->second });
+            }
+        }
+
+        m_bChanged = uNumColumns > 0u;
+        m_uChangedBeginX = 0u;
+        m_uChangedBeginZ = 0u;
+        m_uChangedEndX = uWidth;
+        m_uChangedEndZ = uDepth;
+
+        Propagate(UINT_MAX, pStats);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::SetEmissiveType
+
+      Summary:  Makes every block of a palette entry touching an empty
+                block emit light, like lava or glowstone. Takes effect
+                on the next Initialize
+
+      Args:     BYTE type
+                  Palette entry
+                BYTE level
+                  Light emitted, clamped to MAX_LIGHT_LEVEL. 0 stops
+                  the entry from emitting
+
+      Modifies: [m_aEmissiveLevels].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelLightMap::SetEmissiveType(_In_ BYTE type, _In_ BYTE level)
+    {
+        m_aEmissiveLevels[type] = level < MAX_LIGHT_LEVEL ? level : MAX_LIGHT_LEVEL;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::SetEmitter
+
+      Summary:  Adds, changes or removes a light in a block, like a
+                torch. The light only shines while the block is empty.
+                Must be called after Initialize, and the light spreads
+                on the next calls to Propagate
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT y
+                  Block index along the y axis
+                UINT z
+                  Column index along the z axis
+                BYTE level
+                  Light emitted, clamped to MAX_LIGHT_LEVEL. 0 removes
+                  the light
+
+      Modifies: [m_emitters, m_aLight, m_skyRemovalQueue,
+                 m_blockRemovalQueue, m_skyAdditionQueue,
+                 m_blockAdditionQueue].
+
+      Returns:  HRESULT
+                  Status code, E_INVALIDARG when the block is outside
+                  of the stored columns
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT VoxelLightMap::SetEmitter(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ BYTE level)
+    {
+        if (x >= m_heightMap.GetWidth() || y >= m_uSizeY || z >= m_heightMap.GetDepth())
+        {
+            return E_INVALIDARG;
+        }
+
+        const UINT64 uIndex = static_cast<UINT64>(getIndex(x, y, z));
+        if (level == 0u)
+        {
+            m_emitters.erase(uIndex);
+        }
+        else
+        {
+            m_emitters[uIndex] = level < MAX_LIGHT_LEVEL ? level : MAX_LIGHT_LEVEL;
+        }
+
+        darkenCell(x, y, z);
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::OnColumnChanged
+
+      Summary:  Queues the blocks whose light may change after blocks
+                of a column were edited. The edited blocks and the ones
+                right below and above them are darkened and the removal
+                flood clears the light that came through them, then the
+                remaining light floods back in. Emissive blocks of the
+                neighbor columns beside the edit are darkened too since
+                their exposure changed. Must be called after the height
+                map was edited
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT z
+                  Column index along the z axis
+                UINT uBeginY
+                  First block that turned solid, empty or changed type
+                UINT uEndY
+                  One past the last block that changed
+
+      Modifies: [m_aLight, m_skyRemovalQueue,
+                 m_blockRemovalQueue, m_skyAdditionQueue,
+                 m_blockAdditionQueue].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelLightMap::OnColumnChanged(_In_ UINT x, _In_ UINT z, _In_ UINT uBeginY, _In_ UINT uEndY)
+    {
+        if (x >= m_heightMap.GetWidth() || z >= m_heightMap.GetDepth() || m_uSizeY == 0u)
+        {
+            return;
+        }
+
+        uEndY = uEndY < m_uSizeY ? uEndY : m_uSizeY;
+        const UINT uBegin = uBeginY > 0u ? uBeginY - 1u : 0u;
+        const UINT uEnd = uEndY + 1u < m_uSizeY ? uEndY + 1u : m_uSizeY;
+        for (UINT y = uBegin; y < uEnd; ++y)
+        {
+            darkenCell(x, y, z);
+        }
+
+        // Emissive neighbors gained or lost exposed blocks
+        for (INT i = 0; i < 6; ++i)
+        {
+            const INT iNeighborX = static_cast<INT>(x) + NEIGHBOR_OFFSETS[i][0];
+            const INT iNeighborZ = static_cast<INT>(z) + NEIGHBOR_OFFSETS[i][2];
+            if (NEIGHBOR_OFFSETS[i][1] != 0 || !isInside(iNeighborX, 0, iNeighborZ))
+            {
+                continue;
+            }
+
+            for (UINT y = uBeginY; y < uEndY; ++y)
+            {
+                if (isSolid(static_cast<UINT>(iNeighborX), y, static_cast<UINT>(iNeighborZ))
+                    && m_aEmissiveLevels[m_heightMap.GetBlockType(static_cast<UINT>(iNeighborX), y, static_cast<UINT>(iNeighborZ))] > 0u)
+                {
+                    darkenCell(static_cast<UINT>(iNeighborX), y, static_cast<UINT>(iNeighborZ));
+                }
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::Propagate
+
+      Summary:  Takes up to uMaxSteps blocks out of the queues. The
+                removal queues go first so stale light is cleared
+                before the remaining light floods back in. Sky light
+                going down at full strength does not fade, any other
+                step loses one level. Spreading the work over several
+                frames leaves the light of the edited area briefly
+                incomplete but keeps the frame time bounded
+
+      Args:     UINT uMaxSteps
+                  Maximum number of blocks to process
+                VoxelLightStats* pStats
+                  Statistics to accumulate into. Can be null
+
+      Modifies: [m_aLight, m_skyRemovalQueue,
+                 m_blockRemovalQueue, m_skyAdditionQueue,
+                 m_blockAdditionQueue, m_bChanged, m_uChangedBeginX,
+                 m_uChangedBeginZ, m_uChangedEndX, m_uChangedEndZ].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelLightMap::Propagate(_In_ UINT uMaxSteps, _Inout_opt_ VoxelLightStats* pStats)
+    {
+        LARGE_INTEGER startingTime;
+        QueryPerformanceCounter(&startingTime);
+
+        const UINT64 uNumCellsChanged = m_uNumCellsChanged;
+        UINT uNumSteps = 0u;
+        for (; uNumSteps < uMaxSteps; ++uNumSteps)
+        {
+            if (!m_skyRemovalQueue.empty())
+            {
+                const LightNode node = m_skyRemovalQueue.front();
+                m_skyRemovalQueue.pop_front();
+                stepSkyRemoval(node);
+            }
+            else if (!m_blockRemovalQueue.empty())
+            {
+                const LightNode node = m_blockRemovalQueue.front();
+                m_blockRemovalQueue.pop_front();
+                stepBlockRemoval(node);
+            }
+            else if (!m_skyAdditionQueue.empty())
+            {
+                const LightNode node = m_skyAdditionQueue.front();
+                m_skyAdditionQueue.pop_front();
+                stepSkyAddition(node);
+            }
+            else if (!m_blockAdditionQueue.empty())
+            {
+                const LightNode node = m_blockAdditionQueue.front();
+                m_blockAdditionQueue.pop_front();
+                stepBlockAddition(node);
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        if (pStats)
+        {
+            LARGE_INTEGER endingTime;
+            LARGE_INTEGER frequency;
+            QueryPerformanceCounter(&endingTime);
+            QueryPerformanceFrequency(&frequency);
+
+            pStats->uNumSteps += uNumSteps;
+            pStats->uNumCellsChanged += m_uNumCellsChanged - uNumCellsChanged;
+            pStats->uNumPendingSteps = m_skyRemovalQueue.size() + m_blockRemovalQueue.size() + m_skyAdditionQueue.size() + m_blockAdditionQueue.size();
+            pStats->uTicks += static_cast<UINT64>(endingTime.QuadPart - startingTime.QuadPart);
+            pStats->uTicksPerSecond = static_cast<UINT64>(frequency.QuadPart);
+        }
+    }
+
+    BOOL VoxelLightMap::IsPropagating() const
+    {
+        return !m_skyRemovalQueue.empty() || !m_blockRemovalQueue.empty() || !m_skyAdditionQueue.empty() || !m_blockAdditionQueue.empty();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::TakeChangedRegion
+
+      Summary:  Returns the rectangle of columns holding every block
+                whose light changed since the last call, and forgets it
+
+      Args:     UINT& uOutBeginX
+                  First column along the x axis
+                UINT& uOutBeginZ
+                  First column along the z axis
+                UINT& uOutEndX
+                  One past the last column along the x axis
+                UINT& uOutEndZ
+                  One past the last column along the z axis
+
+      Modifies: [m_bChanged].
+
+      Returns:  BOOL
+                  TRUE if any light changed
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelLightMap::TakeChangedRegion(_Out_ UINT& uOutBeginX, _Out_ UINT& uOutBeginZ, _Out_ UINT& uOutEndX, _Out_ UINT& uOutEndZ)
+    {
+        uOutBeginX = m_uChangedBeginX;
+        uOutBeginZ = m_uChangedBeginZ;
+        uOutEndX = m_uChangedEndX;
+        uOutEndZ = m_uChangedEndZ;
+
+        const BOOL bChanged = m_bChanged;
+        m_bChanged = FALSE;
+
+        return bChanged;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::GetLight
+
+      Summary:  Returns the packed light of a block, the sky light in
+                the high nibble and the block light in the low nibble.
+                Blocks outside of the map or above the stored columns
+                only see the sky, blocks below the map are dark
+
+      Args:     INT x
+                  Column index along the x axis
+                INT y
+                  Block index along the y axis
+                INT z
+                  Column index along the z axis
+
+      Returns:  BYTE
+                  Packed light of the block
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BYTE VoxelLightMap::GetLight(_In_ INT x, _In_ INT y, _In_ INT z) const
+    {
+        if (y < 0)
+        {
+            return 0u;
+        }
+
+        if (!isInside(x, y, z))
+        {
+            return FULL_SKY_LIGHT;
+        }
+
+        return m_aLight[getIndex(static_cast<UINT>(x), static_cast<UINT>(y), static_cast<UINT>(z))];
+    }
+
+    BYTE VoxelLightMap::GetSkyLight(_In_ INT x, _In_ INT y, _In_ INT z) const
+    {
+        return GetLight(x, y, z) >> 4u;
+    }
+
+    BYTE VoxelLightMap::GetBlockLight(_In_ INT x, _In_ INT y, _In_ INT z) const
+    {
+        return GetLight(x, y, z) & MAX_LIGHT_LEVEL;
+    }
+
+    UINT VoxelLightMap::GetSizeY() const
+    {
+        return m_uSizeY;
+    }
+
+    BOOL VoxelLightMap::isInside(_In_ INT x, _In_ INT y, _In_ INT z) const
+    {
+        return x >= 0 && y >= 0 && z >= 0
+            && x < static_cast<INT>(m_heightMap.GetWidth()) && y < static_cast<INT>(m_uSizeY) && z < static_cast<INT>(m_heightMap.GetDepth());
+    }
+
+    BOOL VoxelLightMap::isSolid(_In_ UINT x, _In_ UINT y, _In_ UINT z) const
+    {
+        return m_heightMap.GetColumnType(x, z) < m_heightMap.GetNumColors() && y < m_heightMap.GetColumnHeight(x, z);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::getEmission
+
+      Summary:  Returns the block light a block emits. Solid blocks
+                emit the level of their palette entry when they touch
+                an empty block, empty blocks the level of their emitter
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT y
+                  Block index along the y axis
+                UINT z
+                  Column index along the z axis
+
+      Returns:  BYTE
+                  Block light emitted
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BYTE VoxelLightMap::getEmission(_In_ UINT x, _In_ UINT y, _In_ UINT z) const
+    {
+        if (!isSolid(x, y, z))
+        {
+            auto it = m_emitters.find(static_cast<UINT64>(getIndex(x, y, z)));
+            return it != m_emitters.end() ? it->second : 0u;
+        }
+
+        const BYTE level = m_aEmissiveLevels[m_heightMap.GetBlockType(x, y, z)];
+        if (level == 0u)
+        {
+            return 0u;
+        }
+
+        for (INT i = 0; i < 6; ++i)
+        {
+            const INT iNeighborX = static_cast<INT>(x) + NEIGHBOR_OFFSETS[i][0];
+            const INT iNeighborY = static_cast<INT>(y) + NEIGHBOR_OFFSETS[i][1];
+            const INT iNeighborZ = static_cast<INT>(z) + NEIGHBOR_OFFSETS[i][2];
+            if (isInside(iNeighborX, iNeighborY, iNeighborZ)
+                && !isSolid(static_cast<UINT>(iNeighborX), static_cast<UINT>(iNeighborY), static_cast<UINT>(iNeighborZ)))
+            {
+                return level;
+            }
+        }
+
+        return 0u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::getSourceLight
+
+      Summary:  Returns the packed light a block has on its own, full
+                sky light for empty blocks at the top of the stored
+                columns and its emission
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT y
+                  Block index along the y axis
+                UINT z
+                  Column index along the z axis
+
+      Returns:  BYTE
+                  Packed light of the block before any flooding
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BYTE VoxelLightMap::getSourceLight(_In_ UINT x, _In_ UINT y, _In_ UINT z) const
+    {
+        const BYTE sky = y + 1u == m_uSizeY && !isSolid(x, y, z) ? FULL_SKY_LIGHT : 0u;
+        return sky | getEmission(x, y, z);
+    }
+
+    size_t VoxelLightMap::getIndex(_In_ UINT x, _In_ UINT y, _In_ UINT z) const
+    {
+        return (static_cast<size_t>(z) * static_cast<size_t>(m_heightMap.GetWidth()) + static_cast<size_t>(x)) * static_cast<size_t>(m_uSizeY) + static_cast<size_t>(y);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::setLight
+
+      Summary:  Stores the packed light of a block and grows the
+                changed region when it differs
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT y
+                  Block index along the y axis
+                UINT z
+                  Column index along the z axis
+                BYTE light
+                  Packed light of the block
+
+      Modifies: [m_aLight, m_uNumCellsChanged, m_bChanged, m_uChangedBeginX,
+                 m_uChangedBeginZ, m_uChangedEndX, m_uChangedEndZ].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelLightMap::setLight(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ BYTE light)
+    {
+        BYTE& cell = m_aLight[getIndex(x, y, z)];
+        if (cell == light)
+        {
+            return;
+        }
+
+        cell = light;
+        ++m_uNumCellsChanged;
+
+        if (!m_bChanged)
+        {
+            m_bChanged = TRUE;
+            m_uChangedBeginX = x;
+            m_uChangedBeginZ = z;
+            m_uChangedEndX = x + 1u;
+            m_uChangedEndZ = z + 1u;
+            return;
+        }
+
+        m_uChangedBeginX = x < m_uChangedBeginX ? x : m_uChangedBeginX;
+        m_uChangedBeginZ = z < m_uChangedBeginZ ? z : m_uChangedBeginZ;
+        m_uChangedEndX = x + 1u > m_uChangedEndX ? x + 1u : m_uChangedEndX;
+        m_uChangedEndZ = z + 1u > m_uChangedEndZ ? z + 1u : m_uChangedEndZ;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::resetCell
+
+      Summary:  Sets a block back to its own light and queues it to
+                flood when it has any
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT y
+                  Block index along the y axis
+                UINT z
+                  Column index along the z axis
+
+      Modifies: [m_aLight, m_skyAdditionQueue, m_blockAdditionQueue].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelLightMap::resetCell(_In_ UINT x, _In_ UINT y, _In_ UINT z)
+    {
+        const BYTE light = getSourceLight(x, y, z);
+        setLight(x, y, z, light);
+
+        if (light >> 4u)
+        {
+            m_skyAdditionQueue.push_back(LightNode{ .x = x, .y = y, .z = z, .level = static_cast<BYTE>(light >> 4u) });
+        }
+        if (light & MAX_LIGHT_LEVEL)
+        {
+            m_blockAdditionQueue.push_back(LightNode{ .x = x, .y = y, .z = z, .level = static_cast<BYTE>(light & MAX_LIGHT_LEVEL) });
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::darkenCell
+
+      Summary:  Queues the light of a block for removal and resets it.
+                A removal of level 0 still makes its neighbors flood
+                back into the block
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT y
+                  Block index along the y axis
+                UINT z
+                  Column index along the z axis
+
+      Modifies: [m_aLight, m_skyRemovalQueue,
+                 m_blockRemovalQueue, m_skyAdditionQueue,
+                 m_blockAdditionQueue].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelLightMap::darkenCell(_In_ UINT x, _In_ UINT y, _In_ UINT z)
+    {
+        const BYTE light = m_aLight[getIndex(x, y, z)];
+        m_skyRemovalQueue.push_back(LightNode{ .x = x, .y = y, .z = z, .level = static_cast<BYTE>(light >> 4u) });
+        m_blockRemovalQueue.push_back(LightNode{ .x = x, .y = y, .z = z, .level = static_cast<BYTE>(light & MAX_LIGHT_LEVEL) });
+        resetCell(x, y, z);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::stepSkyRemoval
+
+      Summary:  Clears the sky light that may have come through a
+                darkened block: dimmer neighbors, and the full sky
+                light below it, are reset and darken their own
+                neighbors. Brighter neighbors were lit some other way
+                and flood back in
+
+      Args:     const LightNode& node
+                  Darkened block and its former sky light
+
+      Modifies: [m_aLight, m_skyRemovalQueue,
+                 m_blockRemovalQueue, m_skyAdditionQueue,
+                 m_blockAdditionQueue].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelLightMap::stepSkyRemoval(_In_ const LightNode& node)
+    {
+        for (INT i = 0; i < 6; ++i)
+        {
+            const INT iNeighborX = static_cast<INT>(node.x) + NEIGHBOR_OFFSETS[i][0];
+            const INT iNeighborY = static_cast<INT>(node.y) + NEIGHBOR_OFFSETS[i][1];
+            const INT iNeighborZ = static_cast<INT>(node.z) + NEIGHBOR_OFFSETS[i][2];
+            if (!isInside(iNeighborX, iNeighborY, iNeighborZ))
+            {
+                continue;
+            }
+
+            const UINT x = static_cast<UINT>(iNeighborX);
+            const UINT y = static_cast<UINT>(iNeighborY);
+            const UINT z = static_cast<UINT>(iNeighborZ);
+            const BYTE level = m_aLight[getIndex(x, y, z)] >> 4u;
+            if (level == 0u)
+            {
+                continue;
+            }
+
+            const BOOL bDown = NEIGHBOR_OFFSETS[i][1] < 0;
+            if (level < node.level || (bDown && node.level == MAX_LIGHT_LEVEL))
+            {
+                m_skyRemovalQueue.push_back(LightNode{ .x = x, .y = y, .z = z, .level = level });
+                const BYTE light = (getSourceLight(x, y, z) & FULL_SKY_LIGHT) | (m_aLight[getIndex(x, y, z)] & MAX_LIGHT_LEVEL);
+                setLight(x, y, z, light);
+                if (light >> 4u)
+                {
+                    m_skyAdditionQueue.push_back(LightNode{ .x = x, .y = y, .z = z, .level = static_cast<BYTE>(light >> 4u) });
+                }
+            }
+            else
+            {
+                m_skyAdditionQueue.push_back(LightNode{ .x = x, .y = y, .z = z, .level = level });
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::stepBlockRemoval
+
+      Summary:  Clears the block light that may have come through a
+                darkened block: dimmer neighbors are reset and darken
+                their own neighbors. Brighter neighbors were lit some
+                other way and flood back in
+
+      Args:     const LightNode& node
+                  Darkened block and its former block light
+
+      Modifies: [m_aLight, m_skyRemovalQueue,
+                 m_blockRemovalQueue, m_skyAdditionQueue,
+                 m_blockAdditionQueue].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelLightMap::stepBlockRemoval(_In_ const LightNode& node)
+    {
+        for (INT i = 0; i < 6; ++i)
+        {
+            const INT iNeighborX = static_cast<INT>(node.x) + NEIGHBOR_OFFSETS[i][0];
+            const INT iNeighborY = static_cast<INT>(node.y) + NEIGHBOR_OFFSETS[i][1];
+            const INT iNeighborZ = static_cast<INT>(node.z) + NEIGHBOR_OFFSETS[i][2];
+            if (!isInside(iNeighborX, iNeighborY, iNeighborZ))
+            {
+                continue;
+            }
+
+            const UINT x = static_cast<UINT>(iNeighborX);
+            const UINT y = static_cast<UINT>(iNeighborY);
+            const UINT z = static_cast<UINT>(iNeighborZ);
+            const BYTE level = m_aLight[getIndex(x, y, z)] & MAX_LIGHT_LEVEL;
+            if (level == 0u)
+            {
+                continue;
+            }
+
+            if (level < node.level)
+            {
+                m_blockRemovalQueue.push_back(LightNode{ .x = x, .y = y, .z = z, .level = level });
+                const BYTE emission = getEmission(x, y, z);
+                setLight(x, y, z, (m_aLight[getIndex(x, y, z)] & FULL_SKY_LIGHT) | emission);
+                if (emission > 0u)
+                {
+                    m_blockAdditionQueue.push_back(LightNode{ .x = x, .y = y, .z = z, .level = emission });
+                }
+            }
+            else
+            {
+                m_blockAdditionQueue.push_back(LightNode{ .x = x, .y = y, .z = z, .level = level });
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::stepSkyAddition
+
+      Summary:  Spreads the sky light of a block to its empty
+                neighbors, without fading straight down at full
+                strength
+
+      Args:     const LightNode& node
+                  Block to spread the light of
+
+      Modifies: [m_aLight, m_skyAdditionQueue].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelLightMap::stepSkyAddition(_In_ const LightNode& node)
+    {
+        // The block may have been darkened since it was queued
+        const BYTE level = m_aLight[getIndex(node.x, node.y, node.z)] >> 4u;
+        if (level <= 1u)
+        {
+            return;
+        }
+
+        for (INT i = 0; i < 6; ++i)
+        {
+            const INT iNeighborX = static_cast<INT>(node.x) + NEIGHBOR_OFFSETS[i][0];
+            const INT iNeighborY = static_cast<INT>(node.y) + NEIGHBOR_OFFSETS[i][1];
+            const INT iNeighborZ = static_cast<INT>(node.z) + NEIGHBOR_OFFSETS[i][2];
+            if (!isInside(iNeighborX, iNeighborY, iNeighborZ))
+            {
+                continue;
+            }
+
+            const UINT x = static_cast<UINT>(iNeighborX);
+            const UINT y = static_cast<UINT>(iNeighborY);
+            const UINT z = static_cast<UINT>(iNeighborZ);
+            const BYTE newLevel = NEIGHBOR_OFFSETS[i][1] < 0 && level == MAX_LIGHT_LEVEL ? level : level - 1u;
+            const BYTE light = m_aLight[getIndex(x, y, z)];
+            if ((light >> 4u) >= newLevel || isSolid(x, y, z))
+            {
+                continue;
+            }
+
+            setLight(x, y, z, static_cast<BYTE>(newLevel << 4u) | (light & MAX_LIGHT_LEVEL));
+            m_skyAdditionQueue.push_back(LightNode{ .x = x, .y = y, .z = z, .level = newLevel });
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelLightMap::stepBlockAddition
+
+      Summary:  Spreads the block light of a block to its empty
+                neighbors, one level dimmer
+
+      Args:     const LightNode& node
+                  Block to spread the light of
+
+      Modifies: [m_aLight, m_blockAdditionQueue].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelLightMap::stepBlockAddition(_In_ const LightNode& node)
+    {
+        // The block may have been darkened since it was queued
+        const BYTE level = m_aLight[getIndex(node.x, node.y, node.z)] & MAX_LIGHT_LEVEL;
+        if (level <= 1u)
+        {
+            return;
+        }
+
+        for (INT i = 0; i < 6; ++i)
+        {
+            const INT iNeighborX = static_cast<INT>(node.x) + NEIGHBOR_OFFSETS[i][0];
+            const INT iNeighborY = static_cast<INT>(node.y) + NEIGHBOR_OFFSETS[i][1];
+            const INT iNeighborZ = static_cast<INT>(node.z) + NEIGHBOR_OFFSETS[i][2];
+            if (!isInside(iNeighborX, iNeighborY, iNeighborZ))
+            {
+                continue;
+            }
+
+            const UINT x = static_cast<UINT>(iNeighborX);
+            const UINT y = static_cast<UINT>(iNeighborY);
+            const UINT z = static_cast<UINT>(iNeighborZ);
+            const BYTE light = m_aLight[getIndex(x, y, z)];
+            if ((light & MAX_LIGHT_LEVEL) >= level - 1u || isSolid(x, y, z))
+            {
+                continue;
+            }
+
+            setLight(x, y, z, (light & FULL_SKY_LIGHT) | static_cast<BYTE>(level - 1u));
+            m_blockAdditionQueue.push_back(LightNode{ .x = x, .y = y, .z = z, .level = static_cast<BYTE>(level - 1u) });
+        }
+    }
+}
@@ -0,0 +1,160 @@
+/*+===================================================================
+  File:      VOXELLIGHTMAP.H
+
+  Summary:   VoxelLightMap header file contains declarations of
+             VoxelLightMap class used for the lab samples of Game
+             Graphics Programming course.
+
+  Classes: VoxelLightMap
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <deque>
+
+#include "Scene/HeightMap.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   VoxelLightStats
+
+      Summary:  Statistics of the light propagation
+
+                uNumSteps
+                  Cells taken out of the propagation queues
+                uNumCellsChanged
+                  Cells whose sky or block light changed
+                uNumPendingSteps
+                  Cells left in the queues for the next updates
+                uTicks
+                  Time spent propagating in performance counter ticks
+                uTicksPerSecond
+                  Frequency of the performance counter
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelLightStats
+    {
+        UINT64 uNumSteps;
+        UINT64 uNumCellsChanged;
+        UINT64 uNumPendingSteps;
+        UINT64 uTicks;
+        UINT64 uTicksPerSecond;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    VoxelLightMap
+
+      Summary:  Light level of every block of a height map, from 0 to
+                MAX_LIGHT_LEVEL, packed as sky light in the high nibble
+                and block light in the low nibble. Sky light enters
+                from the top of the map and goes down without fading,
+                block light comes from emitters and emissive palette
+                entries. Both spread by a breadth first flood fill,
+                losing one level per block. Edits queue the cells to
+                darken and relight, and Propagate works through the
+                queues a bounded number of cells at a time. Blocks
+                above the stored range are lit by the sky only. Must
+                not be changed while other threads read it
+
+      Methods:  Initialize
+                  Lights the whole map
+                SetEmissiveType
+                  Makes the exposed blocks of a palette entry emit
+                  light
+                SetEmitter
+                  Adds, changes or removes a light in an empty block
+                OnColumnChanged
+                  Queues the blocks around edited blocks of a column
+                Propagate
+                  Works through the queued blocks
+                IsPropagating
+                  Returns whether blocks are left in the queues
+                TakeChangedRegion
+                  Returns and forgets the columns whose light changed
+                GetLight
+                  Returns the packed light of a block
+                GetSkyLight
+                  Returns the sky light of a block
+                GetBlockLight
+                  Returns the block light of a block
+                GetSizeY
+                  Returns the number of blocks stored per column
+                VoxelLightMap
+                  Constructor.
+                ~VoxelLightMap
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class VoxelLightMap
+    {
+    public:
+        static constexpr const BYTE MAX_LIGHT_LEVEL = 15u;
+        static constexpr const BYTE FULL_SKY_LIGHT = MAX_LIGHT_LEVEL << 4u;
+
+        VoxelLightMap(_In_ const HeightMap& heightMap);
+        VoxelLightMap(const VoxelLightMap& other) = delete;
+        VoxelLightMap(VoxelLightMap&& other) = delete;
+        VoxelLightMap& operator=(const VoxelLightMap& other) = delete;
+        VoxelLightMap& operator=(VoxelLightMap&& other) = delete;
+        ~VoxelLightMap() = default;
+
+        void Initialize(_Inout_opt_ VoxelLightStats* pStats = nullptr);
+        void SetEmissiveType(_In_ BYTE type, _In_ BYTE level);
+        HRESULT SetEmitter(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ BYTE level);
+        void OnColumnChanged(_In_ UINT x, _In_ UINT z, _In_ UINT uBeginY, _In_ UINT uEndY);
+        void Propagate(_In_ UINT uMaxSteps, _Inout_opt_ VoxelLightStats* pStats = nullptr);
+        BOOL IsPropagating() const;
+        BOOL TakeChangedRegion(_Out_ UINT& uOutBeginX, _Out_ UINT& uOutBeginZ, _Out_ UINT& uOutEndX, _Out_ UINT& uOutEndZ);
+
+        BYTE GetLight(_In_ INT x, _In_ INT y, _In_ INT z) const;
+        BYTE GetSkyLight(_In_ INT x, _In_ INT y, _In_ INT z) const;
+        BYTE GetBlockLight(_In_ INT x, _In_ INT y, _In_ INT z) const;
+        UINT GetSizeY() const;
+
+    private:
+        struct LightNode
+        {
+            UINT x;
+            UINT y;
+            UINT z;
+            BYTE level;
+        };
+
+        BOOL isInside(_In_ INT x, _In_ INT y, _In_ INT z) const;
+        BOOL isSolid(_In_ UINT x, _In_ UINT y, _In_ UINT z) const;
+        BYTE getEmission(_In_ UINT x, _In_ UINT y, _In_ UINT z) const;
+        BYTE getSourceLight(_In_ UINT x, _In_ UINT y, _In_ UINT z) const;
+        size_t getIndex(_In_ UINT x, _In_ UINT y, _In_ UINT z) const;
+        void setLight(_In_ UINT x, _In_ UINT y, _In_ UINT z, _In_ BYTE light);
+        void resetCell(_In_ UINT x, _In_ UINT y, _In_ UINT z);
+        void darkenCell(_In_ UINT x, _In_ UINT y, _In_ UINT z);
+        void stepSkyRemoval(_In_ const LightNode& node);
+        void stepBlockRemoval(_In_ const LightNode& node);
+        void stepSkyAddition(_In_ const LightNode& node);
+        void stepBlockAddition(_In_ const LightNode& node);
+
+    private:
+        static constexpr const INT NEIGHBOR_OFFSETS[6][3] =
+        {
+            { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+        };
+
+        const HeightMap& m_heightMap;
+        UINT m_uSizeY;
+        std::vector<BYTE> m_aLight;
+        std::vector<BYTE> m_aEmissiveLevels;
+        std::unordered_map<UINT64, BYTE> m_emitters;
+        std::deque<LightNode> m_skyRemovalQueue;
+        std::deque<LightNode> m_blockRemovalQueue;
+        std::deque<LightNode> m_skyAdditionQueue;
+        std::deque<LightNode> m_blockAdditionQueue;
+        UINT64 m_uNumCellsChanged;
+        BOOL m_bChanged;
+        UINT m_uChangedBeginX;
+        UINT m_uChangedBeginZ;
+        UINT m_uChangedEndX;
+        UINT m_uChangedEndZ;
+    };
+}
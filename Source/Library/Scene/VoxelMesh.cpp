@@ -0,0 +1,201 @@
+#include "Scene/VoxelMesh.h"
+
+#include "Texture/Material.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesh::VoxelMesh
+
+      Summary:  Constructor
+
+      Args:     ChunkMeshPart&& part
+                  Faces of the mesh
+                const XMFLOAT4& outputColor
+                  Color of the mesh
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    VoxelMesh::VoxelMesh(_In_ ChunkMeshPart&& part, _In_ const XMFLOAT4& outputColor) :
+        Renderable(outputColor)
+        , m_aVertices(std::move(part.aVertices))
+        , m_aIndices(std::move(part.aIndices))
+        , m_aOcclusion(std::move(part.aOcclusion))
+        , m_occlusionBuffer()
+        , m_aLight(std::move(part.aLight))
+        , m_lightBuffer()
+    {
+        m_aOcclusion.resize(m_aVertices.size(), ChunkMesher::MAX_OCCLUSION_LEVEL);
+        m_aLight.resize(m_aVertices.size(), VoxelLightMap::FULL_SKY_LIGHT);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesh::Initialize
+
+      Summary:  Initializes the buffers of the mesh and the vertex
+                buffers of its ambient occlusion levels and light
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the buffers
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to set buffers
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT VoxelMesh::Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
+    {
+        BasicMeshEntry basicMeshEntry;
+        basicMeshEntry.uNumIndices = GetNumIndices();
+
+        m_aMeshes.push_back(basicMeshEntry);
+
+        HRESULT hr = initialize(pDevice, pImmediateContext);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        D3D11_BUFFER_DESC oBufferDesc = {
+            .ByteWidth = static_cast<UINT>(sizeof(BYTE) * m_aOcclusion.size()),
+            .Usage = D3D11_USAGE_IMMUTABLE,
+            .BindFlags = D3D11_BIND_VERTEX_BUFFER,
+            .CPUAccessFlags = 0,
+            .MiscFlags = 0
+        };
+
+        D3D11_SUBRESOURCE_DATA oInitData = {
+            .pSysMem = m_aOcclusion.data(),
+            .SysMemPitch = 0,
+            .SysMemSlicePitch = 0
+        };
+
+        hr = pDevice->CreateBuffer(&oBufferDesc, &oInitData, m_occlusionBuffer.GetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        D3D11_BUFFER_DESC lBufferDesc = {
+            .ByteWidth = static_cast<UINT>(sizeof(BYTE) * m_aLight.size()),
+            .Usage = D3D11_USAGE_IMMUTABLE,
+            .BindFlags = D3D11_BIND_VERTEX_BUFFER,
+            .CPUAccessFlags = 0,
+            .MiscFlags = 0
+        };
+
+        D3D11_SUBRESOURCE_DATA lInitData = {
+            .pSysMem = m_aLight.data(),
+            .SysMemPitch = 0,
+            .SysMemSlicePitch = 0
+        };
+
+        hr = pDevice->CreateBuffer(&lBufferDesc, &lInitData, m_lightBuffer.GetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        if (HasTexture() > 0)
+        {
+            hr = SetMaterialOfMesh(0, 0);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesh::Update
+
+      Summary:  Updates the mesh every frame
+
+      Args:     FLOAT deltaTime
+                  Elapsed time
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelMesh::Update(_In_ FLOAT deltaTime)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesh::GetNumVertices
+
+      Summary:  Returns the number of vertices in the mesh
+
+      Returns:  UINT
+                  Number of vertices
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelMesh::GetNumVertices() const
+    {
+        return static_cast<UINT>(m_aVertices.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesh::GetNumIndices
+
+      Summary:  Returns the number of indices in the mesh
+
+      Returns:  UINT
+                  Number of indices
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT VoxelMesh::GetNumIndices() const
+    {
+        return static_cast<UINT>(m_aIndices.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesh::GetOcclusionBuffer
+
+      Summary:  Returns the vertex buffer of the ambient occlusion
+                levels, one byte per vertex
+
+      Returns:  ComPtr<ID3D11Buffer>&
+                  Vertex buffer of the ambient occlusion levels
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ComPtr<ID3D11Buffer>& VoxelMesh::GetOcclusionBuffer()
+    {
+        return m_occlusionBuffer;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesh::GetLightBuffer
+
+      Summary:  Returns the vertex buffer of the packed light, sky light
+                in the high nibble and block light in the low nibble,
+                one byte per vertex
+
+      Returns:  ComPtr<ID3D11Buffer>&
+                  Vertex buffer of the packed light
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ComPtr<ID3D11Buffer>& VoxelMesh::GetLightBuffer()
+    {
+        return m_lightBuffer;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesh::getVertices
+
+      Summary:  Returns the pointer to the vertices data
+
+      Returns:  const library::SimpleVertex*
+                  Pointer to the vertices data
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const SimpleVertex* VoxelMesh::getVertices() const
+    {
+        return m_aVertices.data();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelMesh::getIndices
+
+      Summary:  Returns the pointer to the indices data
+
+      Returns:  const WORD*
+                  Pointer to the indices data
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const WORD* VoxelMesh::getIndices() const
+    {
+        return m_aIndices.data();
+    }
+}
@@ -0,0 +1,72 @@
+/*+===================================================================
+  File:      VOXELMESH.H
+
+  Summary:   VoxelMesh header file contains declarations of VoxelMesh
+             class used for the lab samples of Game Graphics
+             Programming course.
+
+  Classes: VoxelMesh
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Renderer/DataTypes.h"
+#include "Renderer/Renderable.h"
+#include "Scene/ChunkMesher.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    VoxelMesh
+
+      Summary:  Static mesh of the visible faces of one palette entry
+                of a chunk, built by the ChunkMesher. Drawn with a
+                single DrawIndexed call instead of one cube instance
+                per block. The ambient occlusion level and the packed
+                light of every vertex are kept in their own one byte
+                vertex buffers
+
+      Methods:  GetOcclusionBuffer
+                  Returns the vertex buffer of the ambient occlusion
+                  levels
+                GetLightBuffer
+                  Returns the vertex buffer of the packed light
+                VoxelMesh
+                  Constructor.
+                ~VoxelMesh
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class VoxelMesh : public Renderable
+    {
+    public:
+        VoxelMesh(_In_ ChunkMeshPart&& part, _In_ const XMFLOAT4& outputColor);
+        VoxelMesh(const VoxelMesh& other) = delete;
+        VoxelMesh(VoxelMesh&& other) = delete;
+        VoxelMesh& operator=(const VoxelMesh& other) = delete;
+        VoxelMesh& operator=(VoxelMesh&& other) = delete;
+        ~VoxelMesh() = default;
+
+        virtual HRESULT Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext) override;
+        virtual void Update(_In_ FLOAT deltaTime) override;
+
+        UINT GetNumVertices() const override;
+        UINT GetNumIndices() const override;
+        ComPtr<ID3D11Buffer>& GetOcclusionBuffer();
+        ComPtr<ID3D11Buffer>& GetLightBuffer();
+
+    protected:
+        const SimpleVertex* getVertices() const override;
+        const WORD* getIndices() const override;
+
+    private:
+        std::vector<SimpleVertex> m_aVertices;
+        std::vector<WORD> m_aIndices;
+        std::vector<BYTE> m_aOcclusion;
+        ComPtr<ID3D11Buffer> m_occlusionBuffer;
+        std::vector<BYTE> m_aLight;
+        ComPtr<ID3D11Buffer> m_lightBuffer;
+    };
+}
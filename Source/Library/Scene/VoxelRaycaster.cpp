@@ -0,0 +1,500 @@
+#include "Scene/VoxelRaycaster.h"
+
+#include <random>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelRaycaster::VoxelRaycaster
+
+      Summary:  Constructor. Finds the tallest column to bound the grid
+
+      Args:     const HeightMap& heightMap
+                  Height map to cast rays against. Must outlive the
+                  raycaster
+
+      Modifies: [m_heightMap, m_gridOrigin, m_uMaxHeight].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    VoxelRaycaster::VoxelRaycaster(_In_ const HeightMap& heightMap)
+        : m_heightMap(heightMap)
+        , m_gridOrigin(heightMap.GetGridOrigin())
+        , m_uMaxHeight(0u)
+    {
+        const size_t uNumColumns = static_cast<size_t>(m_heightMap.GetWidth()) * static_cast<size_t>(m_heightMap.GetDepth());
+        const WORD* pColumnHeights = m_heightMap.GetColumnHeights();
+        for (size_t i = 0u; i < uNumColumns; ++i)
+        {
+            m_uMaxHeight = pColumnHeights[i] > m_uMaxHeight ? pColumnHeights[i] : m_uMaxHeight;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelRaycaster::Raycast
+
+      Summary:  Returns the first block hit by a ray. The ray is moved
+                into grid space, where blocks are unit cubes and block
+                (x, y, z) spans [x, x + 1) x [y, y + 1) x [z, z + 1),
+                and clipped to the bounds of the map. From there it
+                steps to the neighboring block across the nearest
+                boundary until the block is solid or the ray leaves
+                the grid or exceeds its maximum distance
+
+      Args:     const VoxelRay& ray
+                  Ray to cast
+                VoxelRaycastHit& outHit
+                  Hit block, face, distance and position
+
+      Returns:  BOOL
+                  TRUE if a block was hit
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelRaycaster::Raycast(_In_ const VoxelRay& ray, _Out_ VoxelRaycastHit& outHit) const
+    {
+        outHit = VoxelRaycastHit{ .bHit = FALSE };
+
+        const FLOAT length = sqrtf(ray.Direction.x * ray.Direction.x + ray.Direction.y * ray.Direction.y + ray.Direction.z * ray.Direction.z);
+        if (length == 0.0f)
+        {
+            return FALSE;
+        }
+
+        // Blocks are 2 units wide, so grid space moves half as fast as
+        // world space and the ray parameter stays in world units
+        const FLOAT aDirection[3] = { ray.Direction.x / length, ray.Direction.y / length, ray.Direction.z / length };
+        const FLOAT aOrigin[3] =
+        {
+            (ray.Origin.x - m_gridOrigin.x + 1.0f) * 0.5f,
+            (ray.Origin.y - m_gridOrigin.y + 1.0f) * 0.5f,
+            (ray.Origin.z - m_gridOrigin.z + 1.0f) * 0.5f
+        };
+        const FLOAT aGridDirection[3] = { aDirection[0] * 0.5f, aDirection[1] * 0.5f, aDirection[2] * 0.5f };
+        const INT aSize[3] = { static_cast<INT>(m_heightMap.GetWidth()), static_cast<INT>(m_uMaxHeight), static_cast<INT>(m_heightMap.GetDepth()) };
+
+        // Clip the ray to the bounds of the grid
+        FLOAT tEnter = 0.0f;
+        FLOAT tExit = ray.MaxDistance;
+        INT iEnterAxis = -1;
+        for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+        {
+            if (aGridDirection[uAxis] == 0.0f)
+            {
+                if (aOrigin[uAxis] < 0.0f || aOrigin[uAxis] >= static_cast<FLOAT>(aSize[uAxis]))
+                {
+                    return FALSE;
+                }
+                continue;
+            }
+
+            FLOAT tNear = (0.0f - aOrigin[uAxis]) / aGridDirection[uAxis];
+            FLOAT tFar = (static_cast<FLOAT>(aSize[uAxis]) - aOrigin[uAxis]) / aGridDirection[uAxis];
+            if (tNear > tFar)
+            {
+                const FLOAT tSwap = tNear;
+                tNear = tFar;
+                tFar = tSwap;
+            }
+
+            if (tNear > tEnter)
+            {
+                tEnter = tNear;
+                iEnterAxis = static_cast<INT>(uAxis);
+            }
+            tExit = tFar < tExit ? tFar : tExit;
+        }
+
+        if (tEnter > tExit)
+        {
+            return FALSE;
+        }
+
+        INT aBlock[3];
+        INT aStep[3];
+        FLOAT aNextT[3];
+        FLOAT aDeltaT[3];
+        for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+        {
+            const FLOAT position = aOrigin[uAxis] + aGridDirection[uAxis] * tEnter;
+            INT iBlock = static_cast<INT>(floorf(position));
+            if (static_cast<INT>(uAxis) == iEnterAxis)
+            {
+                iBlock = aGridDirection[uAxis] > 0.0f ? 0 : aSize[uAxis] - 1;
+            }
+            aBlock[uAxis] = iBlock < 0 ? 0 : (iBlock >= aSize[uAxis] ? aSize[uAxis] - 1 : iBlock);
+
+            if (aGridDirection[uAxis] > 0.0f)
+            {
+                aStep[uAxis] = 1;
+                aNextT[uAxis] = (static_cast<FLOAT>(aBlock[uAxis] + 1) - aOrigin[uAxis]) / aGridDirection[uAxis];
+                aDeltaT[uAxis] = 1.0f / aGridDirection[uAxis];
+            }
+            else if (aGridDirection[uAxis] < 0.0f)
+            {
+                aStep[uAxis] = -1;
+                aNextT[uAxis] = (static_cast<FLOAT>(aBlock[uAxis]) - aOrigin[uAxis]) / aGridDirection[uAxis];
+                aDeltaT[uAxis] = -1.0f / aGridDirection[uAxis];
+            }
+            else
+            {
+                aStep[uAxis] = 0;
+                aNextT[uAxis] = FLT_MAX;
+                aDeltaT[uAxis] = FLT_MAX;
+            }
+        }
+
+        INT aNormal[3] = { 0, 0, 0 };
+        if (iEnterAxis >= 0)
+        {
+            aNormal[iEnterAxis] = -aStep[iEnterAxis];
+        }
+
+        FLOAT t = tEnter;
+        for (;;)
+        {
+            if (isSolid(aBlock[0], aBlock[1], aBlock[2]))
+            {
+                outHit.bHit = TRUE;
+                outHit.Block = XMUINT3(static_cast<UINT>(aBlock[0]), static_cast<UINT>(aBlock[1]), static_cast<UINT>(aBlock[2]));
+                outHit.Normal = XMINT3(aNormal[0], aNormal[1], aNormal[2]);
+                outHit.Distance = t;
+                outHit.Position = XMFLOAT3(
+                    ray.Origin.x + aDirection[0] * t,
+                    ray.Origin.y + aDirection[1] * t,
+                    ray.Origin.z + aDirection[2] * t
+                );
+                outHit.Type = m_heightMap.GetBlockType(static_cast<UINT>(aBlock[0]), static_cast<UINT>(aBlock[1]), static_cast<UINT>(aBlock[2]));
+                return TRUE;
+            }
+
+            const UINT uAxis = aNextT[0] < aNextT[1]
+                ? (aNextT[0] < aNextT[2] ? 0u : 2u)
+                : (aNextT[1] < aNextT[2] ? 1u : 2u);
+            if (aNextT[uAxis] > tExit)
+            {
+                return FALSE;
+            }
+
+            t = aNextT[uAxis];
+            aBlock[uAxis] += aStep[uAxis];
+            if (aBlock[uAxis] < 0 || aBlock[uAxis] >= aSize[uAxis])
+            {
+                return FALSE;
+            }
+            aNextT[uAxis] += aDeltaT[uAxis];
+
+            aNormal[0] = 0;
+            aNormal[1] = 0;
+            aNormal[2] = 0;
+            aNormal[uAxis] = -aStep[uAxis];
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelRaycaster::RaycastBatch
+
+      Summary:  Casts many rays. With a thread pool the rays are split
+                into one contiguous range per worker
+
+      Args:     const std::vector<VoxelRay>& aRays
+                  Rays to cast
+                std::vector<VoxelRaycastHit>& aOutHits
+                  Hit of each ray, in the order of the rays
+                ThreadPool* pThreadPool
+                  Thread pool to cast the rays on. Casts on the calling
+                  thread if null. Must not be called from a worker of
+                  this pool
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelRaycaster::RaycastBatch(
+        _In_ const std::vector<VoxelRay>& aRays,
+        _Out_ std::vector<VoxelRaycastHit>& aOutHits,
+        _In_opt_ ThreadPool* pThreadPool
+    ) const
+    {
+        aOutHits.resize(aRays.size());
+
+        const UINT uNumRays = static_cast<UINT>(aRays.size());
+        UINT uNumRanges = pThreadPool ? pThreadPool->GetNumThreads() : 1u;
+        const UINT uMaxRanges = (uNumRays + MIN_BATCH_RANGE_SIZE - 1u) / MIN_BATCH_RANGE_SIZE;
+        uNumRanges = uNumRanges < uMaxRanges ? uNumRanges : uMaxRanges;
+
+        if (uNumRanges <= 1u)
+        {
+            for (UINT i = 0u; i < uNumRays; ++i)
+            {
+                Raycast(aRays[i], aOutHits[i]);
+            }
+            return;
+        }
+
+        pThreadPool->ParallelFor(uNumRanges, [this, &aRays, &aOutHits, uNumRays, uNumRanges](UINT uRangeIdx)
+            {
+                const UINT uBegin = static_cast<UINT>(static_cast<UINT64>(uNumRays) * uRangeIdx / uNumRanges);
+                const UINT uEnd = static_cast<UINT>(static_cast<UINT64>(uNumRays) * (uRangeIdx + 1u) / uNumRanges);
+                for (UINT i = uBegin; i < uEnd; ++i)
+                {
+                    Raycast(aRays[i], aOutHits[i]);
+                }
+            }
+        );
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelRaycaster::Benchmark
+
+      Summary:  Casts a batch of rays spread evenly over the sphere of
+                directions around a point and reports the time spent,
+                from which the throughput is uNumRays / uTicks
+
+      Args:     const XMFLOAT3& origin
+                  World position the rays start from
+                UINT uNumRays
+                  Number of rays
+                FLOAT maxDistance
+                  Maximum distance of every ray in world units
+                ThreadPool* pThreadPool
+                  Thread pool to cast the rays on. Can be null
+                VoxelRaycastStats& outStats
+                  Statistics of the batch
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelRaycaster::Benchmark(
+        _In_ const XMFLOAT3& origin,
+        _In_ UINT uNumRays,
+        _In_ FLOAT maxDistance,
+        _In_opt_ ThreadPool* pThreadPool,
+        _Out_ VoxelRaycastStats& outStats
+    ) const
+    {
+        outStats = VoxelRaycastStats{};
+
+        // Fibonacci sphere
+        const FLOAT goldenAngle = XM_PI * (3.0f - sqrtf(5.0f));
+        std::vector<VoxelRay> aRays(uNumRays);
+        for (UINT i = 0u; i < uNumRays; ++i)
+        {
+            const FLOAT y = 1.0f - 2.0f * (static_cast<FLOAT>(i) + 0.5f) / static_cast<FLOAT>(uNumRays);
+            const FLOAT radius = sqrtf(1.0f - y * y);
+            const FLOAT angle = goldenAngle * static_cast<FLOAT>(i);
+
+            aRays[i] = VoxelRay
+            {
+                .Origin = origin,
+                .Direction = XMFLOAT3(cosf(angle) * radius, y, sinf(angle) * radius),
+                .MaxDistance = maxDistance
+            };
+        }
+
+        std::vector<VoxelRaycastHit> aHits;
+
+        LARGE_INTEGER startingTime;
+        LARGE_INTEGER endingTime;
+        LARGE_INTEGER frequency;
+        QueryPerformanceCounter(&startingTime);
+        RaycastBatch(aRays, aHits, pThreadPool);
+        QueryPerformanceCounter(&endingTime);
+        QueryPerformanceFrequency(&frequency);
+
+        outStats.uNumRays = uNumRays;
+        for (const VoxelRaycastHit& hit : aHits)
+        {
+            outStats.uNumHits += hit.bHit ? 1u : 0u;
+        }
+        outStats.uTicks = static_cast<UINT64>(endingTime.QuadPart - startingTime.QuadPart);
+        outStats.uTicksPerSecond = static_cast<UINT64>(frequency.QuadPart);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelRaycaster::Validate
+
+      Summary:  Casts random rays and checks each one against a
+                brute-force march that samples the ray every
+                VALIDATION_STEP world units and stops in the first
+                solid block. The rays start anywhere around the map,
+                mostly pointing down. A ray agrees when both find a
+                hit, or both miss, and the distances are within
+                VALIDATION_TOLERANCE. A hit must also have a face
+                normal unless the ray starts inside a block, the block
+                across that face must be empty, and the hit position
+                must lie on that face
+
+      Args:     UINT uNumRays
+                  Number of rays
+                FLOAT maxDistance
+                  Maximum distance of every ray in world units
+                UINT uSeed
+                  Seed of the random rays, so a run can be repeated
+                VoxelRaycastValidationStats& outStats
+                  Number of rays, hits and mismatches
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelRaycaster::Validate(
+        _In_ UINT uNumRays,
+        _In_ FLOAT maxDistance,
+        _In_ UINT uSeed,
+        _Out_ VoxelRaycastValidationStats& outStats
+    ) const
+    {
+        outStats = VoxelRaycastValidationStats{};
+
+        // World bounds of the grid, with some room around it
+        const FLOAT margin = 16.0f;
+        const FLOAT aMin[3] = { m_gridOrigin.x - 1.0f - margin, m_gridOrigin.y - 1.0f, m_gridOrigin.z - 1.0f - margin };
+        const FLOAT aMax[3] =
+        {
+            m_gridOrigin.x - 1.0f + 2.0f * static_cast<FLOAT>(m_heightMap.GetWidth()) + margin,
+            m_gridOrigin.y - 1.0f + 2.0f * static_cast<FLOAT>(m_uMaxHeight) + margin,
+            m_gridOrigin.z - 1.0f + 2.0f * static_cast<FLOAT>(m_heightMap.GetDepth()) + margin
+        };
+
+        std::mt19937 generator(uSeed);
+        std::uniform_real_distribution<FLOAT> unit(0.0f, 1.0f);
+        std::uniform_real_distribution<FLOAT> direction(-1.0f, 1.0f);
+
+        for (UINT i = 0u; i < uNumRays; ++i)
+        {
+            VoxelRay ray =
+            {
+                .Origin = XMFLOAT3(
+                    aMin[0] + (aMax[0] - aMin[0]) * unit(generator),
+                    aMin[1] + (aMax[1] - aMin[1]) * unit(generator),
+                    aMin[2] + (aMax[2] - aMin[2]) * unit(generator)
+                ),
+                .Direction = XMFLOAT3(direction(generator), direction(generator) - 0.3f, direction(generator)),
+                .MaxDistance = maxDistance
+            };
+
+            VoxelRaycastHit hit;
+            Raycast(ray, hit);
+            ++outStats.uNumRays;
+
+            const FLOAT length = sqrtf(ray.Direction.x * ray.Direction.x + ray.Direction.y * ray.Direction.y + ray.Direction.z * ray.Direction.z);
+            if (length == 0.0f)
+            {
+                outStats.uNumMismatches += hit.bHit ? 1u : 0u;
+                continue;
+            }
+            const FLOAT aDirection[3] = { ray.Direction.x / length, ray.Direction.y / length, ray.Direction.z / length };
+
+            BOOL bMarchHit = FALSE;
+            FLOAT marchDistance = 0.0f;
+            for (FLOAT t = 0.0f; t <= maxDistance; t += VALIDATION_STEP)
+            {
+                const INT x = static_cast<INT>(floorf((ray.Origin.x + aDirection[0] * t - m_gridOrigin.x + 1.0f) * 0.5f));
+                const INT y = static_cast<INT>(floorf((ray.Origin.y + aDirection[1] * t - m_gridOrigin.y + 1.0f) * 0.5f));
+                const INT z = static_cast<INT>(floorf((ray.Origin.z + aDirection[2] * t - m_gridOrigin.z + 1.0f) * 0.5f));
+                if (isInside(x, y, z) && isSolid(x, y, z))
+                {
+                    bMarchHit = TRUE;
+                    marchDistance = t;
+                    break;
+                }
+            }
+
+            outStats.uNumHits += bMarchHit ? 1u : 0u;
+            if (bMarchHit != hit.bHit)
+            {
+                ++outStats.uNumMismatches;
+                continue;
+            }
+            if (!bMarchHit)
+            {
+                continue;
+            }
+
+            const FLOAT distanceError = fabsf(marchDistance - hit.Distance);
+            if (distanceError > VALIDATION_TOLERANCE)
+            {
+                ++outStats.uNumMismatches;
+                continue;
+            }
+            outStats.maxDistanceError = distanceError > outStats.maxDistanceError ? distanceError : outStats.maxDistanceError;
+
+            const INT aBlock[3] = { static_cast<INT>(hit.Block.x), static_cast<INT>(hit.Block.y), static_cast<INT>(hit.Block.z) };
+            const INT aNormal[3] = { hit.Normal.x, hit.Normal.y, hit.Normal.z };
+            const FLOAT aPosition[3] =
+            {
+                (hit.Position.x - m_gridOrigin.x + 1.0f) * 0.5f,
+                (hit.Position.y - m_gridOrigin.y + 1.0f) * 0.5f,
+                (hit.Position.z - m_gridOrigin.z + 1.0f) * 0.5f
+            };
+
+            BOOL bAgrees = TRUE;
+            if (aNormal[0] == 0 && aNormal[1] == 0 && aNormal[2] == 0)
+            {
+                bAgrees = marchDistance <= VALIDATION_STEP;
+            }
+            else
+            {
+                const INT aNeighbor[3] = { aBlock[0] + aNormal[0], aBlock[1] + aNormal[1], aBlock[2] + aNormal[2] };
+                bAgrees = !(isInside(aNeighbor[0], aNeighbor[1], aNeighbor[2]) && isSolid(aNeighbor[0], aNeighbor[1], aNeighbor[2]));
+                for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+                {
+                    if (aNormal[uAxis] != 0)
+                    {
+                        const FLOAT face = static_cast<FLOAT>(aBlock[uAxis] + (aNormal[uAxis] > 0 ? 1 : 0));
+                        bAgrees = bAgrees && fabsf(aPosition[uAxis] - face) <= 1e-3f;
+                    }
+                }
+            }
+            outStats.uNumMismatches += bAgrees ? 0u : 1u;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelRaycaster::OnColumnChanged
+
+      Summary:  Keeps the grid as tall as the tallest column after a
+                column of the height map was edited
+
+      Args:     UINT uNumBlocks
+                  New number of blocks of the edited column
+
+      Modifies: [m_uMaxHeight].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void VoxelRaycaster::OnColumnChanged(_In_ UINT uNumBlocks)
+    {
+        m_uMaxHeight = uNumBlocks > m_uMaxHeight ? uNumBlocks : m_uMaxHeight;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelRaycaster::isInside
+
+      Summary:  Returns whether a block lies inside the grid
+
+      Args:     INT x
+                  Column index along the x axis
+                INT y
+                  Block index inside the column
+                INT z
+                  Column index along the z axis
+
+      Returns:  BOOL
+                  TRUE if the block can be passed to isSolid
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelRaycaster::isInside(_In_ INT x, _In_ INT y, _In_ INT z) const
+    {
+        return x >= 0 && y >= 0 && z >= 0
+            && x < static_cast<INT>(m_heightMap.GetWidth())
+            && z < static_cast<INT>(m_heightMap.GetDepth());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VoxelRaycaster::isSolid
+
+      Summary:  Returns whether a block of the grid is solid
+
+      Args:     INT x
+                  Column index along the x axis
+                INT y
+                  Block index inside the column
+                INT z
+                  Column index along the z axis
+
+      Returns:  BOOL
+                  TRUE if the column has a palette entry and is taller
+                  than y
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL VoxelRaycaster::isSolid(_In_ INT x, _In_ INT y, _In_ INT z) const
+    {
+        const size_t uColumnIdx = static_cast<size_t>(z) * static_cast<size_t>(m_heightMap.GetWidth()) + static_cast<size_t>(x);
+
+        return m_heightMap.GetColumnTypes()[uColumnIdx] < m_heightMap.GetNumColors()
+            && static_cast<UINT>(y) < m_heightMap.GetColumnHeights()[uColumnIdx];
+    }
+}
@@ -0,0 +1,182 @@
+/*+===================================================================
+  File:      VOXELRAYCASTER.H
+
+  Summary:   VoxelRaycaster header file contains declarations of
+             VoxelRaycaster class used for the lab samples of Game
+             Graphics Programming course.
+
+  Classes: VoxelRaycaster
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <cfloat>
+
+#include "Scene/HeightMap.h"
+#include "Thread/ThreadPool.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   VoxelRay
+
+      Summary:  Ray in world space. The direction does not need to be
+                normalized, MaxDistance is in world units
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelRay
+    {
+        XMFLOAT3 Origin;
+        XMFLOAT3 Direction;
+        FLOAT MaxDistance;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   VoxelRaycastHit
+
+      Summary:  Result of a raycast
+
+                bHit
+                  Whether a block was hit
+                Block
+                  Column x, block y and column z of the hit block
+                Normal
+                  Outward normal of the face that was hit. Zero when
+                  the ray starts inside a block
+                Distance
+                  Distance along the ray in world units
+                Position
+                  World position of the hit
+                Type
+                  Palette entry of the hit block
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelRaycastHit
+    {
+        BOOL bHit;
+        XMUINT3 Block;
+        XMINT3 Normal;
+        FLOAT Distance;
+        XMFLOAT3 Position;
+        BYTE Type;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   VoxelRaycastStats
+
+      Summary:  Statistics of a raycast benchmark
+
+                uNumRays
+                  Number of rays cast
+                uNumHits
+                  Number of rays that hit a block
+                uTicks
+                  Time spent in performance counter ticks
+                uTicksPerSecond
+                  Frequency of the performance counter
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelRaycastStats
+    {
+        UINT64 uNumRays;
+        UINT64 uNumHits;
+        UINT64 uTicks;
+        UINT64 uTicksPerSecond;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   VoxelRaycastValidationStats
+
+      Summary:  Result of checking the traversal against a brute-force
+                march
+
+                uNumRays
+                  Number of rays cast
+                uNumHits
+                  Number of rays the march found a block for
+                uNumMismatches
+                  Number of rays whose hit, block distance, face normal
+                  or hit position disagree with the march
+                maxDistanceError
+                  Largest difference between the hit distances of
+                  agreeing rays, in world units
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct VoxelRaycastValidationStats
+    {
+        UINT64 uNumRays;
+        UINT64 uNumHits;
+        UINT64 uNumMismatches;
+        FLOAT maxDistanceError;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    VoxelRaycaster
+
+      Summary:  Casts rays against the blocks of a height map with the
+                Amanatides-Woo grid traversal. The ray is clipped to
+                the bounds of the map, then steps from block to block
+                until it enters a solid one. Read only, so rays can be
+                cast from several threads at once
+
+      Methods:  Raycast
+                  Returns the first block hit by a ray
+                RaycastBatch
+                  Casts many rays, optionally on a thread pool
+                Benchmark
+                  Casts a fan of rays from a point and reports the
+                  throughput
+                Validate
+                  Compares random rays against a brute-force fine-step
+                  march
+                OnColumnChanged
+                  Grows the grid after a column was raised
+                VoxelRaycaster
+                  Constructor.
+                ~VoxelRaycaster
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class VoxelRaycaster
+    {
+    public:
+        static constexpr const UINT MIN_BATCH_RANGE_SIZE = 256u;
+        static constexpr const FLOAT VALIDATION_STEP = 0.005f;
+        static constexpr const FLOAT VALIDATION_TOLERANCE = 4.0f * VALIDATION_STEP;
+
+        VoxelRaycaster(_In_ const HeightMap& heightMap);
+        VoxelRaycaster(const VoxelRaycaster& other) = delete;
+        VoxelRaycaster(VoxelRaycaster&& other) = delete;
+        VoxelRaycaster& operator=(const VoxelRaycaster& other) = delete;
+        VoxelRaycaster& operator=(VoxelRaycaster&& other) = delete;
+        ~VoxelRaycaster() = default;
+
+        BOOL Raycast(_In_ const VoxelRay& ray, _Out_ VoxelRaycastHit& outHit) const;
+        void RaycastBatch(
+            _In_ const std::vector<VoxelRay>& aRays,
+            _Out_ std::vector<VoxelRaycastHit>& aOutHits,
+            _In_opt_ ThreadPool* pThreadPool = nullptr
+        ) const;
+        void Benchmark(
+            _In_ const XMFLOAT3& origin,
+            _In_ UINT uNumRays,
+            _In_ FLOAT maxDistance,
+            _In_opt_ ThreadPool* pThreadPool,
+            _Out_ VoxelRaycastStats& outStats
+        ) const;
+        void Validate(
+            _In_ UINT uNumRays,
+            _In_ FLOAT maxDistance,
+            _In_ UINT uSeed,
+            _Out_ VoxelRaycastValidationStats& outStats
+        ) const;
+        void OnColumnChanged(_In_ UINT uNumBlocks);
+
+    private:
+        BOOL isInside(_In_ INT x, _In_ INT y, _In_ INT z) const;
+        BOOL isSolid(_In_ INT x, _In_ INT y, _In_ INT z) const;
+
+    private:
+        const HeightMap& m_heightMap;
+        XMFLOAT3 m_gridOrigin;
+        UINT m_uMaxHeight;
+    };
+}
@@ -0,0 +1,898 @@
+#include "Scene/WorldSave.h"
+
+#include <algorithm>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorldSave::Compress
+
+      Summary:  Compresses bytes in the LZ4 block format. Matches are
+                found with a single hash table of the last position of
+                every 4 byte sequence, which favors speed over ratio.
+                The runs of the columns repeat a lot between
+                neighbors, so even this greedy search shrinks them well
+
+      Args:     const BYTE* pData
+                  Bytes to compress
+                size_t uSize
+                  Number of bytes to compress
+                std::vector<BYTE>& aOutCompressed
+                  Compressed bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void WorldSave::Compress(_In_reads_bytes_(uSize) const BYTE* pData, _In_ size_t uSize, _Out_ std::vector<BYTE>& aOutCompressed)
+    {
+        aOutCompressed.clear();
+        if (uSize == 0u)
+        {
+            return;
+        }
+        aOutCompressed.reserve(uSize + uSize / 255u + 16u);
+
+        const auto writeLength = [&aOutCompressed](size_t uLength)
+        {
+            for (; uLength >= 255u; uLength -= 255u)
+            {
+                aOutCompressed.push_back(255u);
+            }
+            aOutCompressed.push_back(static_cast<BYTE>(uLength));
+        };
+
+        const auto writeLiterals = [&](size_t uBegin, size_t uEnd, size_t uMatchLength)
+        {
+            const size_t uNumLiterals = uEnd - uBegin;
+            const size_t uMatchCode = uMatchLength >= MIN_MATCH ? uMatchLength - MIN_MATCH : 0u;
+            aOutCompressed.push_back(static_cast<BYTE>(((uNumLiterals < 15u ? uNumLiterals : 15u) << 4u) | (uMatchCode < 15u ? uMatchCode : 15u)));
+            if (uNumLiterals >= 15u)
+            {
+                writeLength(uNumLiterals - 15u);
+            }
+            aOutCompressed.insert(aOutCompressed.end(), pData + uBegin, pData + uEnd);
+        };
+
+        std::vector<size_t> aTable(static_cast<size_t>(1u) << HASH_BITS, SIZE_MAX);
+        const size_t uMatchStartLimit = uSize > MATCH_SAFE_DISTANCE ? uSize - MATCH_SAFE_DISTANCE : 0u;
+        const size_t uMatchEndLimit = uSize > LAST_LITERALS ? uSize - LAST_LITERALS : 0u;
+        size_t uAnchor = 0u;
+        size_t i = 0u;
+        while (i < uMatchStartLimit)
+        {
+            UINT uSequence = 0u;
+            memcpy(&uSequence, pData + i, sizeof(uSequence));
+            const UINT uHash = (uSequence * 2654435761u) >> (32u - HASH_BITS);
+            const size_t uCandidate = aTable[uHash];
+            aTable[uHash] = i;
+
+            UINT uCandidateSequence = 0u;
+            if (uCandidate != SIZE_MAX && i - uCandidate <= MAX_OFFSET)
+            {
+                memcpy(&uCandidateSequence, pData + uCandidate, sizeof(uCandidateSequence));
+            }
+            if (uCandidate == SIZE_MAX || i - uCandidate > MAX_OFFSET || uCandidateSequence != uSequence)
+            {
+                ++i;
+                continue;
+            }
+
+            size_t uMatchLength = MIN_MATCH;
+            while (i + uMatchLength < uMatchEndLimit && pData[uCandidate + uMatchLength] == pData[i + uMatchLength])
+            {
+                ++uMatchLength;
+            }
+
+            writeLiterals(uAnchor, i, uMatchLength);
+            const size_t uOffset = i - uCandidate;
+            aOutCompressed.push_back(static_cast<BYTE>(uOffset & 0xFFu));
+            aOutCompressed.push_back(static_cast<BYTE>(uOffset >> 8u));
+            if (uMatchLength - MIN_MATCH >= 15u)
+            {
+                writeLength(uMatchLength - MIN_MATCH - 15u);
+            }
+
+            i += uMatchLength;
+            uAnchor = i;
+        }
+
+        // The last sequence only holds literals
+        writeLiterals(uAnchor, uSize, 0u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorldSave::Decompress
+
+      Summary:  Decompresses bytes of the LZ4 block format. Every length
+                and offset is checked against both buffers, so a
+                corrupted file fails instead of writing out of bounds
+
+      Args:     const BYTE* pCompressed
+                  Compressed bytes
+                size_t uCompressedSize
+                  Number of compressed bytes
+                BYTE* pData
+                  Decompressed bytes
+                size_t uSize
+                  Number of bytes once decompressed
+
+      Returns:  HRESULT
+                  Status code. HRESULT_FROM_WIN32(ERROR_INVALID_DATA)
+                  if the bytes are not a block of exactly uSize bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT WorldSave::Decompress(
+        _In_reads_bytes_(uCompressedSize) const BYTE* pCompressed,
+        _In_ size_t uCompressedSize,
+        _Out_writes_bytes_(uSize) BYTE* pData,
+        _In_ size_t uSize
+    )
+    {
+        size_t uIn = 0u;
+        size_t uOut = 0u;
+        while (uIn < uCompressedSize)
+        {
+            const BYTE token = pCompressed[uIn++];
+
+            size_t uNumLiterals = token >> 4u;
+            if (uNumLiterals == 15u)
+            {
+                BYTE length = 255u;
+                while (length == 255u)
+                {
+                    if (uIn >= uCompressedSize)
+                    {
+                        return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                    }
+                    length = pCompressed[uIn++];
+                    uNumLiterals += length;
+                }
+            }
+
+            if (uNumLiterals > uCompressedSize - uIn || uNumLiterals > uSize - uOut)
+            {
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+            memcpy(pData + uOut, pCompressed + uIn, uNumLiterals);
+            uIn += uNumLiterals;
+            uOut += uNumLiterals;
+
+            if (uIn == uCompressedSize)
+            {
+                break;
+            }
+
+            if (uCompressedSize - uIn < 2u)
+            {
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+            const size_t uOffset = static_cast<size_t>(pCompressed[uIn]) | (static_cast<size_t>(pCompressed[uIn + 1u]) << 8u);
+            uIn += 2u;
+            if (uOffset == 0u || uOffset > uOut)
+            {
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+
+            size_t uMatchLength = token & 0xFu;
+            if (uMatchLength == 15u)
+            {
+                BYTE length = 255u;
+                while (length == 255u)
+                {
+                    if (uIn >= uCompressedSize)
+                    {
+                        return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                    }
+                    length = pCompressed[uIn++];
+                    uMatchLength += length;
+                }
+            }
+            uMatchLength += MIN_MATCH;
+
+            if (uMatchLength > uSize - uOut)
+            {
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+
+            // Byte by byte since the match may overlap what it writes
+            for (size_t i = 0u; i < uMatchLength; ++i, ++uOut)
+            {
+                pData[uOut] = pData[uOut - uOffset];
+            }
+        }
+
+        return uOut == uSize ? S_OK : HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorldSave::WorldSave
+
+      Summary:  Constructor. The height map is taken as the baseline
+                of the saves, so it must not be edited yet
+
+      Args:     const HeightMap& heightMap
+                  Height map whose edits are saved. Must outlive the
+                  world save
+                UINT uChunkSize
+                  Number of columns along each side of a chunk
+
+      Modifies: [m_heightMap, m_uChunkSize, m_uBaselineHash,
+                 m_editedChunks, m_aUnrequestedChunks,
+                 m_uNumRequestedChunks, m_bOpening, m_loadFile,
+                 m_saveResult, m_loadResult, m_completedCondition,
+                 m_bOpened, m_aOpenedChunks, m_completedChunks,
+                 m_bCancelled, m_threadPool].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    WorldSave::WorldSave(_In_ const HeightMap& heightMap, _In_ UINT uChunkSize)
+        : m_heightMap(heightMap)
+        , m_uChunkSize(uChunkSize > 0u ? uChunkSize : 1u)
+        , m_uBaselineHash(heightMap.GetSourceHash())
+        , m_editedChunks()
+        , m_aUnrequestedChunks()
+        , m_uNumRequestedChunks(0u)
+        , m_bOpening(FALSE)
+        , m_loadFile()
+        , m_saveResult(S_OK)
+        , m_loadResult(S_OK)
+        , m_completedMutex()
+        , m_completedCondition()
+        , m_bOpened(FALSE)
+        , m_aOpenedChunks()
+        , m_completedChunks()
+        , m_bCancelled(FALSE)
+        , m_threadPool(std::make_unique<ThreadPool>(1u))
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorldSave::~WorldSave
+
+      Summary:  Destructor. Skips the chunks still to be read but
+                finishes the save being written before joining
+
+      Modifies: [m_bCancelled, m_threadPool].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    WorldSave::~WorldSave()
+    {
+        m_bCancelled = TRUE;
+        m_threadPool.reset();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorldSave::OnColumnChanged
+
+      Summary:  Marks the chunk holding a column as edited, so it is
+                written by the next save. A chunk edited back to its
+                generated state is still saved
+
+      Args:     UINT x
+                  Column index along the x axis
+                UINT z
+                  Column index along the z axis
+
+      Modifies: [m_editedChunks].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void WorldSave::OnColumnChanged(_In_ UINT x, _In_ UINT z)
+    {
+        if (x < m_heightMap.GetWidth() && z < m_heightMap.GetDepth())
+        {
+            m_editedChunks.insert(makeKey(x / m_uChunkSize, z / m_uChunkSize));
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorldSave::Save
+
+      Summary:  Copies the runs of the edited chunks, then encodes,
+                compresses and writes them on the background thread.
+                The file is written next to the target and renamed
+                over it once complete, so a failed save keeps the
+                previous one. Must be called on the thread editing the
+                height map
+
+      Args:     const std::filesystem::path& filePath
+                  Path of the world save
+
+      Modifies: [m_saveResult, m_threadPool].
+
+      Returns:  HRESULT
+                  Status code. HRESULT_FROM_WIN32(ERROR_BUSY) if a save
+                  is being written or a load is being applied. The
+                  result of the write is returned by GetSaveResult
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT WorldSave::Save(_In_ const std::filesystem::path& filePath)
+    {
+        if (IsSaving() || IsLoading())
+        {
+            return HRESULT_FROM_WIN32(ERROR_BUSY);
+        }
+
+        std::vector<UINT64> aKeys(m_editedChunks.begin(), m_editedChunks.end());
+        std::sort(aKeys.begin(), aKeys.end());
+
+        std::vector<WorldSaveChunk> aChunks(aKeys.size());
+        for (size_t i = 0u; i < aKeys.size(); ++i)
+        {
+            WorldSaveChunk& chunk = aChunks[i];
+            chunk.uChunkX = static_cast<UINT>(aKeys[i] & 0xFFFFFFFFull);
+            chunk.uChunkZ = static_cast<UINT>(aKeys[i] >> 32u);
+
+            UINT uNumColumnsX = 0u;
+            chunk.aColumns.resize(getChunkColumnCount(chunk.uChunkX, chunk.uChunkZ, uNumColumnsX));
+            for (size_t j = 0u; j < chunk.aColumns.size(); ++j)
+            {
+                m_heightMap.GetColumnRuns(
+                    chunk.uChunkX * m_uChunkSize + static_cast<UINT>(j % uNumColumnsX),
+                    chunk.uChunkZ * m_uChunkSize + static_cast<UINT>(j / uNumColumnsX),
+                    chunk.aColumns[j]
+                );
+            }
+        }
+
+        m_saveResult = E_PENDING;
+        m_threadPool->Enqueue([this, filePath, aChunks = std::move(aChunks)]()
+        {
+            const HRESULT hr = writeChunks(filePath, aChunks);
+            {
+                std::lock_guard<std::mutex> lock(m_completedMutex);
+                m_saveResult = hr;
+            }
+            m_completedCondition.notify_all();
+        });
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorldSave::Load
+
+      Summary:  Starts loading a world save. The chunk table is read on
+                the background thread, the chunks themselves only when
+                Update requests them. The chunks are applied over the
+                current map, so edits made before outside of the saved
+                chunks are kept
+
+      Args:     const std::filesystem::path& filePath
+                  Path of the world save
+
+      Modifies: [m_bOpening, m_loadResult, m_threadPool].
+
+      Returns:  HRESULT
+                  Status code. HRESULT_FROM_WIN32(ERROR_BUSY) if a save
+                  is being written or a load is being applied. The
+                  result of the load is returned by GetLoadResult
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT WorldSave::Load(_In_ const std::filesystem::path& filePath)
+    {
+        if (IsSaving() || IsLoading())
+        {
+            return HRESULT_FROM_WIN32(ERROR_BUSY);
+        }
+
+        m_bOpening = TRUE;
+        m_loadResult = E_PENDING;
+        m_threadPool->Enqueue([this, filePath]()
+        {
+            openFile(filePath);
+        });
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorldSave::Update
+
+      Summary:  Returns the chunks read since the last call and requests
+                the saved chunks nearest to the eye, keeping at most
+                MAX_PENDING_CHUNKS in flight so the loading follows the
+                camera. Never waits for the background thread
+
+      Args:     INT eyeX
+                  Column of the eye along the x axis
+                INT eyeZ
+                  Column of the eye along the z axis
+                UINT uMaxChunks
+                  Maximum number of chunks to return
+                std::vector<WorldSaveChunk>& aOutChunks
+                  Chunks to apply to the height map
+
+      Modifies: [m_aUnrequestedChunks, m_uNumRequestedChunks,
+                 m_bOpening, m_loadFile, m_loadResult, m_bOpened,
+                 m_aOpenedChunks, m_completedChunks, m_threadPool].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void WorldSave::Update(_In_ INT eyeX, _In_ INT eyeZ, _In_ UINT uMaxChunks, _Out_ std::vector<WorldSaveChunk>& aOutChunks)
+    {
+        aOutChunks.clear();
+        if (!IsLoading())
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_completedMutex);
+
+            if (m_bOpened)
+            {
+                m_aUnrequestedChunks = std::move(m_aOpenedChunks);
+                m_aOpenedChunks.clear();
+                m_bOpened = FALSE;
+                m_bOpening = FALSE;
+            }
+
+            const size_t uNumTaken = m_completedChunks.size() < uMaxChunks ? m_completedChunks.size() : uMaxChunks;
+            for (size_t i = 0u; i < uNumTaken; ++i)
+            {
+                if (!m_completedChunks[i].aColumns.empty())
+                {
+                    aOutChunks.push_back(std::move(m_completedChunks[i]));
+                }
+            }
+            m_completedChunks.erase(m_completedChunks.begin(), m_completedChunks.begin() + static_cast<ptrdiff_t>(uNumTaken));
+            m_uNumRequestedChunks -= static_cast<UINT>(uNumTaken);
+        }
+
+        while (m_uNumRequestedChunks < MAX_PENDING_CHUNKS && !m_aUnrequestedChunks.empty())
+        {
+            size_t uNearestIdx = 0u;
+            INT64 iNearestDistance = INT64_MAX;
+            for (size_t i = 0u; i < m_aUnrequestedChunks.size(); ++i)
+            {
+                const INT64 iDeltaX = static_cast<INT64>(m_aUnrequestedChunks[i].uChunkX * m_uChunkSize + m_uChunkSize / 2u) - eyeX;
+                const INT64 iDeltaZ = static_cast<INT64>(m_aUnrequestedChunks[i].uChunkZ * m_uChunkSize + m_uChunkSize / 2u) - eyeZ;
+                const INT64 iDistance = iDeltaX * iDeltaX + iDeltaZ * iDeltaZ;
+                if (iDistance < iNearestDistance)
+                {
+                    iNearestDistance = iDistance;
+                    uNearestIdx = i;
+                }
+            }
+
+            const WorldSaveChunkEntry entry = m_aUnrequestedChunks[uNearestIdx];
+            m_aUnrequestedChunks[uNearestIdx] = m_aUnrequestedChunks.back();
+            m_aUnrequestedChunks.pop_back();
+
+            ++m_uNumRequestedChunks;
+            m_threadPool->Enqueue([this, entry]()
+            {
+                readChunk(entry);
+            });
+        }
+
+        if (!IsLoading())
+        {
+            // Closed on the background thread, behind the last read
+            m_threadPool->Enqueue([this]()
+            {
+                m_loadFile.close();
+            });
+
+            HRESULT expected = E_PENDING;
+            m_loadResult.compare_exchange_strong(expected, S_OK);
+        }
+    }
+
+    HRESULT WorldSave::GetSaveResult() const
+    {
+        return m_saveResult;
+    }
+
+    HRESULT WorldSave::GetLoadResult() const
+    {
+        return m_loadResult;
+    }
+
+    BOOL WorldSave::IsSaving() const
+    {
+        return m_saveResult == E_PENDING;
+    }
+
+    BOOL WorldSave::IsLoading() const
+    {
+        return m_bOpening || !m_aUnrequestedChunks.empty() || m_uNumRequestedChunks > 0u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorldSave::WaitForChunks
+
+      Summary:  Blocks until the background thread has read the chunk
+                table or chunks that Update has not returned yet, for
+                a caller that must finish a load such as on shutdown.
+                Must be called after Update, which keeps reads in
+                flight while the load is not done. Returns at once if
+                no load is in progress
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void WorldSave::WaitForChunks()
+    {
+        if (!IsLoading())
+        {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(m_completedMutex);
+        m_completedCondition.wait(lock, [this]() { return m_bOpened || !m_completedChunks.empty(); });
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorldSave::WaitForSave
+
+      Summary:  Blocks until the save being written by the background
+                thread is done. Returns at once if none is
+
+      Returns:  HRESULT
+                  Result of the last save, as GetSaveResult
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT WorldSave::WaitForSave()
+    {
+        std::unique_lock<std::mutex> lock(m_completedMutex);
+        m_completedCondition.wait(lock, [this]() { return m_saveResult != E_PENDING; });
+
+        return m_saveResult;
+    }
+
+    UINT WorldSave::GetChunkSize() const
+    {
+        return m_uChunkSize;
+    }
+
+    size_t WorldSave::GetNumEditedChunks() const
+    {
+        return m_editedChunks.size();
+    }
+
+    UINT64 WorldSave::makeKey(_In_ UINT uChunkX, _In_ UINT uChunkZ)
+    {
+        return (static_cast<UINT64>(uChunkZ) << 32u) | static_cast<UINT64>(uChunkX);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorldSave::encodeChunk
+
+      Summary:  Writes the runs of the columns of a chunk, a WORD number
+                of runs per column followed by its runs
+
+      Args:     const WorldSaveChunk& chunk
+                  Chunk to encode
+                std::vector<BYTE>& aOutData
+                  Encoded chunk
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void WorldSave::encodeChunk(_In_ const WorldSaveChunk& chunk, _Out_ std::vector<BYTE>& aOutData) const
+    {
+        aOutData.clear();
+        for (const std::vector<ColumnRun>& aRuns : chunk.aColumns)
+        {
+            const WORD uNumRuns = static_cast<WORD>(aRuns.size());
+            aOutData.insert(aOutData.end(), reinterpret_cast<const BYTE*>(&uNumRuns), reinterpret_cast<const BYTE*>(&uNumRuns) + sizeof(uNumRuns));
+            for (const ColumnRun& run : aRuns)
+            {
+                aOutData.insert(aOutData.end(), reinterpret_cast<const BYTE*>(&run.uEndBlock), reinterpret_cast<const BYTE*>(&run.uEndBlock) + sizeof(run.uEndBlock));
+                aOutData.push_back(run.type);
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorldSave::decodeChunk
+
+      Summary:  Reads the runs of the columns of a chunk. The runs must
+                grow, be made of palette entries and fill the data
+                exactly
+
+      Args:     const std::vector<BYTE>& aData
+                  Encoded chunk
+                WorldSaveChunk& chunk
+                  Chunk whose columns are read. uChunkX and uChunkZ
+                  must be set
+
+      Modifies: [chunk].
+
+      Returns:  HRESULT
+                  Status code. HRESULT_FROM_WIN32(ERROR_INVALID_DATA)
+                  if the data is not a valid chunk
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT WorldSave::decodeChunk(_In_ const std::vector<BYTE>& aData, _Inout_ WorldSaveChunk& chunk) const
+    {
+        UINT uNumColumnsX = 0u;
+        chunk.aColumns.resize(getChunkColumnCount(chunk.uChunkX, chunk.uChunkZ, uNumColumnsX));
+
+        size_t uOffset = 0u;
+        for (std::vector<ColumnRun>& aRuns : chunk.aColumns)
+        {
+            WORD uNumRuns = 0u;
+            if (aData.size() - uOffset < sizeof(uNumRuns))
+            {
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+            memcpy(&uNumRuns, aData.data() + uOffset, sizeof(uNumRuns));
+            uOffset += sizeof(uNumRuns);
+
+            if ((aData.size() - uOffset) / (sizeof(WORD) + sizeof(BYTE)) < uNumRuns)
+            {
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+
+            aRuns.resize(uNumRuns);
+            UINT uFirstBlock = 0u;
+            for (ColumnRun& run : aRuns)
+            {
+                memcpy(&run.uEndBlock, aData.data() + uOffset, sizeof(run.uEndBlock));
+                run.type = aData[uOffset + sizeof(run.uEndBlock)];
+                uOffset += sizeof(WORD) + sizeof(BYTE);
+
+                if (run.uEndBlock <= uFirstBlock || run.type >= m_heightMap.GetNumColors())
+                {
+                    return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                }
+                uFirstBlock = run.uEndBlock;
+            }
+        }
+
+        return uOffset == aData.size() ? S_OK : HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorldSave::getChunkColumnCount
+
+      Summary:  Returns the number of columns of a chunk inside of the
+                map. Chunks on the far edges may be cut
+
+      Args:     UINT uChunkX
+                  Chunk index along the x axis
+                UINT uChunkZ
+                  Chunk index along the z axis
+                UINT& uOutNumColumnsX
+                  Number of columns of the chunk along the x axis
+
+      Returns:  UINT
+                  Number of columns of the chunk
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT WorldSave::getChunkColumnCount(_In_ UINT uChunkX, _In_ UINT uChunkZ, _Out_ UINT& uOutNumColumnsX) const
+    {
+        const UINT uBeginX = uChunkX * m_uChunkSize;
+        const UINT uBeginZ = uChunkZ * m_uChunkSize;
+        const UINT uEndX = uBeginX + m_uChunkSize < m_heightMap.GetWidth() ? uBeginX + m_uChunkSize : m_heightMap.GetWidth();
+        const UINT uEndZ = uBeginZ + m_uChunkSize < m_heightMap.GetDepth() ? uBeginZ + m_uChunkSize : m_heightMap.GetDepth();
+
+        uOutNumColumnsX = uEndX > uBeginX ? uEndX - uBeginX : 0u;
+        return uEndZ > uBeginZ ? uOutNumColumnsX * (uEndZ - uBeginZ) : 0u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorldSave::writeChunks
+
+      Summary:  Encodes, compresses and writes chunks to a temporary
+                file, then renames it over the world save. Runs on the
+                background thread
+
+      Args:     const std::filesystem::path& filePath
+                  Path of the world save
+                const std::vector<WorldSaveChunk>& aChunks
+                  Chunks to write
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT WorldSave::writeChunks(_In_ const std::filesystem::path& filePath, _In_ const std::vector<WorldSaveChunk>& aChunks) const
+    {
+        WorldSaveHeader header =
+        {
+            .aMagic = { MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3] },
+            .uVersion = VERSION,
+            .uWidth = m_heightMap.GetWidth(),
+            .uHeight = m_heightMap.GetHeight(),
+            .uDepth = m_heightMap.GetDepth(),
+            .uNumColors = m_heightMap.GetNumColors(),
+            .uChunkSize = m_uChunkSize,
+            .uNumChunks = static_cast<UINT>(aChunks.size()),
+            .uBaselineHash = m_uBaselineHash
+        };
+
+        std::vector<WorldSaveChunkEntry> aEntries(aChunks.size());
+        std::vector<std::vector<BYTE>> aCompressedChunks(aChunks.size());
+        UINT64 uOffset = sizeof(WorldSaveHeader) + sizeof(WorldSaveChunkEntry) * aEntries.size();
+        std::vector<BYTE> aData;
+        for (size_t i = 0u; i < aChunks.size(); ++i)
+        {
+            encodeChunk(aChunks[i], aData);
+            Compress(aData.data(), aData.size(), aCompressedChunks[i]);
+
+            aEntries[i] = WorldSaveChunkEntry
+            {
+                .uChunkX = aChunks[i].uChunkX,
+                .uChunkZ = aChunks[i].uChunkZ,
+                .uOffset = uOffset,
+                .uCompressedSize = static_cast<UINT>(aCompressedChunks[i].size()),
+                .uRawSize = static_cast<UINT>(aData.size())
+            };
+            uOffset += aCompressedChunks[i].size();
+        }
+
+        std::filesystem::path tempFilePath = filePath;
+        tempFilePath += L".tmp";
+        {
+            std::ofstream outputFile(tempFilePath, std::ios::binary | std::ios::trunc);
+            if (!outputFile.is_open())
+            {
+                return E_FAIL;
+            }
+
+            outputFile.write(reinterpret_cast<const CHAR*>(&header), sizeof(header));
+            if (!aEntries.empty())
+            {
+                outputFile.write(reinterpret_cast<const CHAR*>(aEntries.data()), static_cast<std::streamsize>(sizeof(WorldSaveChunkEntry) * aEntries.size()));
+            }
+            for (const std::vector<BYTE>& aCompressed : aCompressedChunks)
+            {
+                outputFile.write(reinterpret_cast<const CHAR*>(aCompressed.data()), static_cast<std::streamsize>(aCompressed.size()));
+            }
+
+            if (!outputFile.good())
+            {
+                return E_FAIL;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(tempFilePath, filePath, error);
+        if (error)
+        {
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorldSave::openFile
+
+      Summary:  Opens a world save and reads its chunk table. The save
+                must come from the same generated map. Runs on the
+                background thread. A file that is not a world save of
+                this map fails the load with
+                HRESULT_FROM_WIN32(ERROR_INVALID_DATA), as does a chunk
+                entry whose data lies past the end of the file or whose
+                raw size is larger than the most runs its columns can
+                hold, so readChunk never allocates more than the file
+                can describe
+
+      Args:     const std::filesystem::path& filePath
+                  Path of the world save
+
+      Modifies: [m_loadFile, m_loadResult, m_bOpened,
+                 m_aOpenedChunks].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void WorldSave::openFile(_In_ const std::filesystem::path& filePath)
+    {
+        std::vector<WorldSaveChunkEntry> aEntries;
+        HRESULT hr = S_OK;
+
+        m_loadFile.open(filePath, std::ios::binary);
+        if (!m_loadFile.is_open())
+        {
+            hr = HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+        }
+
+        UINT64 uFileSize = 0u;
+        WorldSaveHeader header = {};
+        if (SUCCEEDED(hr))
+        {
+            m_loadFile.seekg(0, std::ios::end);
+            uFileSize = static_cast<UINT64>(m_loadFile.tellg());
+            m_loadFile.seekg(0, std::ios::beg);
+
+            m_loadFile.read(reinterpret_cast<CHAR*>(&header), sizeof(header));
+            if (!m_loadFile.good()
+                || memcmp(header.aMagic, MAGIC, sizeof(MAGIC)) != 0
+                || header.uVersion != VERSION
+                || header.uWidth != m_heightMap.GetWidth()
+                || header.uHeight != m_heightMap.GetHeight()
+                || header.uDepth != m_heightMap.GetDepth()
+                || header.uNumColors != m_heightMap.GetNumColors()
+                || header.uChunkSize != m_uChunkSize
+                || (header.uBaselineHash != 0u && m_uBaselineHash != 0u && header.uBaselineHash != m_uBaselineHash))
+            {
+                hr = HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+        }
+
+        if (SUCCEEDED(hr))
+        {
+            const UINT uNumChunksX = (m_heightMap.GetWidth() + m_uChunkSize - 1u) / m_uChunkSize;
+            const UINT uNumChunksZ = (m_heightMap.GetDepth() + m_uChunkSize - 1u) / m_uChunkSize;
+            if (static_cast<UINT64>(header.uNumChunks) > static_cast<UINT64>(uNumChunksX) * static_cast<UINT64>(uNumChunksZ))
+            {
+                hr = HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            }
+            else
+            {
+                aEntries.resize(header.uNumChunks);
+                if (!aEntries.empty())
+                {
+                    m_loadFile.read(reinterpret_cast<CHAR*>(aEntries.data()), static_cast<std::streamsize>(sizeof(WorldSaveChunkEntry) * aEntries.size()));
+                }
+                if (!m_loadFile.good())
+                {
+                    hr = HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                }
+                for (const WorldSaveChunkEntry& entry : aEntries)
+                {
+                    if (entry.uChunkX >= uNumChunksX || entry.uChunkZ >= uNumChunksZ
+                        || entry.uOffset > uFileSize || entry.uCompressedSize > uFileSize - entry.uOffset)
+                    {
+                        hr = HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                        break;
+                    }
+
+                    // Every column holds a run count and at most 0xFFFF
+                    // runs of an end block and a palette entry
+                    UINT uNumColumnsX = 0u;
+                    const UINT64 uMaxRawSize = static_cast<UINT64>(getChunkColumnCount(entry.uChunkX, entry.uChunkZ, uNumColumnsX))
+                        * (sizeof(WORD) + 0xFFFFull * (sizeof(WORD) + sizeof(BYTE)));
+                    if (entry.uRawSize > uMaxRawSize)
+                    {
+                        hr = HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (FAILED(hr))
+        {
+            aEntries.clear();
+            m_loadFile.close();
+            m_loadResult = hr;
+        }
+
+        std::lock_guard<std::mutex> lock(m_completedMutex);
+        m_aOpenedChunks = std::move(aEntries);
+        m_bOpened = TRUE;
+        m_completedCondition.notify_all();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorldSave::readChunk
+
+      Summary:  Reads, decompresses and decodes a chunk of the opened
+                world save. A chunk that fails is handed back without
+                columns and the load reports the error. Runs on the
+                background thread
+
+      Args:     const WorldSaveChunkEntry& entry
+                  Chunk to read
+
+      Modifies: [m_loadFile, m_loadResult, m_completedChunks].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void WorldSave::readChunk(_In_ const WorldSaveChunkEntry& entry)
+    {
+        WorldSaveChunk chunk =
+        {
+            .uChunkX = entry.uChunkX,
+            .uChunkZ = entry.uChunkZ,
+            .aColumns = {}
+        };
+
+        if (!m_bCancelled)
+        {
+            std::vector<BYTE> aCompressed(entry.uCompressedSize);
+            std::vector<BYTE> aData(entry.uRawSize);
+            m_loadFile.clear();
+            m_loadFile.seekg(static_cast<std::streamoff>(entry.uOffset));
+            m_loadFile.read(reinterpret_cast<CHAR*>(aCompressed.data()), static_cast<std::streamsize>(aCompressed.size()));
+
+            HRESULT hr = m_loadFile.good() ? S_OK : HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            if (SUCCEEDED(hr))
+            {
+                hr = Decompress(aCompressed.data(), aCompressed.size(), aData.data(), aData.size());
+            }
+            if (SUCCEEDED(hr))
+            {
+                hr = decodeChunk(aData, chunk);
+            }
+            if (FAILED(hr))
+            {
+                chunk.aColumns.clear();
+                m_loadResult = hr;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_completedMutex);
+        m_completedChunks.push_back(std::move(chunk));
+        m_completedCondition.notify_all();
+    }
+}
@@ -0,0 +1,235 @@
+/*+===================================================================
+  File:      WORLDSAVE.H
+
+  Summary:   WorldSave header file contains declarations of WorldSave
+             class used for the lab samples of Game Graphics
+             Programming course.
+
+  Classes: WorldSave
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+
+#include "Scene/HeightMap.h"
+#include "Thread/ThreadPool.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   WorldSaveHeader
+
+      Summary:  Header of the world save file. It is followed by
+                uNumChunks WorldSaveChunkEntry and the compressed
+                chunks. The save only applies to the height map it
+                was made from: same size, same palette size and, when
+                known, same source hash
+
+                aMagic
+                  WorldSave::MAGIC
+                uVersion
+                  WorldSave::VERSION
+                uWidth
+                  Number of columns of the map along the x axis
+                uHeight
+                  Vertical scale of the map
+                uDepth
+                  Number of columns of the map along the z axis
+                uNumColors
+                  Number of palette entries of the map
+                uChunkSize
+                  Number of columns along each side of a chunk
+                uNumChunks
+                  Number of saved chunks
+                uBaselineHash
+                  Source hash of the map before any edit, 0 if unknown
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct WorldSaveHeader
+    {
+        CHAR aMagic[4];
+        UINT uVersion;
+        UINT uWidth;
+        UINT uHeight;
+        UINT uDepth;
+        UINT uNumColors;
+        UINT uChunkSize;
+        UINT uNumChunks;
+        UINT64 uBaselineHash;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   WorldSaveChunkEntry
+
+      Summary:  Location of a saved chunk in the file. The chunk holds
+                for every column, row major, a WORD number of runs and
+                the runs as a WORD end block and a BYTE type each,
+                compressed in the LZ4 block format
+
+                uChunkX
+                  Chunk index along the x axis
+                uChunkZ
+                  Chunk index along the z axis
+                uOffset
+                  Offset of the compressed chunk from the file start
+                uCompressedSize
+                  Bytes of the compressed chunk
+                uRawSize
+                  Bytes of the chunk once decompressed
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct WorldSaveChunkEntry
+    {
+        UINT uChunkX;
+        UINT uChunkZ;
+        UINT64 uOffset;
+        UINT uCompressedSize;
+        UINT uRawSize;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   WorldSaveChunk
+
+      Summary:  Columns of a saved chunk
+
+                uChunkX
+                  Chunk index along the x axis
+                uChunkZ
+                  Chunk index along the z axis
+                aColumns
+                  Runs of every column of the chunk inside of the map,
+                  row major
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct WorldSaveChunk
+    {
+        UINT uChunkX;
+        UINT uChunkZ;
+        std::vector<std::vector<ColumnRun>> aColumns;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    WorldSave
+
+      Summary:  Saves and loads the edits of a height map. Only the
+                chunks whose columns were edited since the map was
+                generated are saved, as the runs of their columns
+                compressed in the LZ4 block format. The chunks are
+                snapshotted on the calling thread, then compressed and
+                written by a background thread. Loading reads the chunk
+                table on the background thread, then decompresses the
+                chunks nearest to the camera a few at a time, and hands
+                them back to be applied on the main thread
+
+      Methods:  Compress
+                  Compresses bytes in the LZ4 block format
+                Decompress
+                  Decompresses bytes of the LZ4 block format
+                OnColumnChanged
+                  Marks the chunk holding a column as edited
+                Save
+                  Starts writing the edited chunks to a file
+                Load
+                  Starts reading the chunks of a file
+                Update
+                  Requests the nearest saved chunks and returns the
+                  ones read
+                GetSaveResult
+                  Returns the status of the last save
+                GetLoadResult
+                  Returns the status of the last load
+                IsSaving
+                  Returns whether a save is being written
+                IsLoading
+                  Returns whether chunks of a load are left to apply
+                WaitForChunks
+                  Blocks until the background thread hands back
+                  chunks of the load
+                WaitForSave
+                  Blocks until the save being written is done
+                GetChunkSize
+                  Returns the number of columns along each side of a
+                  chunk
+                GetNumEditedChunks
+                  Returns the number of chunks that would be saved
+                WorldSave
+                  Constructor.
+                ~WorldSave
+                  Destructor. Finishes the save being written
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class WorldSave
+    {
+    public:
+        static constexpr const CHAR MAGIC[4] = { 'V', 'X', 'W', 'S' };
+        static constexpr const UINT VERSION = 1u;
+        static constexpr const UINT MAX_PENDING_CHUNKS = 4u;
+
+        static void Compress(_In_reads_bytes_(uSize) const BYTE* pData, _In_ size_t uSize, _Out_ std::vector<BYTE>& aOutCompressed);
+        static HRESULT Decompress(
+            _In_reads_bytes_(uCompressedSize) const BYTE* pCompressed,
+            _In_ size_t uCompressedSize,
+            _Out_writes_bytes_(uSize) BYTE* pData,
+            _In_ size_t uSize
+        );
+
+        WorldSave(_In_ const HeightMap& heightMap, _In_ UINT uChunkSize);
+        WorldSave(const WorldSave& other) = delete;
+        WorldSave(WorldSave&& other) = delete;
+        WorldSave& operator=(const WorldSave& other) = delete;
+        WorldSave& operator=(WorldSave&& other) = delete;
+        ~WorldSave();
+
+        void OnColumnChanged(_In_ UINT x, _In_ UINT z);
+        HRESULT Save(_In_ const std::filesystem::path& filePath);
+        HRESULT Load(_In_ const std::filesystem::path& filePath);
+        void Update(_In_ INT eyeX, _In_ INT eyeZ, _In_ UINT uMaxChunks, _Out_ std::vector<WorldSaveChunk>& aOutChunks);
+
+        HRESULT GetSaveResult() const;
+        HRESULT GetLoadResult() const;
+        BOOL IsSaving() const;
+        BOOL IsLoading() const;
+        void WaitForChunks();
+        HRESULT WaitForSave();
+        UINT GetChunkSize() const;
+        size_t GetNumEditedChunks() const;
+
+    private:
+        static UINT64 makeKey(_In_ UINT uChunkX, _In_ UINT uChunkZ);
+
+        void encodeChunk(_In_ const WorldSaveChunk& chunk, _Out_ std::vector<BYTE>& aOutData) const;
+        HRESULT decodeChunk(_In_ const std::vector<BYTE>& aData, _Inout_ WorldSaveChunk& chunk) const;
+        UINT getChunkColumnCount(_In_ UINT uChunkX, _In_ UINT uChunkZ, _Out_ UINT& uOutNumColumnsX) const;
+        HRESULT writeChunks(_In_ const std::filesystem::path& filePath, _In_ const std::vector<WorldSaveChunk>& aChunks) const;
+        void openFile(_In_ const std::filesystem::path& filePath);
+        void readChunk(_In_ const WorldSaveChunkEntry& entry);
+
+    private:
+        static constexpr const UINT MIN_MATCH = 4u;
+        static constexpr const UINT LAST_LITERALS = 5u;
+        static constexpr const UINT MATCH_SAFE_DISTANCE = 12u;
+        static constexpr const UINT MAX_OFFSET = 0xFFFFu;
+        static constexpr const UINT HASH_BITS = 12u;
+
+        const HeightMap& m_heightMap;
+        UINT m_uChunkSize;
+        UINT64 m_uBaselineHash;
+        std::unordered_set<UINT64> m_editedChunks;
+        std::vector<WorldSaveChunkEntry> m_aUnrequestedChunks;
+        UINT m_uNumRequestedChunks;
+        BOOL m_bOpening;
+        std::ifstream m_loadFile;
+        std::atomic<HRESULT> m_saveResult;
+        std::atomic<HRESULT> m_loadResult;
+        std::mutex m_completedMutex;
+        std::condition_variable m_completedCondition;
+        BOOL m_bOpened;
+        std::vector<WorldSaveChunkEntry> m_aOpenedChunks;
+        std::vector<WorldSaveChunk> m_completedChunks;
+        std::atomic<BOOL> m_bCancelled;
+        std::unique_ptr<ThreadPool> m_threadPool;
+    };
+}
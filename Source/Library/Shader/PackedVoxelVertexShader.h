@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Common.h"
+
+#include "Shader/VertexShader.h"
+
+namespace library
+{
+    class PackedVoxelVertexShader : public VertexShader
+    {
+    public:
+        PackedVoxelVertexShader() = delete;
+        PackedVoxelVertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel);
+        PackedVoxelVertexShader(const PackedVoxelVertexShader& other) = delete;
+        PackedVoxelVertexShader(PackedVoxelVertexShader&& other) = delete;
+        PackedVoxelVertexShader& operator=(const PackedVoxelVertexShader& other) = delete;
+        PackedVoxelVertexShader& operator=(PackedVoxelVertexShader&& other) = delete;
+        virtual ~PackedVoxelVertexShader() = default;
+
+        virtual HRESULT Initialize(_In_ ID3D11Device* pDevice) override;
+    };
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Common.h"
+
+#include "Shader/VertexShader.h"
+
+namespace library
+{
+    class VoxelMeshVertexShader : public VertexShader
+    {
+    public:
+        VoxelMeshVertexShader() = delete;
+        VoxelMeshVertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel);
+        VoxelMeshVertexShader(const VoxelMeshVertexShader& other) = delete;
+        VoxelMeshVertexShader(VoxelMeshVertexShader&& other) = delete;
+        VoxelMeshVertexShader& operator=(const VoxelMeshVertexShader& other) = delete;
+        VoxelMeshVertexShader& operator=(VoxelMeshVertexShader&& other) = delete;
+        virtual ~VoxelMeshVertexShader() = default;
+
+        virtual HRESULT Initialize(_In_ ID3D11Device* pDevice) override;
+    };
+}
@@ -6,6 +6,56 @@ namespace library
 {
     ComPtr<ID3D11SamplerState> Texture::s_samplers[static_cast<size_t>(eTextureSamplerType::COUNT)];
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GetBitsPerPixel
+
+      Summary:  Returns the bits per pixel of the formats produced by
+                the texture loaders. Block compressed formats are
+                averaged over their 4x4 blocks
+
+      Args:     DXGI_FORMAT format
+                  Texture format
+
+      Returns:  UINT
+                  Bits per pixel
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT GetBitsPerPixel(_In_ DXGI_FORMAT format)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+            return 128u;
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        case DXGI_FORMAT_R16G16B16A16_UNORM:
+            return 64u;
+        case DXGI_FORMAT_R8_UNORM:
+        case DXGI_FORMAT_A8_UNORM:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            return 8u;
+        case DXGI_FORMAT_R16_UNORM:
+        case DXGI_FORMAT_R16_FLOAT:
+        case DXGI_FORMAT_B5G6R5_UNORM:
+        case DXGI_FORMAT_B5G5R5A1_UNORM:
+            return 16u;
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+            return 4u;
+        default:
+            return 32u;
+        }
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Texture::Texture
 
@@ -14,27 +64,39 @@ namespace library
       Args:     const std::filesystem::path& textureFilePath
                   Path to the texture to use
 
-      Modifies: [m_filePath, m_textureRV, m_samplerLinear].
+      Modifies: [m_filePath, m_textureRV, m_loadCommandList,
+                 m_textureSamplerType, m_loadState, m_loadResult,
+                 m_uSizeInBytes].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     Texture::Texture(_In_ const std::filesystem::path& filePath, _In_opt_ eTextureSamplerType textureSamplerType) :
         m_filePath(filePath),
         m_textureRV(),
-        m_textureSamplerType(textureSamplerType)
+        m_loadCommandList(),
+        m_textureSamplerType(textureSamplerType),
+        m_loadState(eTextureLoadState::UNLOADED),
+        m_loadResult(S_OK),
+        m_uSizeInBytes(0u)
     {}
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Texture::Initialize
 
-      Summary:  Initializes the texture
+      Summary:  Initializes the texture. A texture that is already
+                loaded or queued to the texture loader is left as is
 
       Args:     ID3D11Device* pDevice
                   The Direct3D device to create the buffers
                 ID3D11DeviceContext* pImmediateContext
                   The Direct3D context to set buffers
 
-      Modifies: [m_textureRV, m_samplerLinear].
+      Modifies: [m_textureRV, m_loadState, m_loadResult, m_uSizeInBytes].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     HRESULT Texture::Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext) {
+        if (m_loadState != eTextureLoadState::UNLOADED)
+        {
+            return initializeSamplers(pDevice);
+        }
+
         HRESULT hr = CreateWICTextureFromFile(pDevice, pImmediateContext, m_filePath.c_str(), nullptr, m_textureRV.GetAddressOf());
         if (FAILED(hr))
         {
@@ -48,6 +110,202 @@ namespace library
             }
         }
 
+        m_loadState = eTextureLoadState::LOADED;
+        m_loadResult = hr;
+        updateSizeInBytes();
+
+        return initializeSamplers(pDevice);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::BeginLoading
+
+      Summary:  Marks the texture as loading and creates the samplers.
+                Called on the render thread before Load is queued
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the samplers
+
+      Modifies: [m_loadState].
+
+      Returns:  HRESULT
+                  Status code. S_FALSE if the texture was already
+                  loaded or queued
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Texture::BeginLoading(_In_ ID3D11Device* pDevice)
+    {
+        HRESULT hr = initializeSamplers(pDevice);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        if (m_loadState != eTextureLoadState::UNLOADED)
+        {
+            return S_FALSE;
+        }
+
+        m_loadState = eTextureLoadState::LOADING;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::Load
+
+      Summary:  Decodes the file and creates the texture. Safe to call
+                on a worker thread: the mip generation is recorded on a
+                deferred context and replayed by EndLoading
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the texture
+
+      Modifies: [m_textureRV, m_loadCommandList, m_loadResult].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Texture::Load(_In_ ID3D11Device* pDevice)
+    {
+        ComPtr<ID3D11DeviceContext> deferredContext;
+        HRESULT hr = pDevice->CreateDeferredContext(0u, deferredContext.GetAddressOf());
+        if (SUCCEEDED(hr))
+        {
+            hr = CreateWICTextureFromFile(pDevice, deferredContext.Get(), m_filePath.c_str(), nullptr, m_textureRV.GetAddressOf());
+            if (SUCCEEDED(hr))
+            {
+                hr = deferredContext->FinishCommandList(FALSE, m_loadCommandList.GetAddressOf());
+            }
+        }
+
+        if (FAILED(hr))
+        {
+            m_textureRV.Reset();
+            hr = CreateDDSTextureFromFile(pDevice, m_filePath.c_str(), nullptr, m_textureRV.GetAddressOf());
+            if (FAILED(hr))
+            {
+                OutputDebugString(L"Can't load texture from \"");
+                OutputDebugString(m_filePath.c_str());
+                OutputDebugString(L"\n");
+            }
+        }
+
+        m_loadResult = hr;
+
+        return hr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::EndLoading
+
+      Summary:  Replays the upload recorded by Load and makes the
+                texture available to the renderer. Called on the render
+                thread
+
+      Args:     ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to execute the upload
+
+      Modifies: [m_textureRV, m_loadCommandList, m_loadState,
+                 m_uSizeInBytes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Texture::EndLoading(_In_ ID3D11DeviceContext* pImmediateContext)
+    {
+        if (FAILED(m_loadResult))
+        {
+            m_textureRV.Reset();
+            m_loadCommandList.Reset();
+            m_loadState = eTextureLoadState::FAILED;
+            return;
+        }
+
+        if (m_loadCommandList)
+        {
+            pImmediateContext->ExecuteCommandList(m_loadCommandList.Get(), TRUE);
+            m_loadCommandList.Reset();
+        }
+
+        m_loadState = eTextureLoadState::LOADED;
+        updateSizeInBytes();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::Unload
+
+      Summary:  Releases the texture resource of a loaded texture. The
+                texture goes back to the UNLOADED state and can be
+                loaded again
+
+      Modifies: [m_textureRV, m_loadState, m_uSizeInBytes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Texture::Unload()
+    {
+        if (m_loadState != eTextureLoadState::LOADED)
+        {
+            return;
+        }
+
+        m_textureRV.Reset();
+        m_loadState = eTextureLoadState::UNLOADED;
+        m_uSizeInBytes = 0u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::updateSizeInBytes
+
+      Summary:  Estimates the video memory used by the texture from
+                the description of its resource, mip chain included
+
+      Modifies: [m_uSizeInBytes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Texture::updateSizeInBytes()
+    {
+        m_uSizeInBytes = 0u;
+        if (!m_textureRV)
+        {
+            return;
+        }
+
+        ComPtr<ID3D11Resource> resource;
+        m_textureRV->GetResource(resource.GetAddressOf());
+
+        ComPtr<ID3D11Texture2D> texture2D;
+        if (FAILED(resource.As(&texture2D)))
+        {
+            return;
+        }
+
+        D3D11_TEXTURE2D_DESC desc = {};
+        texture2D->GetDesc(&desc);
+
+        const UINT64 uBitsPerPixel = GetBitsPerPixel(desc.Format);
+        UINT64 uNumPixels = 0u;
+        for (UINT uMip = 0u; uMip < desc.MipLevels; ++uMip)
+        {
+            const UINT64 uWidth = (desc.Width >> uMip) > 0u ? (desc.Width >> uMip) : 1u;
+            const UINT64 uHeight = (desc.Height >> uMip) > 0u ? (desc.Height >> uMip) : 1u;
+            uNumPixels += uWidth * uHeight;
+        }
+
+        m_uSizeInBytes = uNumPixels * desc.ArraySize * uBitsPerPixel / 8u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::initializeSamplers
+
+      Summary:  Creates the shared sampler states if missing
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the samplers
+
+      Modifies: [s_samplers].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Texture::initializeSamplers(_In_ ID3D11Device* pDevice)
+    {
+        HRESULT hr = S_OK;
+
         // Create the sample state
         if (!s_samplers[static_cast<size_t>(eTextureSamplerType::TRILINEAR_WRAP)].Get())
         {
@@ -86,11 +344,8 @@ namespace library
         }
 
         return hr;
-
     }
 
-
-
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Texture::GetTextureResourceView
 
@@ -116,4 +371,44 @@ namespace library
     {
         return m_textureSamplerType;
     }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::GetLoadState
+
+      Summary:  Returns the load state
+
+      Returns:  eTextureLoadState
+                  Load state
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    eTextureLoadState Texture::GetLoadState() const
+    {
+        return m_loadState;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::GetSizeInBytes
+
+      Summary:  Returns the estimated GPU memory of the loaded texture,
+                0 while it is not loaded
+
+      Returns:  UINT64
+                  Size of the texture in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 Texture::GetSizeInBytes() const
+    {
+        return m_uSizeInBytes;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::GetFilePath
+
+      Summary:  Returns the path of the texture file
+
+      Returns:  const std::filesystem::path&
+                  Texture file path
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::filesystem::path& Texture::GetFilePath() const
+    {
+        return m_filePath;
+    }
 }
\ No newline at end of file
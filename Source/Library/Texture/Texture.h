@@ -21,6 +21,14 @@ namespace library
         COUNT,
     };
 
+    enum class eTextureLoadState : size_t
+    {
+        UNLOADED = 0,
+        LOADING,
+        LOADED,
+        FAILED,
+    };
+
     class Texture
     {
     public:
@@ -35,15 +43,32 @@ namespace library
         // Should be called once to load the texture
         virtual HRESULT Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext);
 
+        // Asynchronous loading, see TextureLoader
+        HRESULT BeginLoading(_In_ ID3D11Device* pDevice);
+        HRESULT Load(_In_ ID3D11Device* pDevice);
+        void EndLoading(_In_ ID3D11DeviceContext* pImmediateContext);
+        void Unload();
+
         ComPtr<ID3D11ShaderResourceView>& GetTextureResourceView();
         eTextureSamplerType GetSamplerType() const;
+        eTextureLoadState GetLoadState() const;
+        UINT64 GetSizeInBytes() const;
+        const std::filesystem::path& GetFilePath() const;
 
     public:
         static ComPtr<ID3D11SamplerState> s_samplers[static_cast<size_t>(eTextureSamplerType::COUNT)];
 
+    protected:
+        static HRESULT initializeSamplers(_In_ ID3D11Device* pDevice);
+        void updateSizeInBytes();
+
     protected:
         std::filesystem::path m_filePath;
         ComPtr<ID3D11ShaderResourceView> m_textureRV;
+        ComPtr<ID3D11CommandList> m_loadCommandList;
         eTextureSamplerType m_textureSamplerType;
+        eTextureLoadState m_loadState;
+        HRESULT m_loadResult;
+        UINT64 m_uSizeInBytes;
     };
 }
\ No newline at end of file
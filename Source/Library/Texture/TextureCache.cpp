@@ -0,0 +1,252 @@
+#include "Texture/TextureCache.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::GetShared
+
+      Summary:  Returns the process-wide cache, created on first use
+                with the default budget
+
+      Returns:  TextureCache&
+                  Process-wide texture cache
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    TextureCache& TextureCache::GetShared()
+    {
+        static TextureCache s_sharedCache(DEFAULT_BUDGET_BYTES);
+        return s_sharedCache;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::TextureCache
+
+      Summary:  Constructor
+
+      Args:     UINT64 uBudgetBytes
+                  Video memory budget of the loaded textures
+
+      Modifies: [m_entries, m_pathToEntryMap, m_textureToEntryMap,
+                 m_uFrame, m_uBudgetBytes, m_uResidentBytes,
+                 m_uNumHits, m_uNumMisses, m_uNumEvictions,
+                 m_uNumResidentTextures, m_loader].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    TextureCache::TextureCache(_In_ UINT64 uBudgetBytes)
+        : m_entries()
+        , m_pathToEntryMap()
+        , m_textureToEntryMap()
+        , m_uFrame(0u)
+        , m_uBudgetBytes(uBudgetBytes)
+        , m_uResidentBytes(0u)
+        , m_uNumHits(0u)
+        , m_uNumMisses(0u)
+        , m_uNumEvictions(0u)
+        , m_uNumResidentTextures(0u)
+        , m_loader(0u)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::Load
+
+      Summary:  Returns the texture of a file. The same file reached
+                through different paths maps to the same texture. On a
+                miss the texture is created and queued to the loader
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the texture
+                const std::filesystem::path& filePath
+                  Path to the texture file
+                std::shared_ptr<Texture>& outTexture
+                  The cached texture
+
+      Modifies: [m_entries, m_pathToEntryMap, m_textureToEntryMap,
+                 m_uNumHits, m_uNumMisses].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TextureCache::Load(_In_ ID3D11Device* pDevice, _In_ const std::filesystem::path& filePath, _Out_ std::shared_ptr<Texture>& outTexture)
+    {
+        std::error_code error;
+        std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(filePath, error);
+        if (error)
+        {
+            canonicalPath = filePath.lexically_normal();
+        }
+
+        const std::wstring szKey = canonicalPath.wstring();
+
+        auto it = m_pathToEntryMap.find(szKey);
+        if (it != m_pathToEntryMap.end())
+        {
+            ++m_uNumHits;
+            outTexture = it->second->texture;
+            Touch(pDevice, outTexture);
+
+            return S_OK;
+        }
+
+        ++m_uNumMisses;
+        outTexture = std::make_shared<Texture>(canonicalPath);
+
+        m_entries.push_front(Entry{ .texture = outTexture, .uLastUsedFrame = m_uFrame });
+        m_pathToEntryMap.emplace(szKey, m_entries.begin());
+        m_textureToEntryMap.emplace(outTexture.get(), m_entries.begin());
+
+        return m_loader.Enqueue(pDevice, outTexture);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::Touch
+
+      Summary:  Marks a texture as used this frame. An evicted texture
+                is queued to the loader again. Textures not created by
+                the cache are ignored
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the texture
+                const std::shared_ptr<Texture>& texture
+                  Texture bound by the renderer
+
+      Modifies: [m_entries].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureCache::Touch(_In_ ID3D11Device* pDevice, _In_ const std::shared_ptr<Texture>& texture)
+    {
+        auto it = m_textureToEntryMap.find(texture.get());
+        if (it == m_textureToEntryMap.end())
+        {
+            return;
+        }
+
+        it->second->uLastUsedFrame = m_uFrame;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+
+        if (texture->GetLoadState() == eTextureLoadState::UNLOADED)
+        {
+            m_loader.Enqueue(pDevice, texture);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::Update
+
+      Summary:  Finishes the textures loaded since the last frame,
+                recounts the resident bytes and evicts the least
+                recently used textures over the budget. Called once
+                per frame
+
+      Args:     ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to execute the uploads
+
+      Modifies: [m_uFrame, m_uResidentBytes, m_uNumResidentTextures,
+                 m_loader].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureCache::Update(_In_ ID3D11DeviceContext* pImmediateContext)
+    {
+        m_loader.Update(pImmediateContext);
+
+        m_uResidentBytes = 0u;
+        m_uNumResidentTextures = 0u;
+        for (const Entry& entry : m_entries)
+        {
+            if (entry.texture->GetLoadState() == eTextureLoadState::LOADED)
+            {
+                m_uResidentBytes += entry.texture->GetSizeInBytes();
+                ++m_uNumResidentTextures;
+            }
+        }
+
+        evict();
+
+        ++m_uFrame;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::SetBudget
+
+      Summary:  Sets the video memory budget. Takes effect on the next
+                Update
+
+      Args:     UINT64 uBudgetBytes
+                  Video memory budget of the loaded textures
+
+      Modifies: [m_uBudgetBytes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureCache::SetBudget(_In_ UINT64 uBudgetBytes)
+    {
+        m_uBudgetBytes = uBudgetBytes;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::GetStats
+
+      Summary:  Returns the cache counters. The resident figures are
+                the ones of the last Update
+
+      Returns:  TextureCacheStats
+                  Cache counters
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    TextureCacheStats TextureCache::GetStats() const
+    {
+        return TextureCacheStats
+        {
+            .uNumHits = m_uNumHits,
+            .uNumMisses = m_uNumMisses,
+            .uNumEvictions = m_uNumEvictions,
+            .uResidentBytes = m_uResidentBytes,
+            .uBudgetBytes = m_uBudgetBytes,
+            .uNumTextures = static_cast<UINT>(m_entries.size()),
+            .uNumResidentTextures = m_uNumResidentTextures,
+        };
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::GetThreadPool
+
+      Summary:  Returns the thread pool of the texture loader, one
+                thread per hardware thread. Loading code that fans out
+                with ParallelFor runs on it rather than starting and
+                joining a pool of its own. ParallelFor must not be
+                called from one of its tasks
+
+      Returns:  ThreadPool&
+                  Shared loading thread pool
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ThreadPool& TextureCache::GetThreadPool()
+    {
+        return m_loader.GetThreadPool();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::evict
+
+      Summary:  Unloads loaded textures from the least recently used
+                end until the resident bytes fit the budget. Textures
+                used during the current frame are kept
+
+      Modifies: [m_uResidentBytes, m_uNumResidentTextures,
+                 m_uNumEvictions].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureCache::evict()
+    {
+        for (auto it = m_entries.rbegin(); it != m_entries.rend() && m_uResidentBytes > m_uBudgetBytes; ++it)
+        {
+            if (it->uLastUsedFrame == m_uFrame)
+            {
+                // Everything further is more recent
+                break;
+            }
+
+            if (it->texture->GetLoadState() != eTextureLoadState::LOADED)
+            {
+                continue;
+            }
+
+            m_uResidentBytes -= it->texture->GetSizeInBytes();
+            --m_uNumResidentTextures;
+            ++m_uNumEvictions;
+
+            it->texture->Unload();
+        }
+    }
+}
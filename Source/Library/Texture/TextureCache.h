@@ -0,0 +1,131 @@
+/*+===================================================================
+  File:      TEXTURECACHE.H
+
+  Summary:   TextureCache header file contains declaration of class
+             TextureCache used to share textures between materials
+             and keep their video memory under a budget.
+
+  Classes:  TextureCache
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <list>
+
+#include "Texture/Texture.h"
+#include "Texture/TextureLoader.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   TextureCacheStats
+
+      Summary:  Counters of a texture cache
+
+                uNumHits
+                  Loads served by a texture already in the cache
+                uNumMisses
+                  Loads that created a new texture
+                uNumEvictions
+                  Textures unloaded to stay under the budget
+                uResidentBytes
+                  Estimated video memory of the loaded textures
+                uBudgetBytes
+                  Video memory budget
+                uNumTextures
+                  Number of textures in the cache
+                uNumResidentTextures
+                  Number of loaded textures in the cache
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct TextureCacheStats
+    {
+        UINT64 uNumHits;
+        UINT64 uNumMisses;
+        UINT64 uNumEvictions;
+        UINT64 uResidentBytes;
+        UINT64 uBudgetBytes;
+        UINT uNumTextures;
+        UINT uNumResidentTextures;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    TextureCache
+
+      Summary:  Process-wide cache of file textures keyed by canonical
+                path. Textures are loaded asynchronously by a texture
+                loader. The renderer touches a texture every time it
+                binds it; when the loaded textures exceed the budget,
+                the least recently used ones are unloaded and loaded
+                again the next time they are touched. Must be used on
+                the render thread
+
+      Methods:  GetShared
+                  Returns the process-wide cache
+                Load
+                  Returns the cached texture of a file, loading it on
+                  a miss
+                Touch
+                  Marks a texture as used this frame
+                Update
+                  Finishes loaded textures and evicts over the budget
+                SetBudget
+                  Sets the video memory budget
+                GetStats
+                  Returns the cache counters
+                GetThreadPool
+                  Returns the shared loading thread pool
+                TextureCache
+                  Constructor.
+                ~TextureCache
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class TextureCache
+    {
+    public:
+        static constexpr const UINT64 DEFAULT_BUDGET_BYTES = 512ull * 1024ull * 1024ull;
+
+    public:
+        static TextureCache& GetShared();
+
+    public:
+        TextureCache(_In_ UINT64 uBudgetBytes);
+        TextureCache(const TextureCache& other) = delete;
+        TextureCache(TextureCache&& other) = delete;
+        TextureCache& operator=(const TextureCache& other) = delete;
+        TextureCache& operator=(TextureCache&& other) = delete;
+        ~TextureCache() = default;
+
+        HRESULT Load(_In_ ID3D11Device* pDevice, _In_ const std::filesystem::path& filePath, _Out_ std::shared_ptr<Texture>& outTexture);
+        void Touch(_In_ ID3D11Device* pDevice, _In_ const std::shared_ptr<Texture>& texture);
+        void Update(_In_ ID3D11DeviceContext* pImmediateContext);
+
+        void SetBudget(_In_ UINT64 uBudgetBytes);
+        TextureCacheStats GetStats() const;
+        ThreadPool& GetThreadPool();
+
+    private:
+        struct Entry
+        {
+            std::shared_ptr<Texture> texture;
+            UINT64 uLastUsedFrame;
+        };
+
+        void evict();
+
+    private:
+        std::list<Entry> m_entries;
+        std::unordered_map<std::wstring, std::list<Entry>::iterator> m_pathToEntryMap;
+        std::unordered_map<const Texture*, std::list<Entry>::iterator> m_textureToEntryMap;
+        UINT64 m_uFrame;
+        UINT64 m_uBudgetBytes;
+        UINT64 m_uResidentBytes;
+        UINT64 m_uNumHits;
+        UINT64 m_uNumMisses;
+        UINT64 m_uNumEvictions;
+        UINT m_uNumResidentTextures;
+        TextureLoader m_loader;
+    };
+}
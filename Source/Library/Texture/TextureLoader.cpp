@@ -0,0 +1,131 @@
+#include "Texture/TextureLoader.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureLoader::TextureLoader
+
+      Summary:  Constructor
+
+      Args:     UINT uNumThreads
+                  Number of decoding threads. 0 uses one thread per
+                  hardware thread
+
+      Modifies: [m_aDecodedTextures, m_uNumPending, m_threadPool].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    TextureLoader::TextureLoader(_In_ UINT uNumThreads)
+        : m_mutex()
+        , m_aDecodedTextures()
+        , m_uNumPending(0u)
+        , m_threadPool(uNumThreads)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureLoader::Enqueue
+
+      Summary:  Queues a texture to be decoded on a worker thread. A
+                texture already loaded or queued is skipped
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the texture
+                const std::shared_ptr<Texture>& texture
+                  Texture to load
+
+      Modifies: [m_uNumPending, m_threadPool].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TextureLoader::Enqueue(_In_ ID3D11Device* pDevice, _In_ const std::shared_ptr<Texture>& texture)
+    {
+        HRESULT hr = texture->BeginLoading(pDevice);
+        if (hr != S_OK)
+        {
+            return SUCCEEDED(hr) ? S_OK : hr;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_uNumPending;
+        }
+
+        // The task keeps the device alive in case the renderer is torn
+        // down while textures are still decoding
+        ComPtr<ID3D11Device> device(pDevice);
+        m_threadPool.Enqueue([this, device, texture]()
+        {
+            // WIC is a COM API, each worker joins the multithreaded
+            // apartment for the duration of the task
+            HRESULT hrCom = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+            texture->Load(device.Get());
+
+            if (SUCCEEDED(hrCom))
+            {
+                CoUninitialize();
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_aDecodedTextures.push_back(texture);
+        });
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureLoader::Update
+
+      Summary:  Finishes the textures decoded since the last call.
+                Must be called on the render thread
+
+      Args:     ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to execute the uploads
+
+      Modifies: [m_aDecodedTextures, m_uNumPending].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureLoader::Update(_In_ ID3D11DeviceContext* pImmediateContext)
+    {
+        std::vector<std::shared_ptr<Texture>> aDecodedTextures;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            aDecodedTextures.swap(m_aDecodedTextures);
+            m_uNumPending -= static_cast<UINT>(aDecodedTextures.size());
+        }
+
+        for (const std::shared_ptr<Texture>& texture : aDecodedTextures)
+        {
+            texture->EndLoading(pImmediateContext);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureLoader::GetNumPending
+
+      Summary:  Returns the number of queued textures that Update has
+                not finished yet
+
+      Returns:  UINT
+                  Number of pending textures
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT TextureLoader::GetNumPending() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_uNumPending;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureLoader::GetThreadPool
+
+      Summary:  Returns the thread pool the textures decode on, so
+                other loading work can run on it instead of starting
+                threads of its own
+
+      Returns:  ThreadPool&
+                  Thread pool of the loader
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ThreadPool& TextureLoader::GetThreadPool()
+    {
+        return m_threadPool;
+    }
+}
@@ -0,0 +1,65 @@
+/*+===================================================================
+  File:      TEXTURELOADER.H
+
+  Summary:   TextureLoader header file contains declaration of class
+             TextureLoader used to decode textures on worker threads.
+
+  Classes:  TextureLoader
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <mutex>
+
+#include "Texture/Texture.h"
+#include "Thread/ThreadPool.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    TextureLoader
+
+      Summary:  Decodes textures and creates their resources on a
+                thread pool. The uploads are finished on the render
+                thread by Update, until then the textures stay in the
+                LOADING state and the renderer binds a placeholder
+
+      Methods:  Enqueue
+                  Queues a texture to be loaded
+                Update
+                  Finishes the textures decoded since the last call
+                GetNumPending
+                  Returns the number of textures not finished yet
+                GetThreadPool
+                  Returns the thread pool the textures decode on
+                TextureLoader
+                  Constructor.
+                ~TextureLoader
+                  Destructor. Waits for the queued textures
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class TextureLoader
+    {
+    public:
+        TextureLoader(_In_ UINT uNumThreads);
+        TextureLoader(const TextureLoader& other) = delete;
+        TextureLoader(TextureLoader&& other) = delete;
+        TextureLoader& operator=(const TextureLoader& other) = delete;
+        TextureLoader& operator=(TextureLoader&& other) = delete;
+        ~TextureLoader() = default;
+
+        HRESULT Enqueue(_In_ ID3D11Device* pDevice, _In_ const std::shared_ptr<Texture>& texture);
+        void Update(_In_ ID3D11DeviceContext* pImmediateContext);
+
+        UINT GetNumPending() const;
+        ThreadPool& GetThreadPool();
+
+    private:
+        mutable std::mutex m_mutex;
+        std::vector<std::shared_ptr<Texture>> m_aDecodedTextures;
+        UINT m_uNumPending;
+        ThreadPool m_threadPool;
+    };
+}
@@ -0,0 +1,175 @@
+#include "Thread/ThreadPool.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ThreadPool::ThreadPool
+
+      Summary:  Constructor. Starts the worker threads
+
+      Args:     UINT uNumThreads
+                  Number of worker threads. 0 uses one thread per
+                  hardware thread
+
+      Modifies: [m_aWorkers, m_tasks, m_uNumActiveTasks, m_bStopping].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ThreadPool::ThreadPool(_In_ UINT uNumThreads)
+        : m_aWorkers()
+        , m_tasks()
+        , m_mutex()
+        , m_taskAvailable()
+        , m_idle()
+        , m_uNumActiveTasks(0u)
+        , m_bStopping(FALSE)
+    {
+        if (uNumThreads == 0u)
+        {
+            uNumThreads = std::thread::hardware_concurrency();
+            if (uNumThreads == 0u)
+            {
+                uNumThreads = 1u;
+            }
+        }
+
+        m_aWorkers.reserve(uNumThreads);
+        for (UINT i = 0u; i < uNumThreads; ++i)
+        {
+            m_aWorkers.emplace_back(&ThreadPool::workerMain, this);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ThreadPool::~ThreadPool
+
+      Summary:  Destructor. Lets the workers drain the queue and joins
+                them
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bStopping = TRUE;
+        }
+        m_taskAvailable.notify_all();
+
+        for (std::thread& worker : m_aWorkers)
+        {
+            worker.join();
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ThreadPool::Enqueue
+
+      Summary:  Adds a task to the queue
+
+      Args:     std::function<void()>&& task
+                  Task to run on a worker thread
+
+      Modifies: [m_tasks].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ThreadPool::Enqueue(_In_ std::function<void()>&& task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_taskAvailable.notify_one();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ThreadPool::WaitIdle
+
+      Summary:  Blocks until the queue is empty and no task is running
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ThreadPool::WaitIdle()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this] { return m_tasks.empty() && m_uNumActiveTasks == 0u; });
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ThreadPool::ParallelFor
+
+      Summary:  Runs task(0) to task(uNumTasks - 1) on the worker
+                threads and blocks until all of them returned. Only
+                waits for its own tasks, so other users of the pool
+                are not affected. Must not be called from a worker
+                thread
+
+      Args:     UINT uNumTasks
+                  Number of tasks
+                const std::function<void(UINT)>& task
+                  Task called with the index of each task
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ThreadPool::ParallelFor(_In_ UINT uNumTasks, _In_ const std::function<void(UINT)>& task)
+    {
+        if (uNumTasks == 0u)
+        {
+            return;
+        }
+
+        std::latch done(static_cast<std::ptrdiff_t>(uNumTasks));
+        for (UINT uTaskIdx = 0u; uTaskIdx < uNumTasks; ++uTaskIdx)
+        {
+            Enqueue([&task, &done, uTaskIdx]()
+            {
+                task(uTaskIdx);
+                done.count_down();
+            });
+        }
+        done.wait();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ThreadPool::GetNumThreads
+
+      Summary:  Returns the number of worker threads
+
+      Returns:  UINT
+                  Number of worker threads
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT ThreadPool::GetNumThreads() const
+    {
+        return static_cast<UINT>(m_aWorkers.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ThreadPool::workerMain
+
+      Summary:  Worker thread loop
+
+      Modifies: [m_tasks, m_uNumActiveTasks].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ThreadPool::workerMain()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_taskAvailable.wait(lock, [this] { return m_bStopping || !m_tasks.empty(); });
+
+                if (m_tasks.empty())
+                {
+                    return;
+                }
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+                ++m_uNumActiveTasks;
+            }
+
+            task();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_uNumActiveTasks;
+                if (m_tasks.empty() && m_uNumActiveTasks == 0u)
+                {
+                    m_idle.notify_all();
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/*+===================================================================
+  File:      THREADPOOL.H
+
+  Summary:   ThreadPool header file contains declarations of
+             ThreadPool class used for the lab samples of Game
+             Graphics Programming course.
+
+  Classes: ThreadPool
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <thread>
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    ThreadPool
+
+      Summary:  Fixed number of worker threads consuming a FIFO queue
+                of tasks
+
+      Methods:  Enqueue
+                  Adds a task to the queue
+                WaitIdle
+                  Blocks until the queue is empty and no task runs
+                ParallelFor
+                  Runs a number of indexed tasks and waits for them
+                GetNumThreads
+                  Returns the number of worker threads
+                ThreadPool
+                  Constructor.
+                ~ThreadPool
+                  Destructor. Finishes the queued tasks and joins
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class ThreadPool
+    {
+    public:
+        ThreadPool(_In_ UINT uNumThreads);
+        ThreadPool(const ThreadPool& other) = delete;
+        ThreadPool(ThreadPool&& other) = delete;
+        ThreadPool& operator=(const ThreadPool& other) = delete;
+        ThreadPool& operator=(ThreadPool&& other) = delete;
+        ~ThreadPool();
+
+        void Enqueue(_In_ std::function<void()>&& task);
+        void WaitIdle();
+        void ParallelFor(_In_ UINT uNumTasks, _In_ const std::function<void(UINT)>& task);
+
+        UINT GetNumThreads() const;
+
+    private:
+        void workerMain();
+
+    private:
+        std::vector<std::thread> m_aWorkers;
+        std::deque<std::function<void()>> m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_taskAvailable;
+        std::condition_variable m_idle;
+        UINT m_uNumActiveTasks;
+        BOOL m_bStopping;
+    };
+}